@@ -0,0 +1,249 @@
+//
+//  FindMatcher.swift
+//  CodeEditSourceEditor
+//
+
+import Foundation
+
+/// A compiled find query that searches any range of a string.
+///
+/// Plain "contains" queries are matched on UTF-16 code units directly, scanning for the first unit of the query
+/// sixteen units at a time. Every other query compiles to an `NSRegularExpression`. A matcher holds no mutable
+/// state, so it may search an immutable string from a background thread.
+struct FindMatcher {
+    private enum Kind {
+        /// Query code units; lowercased when matching ignores (ASCII) case.
+        case literal(needle: [UInt16], ignoresCase: Bool)
+        case regex(NSRegularExpression)
+    }
+
+    private let kind: Kind
+
+    /// Whether a match may span any amount of text (user regular expressions). Such queries can't be updated
+    /// locally after an edit and are searched again in full.
+    let isUnbounded: Bool
+
+    /// The length of the query, the farthest a bounded match can reach past an edit.
+    let queryLength: Int
+
+    /// Number of code units searched between progress reports.
+    static let chunkLength = 1 << 20
+
+    init?(text: String, method: FindMethod, matchCase: Bool) {
+        guard !text.isEmpty else { return nil }
+        queryLength = (text as NSString).length
+        isUnbounded = method == .regularExpression
+
+        // Literal fast path. Case-insensitive only for ASCII queries, other scripts need full case folding.
+        if method == .contains && (matchCase || text.utf16.allSatisfy({ $0 < 0x80 })) {
+            let units = Array(text.utf16)
+            kind = .literal(needle: matchCase ? units : units.map(Self.lowercasedASCII), ignoresCase: !matchCase)
+            return
+        }
+
+        // Set case sensitivity based on matchCase property
+        var options: NSRegularExpression.Options = matchCase ? [] : [.caseInsensitive]
+
+        // Add multiline options for regular expressions
+        if method == .regularExpression {
+            options.insert(.dotMatchesLineSeparators)
+            options.insert(.anchorsMatchLines)
+        }
+
+        let pattern: String
+        switch method {
+        case .contains:
+            // Simple substring match, escape special characters
+            pattern = NSRegularExpression.escapedPattern(for: text)
+        case .matchesWord:
+            // Match whole words only using word boundaries
+            pattern = "\\b" + NSRegularExpression.escapedPattern(for: text) + "\\b"
+        case .startsWith:
+            // Match at the start of a line or after a word boundary
+            pattern = "(?:^|\\b)" + NSRegularExpression.escapedPattern(for: text)
+        case .endsWith:
+            // Match at the end of a line or before a word boundary
+            pattern = NSRegularExpression.escapedPattern(for: text) + "(?:$|\\b)"
+        case .regularExpression:
+            // Use the pattern directly without additional escaping
+            pattern = text
+        }
+
+        guard let regex = try? NSRegularExpression(pattern: pattern, options: options) else {
+            return nil
+        }
+        kind = .regex(regex)
+    }
+
+    // MARK: - Search
+
+    /// All non-empty matches inside `range`, in document order.
+    func matches(in string: NSString, range: NSRange) -> [NSRange] {
+        var result: [NSRange] = []
+        enumerateMatches(in: string, range: range) { batch, _ in
+            result.append(contentsOf: batch)
+            return true
+        }
+        return result
+    }
+
+    /// Search `range`, reporting matches in document order in batches along with the offset the search has reached.
+    /// `batch` is called at least once per ``chunkLength`` code units searched (possibly with no matches); returning
+    /// `false` stops the search. Text outside `range` is visible to anchors, word boundaries and lookarounds but never
+    /// part of a match.
+    func enumerateMatches(
+        in string: NSString,
+        range: NSRange,
+        batch: (_ matches: [NSRange], _ searchedTo: Int) -> Bool
+    ) {
+        switch kind {
+        case let .literal(needle, ignoresCase):
+            Self.enumerateLiteral(needle, ignoresCase: ignoresCase, in: string, range: range, batch: batch)
+        case .regex(let regex):
+            Self.enumerateRegex(regex, in: string, range: range, batch: batch)
+        }
+    }
+
+    private static func enumerateRegex(
+        _ regex: NSRegularExpression,
+        in string: NSString,
+        range: NSRange,
+        batch: ([NSRange], Int) -> Bool
+    ) {
+        var pending: [NSRange] = []
+        var reportedThrough = range.location
+
+        regex.enumerateMatches(
+            in: string as String,
+            options: [.reportProgress, .withTransparentBounds, .withoutAnchoringBounds],
+            range: range
+        ) { match, _, stop in
+            if let matchRange = match?.range, !matchRange.isEmpty {
+                pending.append(matchRange)
+            }
+            // Progress callbacks carry no match; report once enough text has gone by
+            let position = pending.last.map(NSMaxRange) ?? reportedThrough
+            if match == nil || position - reportedThrough >= chunkLength {
+                reportedThrough = position
+                if !batch(pending, position) {
+                    stop.pointee = true
+                }
+                pending.removeAll(keepingCapacity: true)
+            }
+        }
+        _ = batch(pending, NSMaxRange(range))
+    }
+
+    private static func enumerateLiteral(
+        _ needle: [UInt16],
+        ignoresCase: Bool,
+        in string: NSString,
+        range: NSRange,
+        batch: ([NSRange], Int) -> Bool
+    ) {
+        let needleLength = needle.count
+        let end = NSMaxRange(range)
+        guard range.length >= needleLength else {
+            _ = batch([], end)
+            return
+        }
+
+        // Each chunk is read with `needleLength - 1` units of overlap so matches across the seam are found
+        var buffer = [UInt16](repeating: 0, count: min(chunkLength + needleLength - 1, range.length))
+        var chunkStart = range.location
+        // Matches don't overlap; the next one can't start before this
+        var nextStart = range.location
+
+        while chunkStart + needleLength <= end {
+            let length = min(buffer.count, end - chunkStart)
+            var found: [NSRange] = []
+
+            buffer.withUnsafeMutableBufferPointer { buffer in
+                string.getCharacters(buffer.baseAddress!, range: NSRange(location: chunkStart, length: length))
+                let chunk = UnsafeBufferPointer(rebasing: buffer[0..<length])
+                // Starts past the chunk length belong to the next chunk
+                let lastStart = min(length - needleLength, chunkLength - 1)
+                let first = needle[0]
+                let firstUpper = ignoresCase ? uppercasedASCII(first) : first
+
+                var index = max(0, nextStart - chunkStart)
+                while index <= lastStart, let candidate = firstIndex(
+                    of: first,
+                    or: firstUpper,
+                    in: chunk,
+                    from: index,
+                    through: lastStart
+                ) {
+                    if hasMatch(needle, ignoresCase: ignoresCase, in: chunk, at: candidate) {
+                        found.append(NSRange(location: chunkStart + candidate, length: needleLength))
+                        index = candidate + needleLength
+                    } else {
+                        index = candidate + 1
+                    }
+                }
+                nextStart = max(nextStart, chunkStart + index)
+            }
+
+            chunkStart += chunkLength
+            guard batch(found, min(chunkStart, end)) else { return }
+        }
+    }
+
+    // MARK: - Literal Helpers
+
+    /// First index in `from...last` holding `unit` or `alternate`.
+    private static func firstIndex(
+        of unit: UInt16,
+        or alternate: UInt16,
+        in buffer: UnsafeBufferPointer<UInt16>,
+        from start: Int,
+        through last: Int
+    ) -> Int? {
+        guard let base = buffer.baseAddress else { return nil }
+        let raw = UnsafeRawPointer(base)
+        let units = SIMD16<UInt16>(repeating: unit)
+        let alternates = SIMD16<UInt16>(repeating: alternate)
+
+        var index = start
+        while index + 16 <= last + 1 {
+            let vector = raw.loadUnaligned(fromByteOffset: index * 2, as: SIMD16<UInt16>.self)
+            let hits = (vector .== units) .| (vector .== alternates)
+            if any(hits) {
+                for lane in 0..<16 where hits[lane] {
+                    return index + lane
+                }
+            }
+            index += 16
+        }
+        while index <= last {
+            if buffer[index] == unit || buffer[index] == alternate {
+                return index
+            }
+            index += 1
+        }
+        return nil
+    }
+
+    private static func hasMatch(
+        _ needle: [UInt16],
+        ignoresCase: Bool,
+        in buffer: UnsafeBufferPointer<UInt16>,
+        at start: Int
+    ) -> Bool {
+        for offset in 1..<needle.count {
+            let unit = buffer[start + offset]
+            if (ignoresCase ? lowercasedASCII(unit) : unit) != needle[offset] {
+                return false
+            }
+        }
+        return true
+    }
+
+    private static func lowercasedASCII(_ unit: UInt16) -> UInt16 {
+        (0x41...0x5A).contains(unit) ? unit + 0x20 : unit
+    }
+
+    private static func uppercasedASCII(_ unit: UInt16) -> UInt16 {
+        (0x61...0x7A).contains(unit) ? unit - 0x20 : unit
+    }
+}
@@ -5,9 +5,11 @@
 //  Created by Khan Winter on 4/18/25.
 //
 
+import Foundation
 import CodeEditTextView
 
 extension FindPanelViewModel {
+    /// Emphasize matches near the viewport, with the current match active and selected in the document.
     func addMatchEmphases(flashCurrent: Bool) {
         guard let target = target, let emphasisManager = target.textView.emphasisManager else {
             return
@@ -16,10 +18,16 @@ extension FindPanelViewModel {
         // Clear existing emphases
         emphasisManager.removeEmphases(for: EmphasisGroup.find)
 
+        // The current match is always included so it gets selected, even when it's off screen
+        var indices = emphasizedMatchIndices()
+        if let currentFindMatchIndex, !indices.contains(currentFindMatchIndex) {
+            indices.append(currentFindMatchIndex)
+        }
+
         // Create emphasis with the nearest match as active
-        let emphases = findMatches.enumerated().map { index, range in
+        let emphases = indices.map { index in
             Emphasis(
-                range: range,
+                range: findMatches[index],
                 style: .standard,
                 flash: flashCurrent && index == currentFindMatchIndex,
                 inactive: index != currentFindMatchIndex,
@@ -29,6 +37,40 @@ extension FindPanelViewModel {
 
         // Add all emphases
         emphasisManager.addEmphases(emphases, for: EmphasisGroup.find)
+        showsMatchEmphases = true
+    }
+
+    /// Re-create the emphases shown by ``addMatchEmphases(flashCurrent:)`` for the matches now near the viewport,
+    /// after scrolling or when matches change. Leaves the selection alone.
+    func updateVisibleEmphases() {
+        guard showsMatchEmphases, let emphasisManager = target?.textView.emphasisManager else {
+            return
+        }
+
+        let emphases = emphasizedMatchIndices().map { index in
+            Emphasis(
+                range: findMatches[index],
+                style: .standard,
+                flash: false,
+                inactive: index != currentFindMatchIndex,
+                selectInDocument: false
+            )
+        }
+        emphasisManager.replaceEmphases(emphases, for: EmphasisGroup.find)
+    }
+
+    /// Indices of matches within a screen's worth of text of the visible text; all matches when the text view
+    /// isn't laid out.
+    private func emphasizedMatchIndices() -> [Int] {
+        guard let textView = target?.textView, let visibleRange = textView.visibleTextRange else {
+            return Array(findMatches.indices)
+        }
+
+        let start = max(0, visibleRange.location - visibleRange.length)
+        let end = NSMaxRange(visibleRange) + visibleRange.length
+        let first = Self.firstIndex(in: findMatches, endingAfter: start)
+        let last = Self.firstIndex(in: findMatches, startingAtOrAfter: end)
+        return first < last ? Array(first..<last) : []
     }
 
     func flashCurrentMatch() {
@@ -42,6 +84,7 @@ extension FindPanelViewModel {
 
         // Clear existing emphases
         emphasisManager.removeEmphases(for: EmphasisGroup.find)
+        showsMatchEmphases = false
 
         // Create emphasis with the nearest match as active
         let emphasis = (
@@ -60,5 +103,6 @@ extension FindPanelViewModel {
 
     func clearMatchEmphases() {
         target?.textView.emphasisManager?.removeEmphases(for: EmphasisGroup.find)
+        showsMatchEmphases = false
     }
 }
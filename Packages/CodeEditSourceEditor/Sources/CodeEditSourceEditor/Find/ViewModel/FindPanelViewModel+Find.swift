@@ -8,69 +8,294 @@
 import Foundation
 
 extension FindPanelViewModel {
+    /// Documents up to this many UTF-16 code units are searched synchronously, in one pass.
+    static let synchronousFindLength = 1 << 19
+
+    /// Minimum time between publishing partial results of a background search.
+    static let findProgressInterval: TimeInterval = 0.1
+
     // MARK: - Find
 
     /// Performs a find operation on the find target and updates both the ``findMatches`` array and the emphasis
     /// manager's emphases.
+    ///
+    /// Small documents are searched in one pass. In larger ones the visible text is searched first, so matches on
+    /// screen show up immediately, and the rest of the document is searched in the background while
+    /// ``findMatches`` fills in. Starting another find cancels a search in progress.
     func find() {
+        cancelFind()
+        dirtyRanges = []
+        needsFullFind = false
+
         // Don't find if target isn't ready or the query is empty
         guard let target = target, !findText.isEmpty else {
+            self.activeMatcher = nil
             self.findMatches = []
             return
         }
 
-        // Set case sensitivity based on matchCase property
-        var findOptions: NSRegularExpression.Options = matchCase ? [] : [.caseInsensitive]
+        guard let matcher = FindMatcher(text: findText, method: findMethod, matchCase: matchCase) else {
+            self.activeMatcher = nil
+            self.findMatches = []
+            self.currentFindMatchIndex = nil
+            return
+        }
+        activeMatcher = matcher
 
-        // Add multiline options for regular expressions
-        if findMethod == .regularExpression {
-            findOptions.insert(.dotMatchesLineSeparators)
-            findOptions.insert(.anchorsMatchLines)
+        let documentRange = target.textView.documentRange
+        guard documentRange.length > Self.synchronousFindLength,
+              let visibleRange = target.textView.visibleTextRange?.intersection(documentRange) else {
+            self.findMatches = matcher.matches(in: target.textView.textStorage.mutableString, range: documentRange)
+            didUpdateMatches()
+            return
         }
 
-        let pattern: String
+        let snapshot = documentSnapshot ?? NSString(string: target.textView.textStorage.string)
+        documentSnapshot = snapshot
+
+        let visibleMatches = matcher.matches(in: snapshot, range: visibleRange)
+        self.findMatches = visibleMatches
+        didUpdateMatches()
 
-        switch findMethod {
-        case .contains:
-            // Simple substring match, escape special characters
-            pattern = NSRegularExpression.escapedPattern(for: findText)
+        searchInBackground(matcher, in: snapshot, range: documentRange, visibleMatches: visibleMatches)
+    }
 
-        case .matchesWord:
-            // Match whole words only using word boundaries
-            pattern = "\\b" + NSRegularExpression.escapedPattern(for: findText) + "\\b"
+    /// Stops a background search; ``findMatches`` keeps what was found so far.
+    func cancelFind() {
+        findTask?.cancel()
+        findTask = nil
+        findGeneration += 1
+    }
 
-        case .startsWith:
-            // Match at the start of a line or after a word boundary
-            pattern = "(?:^|\\b)" + NSRegularExpression.escapedPattern(for: findText)
+    /// Whether ``findMatches`` covers only part of the document because a background search is still running.
+    var isFindInProgress: Bool {
+        findTask != nil
+    }
+
+    /// Finish a background search synchronously, so ``findMatches`` covers the whole document.
+    func completeFind() {
+        guard isFindInProgress, let target, let matcher = activeMatcher else { return }
+        cancelFind()
+        let current = currentMatchRange
+        let text = target.textView.textStorage.mutableString
+        self.findMatches = matcher.matches(in: text, range: target.textView.documentRange)
+        restoreCurrentMatch(current)
+    }
 
-        case .endsWith:
-            // Match at the end of a line or before a word boundary
-            pattern = NSRegularExpression.escapedPattern(for: findText) + "(?:$|\\b)"
+    private func searchInBackground(
+        _ matcher: FindMatcher,
+        in snapshot: NSString,
+        range: NSRange,
+        visibleMatches: [NSRange]
+    ) {
+        let generation = findGeneration
+        findTask = Task.detached(priority: .userInitiated) { [weak self] in
+            var found: [NSRange] = []
+            var lastPublished = Date.distantPast
+
+            matcher.enumerateMatches(in: snapshot, range: range) { batch, searchedTo in
+                guard !Task.isCancelled else { return false }
+                found.append(contentsOf: batch)
+
+                let now = Date()
+                guard now.timeIntervalSince(lastPublished) >= Self.findProgressInterval else { return true }
+                lastPublished = now
+
+                // Visible matches past the searched text stay listed until the search reaches them
+                let searched = max(searchedTo, found.last.map(NSMaxRange) ?? 0)
+                let pending = visibleMatches.drop(while: { $0.location < searched })
+                let partial = found + pending
+                DispatchQueue.main.async {
+                    self?.receiveBackgroundMatches(partial, isComplete: false, generation: generation)
+                }
+                return true
+            }
 
-        case .regularExpression:
-            // Use the pattern directly without additional escaping
-            pattern = findText
+            guard !Task.isCancelled else { return }
+            DispatchQueue.main.async { [found] in
+                self?.receiveBackgroundMatches(found, isComplete: true, generation: generation)
+            }
         }
+    }
 
-        guard let regex = try? NSRegularExpression(pattern: pattern, options: findOptions) else {
-            self.findMatches = []
-            self.currentFindMatchIndex = nil
+    private func receiveBackgroundMatches(_ matches: [NSRange], isComplete: Bool, generation: Int) {
+        guard generation == findGeneration else { return }
+        if isComplete {
+            findTask = nil
+        }
+
+        let current = currentMatchRange
+        self.findMatches = matches
+        restoreCurrentMatch(current)
+        updateVisibleEmphases()
+    }
+
+    // MARK: - Edits
+
+    /// Remove matches touched by an edit and shift the ones after it. The edited text is searched again on the
+    /// following text change notification, see ``updateMatchesAfterEdit()``.
+    func textStorageDidEdit(_ textStorage: NSTextStorage, editedRange: NSRange, changeInLength: Int) {
+        guard let matcher = activeMatcher, !needsFullFind else { return }
+        guard !matcher.isUnbounded, !isFindInProgress else {
+            // Matches may span the edit, or aren't all known yet
+            needsFullFind = true
+            return
+        }
+
+        let text = textStorage.mutableString
+        let oldEditEnd = NSMaxRange(editedRange) - changeInLength
+
+        // Matches can reach `queryLength` past the edit; whole lines are searched again so anchors and word
+        // boundaries see their context
+        let reachStart = max(0, editedRange.location - matcher.queryLength)
+        let reachEnd = min(text.length, NSMaxRange(editedRange) + matcher.queryLength)
+        var dirty = text.lineRange(for: NSRange(location: reachStart, length: reachEnd - reachStart))
+
+        // Same range in pre-edit coordinates
+        let oldDirtyStart = dirty.location
+        let oldDirtyEnd = NSMaxRange(dirty) - changeInLength
+        // Edited as a copy so the published array changes once
+        var matches = findMatches
+        let removeFrom = Self.firstIndex(in: matches, endingAfter: oldDirtyStart)
+        let removeTo = Self.firstIndex(in: matches, startingAtOrAfter: oldDirtyEnd)
+
+        if removeFrom < removeTo {
+            // A removed match may reach outside the dirty lines; search its text again too
+            let firstStart = matches[removeFrom].location
+            let lastEnd = NSMaxRange(matches[removeTo - 1])
+            let start = min(dirty.location, firstStart)
+            let end = max(NSMaxRange(dirty), lastEnd >= oldEditEnd ? lastEnd + changeInLength : lastEnd)
+            dirty = text.lineRange(for: NSRange(location: start, length: min(end, text.length) - start))
+        }
+
+        if changeInLength != 0 {
+            for index in removeTo..<matches.count {
+                matches[index].location += changeInLength
+            }
+        }
+        // Earlier dirty ranges move with the text; one reaching into the edit grows or shrinks with it
+        for index in dirtyRanges.indices {
+            let range = dirtyRanges[index]
+            if range.location >= oldEditEnd {
+                dirtyRanges[index].location += changeInLength
+            } else if NSMaxRange(range) > editedRange.location {
+                dirtyRanges[index].length = max(editedRange.location - range.location, range.length + changeInLength)
+            }
+        }
+        if let current = currentFindMatchIndex {
+            if current >= removeTo {
+                currentFindMatchIndex = current - (removeTo - removeFrom)
+            } else if current >= removeFrom {
+                currentFindMatchIndex = nil
+            }
+        }
+        matches.removeSubrange(removeFrom..<removeTo)
+        findMatches = matches
+        dirtyRanges.append(dirty)
+    }
+
+    /// Search the text edited since the last call and merge the results into ``findMatches``. Falls back to a full
+    /// find when the edits couldn't be tracked.
+    func updateMatchesAfterEdit() {
+        guard let target, let matcher = activeMatcher, !needsFullFind else {
+            find()
             return
         }
 
-        let text = target.textView.string
-        let range = target.textView.documentRange
-        let matches = regex.matches(in: text, range: range).filter { !$0.range.isEmpty }
+        let text = target.textView.textStorage.mutableString
+        let ranges = mergedDirtyRanges(length: text.length)
+        dirtyRanges = []
+
+        var matches = findMatches
+        for range in ranges {
+            let found = matcher.matches(in: text, range: range)
+            // Kept matches don't start inside a dirty range; replace any that do rather than list overlapping matches
+            let insertAt = Self.firstIndex(in: matches, startingAtOrAfter: range.location)
+            let replaceTo = Self.firstIndex(in: matches, startingAtOrAfter: NSMaxRange(range))
+            matches.replaceSubrange(insertAt..<replaceTo, with: found)
+        }
+        findMatches = matches
+
+        didUpdateMatches()
+    }
 
-        self.findMatches = matches.map(\.range)
+    private func mergedDirtyRanges(length: Int) -> [NSRange] {
+        var merged: [NSRange] = []
+        for range in dirtyRanges.sorted(by: { $0.location < $1.location }) {
+            let start = min(range.location, length)
+            let clamped = NSRange(location: start, length: min(NSMaxRange(range), length) - start)
+            if let last = merged.last, clamped.location <= NSMaxRange(last) {
+                merged[merged.count - 1] = last.union(clamped)
+            } else {
+                merged.append(clamped)
+            }
+        }
+        return merged
+    }
 
+    // MARK: - Current Match
+
+    /// Select the match nearest the cursor and emphasize matches if the find panel is focused.
+    private func didUpdateMatches() {
         // Find the nearest match to the current cursor position
         currentFindMatchIndex = getNearestEmphasisIndex(matchRanges: findMatches)
 
         // Only add emphasis layers if the find panel is focused
         if isFocused {
             addMatchEmphases(flashCurrent: false)
+        } else {
+            updateVisibleEmphases()
+        }
+    }
+
+    private var currentMatchRange: NSRange? {
+        guard let currentFindMatchIndex, findMatches.indices.contains(currentFindMatchIndex) else { return nil }
+        return findMatches[currentFindMatchIndex]
+    }
+
+    /// Point ``currentFindMatchIndex`` back at `range` after ``findMatches`` changed, or at the match nearest the
+    /// cursor if it's gone.
+    private func restoreCurrentMatch(_ range: NSRange?) {
+        if let range {
+            let index = Self.firstIndex(in: findMatches, startingAtOrAfter: range.location)
+            if index < findMatches.count && findMatches[index] == range {
+                currentFindMatchIndex = index
+                return
+            }
+        }
+        currentFindMatchIndex = getNearestEmphasisIndex(matchRanges: findMatches)
+    }
+
+    // MARK: - Match Lookup
+
+    /// Index of the first match starting at or after `location`; matches are sorted and don't overlap.
+    static func firstIndex(in matches: [NSRange], startingAtOrAfter location: Int) -> Int {
+        var low = 0
+        var high = matches.count
+        while low < high {
+            let mid = (low + high) / 2
+            if matches[mid].location < location {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return low
+    }
+
+    /// Index of the first match ending after `location`.
+    static func firstIndex(in matches: [NSRange], endingAfter location: Int) -> Int {
+        var low = 0
+        var high = matches.count
+        while low < high {
+            let mid = (low + high) / 2
+            if NSMaxRange(matches[mid]) <= location {
+                low = mid + 1
+            } else {
+                high = mid
+            }
         }
+        return low
     }
 
     // MARK: - Get Nearest Emphasis Index
@@ -18,9 +18,19 @@ extension FindPanelViewModel {
             return
         }
 
-        replaceMatch(index: currentFindMatchIndex, textView: target.textView, matches: &findMatches)
+        // Partial results of a background search would be stale after the edit; search again afterwards
+        let restartFind = isFindInProgress
+        cancelFind()
 
-        self.findMatches = findMatches.enumerated().filter({ $0.offset != currentFindMatchIndex }).map(\.element)
+        var matches = findMatches
+        replaceMatch(index: currentFindMatchIndex, textView: target.textView, matches: &matches)
+
+        self.findMatches = matches.enumerated().filter({ $0.offset != currentFindMatchIndex }).map(\.element)
+
+        if restartFind {
+            find()
+            return
+        }
 
         // Update currentFindMatchIndex based on wrapAround setting
         if findMatches.isEmpty {
@@ -42,6 +52,9 @@ extension FindPanelViewModel {
             return
         }
 
+        // Every match must be known before replacing
+        completeFind()
+
         target.textView.undoManager?.beginUndoGrouping()
         target.textView.textStorage.beginEditing()
 
@@ -75,14 +88,16 @@ extension FindPanelViewModel {
     private func replaceMatch(index: Int, textView: TextView, matches: inout [NSRange]) {
         let range = matches[index]
         // Set cursor positions to the match range
+        isReplacing = true
         textView.replaceCharacters(in: range, with: replaceText)
+        isReplacing = false
 
         // Adjust the length of the replacement
         let lengthDiff = replaceText.utf16.count - range.length
 
         // Update all match ranges after the current match
         for idx in matches.dropFirst(index + 1).indices {
-            matches[idx].location -= lengthDiff
+            matches[idx].location += lengthDiff
         }
     }
 }
@@ -44,6 +44,25 @@ class FindPanelViewModel: ObservableObject {
     @Published var matchCase: Bool = false
     @Published var wrapAround: Bool = true
 
+    // MARK: - Find State
+
+    /// The compiled query ``findMatches`` were found with.
+    var activeMatcher: FindMatcher?
+    /// Background search of the rest of a large document, if one is running.
+    var findTask: Task<Void, Never>?
+    /// Incremented whenever a search is cancelled, so results of a stale search are dropped.
+    var findGeneration = 0
+    /// Immutable copy of the document for background searches; dropped on edit.
+    var documentSnapshot: NSString?
+    /// Text edited since the last text change notification whose matches must be searched again.
+    var dirtyRanges: [NSRange] = []
+    /// Set when an edit can't be applied to ``findMatches`` locally.
+    var needsFullFind = false
+    /// Set while replacing matches; replace updates ``findMatches`` itself.
+    var isReplacing = false
+    /// Whether the find group currently shows every match near the viewport (rather than a single flash).
+    var showsMatchEmphases = false
+
     /// The height of the find panel.
     var panelHeight: CGFloat {
         return mode == .replace ? 54 : 28
@@ -73,17 +92,55 @@ class FindPanelViewModel: ObservableObject {
                 name: TextView.textDidChangeNotification,
                 object: textViewController.textView
             )
+
+            // Edited ranges, to update matches without searching the whole document
+            NotificationCenter.default.addObserver(
+                self,
+                selector: #selector(textStorageDidProcessEditing(_:)),
+                name: NSTextStorage.didProcessEditingNotification,
+                object: nil
+            )
+
+            // Emphases exist only near the viewport and follow it
+            NotificationCenter.default.addObserver(
+                self,
+                selector: #selector(scrollPositionDidUpdate),
+                name: TextViewController.scrollPositionDidUpdateNotification,
+                object: textViewController
+            )
         }
     }
 
+    deinit {
+        findTask?.cancel()
+    }
+
     // MARK: - Text Listeners
 
-    /// Find target's text content changed, we need to re-search the contents and emphasize results.
+    /// Find target's text content changed, we need to re-search the edited text and emphasize results.
     @objc private func textDidChange() {
         // Only update if we have find text
-        if !findText.isEmpty {
-            find()
+        guard !findText.isEmpty, !isReplacing else { return }
+        updateMatchesAfterEdit()
+    }
+
+    @objc private func textStorageDidProcessEditing(_ notification: Notification) {
+        guard let textStorage = notification.object as? NSTextStorage,
+              textStorage === target?.textView.textStorage,
+              textStorage.editedMask.contains(.editedCharacters) else {
+            return
         }
+        documentSnapshot = nil
+        guard !isReplacing else { return }
+        textStorageDidEdit(
+            textStorage,
+            editedRange: textStorage.editedRange,
+            changeInLength: textStorage.changeInLength
+        )
+    }
+
+    @objc private func scrollPositionDidUpdate() {
+        updateVisibleEmphases()
     }
 
     /// The contents of the find search field changed, trigger related events.
@@ -99,12 +156,12 @@ class FindPanelViewModel: ObservableObject {
         // If the textview is first responder, exit fast
         if target?.findPanelTargetView.window?.firstResponder === target?.findPanelTargetView {
             // If the text view has focus, just clear visual emphases but keep our find matches
-            target?.textView.emphasisManager?.removeEmphases(for: EmphasisGroup.find)
+            clearMatchEmphases()
             return
         }
 
         // Clear existing emphases before performing new find
-        target?.textView.emphasisManager?.removeEmphases(for: EmphasisGroup.find)
+        clearMatchEmphases()
         find()
 
         NotificationCenter.default.post(name: Self.Notifications.textDidChange, object: target)
@@ -236,4 +236,51 @@ struct FindPanelTests {
         viewModel.find()
         #expect(viewModel.findMatches.count == 3)
     }
+
+    @Test func literalMatcherMatchesRegularExpression() async throws {
+        let text = "Test test TEST tEsT\nprefix_test testtest\ntes t" as NSString
+        let range = NSRange(location: 0, length: text.length)
+
+        for matchCase in [true, false] {
+            for query in ["test", "Test", "tt", "t", "est t"] {
+                let literal = try #require(FindMatcher(text: query, method: .contains, matchCase: matchCase))
+                let regex = try NSRegularExpression(
+                    pattern: NSRegularExpression.escapedPattern(for: query),
+                    options: matchCase ? [] : [.caseInsensitive]
+                )
+                let expected = regex.matches(in: text as String, range: range).map(\.range)
+                #expect(literal.matches(in: text, range: range) == expected)
+            }
+        }
+    }
+
+    @Test func literalMatcherFindsMatchesAcrossChunks() async throws {
+        let chunkLength = FindMatcher.chunkLength
+        let text = String(repeating: "a", count: chunkLength - 2) + "needle" + String(repeating: "b", count: 10)
+        let matcher = try #require(FindMatcher(text: "needle", method: .contains, matchCase: true))
+
+        let string = text as NSString
+        let matches = matcher.matches(in: string, range: NSRange(location: 0, length: string.length))
+        #expect(matches == [NSRange(location: chunkLength - 2, length: 6)])
+    }
+
+    @Test func matchesUpdateAfterEdit() async throws {
+        target.textView.string = "test1\ntest2\ntest3"
+        viewModel.findText = "test"
+        viewModel.find()
+        #expect(viewModel.findMatches.count == 3)
+
+        // Insert a match on the first line, shifting the others
+        let textStorage = target.textView.textStorage!
+        textStorage.replaceCharacters(in: NSRange(location: 0, length: 0), with: "test ")
+        viewModel.textStorageDidEdit(textStorage, editedRange: NSRange(location: 0, length: 5), changeInLength: 5)
+        viewModel.updateMatchesAfterEdit()
+        #expect(viewModel.findMatches.map(\.location) == [0, 5, 11, 17])
+
+        // Break the match on the last line
+        textStorage.replaceCharacters(in: NSRange(location: 18, length: 1), with: "x")
+        viewModel.textStorageDidEdit(textStorage, editedRange: NSRange(location: 18, length: 1), changeInLength: 0)
+        viewModel.updateMatchesAfterEdit()
+        #expect(viewModel.findMatches.map(\.location) == [0, 5, 11])
+    }
 }
@@ -76,6 +76,70 @@ struct JSONRPCNotification: Codable {
     }
 }
 
+// MARK: - Typed Envelopes
+
+/// Outgoing request encoded straight from its params type (no AnyCodable round-trip)
+struct JSONRPCTypedRequest<Params: Encodable>: Encodable {
+    let jsonrpc: String = "2.0"
+    let id: RequestId
+    let method: String
+    let params: Params
+
+    enum CodingKeys: String, CodingKey {
+        case jsonrpc, id, method, params
+    }
+}
+
+struct JSONRPCTypedNotification<Params: Encodable>: Encodable {
+    let jsonrpc: String = "2.0"
+    let method: String
+    let params: Params
+
+    enum CodingKeys: String, CodingKey {
+        case jsonrpc, method, params
+    }
+}
+
+/// Response decoded directly into the expected result type
+struct JSONRPCTypedResponse<Result: Decodable>: Decodable {
+    let id: RequestId
+    let result: Result?
+    let error: JSONRPCError?
+
+    enum CodingKeys: String, CodingKey {
+        case id, result, error
+    }
+}
+
+/// Incoming notification params decoded directly into a concrete type
+struct JSONRPCTypedNotificationParams<Params: Decodable>: Decodable {
+    let params: Params
+}
+
+/// Placeholder result for responses whose payload is ignored
+struct JSONRPCIgnoredResult: Decodable {
+    init(from decoder: Decoder) throws {}
+}
+
+/// Raw frame of a response, decoded by whoever awaits it
+struct JSONRPCRawResponse {
+    let id: RequestId
+    let data: Data
+}
+
+/// Notification delivered to sessions; session updates arrive already decoded
+enum ACPNotification {
+    case sessionUpdate(SessionUpdateNotification)
+    case other(JSONRPCNotification)
+
+    var method: String {
+        switch self {
+        case .sessionUpdate: return "session/update"
+        case .other(let notification): return notification.method
+        }
+    }
+}
+
 struct JSONRPCError: Codable {
     let code: Int
     let message: String
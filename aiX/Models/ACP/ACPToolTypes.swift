@@ -128,6 +128,8 @@ struct ToolCall: Codable, Identifiable {
     var timestamp: Date = Date()
     var iterationId: String?
     var parentToolCallId: String?  // Parent Task's toolCallId for nested tool calls
+    /// Bumped by AgentSession on every stored change, so views can tell updates apart cheaply
+    var revision = 0
 
     var id: String { toolCallId }
 
@@ -71,6 +71,28 @@ struct GitGraphCommit: Identifiable {
     }
 }
 
+extension GitGraphCommit {
+    /// Same commit at another row, with updated branch and worktree labels
+    func relabeled(row: Int, branchNames: [String], worktreeNames: [String]) -> GitGraphCommit {
+        GitGraphCommit(
+            id: id,
+            shortHash: shortHash,
+            message: message,
+            author: author,
+            date: date,
+            filesChanged: filesChanged,
+            additions: additions,
+            deletions: deletions,
+            parentIds: parentIds,
+            row: row,
+            column: column,
+            trackColor: trackColor,
+            branchNames: branchNames,
+            worktreeNames: worktreeNames
+        )
+    }
+}
+
 /// Connection line between commits
 struct GitGraphConnection {
     let fromCommitId: String
@@ -100,6 +122,27 @@ struct GitGraphConnection {
     }
 }
 
+extension GitGraphConnection {
+    func shifted(by rows: Int) -> GitGraphConnection {
+        GitGraphConnection(
+            fromCommitId: fromCommitId,
+            toCommitId: toCommitId,
+            fromColumn: fromColumn,
+            toColumn: toColumn,
+            fromRow: fromRow + rows,
+            toRow: toRow + rows,
+            color: color
+        )
+    }
+}
+
+/// Commits and connections of the part of a graph laid out so far
+struct GitGraphSnapshot {
+    var commits: [GitGraphCommit] = []
+    var connections: [GitGraphConnection] = []
+    var hasMore = false
+}
+
 /// Branch track information
 struct GitGraphTrack {
     let column: Int
@@ -18,6 +18,8 @@ struct GitStatus: Equatable, Identifiable {
     let behindCount: Int
     let additions: Int
     let deletions: Int
+    // Too many changed files to count lines; additions/deletions are unknown rather than 0
+    var lineStatsOmitted = false
 
     var hasChanges: Bool {
         totalChanges > 0
@@ -49,6 +51,44 @@ struct GitStatus: Equatable, Identifiable {
         lhs.aheadCount == rhs.aheadCount &&
         lhs.behindCount == rhs.behindCount &&
         lhs.additions == rhs.additions &&
-        lhs.deletions == rhs.deletions
+        lhs.deletions == rhs.deletions &&
+        lhs.lineStatsOmitted == rhs.lineStatsOmitted
+    }
+}
+
+extension GitStatus {
+    /// Apply an incremental status change to the file lists; branch and line stats are kept
+    func applying(_ delta: GitStatusDelta) -> GitStatus {
+        var touched = Set(delta.removed)
+        for entry in delta.added { touched.insert(entry.path) }
+        for entry in delta.changed { touched.insert(entry.path) }
+
+        var staged = stagedFiles.filter { !touched.contains($0) }
+        var modified = modifiedFiles.filter { !touched.contains($0) }
+        var untracked = untrackedFiles.filter { !touched.contains($0) }
+        var conflicted = conflictedFiles.filter { !touched.contains($0) }
+
+        for entry in delta.added + delta.changed {
+            switch entry.category {
+            case .staged: staged.append(entry.path)
+            case .modified: modified.append(entry.path)
+            case .untracked: untracked.append(entry.path)
+            case .conflicted: conflicted.append(entry.path)
+            case .clean: break
+            }
+        }
+
+        return GitStatus(
+            stagedFiles: staged.sorted(),
+            modifiedFiles: modified.sorted(),
+            untrackedFiles: untracked.sorted(),
+            conflictedFiles: conflicted.sorted(),
+            currentBranch: currentBranch,
+            aheadCount: aheadCount,
+            behindCount: behindCount,
+            additions: additions,
+            deletions: deletions,
+            lineStatsOmitted: lineStatsOmitted
+        )
     }
 }
@@ -38,17 +38,21 @@ actor ACPClient {
     private let requestRouter: ACPRequestRouter
     private let errorHandler: ACPErrorHandler
 
-    private var pendingRequests: [RequestId: CheckedContinuation<JSONRPCResponse, Error>] = [:]
+    private var pendingRequests: [RequestId: CheckedContinuation<JSONRPCRawResponse, Error>] = [:]
     private var nextRequestId: Int = 1
+    // Agent-to-client requests being answered; each runs on its own task so a request waiting
+    // on the user (e.g. a permission prompt) doesn't hold up later messages
+    private var incomingRequestTasks: [UUID: Task<Void, Never>] = [:]
 
-    private let notificationContinuation: AsyncStream<JSONRPCNotification>.Continuation
-    private let notificationStream: AsyncStream<JSONRPCNotification>
+    private let notificationContinuation: AsyncStream<ACPNotification>.Continuation
+    private let notificationStream: AsyncStream<ACPNotification>
 
     private var debugContinuation: AsyncStream<DebugMessage>.Continuation?
     private var debugStream: AsyncStream<DebugMessage>?
 
     private let decoder: JSONDecoder
     private let encoder: JSONEncoder
+    private let codec: ACPMessageCodec
 
     weak var delegate: ACPClientDelegate?
 
@@ -60,9 +64,10 @@ actor ACPClient {
         decoder = JSONDecoder()
         encoder = JSONEncoder()
         encoder.outputFormatting = [.withoutEscapingSlashes]
+        codec = ACPMessageCodec(decoder: decoder)
 
         // Create notification stream
-        var continuation: AsyncStream<JSONRPCNotification>.Continuation!
+        var continuation: AsyncStream<ACPNotification>.Continuation!
         notificationStream = AsyncStream { cont in
             continuation = cont
         }
@@ -86,7 +91,7 @@ actor ACPClient {
 
     // MARK: - Public API
 
-    var notifications: AsyncStream<JSONRPCNotification> {
+    var notifications: AsyncStream<ACPNotification> {
         notificationStream
     }
 
@@ -139,7 +144,7 @@ actor ACPClient {
             clientInfo: info
         )
 
-        let response = try await sendRequest(method: "initialize", params: request, timeout: timeout)
+        let response = try await sendRequest(method: "initialize", params: request, resultType: InitializeResponse.self, timeout: timeout)
 
         guard let result = response.result else {
             if let error = response.error {
@@ -148,8 +153,7 @@ actor ACPClient {
             throw ACPClientError.invalidResponse
         }
 
-        let data = try encoder.encode(result)
-        return try decoder.decode(InitializeResponse.self, from: data)
+        return result
     }
 
     func newSession(
@@ -162,7 +166,7 @@ actor ACPClient {
             mcpServers: mcpServers
         )
 
-        let response = try await sendRequest(method: "session/new", params: request, timeout: timeout)
+        let response = try await sendRequest(method: "session/new", params: request, resultType: NewSessionResponse.self, timeout: timeout)
 
         guard let result = response.result else {
             if let error = response.error {
@@ -171,8 +175,7 @@ actor ACPClient {
             throw ACPClientError.invalidResponse
         }
 
-        let data = try encoder.encode(result)
-        return try decoder.decode(NewSessionResponse.self, from: data)
+        return result
     }
 
     func sendPrompt(
@@ -185,7 +188,7 @@ actor ACPClient {
         )
 
         // No timeout for prompts - agent can run for hours
-        let response = try await sendRequest(method: "session/prompt", params: request, timeout: nil)
+        let response = try await sendRequest(method: "session/prompt", params: request, resultType: SessionPromptResponse.self, timeout: nil)
 
         if let error = response.error {
             throw ACPClientError.agentError(error)
@@ -195,8 +198,7 @@ actor ACPClient {
             throw ACPClientError.invalidResponse
         }
 
-        let data = try encoder.encode(result)
-        return try decoder.decode(SessionPromptResponse.self, from: data)
+        return result
     }
 
     func authenticate(
@@ -208,35 +210,23 @@ actor ACPClient {
             credentials: credentials
         )
 
-        let response = try await sendRequest(method: "authenticate", params: request)
+        let rawResponse = try await sendRawRequest(method: "authenticate", params: request)
 
-        // Check for errors first
-        if let error = response.error {
-            throw ACPClientError.agentError(error)
-        }
-
-        // For authenticate, null or empty object result means success
-        if response.result == nil || (response.result?.value is NSNull) {
-            return AuthenticateResponse(success: true, error: nil)
-        }
-
-        // Check for empty object (Codex returns {})
-        if let dict = response.result?.value as? [String: Any], dict.isEmpty {
+        // Null, empty object (Codex returns {}) or an undecodable result all mean success
+        guard let response = try? codec.decodeResponse(rawResponse, as: AuthenticateResponse.self) else {
+            let status = try codec.decodeResponse(rawResponse, as: JSONRPCIgnoredResult.self)
+            if let error = status.error {
+                throw ACPClientError.agentError(error)
+            }
             return AuthenticateResponse(success: true, error: nil)
         }
 
-        // Otherwise try to decode the result
-        guard let result = response.result else {
-            throw ACPClientError.invalidResponse
+        // Check for errors first
+        if let error = response.error {
+            throw ACPClientError.agentError(error)
         }
 
-        do {
-            let data = try encoder.encode(result)
-            return try decoder.decode(AuthenticateResponse.self, from: data)
-        } catch {
-            // If decoding fails but there's no error, treat as success
-            return AuthenticateResponse(success: true, error: nil)
-        }
+        return response.result ?? AuthenticateResponse(success: true, error: nil)
     }
 
     func setMode(
@@ -248,7 +238,7 @@ actor ACPClient {
             modeId: modeId
         )
 
-        let response = try await sendRequest(method: "session/set_mode", params: request)
+        let response = try await sendRequest(method: "session/set_mode", params: request, resultType: JSONRPCIgnoredResult.self)
 
         // Check for errors
         if let error = response.error {
@@ -268,7 +258,7 @@ actor ACPClient {
             modelId: modelId
         )
 
-        let response = try await sendRequest(method: "session/set_model", params: request)
+        let response = try await sendRequest(method: "session/set_model", params: request, resultType: JSONRPCIgnoredResult.self)
 
         // Check for errors
         if let error = response.error {
@@ -290,7 +280,7 @@ actor ACPClient {
             value: value
         )
 
-        let response = try await sendRequest(method: "session/set_config_option", params: request)
+        let response = try await sendRequest(method: "session/set_config_option", params: request, resultType: SetSessionConfigOptionResponse.self)
 
         // Check for errors
         if let error = response.error {
@@ -301,8 +291,7 @@ actor ACPClient {
             throw ACPClientError.invalidResponse
         }
 
-        let data = try encoder.encode(result)
-        return try decoder.decode(SetSessionConfigOptionResponse.self, from: data)
+        return result
     }
 
     func cancelSession(sessionId: SessionId) async throws {
@@ -321,7 +310,7 @@ actor ACPClient {
             mcpServers: mcpServers
         )
 
-        let response = try await sendRequest(method: "session/load", params: request)
+        let response = try await sendRequest(method: "session/load", params: request, resultType: LoadSessionResponse.self)
 
         guard let result = response.result else {
             if let error = response.error {
@@ -330,15 +319,25 @@ actor ACPClient {
             throw ACPClientError.invalidResponse
         }
 
-        let data = try encoder.encode(result)
-        return try decoder.decode(LoadSessionResponse.self, from: data)
+        return result
     }
 
-    func sendRequest<T: Encodable>(
+    /// Send a request and decode its response straight into `resultType`
+    func sendRequest<Params: Encodable, Result: Decodable>(
         method: String,
-        params: T,
+        params: Params,
+        resultType: Result.Type,
         timeout: TimeInterval? = 120.0
-    ) async throws -> JSONRPCResponse {
+    ) async throws -> JSONRPCTypedResponse<Result> {
+        let response = try await sendRawRequest(method: method, params: params, timeout: timeout)
+        return try codec.decodeResponse(response, as: resultType)
+    }
+
+    private func sendRawRequest<Params: Encodable>(
+        method: String,
+        params: Params,
+        timeout: TimeInterval? = 120.0
+    ) async throws -> JSONRPCRawResponse {
         guard await processManager.isRunning() else {
             throw ACPClientError.processNotRunning
         }
@@ -348,13 +347,10 @@ actor ACPClient {
 
         logger.debug("Sending request: \(method) id=\(requestId)")
 
-        let paramsData = try encoder.encode(params)
-        let paramsValue = try decoder.decode(AnyCodable.self, from: paramsData)
-
-        let request = JSONRPCRequest(
+        let request = JSONRPCTypedRequest(
             id: requestId,
             method: method,
-            params: paramsValue
+            params: params
         )
 
         return try await withRequestTimeout(seconds: timeout, requestId: requestId) {
@@ -417,13 +413,9 @@ actor ACPClient {
             let sessionId: SessionId
         }
 
-        let params = CancelParams(sessionId: sessionId)
-        let paramsData = try encoder.encode(params)
-        let paramsValue = try decoder.decode(AnyCodable.self, from: paramsData)
-
-        let notification = JSONRPCNotification(
+        let notification = JSONRPCTypedNotification(
             method: "session/cancel",
-            params: paramsValue
+            params: CancelParams(sessionId: sessionId)
         )
 
         try await writeMessageWithDebug(notification, method: "session/cancel")
@@ -432,6 +424,11 @@ actor ACPClient {
     func terminate() async {
         await processManager.terminate()
 
+        for task in incomingRequestTasks.values {
+            task.cancel()
+        }
+        incomingRequestTasks.removeAll()
+
         // Fail all pending requests
         for (_, continuation) in pendingRequests {
             continuation.resume(throwing: ACPClientError.processNotRunning)
@@ -447,50 +444,60 @@ actor ACPClient {
     // MARK: - Private Methods
 
     private func handleMessage(data: Data) async {
-        // Skip empty or whitespace-only lines
-        guard let text = String(data: data, encoding: .utf8),
-              !text.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty else {
+        // Discriminators come from a byte scan; the body is then decoded once, into its concrete type
+        let header: ACPMessageHeader
+        do {
+            header = try ACPMessageHeader.scan(data) ?? ACPMessageHeader.decode(data, using: decoder)
+        } catch {
+            // Skip empty or whitespace-only lines
+            if data.allSatisfy({ $0 == 0x20 || $0 == 0x09 || $0 == 0x0A || $0 == 0x0D }) {
+                return
+            }
+            logParseFailure(error, data: data)
             return
         }
 
         // Emit to debug stream if enabled
         if let continuation = debugContinuation {
-            let method = extractMethod(from: data)
             continuation.yield(DebugMessage(
                 direction: .incoming,
                 timestamp: Date(),
                 rawData: data,
-                method: method
+                method: header.method
             ))
         }
 
         do {
-            let message = try decoder.decode(ACPMessage.self, from: data)
-
-            switch message {
-            case .response(let response):
-                logger.debug("Received response for id=\(response.id)")
-                await handleResponse(response)
+            switch header.kind {
+            case .response:
+                guard let id = header.id else {
+                    throw ACPClientError.invalidResponse
+                }
+                logger.debug("Received response for id=\(id)")
+                await handleResponse(JSONRPCRawResponse(id: id, data: data))
 
-            case .notification(let notification):
-                logger.debug("Received notification: \(notification.method)")
-                notificationContinuation.yield(notification)
+            case .notification:
+                let method = header.method ?? ""
+                logger.debug("Received notification: \(method)")
+                notificationContinuation.yield(try codec.decodeNotification(data, method: method))
 
-            case .request(let request):
+            case .request:
+                let request = try decoder.decode(JSONRPCRequest.self, from: data)
                 logger.debug("Received request: \(request.method)")
-                await handleIncomingRequest(request)
+                startIncomingRequest(request)
             }
         } catch {
-            // Log at warning level with full context to catch parsing issues
-            if let text = String(data: data, encoding: .utf8) {
-                logger.warning("Failed to parse message: \(error.localizedDescription)\nData: \(text.prefix(500))")
-            } else {
-                logger.warning("Failed to parse message: \(error.localizedDescription)")
-            }
+            logParseFailure(error, data: data)
         }
     }
 
-    private func handleResponse(_ response: JSONRPCResponse) async {
+    private func logParseFailure(_ error: Error, data: Data) {
+        // Log at warning level with full context to catch parsing issues
+        let text = String(decoding: data.prefix(500), as: UTF8.self)
+        logger.warning("Failed to parse message: \(error.localizedDescription)\nData: \(text)")
+    }
+
+    private func handleResponse(_ response: JSONRPCRawResponse) async {
         let pendingIds = pendingRequests.keys.map { String(describing: $0) }
         logger.debug("Handling response for id=\(response.id), pending requests: \(pendingIds)")
 
@@ -504,6 +511,18 @@ actor ACPClient {
         continuation.resume(returning: response)
     }
 
+    private func startIncomingRequest(_ request: JSONRPCRequest) {
+        let id = UUID()
+        incomingRequestTasks[id] = Task {
+            await self.handleIncomingRequest(request)
+            self.finishIncomingRequest(id)
+        }
+    }
+
+    private func finishIncomingRequest(_ id: UUID) {
+        incomingRequestTasks.removeValue(forKey: id)
+    }
+
     private func handleIncomingRequest(_ request: JSONRPCRequest) async {
         logger.info("Incoming request: \(request.method) id=\(request.id)")
         do {
@@ -546,6 +565,11 @@ actor ACPClient {
     private func handleTermination(exitCode: Int32) async {
         logger.info("Agent process terminated with code: \(exitCode)")
 
+        for task in incomingRequestTasks.values {
+            task.cancel()
+        }
+        incomingRequestTasks.removeAll()
+
         // Fail all pending requests
         for (_, continuation) in pendingRequests {
             continuation.resume(throwing: ACPClientError.processFailed(exitCode))
@@ -557,7 +581,7 @@ actor ACPClient {
 
     private func registerRequest(
         id: RequestId,
-        continuation: CheckedContinuation<JSONRPCResponse, Error>
+        continuation: CheckedContinuation<JSONRPCRawResponse, Error>
     ) async {
         pendingRequests[id] = continuation
     }
@@ -586,25 +610,19 @@ actor ACPClient {
         }
     }
 
-    private func extractMethod(from data: Data) -> String? {
-        guard let json = try? JSONSerialization.jsonObject(with: data) as? [String: Any] else {
-            return nil
-        }
-        return json["method"] as? String
-    }
-
     private func writeMessageWithDebug<T: Encodable>(_ message: T, method: String? = nil) async throws {
+        // Encode once; the same bytes go to the debug stream and the agent
+        let data = try encoder.encode(message)
+
         // Emit to debug stream if enabled
         if let continuation = debugContinuation {
-            if let data = try? encoder.encode(message) {
-                continuation.yield(DebugMessage(
-                    direction: .outgoing,
-                    timestamp: Date(),
-                    rawData: data,
-                    method: method
-                ))
-            }
+            continuation.yield(DebugMessage(
+                direction: .outgoing,
+                timestamp: Date(),
+                rawData: data,
+                method: method
+            ))
         }
-        try await processManager.writeMessage(message)
+        try await processManager.writeEncodedMessage(data)
     }
 }
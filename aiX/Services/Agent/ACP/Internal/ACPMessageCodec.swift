@@ -0,0 +1,255 @@
+//
+//  ACPMessageCodec.swift
+//  aizen
+//
+//  Discriminator scan and typed decoding of framed ACP messages
+//
+
+import Foundation
+
+/// Top-level `method` and `id` of a JSON-RPC message, read without building a JSON tree
+struct ACPMessageHeader {
+    enum Kind {
+        case request
+        case response
+        case notification
+    }
+
+    let method: String?
+    let id: RequestId?
+    let hasMethod: Bool
+    let hasId: Bool
+
+    var kind: Kind {
+        if hasMethod && hasId { return .request }
+        if hasMethod { return .notification }
+        return .response
+    }
+
+    /// Scan the top-level keys of a JSON object. Nested values are skipped bracket-wise;
+    /// returns nil for anything the scan can't read exactly (callers fall back to a full decode).
+    static func scan(_ data: Data) -> ACPMessageHeader? {
+        data.withUnsafeBytes { raw -> ACPMessageHeader? in
+            var scanner = Scanner(bytes: raw.bindMemory(to: UInt8.self))
+            return scanner.header()
+        }
+    }
+
+    /// Full-decode fallback for messages the scan rejects (escaped keys, odd ids)
+    static func decode(_ data: Data, using decoder: JSONDecoder) throws -> ACPMessageHeader {
+        let decoded = try decoder.decode(DecodedHeader.self, from: data)
+        return ACPMessageHeader(
+            method: decoded.method,
+            id: decoded.id,
+            hasMethod: decoded.method != nil,
+            hasId: decoded.id != nil
+        )
+    }
+
+    private struct DecodedHeader: Decodable {
+        let method: String?
+        let id: RequestId?
+    }
+
+    private struct Scanner {
+        let bytes: UnsafeBufferPointer<UInt8>
+        var i = 0
+
+        init(bytes: UnsafeBufferPointer<UInt8>) {
+            self.bytes = bytes
+        }
+
+        mutating func header() -> ACPMessageHeader? {
+            skipWhitespace()
+            guard consume(0x7B) else { return nil } // {
+
+            var method: String?
+            var id: RequestId?
+            var hasMethod = false
+            var hasId = false
+
+            skipWhitespace()
+            if consume(0x7D) {
+                return ACPMessageHeader(method: nil, id: nil, hasMethod: false, hasId: false)
+            }
+
+            while i < bytes.count {
+                skipWhitespace()
+                guard let key = readSimpleString() else { return nil }
+                skipWhitespace()
+                guard consume(0x3A) else { return nil } // :
+                skipWhitespace()
+
+                switch key {
+                case "method":
+                    hasMethod = true
+                    guard let value = readSimpleString() else { return nil }
+                    method = value
+                case "id":
+                    hasId = true
+                    if peek == 0x22 {
+                        guard let value = readSimpleString() else { return nil }
+                        id = .string(value)
+                    } else if let value = readInteger() {
+                        id = .number(value)
+                    } else if skipLiteral("null") {
+                        hasId = false
+                    } else {
+                        return nil
+                    }
+                default:
+                    guard skipValue() else { return nil }
+                }
+
+                skipWhitespace()
+                if consume(0x2C) { continue } // ,
+                if consume(0x7D) {
+                    return ACPMessageHeader(method: method, id: id, hasMethod: hasMethod, hasId: hasId)
+                }
+                return nil
+            }
+            return nil
+        }
+
+        private var peek: UInt8? {
+            i < bytes.count ? bytes[i] : nil
+        }
+
+        private mutating func consume(_ byte: UInt8) -> Bool {
+            guard peek == byte else { return false }
+            i += 1
+            return true
+        }
+
+        private mutating func skipWhitespace() {
+            while let byte = peek, byte == 0x20 || byte == 0x09 || byte == 0x0A || byte == 0x0D {
+                i += 1
+            }
+        }
+
+        // Strings without escapes only; keys and discriminators never need them in practice
+        private mutating func readSimpleString() -> String? {
+            guard consume(0x22) else { return nil }
+            let start = i
+            while let byte = peek {
+                if byte == 0x5C { return nil }
+                if byte == 0x22 {
+                    let value = String(decoding: UnsafeBufferPointer(rebasing: bytes[start..<i]), as: UTF8.self)
+                    i += 1
+                    return value
+                }
+                i += 1
+            }
+            return nil
+        }
+
+        private mutating func readInteger() -> Int? {
+            var negative = false
+            if peek == 0x2D { // -
+                negative = true
+                i += 1
+            }
+            var value = 0
+            var digits = 0
+            while let byte = peek, byte >= 0x30 && byte <= 0x39 {
+                let (multiplied, overflow1) = value.multipliedReportingOverflow(by: 10)
+                let (added, overflow2) = multiplied.addingReportingOverflow(Int(byte - 0x30))
+                guard !overflow1 && !overflow2 else { return nil }
+                value = added
+                digits += 1
+                i += 1
+            }
+            // Fractions and exponents aren't valid request ids here
+            guard digits > 0, peek != 0x2E, peek != 0x65, peek != 0x45 else { return nil }
+            return negative ? -value : value
+        }
+
+        private mutating func skipLiteral(_ literal: StaticString) -> Bool {
+            let count = literal.utf8CodeUnitCount
+            guard i + count <= bytes.count else { return false }
+            let utf8 = UnsafeBufferPointer(start: literal.utf8Start, count: count)
+            for offset in 0..<count where bytes[i + offset] != utf8[offset] {
+                return false
+            }
+            i += count
+            return true
+        }
+
+        // Skip one value: strings honour escapes, containers are skipped by depth
+        private mutating func skipValue() -> Bool {
+            var depth = 0
+            var inString = false
+            var escaped = false
+
+            while let byte = peek {
+                if inString {
+                    if escaped {
+                        escaped = false
+                    } else if byte == 0x5C {
+                        escaped = true
+                    } else if byte == 0x22 {
+                        inString = false
+                        if depth == 0 {
+                            i += 1
+                            return true
+                        }
+                    }
+                    i += 1
+                    continue
+                }
+
+                switch byte {
+                case 0x22:
+                    inString = true
+                case 0x7B, 0x5B:
+                    depth += 1
+                case 0x7D, 0x5D:
+                    if depth == 0 { return true } // end of the enclosing object
+                    depth -= 1
+                    if depth == 0 {
+                        i += 1
+                        return true
+                    }
+                case 0x2C:
+                    if depth == 0 { return true }
+                default:
+                    break
+                }
+                i += 1
+            }
+            return false
+        }
+    }
+}
+
+/// Decodes framed messages straight into their concrete types
+struct ACPMessageCodec {
+    private let decoder: JSONDecoder
+    // Session updates have always been decoded with snake-case key conversion
+    private let sessionUpdateDecoder: JSONDecoder
+
+    init(decoder: JSONDecoder) {
+        self.decoder = decoder
+        self.sessionUpdateDecoder = JSONDecoder()
+        self.sessionUpdateDecoder.keyDecodingStrategy = .convertFromSnakeCase
+    }
+
+    func decodeNotification(_ data: Data, method: String) throws -> ACPNotification {
+        if method == "session/update" {
+            let envelope = try sessionUpdateDecoder.decode(
+                JSONRPCTypedNotificationParams<SessionUpdateNotification>.self,
+                from: data
+            )
+            return .sessionUpdate(envelope.params)
+        }
+        return .other(try decoder.decode(JSONRPCNotification.self, from: data))
+    }
+
+    func decodeResponse<Result: Decodable>(_ response: JSONRPCRawResponse, as type: Result.Type) throws -> JSONRPCTypedResponse<Result> {
+        do {
+            return try decoder.decode(JSONRPCTypedResponse<Result>.self, from: response.data)
+        } catch {
+            throw ACPClientError.decodingError(error)
+        }
+    }
+}
@@ -0,0 +1,135 @@
+//
+//  ACPMessageFramer.swift
+//  aizen
+//
+//  Single-pass framing of JSON-RPC messages from the agent's stdout
+//
+
+import Foundation
+
+/// Splits a byte stream into complete top-level JSON values.
+///
+/// ACP messages are newline-delimited, but agents sometimes pretty-print, so frames are
+/// delimited structurally: string/escape state and bracket depth are carried across
+/// chunks and every byte is examined exactly once. Completed frames are returned as
+/// slices of the receive buffer (no copy); only the unfinished tail is moved into a fresh
+/// buffer, and that tail always started inside the latest chunk.
+struct ACPMessageFramer {
+    private var buffer = Data()
+    // Next byte to examine
+    private var cursor = 0
+    // Start of the frame being scanned; nil between frames
+    private var frameStart: Int?
+    private var depth = 0
+    private var inString = false
+    private var escaped = false
+    // Skipping a non-JSON line (e.g. a log line printed to stdout)
+    private var discardingLine = false
+
+    private(set) var discardedLines = 0
+
+    /// Bytes held for the incomplete trailing frame
+    var pendingByteCount: Int {
+        buffer.count - (frameStart ?? cursor)
+    }
+
+    /// Feed a chunk and return the frames it completed, in order
+    mutating func append(_ chunk: Data) -> [Data] {
+        guard !chunk.isEmpty else { return [] }
+        buffer.append(chunk)
+
+        var ranges: [Range<Int>] = []
+        buffer.withUnsafeBytes { (raw: UnsafeRawBufferPointer) in
+            let bytes = raw.bindMemory(to: UInt8.self)
+            let end = bytes.count
+            var i = cursor
+
+            while i < end {
+                let byte = bytes[i]
+
+                if discardingLine {
+                    if byte == 0x0A { discardingLine = false }
+                    i += 1
+                    continue
+                }
+
+                guard let start = frameStart else {
+                    switch byte {
+                    case 0x20, 0x09, 0x0D, 0x0A:
+                        break
+                    case 0x7B, 0x5B: // { [
+                        frameStart = i
+                        depth = 1
+                    default:
+                        discardingLine = true
+                        discardedLines += 1
+                    }
+                    i += 1
+                    continue
+                }
+
+                if inString {
+                    if escaped {
+                        escaped = false
+                    } else if byte == 0x5C { // backslash
+                        escaped = true
+                    } else if byte == 0x22 { // quote
+                        inString = false
+                    }
+                } else {
+                    switch byte {
+                    case 0x22:
+                        inString = true
+                    case 0x7B, 0x5B:
+                        depth += 1
+                    case 0x7D, 0x5D:
+                        depth -= 1
+                        if depth == 0 {
+                            ranges.append(start..<(i + 1))
+                            frameStart = nil
+                        }
+                    default:
+                        break
+                    }
+                }
+                i += 1
+            }
+            cursor = end
+        }
+
+        guard let lastEnd = ranges.last?.upperBound else { return [] }
+
+        let frames = ranges.map { buffer[$0] }
+
+        // Frames keep the old storage alive; continue with a buffer holding only the tail
+        let tailStart = frameStart ?? lastEnd
+        buffer = tailStart < buffer.count ? Data(buffer[tailStart...]) : Data()
+        cursor -= tailStart
+        if frameStart != nil {
+            frameStart = 0
+        }
+        return frames
+    }
+
+    /// Unframed bytes left at end of stream (a truncated or non-JSON message)
+    mutating func takeRemainder() -> Data? {
+        let start = frameStart ?? cursor
+        let remainder = start < buffer.count ? Data(buffer[start...]) : nil
+        reset()
+        guard let remainder,
+              remainder.contains(where: { $0 != 0x20 && $0 != 0x09 && $0 != 0x0D && $0 != 0x0A }) else {
+            return nil
+        }
+        return remainder
+    }
+
+    mutating func reset() {
+        buffer = Data()
+        cursor = 0
+        frameStart = nil
+        depth = 0
+        inString = false
+        escaped = false
+        discardingLine = false
+    }
+}
@@ -16,7 +16,16 @@ actor ACPProcessManager {
     private var stdoutPipe: Pipe?
     private var stderrPipe: Pipe?
 
-    private var readBuffer: Data = Data()
+    private var framer = ACPMessageFramer()
+    // Framed messages awaiting delivery; drained by one loop at a time to keep order.
+    // The receiver hands incoming requests off to their own tasks, so a drain only ever
+    // waits on response and notification delivery.
+    private var pendingMessages: [Data] = []
+    private var pendingIndex = 0
+    private var isDraining = false
+    // Waiting for the active drain to deliver everything queued
+    private var drainWaiters: [CheckedContinuation<Void, Never>] = []
+    private var outputBuffer = Data()
 
     private let encoder: JSONEncoder
     private let decoder: JSONDecoder
@@ -157,22 +166,29 @@ actor ACPProcessManager {
         stdoutPipe = nil
         stderrPipe = nil
 
-        readBuffer.removeAll()
+        framer.reset()
+        pendingMessages.removeAll()
+        pendingIndex = 0
     }
 
     // MARK: - I/O Operations
 
     func writeMessage<T: Encodable>(_ message: T) async throws {
+        try writeEncodedMessage(try encoder.encode(message))
+    }
+
+    /// Write an already-encoded message as one line
+    func writeEncodedMessage(_ data: Data) throws {
         guard let stdin = stdinPipe?.fileHandleForWriting else {
             throw ACPClientError.processNotRunning
         }
 
-        let data = try encoder.encode(message)
-
-        var lineData = data
-        lineData.append(0x0A) // newline
+        // Reused across writes so each message doesn't allocate a fresh line buffer
+        outputBuffer.removeAll(keepingCapacity: true)
+        outputBuffer.append(data)
+        outputBuffer.append(0x0A) // newline
 
-        try stdin.write(contentsOf: lineData)
+        try stdin.write(contentsOf: outputBuffer)
     }
 
     // MARK: - Callbacks
@@ -221,7 +237,11 @@ actor ACPProcessManager {
     }
 
     private func processIncomingData(_ data: Data) async {
-        readBuffer.append(data)
+        pendingMessages.append(contentsOf: framer.append(data))
+
+        if framer.pendingByteCount > 100000 && framer.pendingByteCount - data.count <= 100000 {
+            logger.warning("Large buffer (\(self.framer.pendingByteCount) bytes) without complete JSON message")
+        }
 
         await drainBufferedMessages()
     }
@@ -256,82 +276,46 @@ actor ACPProcessManager {
         stdoutPipe = nil
         stderrPipe = nil
         process = nil
-        readBuffer.removeAll()
+        framer.reset()
     }
 
     // MARK: - JSON Message Parsing
     // ACP spec: Messages are newline-delimited JSON (one message per line)
     // However, we handle multi-line JSON to be forgiving with agents that
-    // send pretty-printed JSON
+    // send pretty-printed JSON; ACPMessageFramer delimits messages structurally
 
     private func drainBufferedMessages() async {
-        while let message = popNextMessage() {
-            await onDataReceived?(message)
-        }
-    }
-
-    /// Extract the next complete JSON message from the buffer
-    /// ACP spec says newline-delimited, but JSON strings can contain \n characters
-    /// We need to find complete JSON objects, not just split on newlines
-    private func popNextMessage() -> Data? {
-        // Skip leading whitespace
-        let whitespace: Set<UInt8> = [0x20, 0x09, 0x0D, 0x0A]  // space, tab, CR, LF
-        while let first = readBuffer.first, whitespace.contains(first) {
-            readBuffer.removeFirst()
-        }
-
-        guard !readBuffer.isEmpty else {
-            return nil
-        }
-
-        // Convert to byte array for safe subscript access
-        let bytes = Array(readBuffer)
-        let maxSearch = min(bytes.count, 200000)
-
-        for endIndex in 0..<maxSearch {
-            let byte = bytes[endIndex]
-
-            // Only attempt parsing at potential JSON boundaries
-            // } ends objects, ] ends arrays, \n ends compact JSON lines
-            let isPotentialBoundary = (byte == 0x7D || byte == 0x5D || byte == 0x0A)
-
-            guard isPotentialBoundary else {
-                continue
-            }
-
-            // Create test data from byte array
-            let testData = Data(bytes[0...endIndex])
-
-            // Try to parse as complete JSON
-            if let _ = try? JSONSerialization.jsonObject(with: testData) {
-                // Valid complete JSON found!
-                // Ensure we don't remove more than available (buffer may have changed)
-                let removeCount = min(endIndex + 1, readBuffer.count)
-                readBuffer.removeFirst(removeCount)
-                logger.debug("Parsed JSON message, \(testData.count) bytes")
-                return testData
-            }
+        // A drain already in progress (suspended in the callback) will pick these up
+        guard !isDraining else { return }
+        isDraining = true
+        defer {
+            isDraining = false
+            let waiters = drainWaiters
+            drainWaiters.removeAll()
+            waiters.forEach { $0.resume() }
         }
 
-        // No complete JSON found in reasonable range
-        if readBuffer.count > 100000 {
-            let bufferSize = readBuffer.count
-            logger.warning("Large buffer (\(bufferSize) bytes) without complete JSON message")
+        while pendingIndex < pendingMessages.count {
+            let message = pendingMessages[pendingIndex]
+            pendingIndex += 1
+            logger.debug("Parsed JSON message, \(message.count) bytes")
+            await onDataReceived?(message)
         }
-
-        return nil
+        pendingMessages.removeAll(keepingCapacity: true)
+        pendingIndex = 0
     }
 
     private func flushRemainingBufferIfNeeded() async {
+        // Any remaining partial message is delivered as-is, behind the frames still queued
+        if let remaining = framer.takeRemainder() {
+            pendingMessages.append(remaining)
+        }
         await drainBufferedMessages()
 
-        if !readBuffer.isEmpty {
-            // Process any remaining partial line as a message
-            let remaining = readBuffer
-            readBuffer.removeAll(keepingCapacity: true)
-            if !remaining.isEmpty {
-                await onDataReceived?(remaining)
-            }
+        // A drain suspended in the callback returns the call above at once; wait for it
+        // so termination is reported after the last message
+        if isDraining {
+            await withCheckedContinuation { drainWaiters.append($0) }
         }
     }
 }
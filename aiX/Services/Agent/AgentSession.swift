@@ -562,7 +562,10 @@ class AgentSession: ObservableObject, ACPClientDelegate {
     /// Insert or update a tool call (O(1) operation)
     func upsertToolCall(_ toolCall: ToolCall) {
         let id = toolCall.toolCallId
-        if toolCallsById[id] == nil {
+        var toolCall = toolCall
+        if let existing = toolCallsById[id] {
+            toolCall.revision = existing.revision + 1
+        } else {
             toolCallOrder.append(id)
         }
         toolCallsById[id] = toolCall
@@ -573,6 +576,7 @@ class AgentSession: ObservableObject, ACPClientDelegate {
     func updateToolCallInPlace(id: String, update: (inout ToolCall) -> Void) {
         guard var toolCall = toolCallsById[id] else { return }
         update(&toolCall)
+        toolCall.revision += 1
         toolCallsById[id] = toolCall
     }
 
@@ -22,31 +22,14 @@ extension AgentSession {
         }
     }
 
-    /// Handle incoming session update notifications
-    func handleNotification(_ notification: JSONRPCNotification) {
-        guard notification.method == "session/update" else {
+    /// Handle incoming session update notifications (decoded by ACPClient off the main actor)
+    func handleNotification(_ notification: ACPNotification) {
+        guard case .sessionUpdate(let updateNotification) = notification else {
             return
         }
 
-        do {
-            let params = notification.params?.value as? [String: Any] ?? [:]
-
-            // Log the update type for debugging
-            if let update = params["update"] as? [String: Any],
-               let updateType = update["sessionUpdate"] as? String {
-                logger.debug("Processing session update: \(updateType)")
-            }
-
-            let data = try JSONSerialization.data(withJSONObject: params)
-            let decoder = JSONDecoder()
-            decoder.keyDecodingStrategy = .convertFromSnakeCase
-            let updateNotification = try decoder.decode(SessionUpdateNotification.self, from: data)
-
-            // Process update directly - we're already on MainActor from startNotificationListener
-            processUpdate(updateNotification.update)
-        } catch {
-            logger.warning("Failed to parse session update: \(error.localizedDescription)\nRaw params: \(String(describing: notification.params))")
-        }
+        // Process update directly - we're already on MainActor from startNotificationListener
+        processUpdate(updateNotification.update)
     }
 
     /// Process session update
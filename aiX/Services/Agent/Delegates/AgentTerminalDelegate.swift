@@ -10,11 +10,8 @@ import Foundation
 /// Tracks state of a single terminal
 private struct TerminalState {
     let process: Process
-    var outputBuffer: String = ""
-    var outputByteLimit: Int?
-    var lastReadIndex: Int = 0
+    let output: AgentTerminalOutputBuffer
     var isReleased: Bool = false
-    var wasTruncated: Bool = false
     var exitWaiters: [CheckedContinuation<(exitCode: Int?, signal: String?), Never>] = []
 }
 
@@ -60,7 +57,7 @@ actor AgentTerminalDelegate {
     // MARK: - Private Cleanup
 
     /// Drain remaining data from a pipe synchronously
-    private func drainPipe(_ pipe: Pipe, terminalId: String) {
+    private func drainPipe(_ pipe: Pipe, terminalId: String, stream: AgentTerminalOutputBuffer.Stream) {
         let handle = pipe.fileHandleForReading
 
         // Disable handler first to avoid race
@@ -74,9 +71,7 @@ actor AgentTerminalDelegate {
                 guard let data = try handle.read(upToCount: 65536), !data.isEmpty else {
                     break
                 }
-                if let output = String(data: data, encoding: .utf8) {
-                    appendOutput(terminalId: terminalId, output: output)
-                }
+                appendOutput(terminalId: terminalId, data: data, from: stream)
             }
         } catch {
             // File handle already closed, nothing to drain
@@ -87,7 +82,7 @@ actor AgentTerminalDelegate {
     private func cleanupProcessPipes(_ process: Process, terminalId: String? = nil) {
         if let outputPipe = process.standardOutput as? Pipe {
             if let id = terminalId {
-                drainPipe(outputPipe, terminalId: id)
+                drainPipe(outputPipe, terminalId: id, stream: .stdout)
             } else {
                 outputPipe.fileHandleForReading.readabilityHandler = nil
             }
@@ -95,7 +90,7 @@ actor AgentTerminalDelegate {
         }
         if let errorPipe = process.standardError as? Pipe {
             if let id = terminalId {
-                drainPipe(errorPipe, terminalId: id)
+                drainPipe(errorPipe, terminalId: id, stream: .stderr)
             } else {
                 errorPipe.fileHandleForReading.readabilityHandler = nil
             }
@@ -176,12 +171,13 @@ actor AgentTerminalDelegate {
         let terminalIdValue = UUID().uuidString
         let terminalId = TerminalId(terminalIdValue)
 
-        let state = TerminalState(process: process, outputByteLimit: outputByteLimit ?? defaultOutputByteLimit)
+        let output = AgentTerminalOutputBuffer(capacity: outputByteLimit ?? defaultOutputByteLimit)
+        let state = TerminalState(process: process, output: output)
         terminals[terminalIdValue] = state
 
-        // Capture output asynchronously
+        // Capture output as it arrives; the buffer is appended in read order, without hopping to the actor
         // Use read(upToCount:) instead of availableData to get Swift errors instead of ObjC exceptions
-        outputPipe.fileHandleForReading.readabilityHandler = { [weak self] handle in
+        outputPipe.fileHandleForReading.readabilityHandler = { handle in
             do {
                 guard let data = try handle.read(upToCount: 65536) else {
                     handle.readabilityHandler = nil
@@ -193,18 +189,14 @@ actor AgentTerminalDelegate {
                     try? handle.close()
                     return
                 }
-                if let output = String(data: data, encoding: .utf8) {
-                    Task {
-                        await self?.appendOutput(terminalId: terminalIdValue, output: output)
-                    }
-                }
+                output.append(data, from: .stdout)
             } catch {
                 // File handle closed or unavailable - clean up
                 handle.readabilityHandler = nil
             }
         }
 
-        errorPipe.fileHandleForReading.readabilityHandler = { [weak self] handle in
+        errorPipe.fileHandleForReading.readabilityHandler = { handle in
             do {
                 guard let data = try handle.read(upToCount: 65536) else {
                     handle.readabilityHandler = nil
@@ -216,11 +208,7 @@ actor AgentTerminalDelegate {
                     try? handle.close()
                     return
                 }
-                if let output = String(data: data, encoding: .utf8) {
-                    Task {
-                        await self?.appendOutput(terminalId: terminalIdValue, output: output)
-                    }
-                }
+                output.append(data, from: .stderr)
             } catch {
                 // File handle closed or unavailable - clean up
                 handle.readabilityHandler = nil
@@ -259,9 +247,9 @@ actor AgentTerminalDelegate {
         }
 
         return TerminalOutputResponse(
-            output: state.outputBuffer,
+            output: state.output.text,
             exitStatus: exitStatus,
-            truncated: state.wasTruncated,
+            truncated: state.output.wasTruncated,
             _meta: nil
         )
     }
@@ -348,6 +336,7 @@ actor AgentTerminalDelegate {
 
         // Re-fetch state after draining (output may have been appended)
         state = terminals[terminalId.value] ?? state
+        state.output.finish()
 
         // Wake up any waiters
         let exitCode = Int(state.process.terminationStatus)
@@ -358,7 +347,7 @@ actor AgentTerminalDelegate {
         // Cache output for UI display before removing
         cacheReleasedOutput(
             terminalId: terminalId.value,
-            output: state.outputBuffer,
+            output: state.output.text,
             exitCode: exitCode
         )
 
@@ -398,8 +387,7 @@ actor AgentTerminalDelegate {
         if let state = terminals[terminalId.value] {
             // Always drain available output to capture any pending data
             drainAvailableOutput(terminalId: terminalId.value, process: state.process)
-            // Re-fetch state after draining
-            return terminals[terminalId.value]?.outputBuffer ?? state.outputBuffer
+            return state.output.text
         }
         // Then check released terminals cache
         return releasedOutputs[terminalId.value]?.output
@@ -422,9 +410,8 @@ actor AgentTerminalDelegate {
             do {
                 // Use read(upToCount:) which throws Swift errors instead of availableData
                 // which throws ObjC NSException when the file handle is closed
-                if let data = try handle.read(upToCount: 65536), !data.isEmpty,
-                   let output = String(data: data, encoding: .utf8) {
-                    appendOutput(terminalId: terminalId, output: output)
+                if let data = try handle.read(upToCount: 65536), !data.isEmpty {
+                    appendOutput(terminalId: terminalId, data: data, from: .stdout)
                 }
             } catch {
                 // File handle closed or process terminated - nothing to drain
@@ -434,9 +421,8 @@ actor AgentTerminalDelegate {
         if let errorPipe = process.standardError as? Pipe {
             let handle = errorPipe.fileHandleForReading
             do {
-                if let data = try handle.read(upToCount: 65536), !data.isEmpty,
-                   let output = String(data: data, encoding: .utf8) {
-                    appendOutput(terminalId: terminalId, output: output)
+                if let data = try handle.read(upToCount: 65536), !data.isEmpty {
+                    appendOutput(terminalId: terminalId, data: data, from: .stderr)
                 }
             } catch {
                 // File handle closed or process terminated - nothing to drain
@@ -457,9 +443,7 @@ actor AgentTerminalDelegate {
                         guard let data = try handle.read(upToCount: 65536), !data.isEmpty else {
                             break
                         }
-                        if let output = String(data: data, encoding: .utf8) {
-                            appendOutput(terminalId: terminalId, output: output)
-                        }
+                        appendOutput(terminalId: terminalId, data: data, from: .stdout)
                     }
                 } catch {
                     // Handle already closed
@@ -476,9 +460,7 @@ actor AgentTerminalDelegate {
                         guard let data = try handle.read(upToCount: 65536), !data.isEmpty else {
                             break
                         }
-                        if let output = String(data: data, encoding: .utf8) {
-                            appendOutput(terminalId: terminalId, output: output)
-                        }
+                        appendOutput(terminalId: terminalId, data: data, from: .stderr)
                     }
                 } catch {
                     // Handle already closed
@@ -489,28 +471,8 @@ actor AgentTerminalDelegate {
 
     // MARK: - Private Helpers
 
-    private func appendOutput(terminalId: String, output: String) {
-        guard var state = terminals[terminalId] else { return }
-
-        // Optimized string concatenation using reserveCapacity
-        if state.outputBuffer.isEmpty {
-            state.outputBuffer = output
-        } else {
-            state.outputBuffer.reserveCapacity(state.outputBuffer.count + output.count)
-            state.outputBuffer.append(contentsOf: output)
-        }
-
-        // Apply byte limit truncation - optimized using end index
-        if let limit = state.outputByteLimit, state.outputBuffer.count > limit {
-            let keepRange = state.outputBuffer.index(
-                state.outputBuffer.endIndex,
-                offsetBy: -limit
-            )
-            state.outputBuffer = String(state.outputBuffer[keepRange...])
-            state.wasTruncated = true
-        }
-
-        terminals[terminalId] = state
+    private func appendOutput(terminalId: String, data: Data, from stream: AgentTerminalOutputBuffer.Stream) {
+        terminals[terminalId]?.output.append(data, from: stream)
     }
 
     private func cacheReleasedOutput(terminalId: String, output: String, exitCode: Int) {
@@ -0,0 +1,191 @@
+//
+//  AgentTerminalOutputBuffer.swift
+//  aizen
+//
+//  Byte-bounded output buffer for agent terminals
+//
+
+import Foundation
+
+/// Output of one agent terminal, keeping the last `capacity` bytes.
+///
+/// Bytes go into a ring that grows up to `capacity` and then overwrites its oldest bytes,
+/// so appending costs the length of the chunk whatever the output so far. Each stream holds
+/// back a UTF-8 sequence cut off at the end of a read until the rest arrives, so characters
+/// split across reads survive and stdout and stderr never interleave mid-character. Text is
+/// decoded on read, straight from the ring segments, and reused until more output arrives.
+/// Appended from pipe readability handlers and read from the terminal delegate; locked.
+final class AgentTerminalOutputBuffer: @unchecked Sendable {
+    enum Stream {
+        case stdout
+        case stderr
+    }
+
+    private let capacity: Int
+    private var storage: [UInt8] = []
+    // Oldest byte once the ring is full; new bytes overwrite from here
+    private var head = 0
+    private var droppedBytes = 0
+
+    private var stdoutCarry: [UInt8] = []
+    private var stderrCarry: [UInt8] = []
+
+    private var version = 0
+    private var decoded: (version: Int, text: String)?
+    private let lock = NSLock()
+
+    init(capacity: Int) {
+        self.capacity = max(0, capacity)
+    }
+
+    /// Whether output was dropped to stay within `capacity`
+    var wasTruncated: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return droppedBytes > 0
+    }
+
+    /// The retained output, starting at the first whole character
+    var text: String {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if let decoded, decoded.version == version {
+            return decoded.text
+        }
+        let text = decodeRetained()
+        decoded = (version, text)
+        return text
+    }
+
+    func append(_ data: Data, from stream: Stream) {
+        guard !data.isEmpty else { return }
+        lock.lock()
+        defer { lock.unlock() }
+
+        data.withUnsafeBytes { raw in
+            var carry = stream == .stdout ? stdoutCarry : stderrCarry
+            var chunk = raw[...]
+
+            // Complete the sequence held back from the previous read
+            if let lead = carry.first {
+                let expected = Self.sequenceLength(lead)
+                while carry.count < expected, let next = chunk.first, next & 0xC0 == 0x80 {
+                    carry.append(next)
+                    chunk = chunk.dropFirst()
+                }
+                if carry.count == expected || !chunk.isEmpty {
+                    // Complete, or cut short by a byte that can't continue it (decoded as invalid)
+                    carry.withUnsafeBytes { write($0) }
+                    carry.removeAll(keepingCapacity: true)
+                }
+            }
+
+            if carry.isEmpty {
+                let complete = Self.completePrefixLength(chunk)
+                write(UnsafeRawBufferPointer(rebasing: chunk.prefix(complete)))
+                carry.append(contentsOf: chunk.dropFirst(complete))
+            }
+
+            if stream == .stdout {
+                stdoutCarry = carry
+            } else {
+                stderrCarry = carry
+            }
+        }
+    }
+
+    /// Write out sequences still held back; call once the process has exited
+    func finish() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        for carry in [stdoutCarry, stderrCarry] where !carry.isEmpty {
+            carry.withUnsafeBytes { write($0) }
+        }
+        stdoutCarry.removeAll()
+        stderrCarry.removeAll()
+    }
+
+    // MARK: - Ring
+
+    private func write(_ bytes: UnsafeRawBufferPointer) {
+        guard !bytes.isEmpty else { return }
+        version += 1
+
+        var bytes = bytes[...]
+        if bytes.count >= capacity {
+            // The chunk alone fills the buffer
+            droppedBytes += storage.count + bytes.count - capacity
+            storage = Array(bytes.suffix(capacity))
+            head = 0
+            return
+        }
+
+        // Fill up to capacity before wrapping
+        if storage.count < capacity {
+            let fill = min(capacity - storage.count, bytes.count)
+            storage.append(contentsOf: bytes.prefix(fill))
+            bytes = bytes.dropFirst(fill)
+        }
+
+        // Overwrite the oldest bytes, at most in two runs
+        while !bytes.isEmpty {
+            let run = min(capacity - head, bytes.count)
+            storage.withUnsafeMutableBytes { ring in
+                UnsafeMutableRawBufferPointer(rebasing: ring[head..<(head + run)])
+                    .copyMemory(from: UnsafeRawBufferPointer(rebasing: bytes.prefix(run)))
+            }
+            droppedBytes += run
+            head = (head + run) % capacity
+            bytes = bytes.dropFirst(run)
+        }
+    }
+
+    private func decodeRetained() -> String {
+        storage.withUnsafeBytes { ring -> String in
+            // Oldest run first; `head` is 0 until the ring wraps
+            var first = UnsafeRawBufferPointer(rebasing: ring[head...])
+            let second = UnsafeRawBufferPointer(rebasing: ring[..<head])
+
+            // Truncation can cut the oldest character; start at the next one
+            if droppedBytes > 0 {
+                var skip = 0
+                while skip < 3, skip < first.count, first[skip] & 0xC0 == 0x80 {
+                    skip += 1
+                }
+                first = UnsafeRawBufferPointer(rebasing: first[skip...])
+            }
+
+            let total = first.count + second.count
+            guard total > 0 else { return "" }
+            // Copies the bytes once; ill-formed UTF-8 is repaired
+            return String(unsafeUninitializedCapacity: total) { buffer in
+                let target = UnsafeMutableRawBufferPointer(buffer)
+                target.copyMemory(from: first)
+                UnsafeMutableRawBufferPointer(rebasing: target[first.count...]).copyMemory(from: second)
+                return total
+            }
+        }
+    }
+
+    // MARK: - UTF-8
+
+    private static func sequenceLength(_ lead: UInt8) -> Int {
+        lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1
+    }
+
+    // Length of `bytes` without a trailing sequence that is cut off
+    private static func completePrefixLength(_ bytes: Slice<UnsafeRawBufferPointer>) -> Int {
+        guard !bytes.isEmpty else { return 0 }
+        let end = bytes.endIndex
+        var index = end - 1
+        while index > bytes.startIndex && index > end - 4 && bytes[index] & 0xC0 == 0x80 {
+            index -= 1
+        }
+        if end - index < sequenceLength(bytes[index]) {
+            return index - bytes.startIndex
+        }
+        return bytes.count
+    }
+}
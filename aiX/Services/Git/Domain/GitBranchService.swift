@@ -17,8 +17,7 @@ struct BranchInfo: Hashable, Identifiable {
 actor GitBranchService {
 
     func listBranches(at repoPath: String, includeRemote: Bool = true) async throws -> [BranchInfo] {
-        return try await Task.detached(priority: .utility) {
-            let repo = try Libgit2Repository(path: repoPath)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             let type: Libgit2BranchType = includeRemote ? .all : .local
             let branches = try repo.listBranches(type: type, includeUpstreamInfo: false)
 
@@ -41,30 +40,27 @@ actor GitBranchService {
             }
 
             return result
-        }.value
+        }
     }
 
     func checkoutBranch(at path: String, branch: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.checkoutBranch(name: branch)
-        }.value
+        }
     }
 
     func createBranch(at path: String, name: String, from baseBranch: String? = nil) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.createBranch(name: name, from: baseBranch)
             // Checkout the new branch
             try repo.checkoutBranch(name: name)
-        }.value
+        }
     }
 
     func deleteBranch(at path: String, name: String, force: Bool = false) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.deleteBranch(name: name, force: force)
-        }.value
+        }
     }
 
     func mergeBranch(at path: String, branch: String) async throws -> MergeResult {
@@ -0,0 +1,110 @@
+//
+//  GitCommitGraphService.swift
+//  aizen
+//
+//  Keeps repositories' commit-graph files fresh in the background
+//
+
+import Foundation
+import os.log
+
+/// Writes a commit-graph file for repositories that have none, so history walks (log,
+/// graph) and ahead/behind counts read parents and generation numbers from it instead
+/// of inflating commit objects. A graph git maintains (single file or split chain) is
+/// left alone, and nothing is written when `core.commitGraph` is false. Only a graph this
+/// service wrote itself, recognized by the modification date recorded in the app's cache,
+/// is rewritten once stale. Requests are cheap to repeat: each repository is checked at
+/// most once per `checkInterval`, and a write never blocks the caller.
+actor GitCommitGraphService {
+    static let shared = GitCommitGraphService()
+
+    private let logger = Logger.forCategory("GitCommitGraph")
+
+    // Our own graph is rewritten at least this often so local commits end up in it
+    private let maxAge: TimeInterval = 24 * 60 * 60
+    private let checkInterval: TimeInterval = 60
+
+    private var lastChecked: [String: Date] = [:]
+    private var writing: Set<String> = []
+
+    /// Schedule a commit-graph write for the repository at `repoPath` if it needs one
+    func prepare(at repoPath: String) {
+        let now = Date()
+        if let last = lastChecked[repoPath], now.timeIntervalSince(last) < checkInterval {
+            return
+        }
+        guard !writing.contains(repoPath) else { return }
+        lastChecked[repoPath] = now
+        writing.insert(repoPath)
+
+        let maxAge = self.maxAge
+        Task(priority: .background) {
+            // A write can take seconds on a long history. It opens its own repository handle
+            // on its own thread, so neither a pool worker nor a cooperative thread waits on it.
+            let result: Result<Bool, Error> = await withCheckedContinuation { continuation in
+                let thread = Thread {
+                    continuation.resume(returning: Result { try Self.writeCommitGraphIfNeeded(at: repoPath, maxAge: maxAge) })
+                }
+                thread.qualityOfService = .background
+                thread.start()
+            }
+
+            switch result {
+            case .success(true):
+                logger.debug("Wrote commit-graph for \(repoPath, privacy: .public)")
+            case .success(false):
+                break
+            case .failure(let error):
+                logger.error("Failed to write commit-graph: \(error.localizedDescription)")
+            }
+            finish(repoPath)
+        }
+    }
+
+    /// Write the repository's commit-graph unless it has a graph that isn't ours or ours is fresh
+    private nonisolated static func writeCommitGraphIfNeeded(at repoPath: String, maxAge: TimeInterval) throws -> Bool {
+        let repo = try Libgit2Repository(path: repoPath)
+        guard let commondir = repo.commondir,
+              repo.commitGraphEnabled,
+              !repo.hasCommitGraphChain else { return false }
+
+        if let existing = repo.commitGraphModificationDate {
+            // Someone else's graph (git gc, maintenance) is never replaced
+            guard existing == recordedWriteDate(commondir: commondir),
+                  repo.commitGraphIsStale(written: existing, maxAge: maxAge) else {
+                return false
+            }
+        }
+
+        try repo.writeCommitGraph()
+        if let written = repo.commitGraphModificationDate {
+            recordWriteDate(written, commondir: commondir)
+        }
+        return true
+    }
+
+    private func finish(_ repoPath: String) {
+        writing.remove(repoPath)
+    }
+
+    // MARK: - Ownership
+
+    // Modification date of the graph this service last wrote, kept outside the repository
+    private nonisolated static func recordURL(commondir: String) -> URL {
+        AppCacheDirectory.url(for: commondir, in: "commit-graph")
+    }
+
+    private nonisolated static func recordedWriteDate(commondir: String) -> Date? {
+        guard let text = try? String(contentsOf: recordURL(commondir: commondir), encoding: .utf8),
+              let seconds = Double(text) else {
+            return nil
+        }
+        return Date(timeIntervalSinceReferenceDate: seconds)
+    }
+
+    private nonisolated static func recordWriteDate(_ date: Date, commondir: String) {
+        let url = recordURL(commondir: commondir)
+        try? FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+        try? String(date.timeIntervalSinceReferenceDate).write(to: url, atomically: true, encoding: .utf8)
+    }
+}
@@ -26,9 +26,7 @@ actor GitDiffService {
 
     /// Get diff for a specific file
     func getFileDiff(at filePath: String, in repoPath: String) async throws -> FileDiff {
-        return try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
-
+        return try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             // Get diff for the file
             if let delta = try repo.diffFile(filePath) {
                 var changes: [FileDiff.Change] = []
@@ -54,30 +52,31 @@ actor GitDiffService {
             }
 
             return FileDiff(changes: [])
-        }.value
+        }
     }
 
-    /// Get full diff content for display
-    func getFullDiff(at repoPath: String) async throws -> [Libgit2DiffDelta] {
+    /// Get full diff (`git diff HEAD`) for display; file patches and hunks are materialized on demand.
+    /// A non-empty `paths` restricts the diff to exactly those paths.
+    func getFullDiff(at repoPath: String, paths: [String] = []) async throws -> Libgit2LazyDiff {
         return try await Task.detached {
             let repo = try Libgit2Repository(path: repoPath)
-            return try repo.diffIndexToWorkdir()
+            return try repo.lazyDiffHeadToWorkdir(paths: paths)
         }.value
     }
 
-    /// Get staged diff content
-    func getStagedDiff(at repoPath: String) async throws -> [Libgit2DiffDelta] {
+    /// Get staged diff (nil without a HEAD); file patches and hunks are materialized on demand
+    func getStagedDiff(at repoPath: String, paths: [String] = []) async throws -> Libgit2LazyDiff? {
         return try await Task.detached {
             let repo = try Libgit2Repository(path: repoPath)
-            return try repo.diffHeadToIndex()
+            return try repo.lazyDiffHeadToIndex(paths: paths)
         }.value
     }
 
-    /// Get diff statistics
+    /// Get diff statistics for every changed file, however many there are
     func getDiffStats(at repoPath: String) async throws -> Libgit2DiffStats {
-        return try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
-            return try repo.diffStats()
-        }.value
+        let status = try await GitStatusEngine.shared.summary(for: repoPath, includeUntracked: false)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
+            return try repo.diffStats(for: status)
+        }
     }
 }
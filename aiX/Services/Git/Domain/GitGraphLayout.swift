@@ -0,0 +1,303 @@
+//
+//  GitGraphLayout.swift
+//  aizen
+//
+//  Incremental lane layout for the commit graph
+//
+
+import Foundation
+
+/// Lane (column) assignment for a newest-first commit sequence.
+///
+/// Each lane holds the commit id expected next on it. Expected ids are indexed and free
+/// lanes are kept sorted, so placing a commit and finding the free lane nearest to a merge
+/// are lookups rather than scans over all lanes. The state is only the open lanes, so a
+/// layout can be continued page by page without keeping earlier commits.
+struct GitGraphLaneState {
+    private(set) var lanes: [String?] = []
+    // Commit id -> lanes waiting for it, ascending
+    private var expected: [String: [Int]] = [:]
+    // Unoccupied lanes below `lanes.count`, ascending
+    private var freeLanes: [Int] = []
+
+    /// Place a commit and advance its lane to its first parent; returns the commit's lane
+    mutating func place(oid: String, parentIds: [String]) -> Int {
+        let lane: Int
+        if let waiting = expected.removeValue(forKey: oid) {
+            lane = waiting[0]
+            // Other lanes converging on this commit end here
+            for other in waiting.dropFirst() {
+                release(other)
+            }
+        } else {
+            lane = claimLowestFree()
+        }
+
+        if let primaryParent = parentIds.first {
+            expect(primaryParent, at: lane)
+        } else {
+            // Root commit, the lane ends
+            release(lane)
+        }
+
+        // Merge parents get a lane near this one unless already expected somewhere
+        for extraParent in parentIds.dropFirst() where expected[extraParent] == nil {
+            expect(extraParent, at: claimFree(near: lane))
+        }
+
+        return lane
+    }
+
+    /// Whether the only open lane is the first one, waiting for `oid`
+    func expectsOnly(_ oid: String) -> Bool {
+        lanes.count == 1 && lanes[0] == oid
+    }
+
+    // MARK: - Lanes
+
+    private mutating func expect(_ oid: String, at lane: Int) {
+        lanes[lane] = oid
+        var waiting = expected[oid, default: []]
+        waiting.insert(lane, at: Self.insertionIndex(of: lane, in: waiting))
+        expected[oid] = waiting
+    }
+
+    private mutating func release(_ lane: Int) {
+        lanes[lane] = nil
+        freeLanes.insert(lane, at: Self.insertionIndex(of: lane, in: freeLanes))
+
+        // Trailing free lanes are dropped so the open lanes stay compact
+        while lanes.last == .some(nil) {
+            lanes.removeLast()
+            freeLanes.removeLast()
+        }
+    }
+
+    private mutating func claimLowestFree() -> Int {
+        if freeLanes.isEmpty {
+            lanes.append(nil)
+            return lanes.count - 1
+        }
+        return freeLanes.removeFirst()
+    }
+
+    // Nearest free lane to `anchor` (left wins ties), or a new lane at the end
+    private mutating func claimFree(near anchor: Int) -> Int {
+        let index = Self.insertionIndex(of: anchor, in: freeLanes)
+        let left = index > 0 ? freeLanes[index - 1] : nil
+        let right = index < freeLanes.count ? freeLanes[index] : lanes.count
+
+        if let left, anchor - left <= right - anchor {
+            freeLanes.remove(at: index - 1)
+            return left
+        }
+        if right == lanes.count {
+            lanes.append(nil)
+        } else {
+            freeLanes.remove(at: index)
+        }
+        return right
+    }
+
+    private static func insertionIndex(of value: Int, in sorted: [Int]) -> Int {
+        var low = 0
+        var high = sorted.count
+        while low < high {
+            let mid = (low + high) / 2
+            if sorted[mid] < value {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return low
+    }
+}
+
+/// Branch heads and worktrees to label commits with
+struct GitGraphAnnotations {
+    // Short commit id -> branch names
+    private var branchesByCommit: [String: [String]] = [:]
+    private var worktreesByBranch: [String: [String]] = [:]
+    private var worktreesByCommit: [String: [String]] = [:]
+
+    init(branches: [BranchInfo] = [], worktrees: [WorktreeInfo] = []) {
+        for branch in branches where !branch.commit.isEmpty {
+            branchesByCommit[branch.commit, default: []].append(branch.name)
+        }
+        for worktree in worktrees {
+            let name = URL(fileURLWithPath: worktree.path).lastPathComponent
+            worktreesByBranch[worktree.branch, default: []].append(name)
+            if !worktree.commit.isEmpty {
+                worktreesByCommit[worktree.commit, default: []].append(name)
+            }
+        }
+    }
+
+    func labels(forShortOid shortOid: String) -> (branchNames: [String], worktreeNames: [String]) {
+        let branchNames = branchesByCommit[shortOid] ?? []
+        var worktreeNames = Set(worktreesByCommit[shortOid] ?? [])
+        for branch in branchNames {
+            worktreeNames.formUnion(worktreesByBranch[branch] ?? [])
+        }
+        return (branchNames, Array(worktreeNames))
+    }
+}
+
+/// Commit graph of one repository, laid out a page at a time.
+///
+/// Keeps a retained revision walk, the open lanes and the connections still waiting for
+/// their parent row; it doesn't keep the commits it has returned. Reading the next page
+/// continues the walk and the lanes where the previous page stopped. When commits are added
+/// on top of the loaded history (commit, pull, fast-forward fetch), `prepend` lays out only
+/// the new commits. Not thread-safe; owned by `GitGraphService`.
+final class GitGraphLayoutEngine {
+    private struct Endpoint {
+        let oid: String
+        let row: Int
+        let column: Int
+    }
+
+    private struct Top {
+        let oid: String
+        let time: Date
+        let column: Int
+        let color: String
+    }
+
+    let repoPath: String
+    private let repository: Libgit2Repository
+    private let walk: Libgit2RevisionWalk
+    private var lanes = GitGraphLaneState()
+    // Parent id -> children placed above it whose connection still needs the parent's row
+    private var pendingConnections: [String: [Endpoint]] = [:]
+    private var top: Top?
+
+    var annotations: GitGraphAnnotations
+    private(set) var rowCount = 0
+    var hasMore: Bool { !walk.isExhausted }
+
+    // Larger jumps are cheaper to lay out again than to patch
+    private static let maxPrependedCommits = 2000
+
+    init(repoPath: String, annotations: GitGraphAnnotations) throws {
+        let repository = try Libgit2Repository(path: repoPath)
+        self.repoPath = repoPath
+        self.repository = repository
+        self.walk = try Libgit2RevisionWalk(repository: repository)
+        self.annotations = annotations
+    }
+
+    /// Lay out the next `count` commits below the loaded rows
+    func nextPage(_ count: Int) -> (commits: [GitGraphCommit], connections: [GitGraphConnection]) {
+        let infos = walk.next(maxCount: count)
+        let page = layOut(infos, firstRow: rowCount, lanes: &lanes, pending: &pendingConnections)
+        if top == nil, let first = page.commits.first {
+            top = Top(oid: first.id, time: first.date, column: first.column, color: first.trackColor)
+        }
+        rowCount += infos.count
+        return page
+    }
+
+    /// Lay out commits added above the loaded rows. Returns nil when the new history doesn't
+    /// sit cleanly on top of the old one (rewritten, moved back, or new lanes reaching below
+    /// the old top); the graph must then be laid out again. Loaded rows shift down by the
+    /// number of commits returned.
+    func prepend() -> (commits: [GitGraphCommit], connections: [GitGraphConnection])? {
+        guard let top, let head = repository.headOid() else { return nil }
+        guard head != top.oid else { return ([], []) }
+
+        guard let fresh = try? Libgit2RevisionWalk(repository: repository, tips: [head], hiding: [top.oid]) else {
+            return nil
+        }
+        let infos = fresh.next(maxCount: Self.maxPrependedCommits + 1)
+        guard !infos.isEmpty,
+              infos.count <= Self.maxPrependedCommits,
+              infos.allSatisfy({ $0.time >= top.time }) else {
+            return nil
+        }
+
+        var topLanes = GitGraphLaneState()
+        var topPending: [String: [Endpoint]] = [:]
+        let page = layOut(infos, firstRow: 0, lanes: &topLanes, pending: &topPending)
+        var connections = page.connections
+        guard topLanes.expectsOnly(top.oid) else { return nil }
+
+        // Join the new commits to the old top, which is now below them
+        let shift = infos.count
+        for child in topPending[top.oid] ?? [] {
+            connections.append(GitGraphConnection(
+                fromCommitId: top.oid,
+                toCommitId: child.oid,
+                fromColumn: top.column,
+                toColumn: child.column,
+                fromRow: shift,
+                toRow: child.row,
+                color: top.color
+            ))
+        }
+
+        pendingConnections = pendingConnections.mapValues { children in
+            children.map { Endpoint(oid: $0.oid, row: $0.row + shift, column: $0.column) }
+        }
+        rowCount += shift
+        if let first = page.commits.first {
+            self.top = Top(oid: first.id, time: first.date, column: first.column, color: first.trackColor)
+        }
+        return (page.commits, connections)
+    }
+
+    // MARK: - Layout
+
+    private func layOut(
+        _ infos: [Libgit2CommitInfo],
+        firstRow: Int,
+        lanes: inout GitGraphLaneState,
+        pending: inout [String: [Endpoint]]
+    ) -> (commits: [GitGraphCommit], connections: [GitGraphConnection]) {
+        var commits: [GitGraphCommit] = []
+        var connections: [GitGraphConnection] = []
+        commits.reserveCapacity(infos.count)
+
+        for (offset, info) in infos.enumerated() {
+            let row = firstRow + offset
+            let column = lanes.place(oid: info.oid, parentIds: info.parentIds)
+            let trackColor = GitGraphTrackColor.color(forIndex: column)
+
+            for child in pending.removeValue(forKey: info.oid) ?? [] {
+                connections.append(GitGraphConnection(
+                    fromCommitId: info.oid,
+                    toCommitId: child.oid,
+                    fromColumn: column,
+                    toColumn: child.column,
+                    fromRow: row,
+                    toRow: child.row,
+                    color: trackColor
+                ))
+            }
+            for parentId in info.parentIds {
+                pending[parentId, default: []].append(Endpoint(oid: info.oid, row: row, column: column))
+            }
+
+            let labels = annotations.labels(forShortOid: info.shortOid)
+            commits.append(GitGraphCommit(
+                id: info.oid,
+                shortHash: info.shortOid,
+                message: info.summary,
+                author: info.author.name,
+                date: info.time,
+                filesChanged: 0,
+                additions: 0,
+                deletions: 0,
+                parentIds: info.parentIds,
+                row: row,
+                column: column,
+                trackColor: trackColor,
+                branchNames: labels.branchNames,
+                worktreeNames: labels.worktreeNames
+            ))
+        }
+
+        return (commits, connections)
+    }
+}
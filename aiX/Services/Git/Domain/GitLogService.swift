@@ -11,9 +11,10 @@ actor GitLogService {
 
     /// Get commit history for a repository with pagination
     func getCommitHistory(at repoPath: String, limit: Int = 30, skip: Int = 0) async throws -> [GitCommit] {
+        await GitCommitGraphService.shared.prepare(at: repoPath)
+
         // Run on background thread to avoid blocking
-        return try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             let commits = try repo.log(limit: limit, skip: skip)
 
             return commits.map { commit in
@@ -31,7 +32,7 @@ actor GitLogService {
                     deletions: stats?.deletions ?? 0
                 )
             }
-        }.value
+        }
     }
 
     /// Get diff output for a specific commit
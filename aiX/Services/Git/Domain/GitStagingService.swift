@@ -12,19 +12,17 @@ actor GitStagingService {
     private let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "win.aiX.app", category: "GitStagingService")
 
     func stageFile(at path: String, file: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.stageFile(file)
-        }.value
+        }
     }
 
     func unstageFile(at path: String, file: String) async throws {
         logger.info("unstageFile called - path: \(path), file: \(file)")
         do {
-            try await Task.detached {
-                let repo = try Libgit2Repository(path: path)
+            try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
                 try repo.unstageFile(file)
-            }.value
+            }
             logger.info("unstageFile succeeded for \(file)")
         } catch {
             logger.error("unstageFile failed for \(file): \(error.localizedDescription)")
@@ -33,19 +31,17 @@ actor GitStagingService {
     }
 
     func stageAll(at path: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.stageAll()
-        }.value
+        }
     }
 
     func unstageAll(at path: String) async throws {
         logger.info("unstageAll called - path: \(path)")
         do {
-            try await Task.detached {
-                let repo = try Libgit2Repository(path: path)
+            try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
                 try repo.unstageAll()
-            }.value
+            }
             logger.info("unstageAll succeeded")
         } catch {
             logger.error("unstageAll failed: \(error.localizedDescription)")
@@ -54,46 +50,40 @@ actor GitStagingService {
     }
 
     func commit(at path: String, message: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             _ = try repo.commit(message: message)
-        }.value
+        }
     }
 
     func amendCommit(at path: String, message: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             _ = try repo.commit(message: message, amend: true)
-        }.value
+        }
     }
 
     func commitWithSignoff(at path: String, message: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             let sigInfo = try repo.getSignatureInfo()
             let signoffMessage = "\(message)\n\nSigned-off-by: \(sigInfo.name) <\(sigInfo.email)>"
             _ = try repo.commit(message: signoffMessage)
-        }.value
+        }
     }
 
     func discardChanges(at path: String, file: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.discardChanges(file)
-        }.value
+        }
     }
 
     func discardAll(at path: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.discardAllChanges()
-        }.value
+        }
     }
 
     func cleanUntracked(at path: String) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: path)
+        try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             try repo.cleanUntrackedFiles()
-        }.value
+        }
     }
 }
@@ -0,0 +1,357 @@
+//
+//  GitStatusEngine.swift
+//  aizen
+//
+//  Incremental per-worktree git status kept up to date from file and index events
+//
+
+import Foundation
+import os.log
+
+/// Change between two status results of a worktree
+struct GitStatusDelta: Sendable {
+    var added: [Libgit2StatusEntry] = []
+    var changed: [Libgit2StatusEntry] = []
+    var removed: [String] = []
+
+    var isEmpty: Bool {
+        added.isEmpty && changed.isEmpty && removed.isEmpty
+    }
+}
+
+/// Index and HEAD state a full status scan was taken at
+struct GitStatusScanKey: Equatable, Sendable {
+    let head: String
+    let indexChecksum: String
+    let indexSize: UInt64
+    let indexModified: Int64
+
+    static func current(worktreePath: String) -> GitStatusScanKey? {
+        FileSearchIndexStore.currentKey(worktreePath: worktreePath).map {
+            GitStatusScanKey(
+                head: $0.head,
+                indexChecksum: $0.indexChecksum,
+                indexSize: $0.indexSize,
+                indexModified: $0.indexModified
+            )
+        }
+    }
+}
+
+/// Keeps the last status of each subscribed worktree. Worktree file events re-status only
+/// the touched paths; a full `git_status_list_new` scan runs only when the git index or
+/// HEAD changes (or FSEvents dropped events). Subscribers receive deltas, not snapshots.
+actor GitStatusEngine {
+    static let shared = GitStatusEngine()
+
+    private struct WorktreeState {
+        var entries: [String: Libgit2StatusEntry] = [:]
+        // Index/HEAD state of the last full scan; nil until the first scan finishes
+        var scanKey: GitStatusScanKey?
+        var subscribers: [UUID: @Sendable (GitStatusDelta) -> Void] = [:]
+        var fileWatcher: WorktreeFileEventWatcher?
+        var indexWatchToken: UUID?
+        var pendingPaths: Set<String> = []
+        var needsFullScan = true
+        var refreshTask: Task<Void, Never>?
+    }
+
+    private let logger = Logger.forCategory("GitStatusEngine")
+    private var worktrees: [String: WorktreeState] = [:]
+    // Past this many touched paths that status can report, a full scan is cheaper than per-path status
+    private let maxIncrementalPaths = 256
+    // Touched paths kept before ignore filtering; beyond this a full scan is queued instead
+    private let maxPendingPaths = 50_000
+
+    private init() {}
+
+    // MARK: - Subscriptions
+
+    /// Start tracking a worktree (if needed) and receive its status deltas. The first delta
+    /// after the initial scan lists every entry as added.
+    func addSubscriber(
+        worktreePath: String,
+        onDelta: @escaping @Sendable (GitStatusDelta) -> Void
+    ) async -> UUID {
+        let id = UUID()
+
+        if worktrees[worktreePath] != nil {
+            worktrees[worktreePath]?.subscribers[id] = onDelta
+            if let entries = worktrees[worktreePath]?.entries, !entries.isEmpty {
+                onDelta(GitStatusDelta(added: Array(entries.values)))
+            }
+            return id
+        }
+
+        var state = WorktreeState()
+        state.subscribers[id] = onDelta
+
+        let watcher = WorktreeFileEventWatcher(worktreePath: worktreePath)
+        watcher.start { [worktreePath] paths, mustRescan in
+            Task {
+                await GitStatusEngine.shared.handleFileEvents(worktreePath: worktreePath, paths: paths, mustRescan: mustRescan)
+            }
+        }
+        state.fileWatcher = watcher
+        worktrees[worktreePath] = state
+
+        let token = await GitIndexWatchCenter.shared.addSubscriber(worktreePath: worktreePath) {
+            Task {
+                await GitStatusEngine.shared.handleIndexChange(worktreePath: worktreePath)
+            }
+        }
+        if worktrees[worktreePath] != nil {
+            worktrees[worktreePath]?.indexWatchToken = token
+        } else {
+            await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: worktreePath, id: token)
+        }
+
+        scheduleRefresh(worktreePath)
+        return id
+    }
+
+    func removeSubscriber(worktreePath: String, id: UUID) async {
+        guard var state = worktrees[worktreePath] else { return }
+        state.subscribers.removeValue(forKey: id)
+        guard state.subscribers.isEmpty else {
+            worktrees[worktreePath] = state
+            return
+        }
+
+        worktrees.removeValue(forKey: worktreePath)
+        state.refreshTask?.cancel()
+        state.fileWatcher?.stop()
+        if let token = state.indexWatchToken {
+            await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: worktreePath, id: token)
+        }
+    }
+
+    // MARK: - Queries
+
+    /// Current status. Tracked worktrees answer from the kept entries (rescanning first if
+    /// the index or HEAD moved since the last scan); others get a one-off full status.
+    func summary(for worktreePath: String, includeUntracked: Bool = true) async throws -> Libgit2StatusSummary {
+        guard worktrees[worktreePath] != nil else {
+            return try await Self.scanOnce(worktreePath, includeUntracked: includeUntracked)
+        }
+
+        let key = await Task.detached(priority: .utility) {
+            GitStatusScanKey.current(worktreePath: worktreePath)
+        }.value
+        if key == nil || key != worktrees[worktreePath]?.scanKey {
+            worktrees[worktreePath]?.needsFullScan = true
+            scheduleRefresh(worktreePath)
+        }
+        await worktrees[worktreePath]?.refreshTask?.value
+
+        // Untracked, or the last scan failed
+        guard let state = worktrees[worktreePath], state.scanKey != nil else {
+            return try await Self.scanOnce(worktreePath, includeUntracked: includeUntracked)
+        }
+
+        let entries = state.entries.values
+            .filter { includeUntracked || !$0.status.isUntracked || $0.status.isStaged }
+            .sorted { $0.path < $1.path }
+        return Libgit2StatusSummary(entries: entries)
+    }
+
+    private static func scanOnce(_ worktreePath: String, includeUntracked: Bool) async throws -> Libgit2StatusSummary {
+        try await Libgit2RepositoryPool.shared.withRepository(at: worktreePath) { repo in
+            return try repo.status(includeUntracked: includeUntracked)
+        }
+    }
+
+    // MARK: - Events
+
+    private func handleFileEvents(worktreePath: String, paths: [String], mustRescan: Bool) {
+        guard worktrees[worktreePath] != nil else { return }
+        // Ignored paths (build output and the like) are dropped by the refresh pass before
+        // `maxIncrementalPaths` applies; this bound only keeps the pending set small
+        if mustRescan || (worktrees[worktreePath]?.pendingPaths.count ?? 0) + paths.count > maxPendingPaths {
+            worktrees[worktreePath]?.needsFullScan = true
+            worktrees[worktreePath]?.pendingPaths.removeAll()
+        } else if worktrees[worktreePath]?.needsFullScan == false {
+            worktrees[worktreePath]?.pendingPaths.formUnion(paths)
+        }
+        scheduleRefresh(worktreePath)
+    }
+
+    private func handleIndexChange(worktreePath: String) {
+        guard worktrees[worktreePath] != nil else { return }
+        worktrees[worktreePath]?.needsFullScan = true
+        worktrees[worktreePath]?.pendingPaths.removeAll()
+        scheduleRefresh(worktreePath)
+    }
+
+    // One refresh loop per worktree; events arriving mid-refresh are picked up by the next pass
+    private func scheduleRefresh(_ worktreePath: String) {
+        guard let state = worktrees[worktreePath], state.refreshTask == nil else { return }
+        worktrees[worktreePath]?.refreshTask = Task {
+            await self.runRefreshLoop(worktreePath)
+        }
+    }
+
+    private func runRefreshLoop(_ worktreePath: String) async {
+        while let state = worktrees[worktreePath], !Task.isCancelled,
+              state.needsFullScan || !state.pendingPaths.isEmpty {
+            if state.needsFullScan {
+                worktrees[worktreePath]?.needsFullScan = false
+                worktrees[worktreePath]?.pendingPaths.removeAll()
+                await fullScan(worktreePath)
+            } else {
+                let paths = Array(state.pendingPaths)
+                worktrees[worktreePath]?.pendingPaths.removeAll()
+                let reportable = await removingIgnoredPaths(paths, in: worktreePath)
+                if reportable.count > maxIncrementalPaths {
+                    await fullScan(worktreePath)
+                } else {
+                    await refresh(worktreePath, paths: reportable)
+                }
+            }
+        }
+        worktrees[worktreePath]?.refreshTask = nil
+    }
+
+    // MARK: - Scanning
+
+    private func removingIgnoredPaths(_ paths: [String], in worktreePath: String) async -> [String] {
+        let ignored = (try? await Libgit2RepositoryPool.shared.withRepository(at: worktreePath) { repo in
+            repo.untrackedIgnoredPaths(paths)
+        }) ?? []
+        return ignored.isEmpty ? paths : paths.filter { !ignored.contains($0) }
+    }
+
+    private func fullScan(_ worktreePath: String) async {
+        let result = try? await Libgit2RepositoryPool.shared.withRepository(at: worktreePath) { repo -> (entries: [Libgit2StatusEntry], key: GitStatusScanKey?) in
+            let summary = try repo.status(includeUntracked: true)
+            return (summary.entries, GitStatusScanKey.current(worktreePath: worktreePath))
+        }
+
+        guard let result, let old = worktrees[worktreePath]?.entries else {
+            logger.error("Full status scan failed for \(worktreePath, privacy: .public)")
+            return
+        }
+
+        var updated: [String: Libgit2StatusEntry] = [:]
+        updated.reserveCapacity(result.entries.count)
+        for entry in result.entries {
+            updated[entry.path] = entry
+        }
+
+        var delta = GitStatusDelta()
+        for (path, entry) in updated {
+            if let previous = old[path] {
+                if previous != entry { delta.changed.append(entry) }
+            } else {
+                delta.added.append(entry)
+            }
+        }
+        for path in old.keys where updated[path] == nil {
+            delta.removed.append(path)
+        }
+
+        worktrees[worktreePath]?.entries = updated
+        worktrees[worktreePath]?.scanKey = result.key
+        publish(delta, for: worktreePath)
+    }
+
+    private func refresh(_ worktreePath: String, paths: [String]) async {
+        guard let old = worktrees[worktreePath]?.entries else { return }
+
+        // Sources of staged renames are folded into the rename entry by a full scan;
+        // per-file status would report them separately, so leave them alone
+        let renameSources = Set(old.values.compactMap(\.oldPath))
+        let candidates = paths.filter { !renameSources.contains($0) }
+        guard !candidates.isEmpty else { return }
+
+        let results = try? await Libgit2RepositoryPool.shared.withRepository(at: worktreePath) { repo -> [String: Libgit2StatusEntry?] in
+            var results: [String: Libgit2StatusEntry?] = [:]
+            var directories: [String] = []
+            for path in candidates {
+                guard let status = repo.fileStatus(path) else {
+                    directories.append(path)
+                    continue
+                }
+                let tracked = !status.isEmpty && !status.contains(.ignored)
+                results[path] = tracked ? Libgit2StatusEntry(path: path, oldPath: nil, status: status) : .some(nil)
+            }
+
+            if !directories.isEmpty, let summary = try? repo.status(includeUntracked: true, paths: directories) {
+                for directory in directories {
+                    results[directory] = .some(nil)
+                }
+                for entry in summary.entries {
+                    results[entry.path] = entry
+                }
+            }
+            return results
+        }
+
+        guard let results, var entries = worktrees[worktreePath]?.entries else { return }
+
+        var delta = GitStatusDelta()
+
+        // A directory refresh replaces every entry beneath it
+        for (path, result) in results where result == nil {
+            let prefix = path.hasSuffix("/") ? path : path + "/"
+            for existing in entries.keys where existing == path || existing.hasPrefix(prefix) {
+                if results[existing] == nil || results[existing] == .some(nil) {
+                    entries.removeValue(forKey: existing)
+                    delta.removed.append(existing)
+                }
+            }
+        }
+
+        // Sorted so an untracked "dir/" entry is applied before anything beneath it
+        let updates = results.compactMap { path, entry in entry.map { (path, $0) } }.sorted { $0.0 < $1.0 }
+        for (path, entry) in updates {
+            // Files inside an untracked directory are already covered by its "dir/" entry
+            if Self.isUntrackedOnly(entry) && Self.hasUntrackedAncestor(path, in: entries) {
+                continue
+            }
+            if path.hasSuffix("/") && Self.isUntrackedOnly(entry) {
+                // The directory entry replaces untracked entries previously listed beneath it
+                for existing in entries.keys where existing != path && existing.hasPrefix(path) {
+                    if let covered = entries[existing], Self.isUntrackedOnly(covered) {
+                        entries.removeValue(forKey: existing)
+                        delta.removed.append(existing)
+                    }
+                }
+            }
+            if let previous = entries[path] {
+                if previous != entry {
+                    entries[path] = entry
+                    delta.changed.append(entry)
+                }
+            } else {
+                entries[path] = entry
+                delta.added.append(entry)
+            }
+        }
+
+        worktrees[worktreePath]?.entries = entries
+        publish(delta, for: worktreePath)
+    }
+
+    private static func isUntrackedOnly(_ entry: Libgit2StatusEntry) -> Bool {
+        entry.status.isUntracked && !entry.status.isStaged
+    }
+
+    private static func hasUntrackedAncestor(_ path: String, in entries: [String: Libgit2StatusEntry]) -> Bool {
+        var components = path.split(separator: "/").dropLast()
+        while !components.isEmpty {
+            if let entry = entries[components.joined(separator: "/") + "/"], entry.status.isUntracked {
+                return true
+            }
+            components = components.dropLast()
+        }
+        return false
+    }
+
+    private func publish(_ delta: GitStatusDelta, for worktreePath: String) {
+        guard !delta.isEmpty, let subscribers = worktrees[worktreePath]?.subscribers.values else { return }
+        for callback in subscribers {
+            callback(delta)
+        }
+    }
+}
@@ -17,20 +17,31 @@ struct DetailedGitStatus {
     let behindBy: Int
     let additions: Int
     let deletions: Int
+    // Set when there were too many changed files to count lines; additions/deletions are then 0
+    let lineStatsOmitted: Bool
 }
 
 actor GitStatusService {
+    // Line counts need a patch per changed file (git_diff_get_stats builds them too); past this
+    // many files they are reported as omitted and callers that need them use GitDiffService.getDiffStats
+    private let maxLineStatFiles = 1_000
 
     func getDetailedStatus(
         at path: String,
         includeUntracked: Bool = true,
         includeDiffStats: Bool = true
     ) async throws -> DetailedGitStatus {
-        // Run libgit2 operations on background thread to avoid blocking
-        return try await Task.detached(priority: .utility) {
-            let repo = try Libgit2Repository(path: path)
-            let status = try repo.status(includeUntracked: includeUntracked)
+        // Answered from the incremental engine's entries when the worktree is tracked
+        let status = try await GitStatusEngine.shared.summary(for: path, includeUntracked: includeUntracked)
+        // Ahead/behind walks history; the commit-graph keeps that walk out of the ODB
+        await GitCommitGraphService.shared.prepare(at: path)
+
+        let lineStatsOmitted = includeDiffStats
+            && status.staged.count + status.modified.count + status.conflicted.count > maxLineStatFiles
+        let computesLineStats = includeDiffStats && !lineStatsOmitted
 
+        // Run libgit2 operations on background thread to avoid blocking
+        return try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             // Get current branch name
             let currentBranch = try? repo.currentBranchName()
 
@@ -39,10 +50,10 @@ actor GitStatusService {
             let aheadBy = aheadBehind.ahead
             let behindBy = aheadBehind.behind
 
-            // Calculate additions/deletions from diff (can be expensive on large repos)
+            // Additions/deletions from patches of the files status already reported as changed
             let diffStats: Libgit2DiffStats
-            if includeDiffStats {
-                diffStats = (try? repo.diffStats()) ?? Libgit2DiffStats(filesChanged: 0, insertions: 0, deletions: 0)
+            if computesLineStats {
+                diffStats = (try? repo.diffStats(for: status)) ?? Libgit2DiffStats(filesChanged: 0, insertions: 0, deletions: 0)
             } else {
                 diffStats = Libgit2DiffStats(filesChanged: 0, insertions: 0, deletions: 0)
             }
@@ -62,38 +73,36 @@ actor GitStatusService {
                 aheadBy: aheadBy,
                 behindBy: behindBy,
                 additions: diffStats.insertions,
-                deletions: diffStats.deletions
+                deletions: diffStats.deletions,
+                lineStatsOmitted: lineStatsOmitted
             )
-        }.value
+        }
     }
 
     func getCurrentBranch(at path: String) async throws -> String {
-        return try await Task.detached(priority: .utility) {
-            let repo = try Libgit2Repository(path: path)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             guard let branch = try repo.currentBranchName() else {
                 throw Libgit2Error.referenceNotFound("HEAD")
             }
             return branch
-        }.value
+        }
     }
 
     func getBranchStatus(at path: String) async throws -> (ahead: Int, behind: Int) {
-        return try await Task.detached(priority: .utility) {
-            let repo = try Libgit2Repository(path: path)
-
+        await GitCommitGraphService.shared.prepare(at: path)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: path) { repo in
             guard (try? repo.currentBranchName()) != nil else {
                 return (0, 0)
             }
 
             return (try? repo.headAheadBehind()) ?? (0, 0)
-        }.value
+        }
     }
 
     func hasUnsavedChanges(at worktreePath: String) async throws -> Bool {
-        return try await Task.detached {
-            let repo = try Libgit2Repository(path: worktreePath)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: worktreePath) { repo in
             let status = try repo.status()
             return status.hasChanges
-        }.value
+        }
     }
 }
@@ -18,8 +18,7 @@ struct WorktreeInfo {
 actor GitWorktreeService {
 
     func listWorktrees(at repoPath: String) async throws -> [WorktreeInfo] {
-        return try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
+        return try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             let worktrees = try repo.listWorktrees()
 
             return worktrees.map { wt in
@@ -56,7 +55,7 @@ actor GitWorktreeService {
                     isDetached: isDetached
                 )
             }
-        }.value
+        }
     }
 
     private static func getInitialBranchName(at path: String) -> String? {
@@ -74,9 +73,7 @@ actor GitWorktreeService {
     }
 
     func addWorktree(at repoPath: String, path: String, branch: String, createBranch: Bool = false, baseBranch: String? = nil) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
-
+        try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             // Generate a unique worktree name from the path
             let worktreeName = URL(fileURLWithPath: path).lastPathComponent
 
@@ -87,7 +84,7 @@ actor GitWorktreeService {
                 createBranch: createBranch,
                 baseBranch: baseBranch
             )
-        }.value
+        }
 
         // Pull LFS objects if LFS is enabled in the repository
         // This is a best-effort operation - don't fail worktree creation if LFS pull fails
@@ -135,9 +132,7 @@ actor GitWorktreeService {
     }
 
     func removeWorktree(at worktreePath: String, repoPath: String, force: Bool = false) async throws {
-        try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
-
+        try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             // Find worktree name from path
             let worktrees = try repo.listWorktrees()
             guard let worktree = worktrees.first(where: { $0.path == worktreePath }) else {
@@ -145,6 +140,6 @@ actor GitWorktreeService {
             }
 
             try repo.removeWorktree(name: worktree.name, force: force)
-        }.value
+        }
     }
 }
@@ -2,79 +2,251 @@
 //  GitDiffCache.swift
 //  aizen
 //
-//  Actor-based LRU cache for git diff data
+//  Byte-budgeted, content-addressed LRU cache for parsed diffs
 //
 
 import Foundation
 
+/// Parsed diff packed into one text buffer plus fixed-size line records,
+/// so a cached diff costs a few allocations instead of several per line.
+struct CompactDiff: Sendable {
+    struct Line {
+        let textStart: UInt32
+        let textLength: UInt32
+        let lineNumber: Int32
+        // 0 when the line has no number on that side
+        let oldLineNumber: Int32
+        let newLineNumber: Int32
+        let type: UInt8
+    }
+
+    static let types: [DiffLineType] = [.added, .deleted, .context, .header]
+
+    private let text: ContiguousArray<UInt8>
+    private let lines: ContiguousArray<Line>
+
+    var count: Int { lines.count }
+
+    /// Approximate memory held by this diff
+    var byteCost: Int {
+        text.capacity + lines.capacity * MemoryLayout<Line>.stride + 64
+    }
+
+    /// Wrap line records that point into `text`; used by the streaming parser,
+    /// which keeps the raw diff bytes as the text buffer instead of copying lines out.
+    init(text: ContiguousArray<UInt8>, lines: ContiguousArray<Line>) {
+        self.text = text
+        self.lines = lines
+    }
+
+    /// Pack `source`, keeping at most `maxLines` lines followed by a truncation marker
+    init(lines source: [DiffLine], maxLines: Int = .max) {
+        let kept = source.prefix(maxLines)
+
+        var text = ContiguousArray<UInt8>()
+        text.reserveCapacity(kept.reduce(0) { $0 + $1.content.utf8.count })
+        var lines = ContiguousArray<Line>()
+        lines.reserveCapacity(kept.count + 1)
+
+        func append(_ line: DiffLine) {
+            let start = text.count
+            text.append(contentsOf: line.content.utf8)
+            lines.append(Line(
+                textStart: UInt32(start),
+                textLength: UInt32(text.count - start),
+                lineNumber: Int32(clamping: line.lineNumber),
+                oldLineNumber: line.oldLineNumber.flatMap { Int32($0) } ?? 0,
+                newLineNumber: line.newLineNumber.flatMap { Int32($0) } ?? 0,
+                type: UInt8(Self.types.firstIndex(of: line.type) ?? 2)
+            ))
+        }
+
+        for line in kept {
+            append(line)
+        }
+        if source.count > maxLines {
+            append(DiffLine(
+                lineNumber: maxLines,
+                oldLineNumber: nil,
+                newLineNumber: nil,
+                content: "... diff truncated (\(source.count - maxLines) more lines) ...",
+                type: .header
+            ))
+        }
+
+        self.text = text
+        self.lines = lines
+    }
+
+    subscript(index: Int) -> DiffLine {
+        let line = lines[index]
+        let start = Int(line.textStart)
+        let content = text.withUnsafeBufferPointer { buffer in
+            String(decoding: UnsafeBufferPointer(rebasing: buffer[start..<start + Int(line.textLength)]), as: UTF8.self)
+        }
+        return DiffLine(
+            lineNumber: Int(line.lineNumber),
+            oldLineNumber: line.oldLineNumber > 0 ? String(line.oldLineNumber) : nil,
+            newLineNumber: line.newLineNumber > 0 ? String(line.newLineNumber) : nil,
+            content: content,
+            type: Self.types[Int(line.type)]
+        )
+    }
+
+    /// Expand back into `DiffLine`s for display
+    func diffLines() -> [DiffLine] {
+        (0..<lines.count).map { self[$0] }
+    }
+
+    func diffLines(in range: Range<Int>) -> [DiffLine] {
+        range.clamped(to: 0..<lines.count).map { self[$0] }
+    }
+
+    /// Copy of the first `maxLines` lines plus a truncation marker, or self if it's short enough
+    func truncated(to maxLines: Int) -> CompactDiff {
+        guard lines.count > maxLines else { return self }
+        return CompactDiff(lines: diffLines(in: 0..<maxLines) + [
+            DiffLine(
+                lineNumber: maxLines,
+                oldLineNumber: nil,
+                newLineNumber: nil,
+                content: "... diff truncated (\(lines.count - maxLines) more lines) ...",
+                type: .header
+            )
+        ])
+    }
+}
+
+/// Diffs keyed by the blob OIDs on both sides, so an unchanged file keeps hitting
+/// and identical changes in different worktrees share one entry.
 actor GitDiffCache {
-    struct CachedDiff {
-        let lines: [DiffLine]
-        let timestamp: Date
-        let contentHash: String
+    static let shared = GitDiffCache()
+
+    struct Key: Hashable, Sendable {
+        static let missingOid = String(repeating: "0", count: 40)
+
+        let oldOid: String
+        let newOid: String
+        // Only set for diffs whose rendering depends on the path (synthesized untracked diffs)
+        var path: String? = nil
+
+        init(oldOid: String?, newOid: String?, path: String? = nil) {
+            self.oldOid = oldOid ?? Self.missingOid
+            self.newOid = newOid ?? Self.missingOid
+            self.path = path
+        }
     }
 
-    private var cache: [String: CachedDiff] = [:]
-    private var accessOrder: [String] = []
-    private let maxCacheSize: Int
-    private let maxDiffLines: Int
+    // Intrusive doubly linked LRU list; head is most recently used
+    private final class Node {
+        let key: Key
+        let diff: CompactDiff
+        var prev: Node?
+        var next: Node?
 
-    init(maxCacheSize: Int = 50, maxDiffLines: Int = 10_000) {
-        self.maxCacheSize = maxCacheSize
+        init(key: Key, diff: CompactDiff) {
+            self.key = key
+            self.diff = diff
+        }
+    }
+
+    private var nodes: [Key: Node] = [:]
+    private var head: Node?
+    private var tail: Node?
+    private(set) var totalBytes = 0
+    private let byteBudget: Int
+    nonisolated let maxDiffLines: Int
+
+    init(byteBudget: Int = 64 * 1024 * 1024, maxDiffLines: Int = 10_000) {
+        self.byteBudget = byteBudget
         self.maxDiffLines = maxDiffLines
     }
 
-    func getDiff(for file: String) -> CachedDiff? {
-        guard let cached = cache[file] else { return nil }
-        updateAccessOrder(file)
-        return cached
-    }
-
-    func cacheDiff(_ lines: [DiffLine], for file: String, contentHash: String) {
-        let truncatedLines = lines.count > maxDiffLines
-            ? Array(lines.prefix(maxDiffLines)) + [
-                DiffLine(
-                    lineNumber: maxDiffLines,
-                    oldLineNumber: nil,
-                    newLineNumber: nil,
-                    content: "... diff truncated (\(lines.count - maxDiffLines) more lines) ...",
-                    type: .header
-                )
-              ]
-            : lines
-
-        cache[file] = CachedDiff(
-            lines: truncatedLines,
-            timestamp: Date(),
-            contentHash: contentHash
-        )
-        updateAccessOrder(file)
+    func diff(for key: Key) -> CompactDiff? {
+        guard let node = nodes[key] else { return nil }
+        moveToFront(node)
+        return node.diff
+    }
+
+    /// Insert a diff. Diffs larger than the whole budget aren't cached.
+    func insert(_ diff: CompactDiff, for key: Key) {
+        if let existing = nodes.removeValue(forKey: key) {
+            unlink(existing)
+            totalBytes -= existing.diff.byteCost
+        }
+
+        let cost = diff.byteCost
+        guard cost <= byteBudget else { return }
+
+        let node = Node(key: key, diff: diff)
+        nodes[key] = node
+        pushFront(node)
+        totalBytes += cost
         evictIfNeeded()
     }
 
-    func invalidate(file: String) {
-        cache.removeValue(forKey: file)
-        accessOrder.removeAll { $0 == file }
+    func invalidate(_ key: Key) {
+        guard let node = nodes.removeValue(forKey: key) else { return }
+        unlink(node)
+        totalBytes -= node.diff.byteCost
     }
 
     func invalidateAll() {
-        cache.removeAll()
-        accessOrder.removeAll()
+        // Break the links so nodes are released without a deep deinit chain
+        var node = head
+        while let current = node {
+            node = current.next
+            current.prev = nil
+            current.next = nil
+        }
+        nodes.removeAll()
+        head = nil
+        tail = nil
+        totalBytes = 0
+    }
+
+    func contains(_ key: Key) -> Bool {
+        nodes[key] != nil
     }
 
-    func contains(file: String) -> Bool {
-        cache[file] != nil
+    // MARK: - LRU List
+
+    private func pushFront(_ node: Node) {
+        node.prev = nil
+        node.next = head
+        head?.prev = node
+        head = node
+        if tail == nil {
+            tail = node
+        }
+    }
+
+    private func unlink(_ node: Node) {
+        if let prev = node.prev {
+            prev.next = node.next
+        } else {
+            head = node.next
+        }
+        if let next = node.next {
+            next.prev = node.prev
+        } else {
+            tail = node.prev
+        }
+        node.prev = nil
+        node.next = nil
     }
 
-    private func updateAccessOrder(_ file: String) {
-        accessOrder.removeAll { $0 == file }
-        accessOrder.append(file)
+    private func moveToFront(_ node: Node) {
+        guard head !== node else { return }
+        unlink(node)
+        pushFront(node)
     }
 
     private func evictIfNeeded() {
-        while cache.count > maxCacheSize, let oldest = accessOrder.first {
-            cache.removeValue(forKey: oldest)
-            accessOrder.removeFirst()
+        while totalBytes > byteBudget, let oldest = tail {
+            unlink(oldest)
+            nodes.removeValue(forKey: oldest.key)
+            totalBytes -= oldest.diff.byteCost
         }
     }
 }
@@ -23,10 +23,9 @@ actor GitDiffProvider {
         let relativePath = fileURL.path.replacingOccurrences(of: repoURL.path + "/", with: "")
 
         // Run libgit2 on background thread to avoid blocking UI
-        let delta = try await Task.detached {
-            let repo = try Libgit2Repository(path: repoPath)
+        let delta = try await Libgit2RepositoryPool.shared.withRepository(at: repoPath) { repo in
             return try repo.diffFile(relativePath)
-        }.value
+        }
 
         guard let delta = delta else {
             return [:]
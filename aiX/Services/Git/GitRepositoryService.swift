@@ -29,8 +29,24 @@ class GitRepositoryService: ObservableObject {
     private var inFlightStatusTask: Task<Void, Never>?
     private var pendingReloadIsLightweight = true
 
+    /// Incremental status changes as they are applied to `currentStatus`
+    let statusChanges = PassthroughSubject<GitStatusDelta, Never>()
+    private var statusEngineToken: UUID?
+    private var statusEnginePath: String?
+
     init(worktreePath: String) {
         self.worktreePath = worktreePath
+        Task { @MainActor [weak self] in
+            await self?.subscribeToStatusEngine()
+        }
+    }
+
+    deinit {
+        if let token = statusEngineToken, let path = statusEnginePath {
+            Task {
+                await GitStatusEngine.shared.removeSubscriber(worktreePath: path, id: token)
+            }
+        }
     }
 
     // MARK: - Public API - Staging Operations
@@ -352,11 +368,45 @@ class GitRepositoryService: ObservableObject {
             self.worktreePath = newPath
             self.currentStatus = .empty
             self.reloadStatusDebouncedOnMain(lightweight: true)
+            await self.subscribeToStatusEngine()
         }
     }
 
     // MARK: - Private Methods
 
+    /// Follow file-level status changes between full reloads
+    @MainActor
+    private func subscribeToStatusEngine() async {
+        let path = worktreePath
+        guard statusEnginePath != path else { return }
+
+        if let token = statusEngineToken, let oldPath = statusEnginePath {
+            await GitStatusEngine.shared.removeSubscriber(worktreePath: oldPath, id: token)
+        }
+        statusEngineToken = nil
+        statusEnginePath = path
+
+        let token = await GitStatusEngine.shared.addSubscriber(worktreePath: path) { [weak self] delta in
+            Task { @MainActor [weak self] in
+                self?.applyStatusDelta(delta, for: path)
+            }
+        }
+
+        // The path may have changed again while subscribing
+        if statusEnginePath == path {
+            statusEngineToken = token
+        } else {
+            await GitStatusEngine.shared.removeSubscriber(worktreePath: path, id: token)
+        }
+    }
+
+    @MainActor
+    private func applyStatusDelta(_ delta: GitStatusDelta, for path: String) {
+        guard worktreePath == path else { return }
+        currentStatus = currentStatus.applying(delta)
+        statusChanges.send(delta)
+    }
+
     private func makeRefreshingSuccessHandler(original: (() -> Void)?) -> () async -> Void {
         return { [weak self] in
             guard let self = self else {
@@ -414,7 +464,8 @@ class GitRepositoryService: ObservableObject {
             aheadCount: detailedStatus.aheadBy,
             behindCount: detailedStatus.behindBy,
             additions: detailedStatus.additions,
-            deletions: detailedStatus.deletions
+            deletions: detailedStatus.deletions,
+            lineStatsOmitted: detailedStatus.lineStatsOmitted
         )
     }
 
@@ -331,7 +331,7 @@ extension Libgit2Repository {
 
     // MARK: - Private Helpers
 
-    private func parseCommit(_ commit: OpaquePointer, oid: inout git_oid) -> Libgit2CommitInfo {
+    func parseCommit(_ commit: OpaquePointer, oid: inout git_oid) -> Libgit2CommitInfo {
         // Get OID string
         var oidStr = [CChar](repeating: 0, count: 41)
         git_oid_tostr(&oidStr, 41, &oid)
@@ -0,0 +1,108 @@
+import Foundation
+import Clibgit2
+
+/// Commit-graph file (`objects/info/commit-graph`) of a repository.
+///
+/// The file holds the parents, commit time and generation number of every commit in a
+/// compact, mmap'd table. libgit2 reads it whenever it is present: revision walks (log,
+/// graph pages) and ahead/behind then look commits up in the table instead of inflating
+/// commit objects from the ODB. Commits missing from the file (made after it was written)
+/// are still read from the ODB, so a slightly stale file is correct, only less helpful.
+///
+/// A graph git wrote itself (possibly a split chain under `objects/info/commit-graphs`, or
+/// with Bloom filters) is never replaced; callers write one only where git has none.
+extension Libgit2Repository {
+    /// Path of the commit-graph file, shared by all worktrees of the repository
+    var commitGraphPath: String? {
+        guard let commondir else { return nil }
+        return (commondir as NSString).appendingPathComponent("objects/info/commit-graph")
+    }
+
+    /// Whether git keeps a split commit-graph chain (`git commit-graph write --split`)
+    var hasCommitGraphChain: Bool {
+        guard let commondir else { return false }
+        let chainPath = (commondir as NSString).appendingPathComponent("objects/info/commit-graphs")
+        return FileManager.default.fileExists(atPath: chainPath)
+    }
+
+    /// Modification date of the commit-graph file, nil when there is none
+    var commitGraphModificationDate: Date? {
+        guard let graphPath = commitGraphPath else { return nil }
+        return (try? FileManager.default.attributesOfItem(atPath: graphPath))?[.modificationDate] as? Date
+    }
+
+    /// Whether `core.commitGraph` allows commit-graph files (true when unset)
+    var commitGraphEnabled: Bool {
+        guard let cfg = try? config() else { return true }
+        defer { git_config_free(cfg) }
+
+        var value: Int32 = 1
+        guard git_config_get_bool(&value, cfg, "core.commitGraph") == 0 else { return true }
+        return value != 0
+    }
+
+    /// Whether a commit-graph written at `written` predates the newest pack (fetch, gc)
+    /// or is older than `maxAge`
+    func commitGraphIsStale(written: Date, maxAge: TimeInterval) -> Bool {
+        guard let commondir else { return false }
+        if Date().timeIntervalSince(written) > maxAge {
+            return true
+        }
+
+        let fileManager = FileManager.default
+        let packDir = (commondir as NSString).appendingPathComponent("objects/pack")
+        let packs = (try? fileManager.contentsOfDirectory(atPath: packDir)) ?? []
+        for pack in packs where pack.hasSuffix(".idx") {
+            let packPath = (packDir as NSString).appendingPathComponent(pack)
+            if let modified = (try? fileManager.attributesOfItem(atPath: packPath))?[.modificationDate] as? Date,
+               modified > written {
+                return true
+            }
+        }
+        return false
+    }
+
+    /// Write the commit-graph file for every commit reachable from HEAD, branches,
+    /// remote-tracking branches and tags. Replaces the file atomically.
+    func writeCommitGraph() throws {
+        guard let ptr = pointer, let graphPath = commitGraphPath else {
+            throw Libgit2Error.notARepository(path)
+        }
+
+        let infoDir = (graphPath as NSString).deletingLastPathComponent
+        try? FileManager.default.createDirectory(atPath: infoDir, withIntermediateDirectories: true)
+
+        var revwalk: OpaquePointer?
+        let walkError = git_revwalk_new(&revwalk, ptr)
+        guard walkError == 0, let walk = revwalk else {
+            throw Libgit2Error.from(walkError, context: "revwalk new")
+        }
+        defer { git_revwalk_free(walk) }
+
+        // Empty repository - nothing to write
+        guard git_revwalk_push_head(walk) == 0 else { return }
+        _ = git_revwalk_push_glob(walk, "heads")
+        _ = git_revwalk_push_glob(walk, "remotes")
+        _ = git_revwalk_push_glob(walk, "tags")
+
+        var options = git_commit_graph_writer_options()
+        git_commit_graph_writer_options_init(&options, UInt32(GIT_COMMIT_GRAPH_WRITER_OPTIONS_VERSION))
+
+        var graphWriter: OpaquePointer?
+        let writerError = git_commit_graph_writer_new(&graphWriter, infoDir, &options)
+        guard writerError == 0, let writer = graphWriter else {
+            throw Libgit2Error.from(writerError, context: "commit-graph writer")
+        }
+        defer { git_commit_graph_writer_free(writer) }
+
+        let addError = git_commit_graph_writer_add_revwalk(writer, walk)
+        guard addError == 0 else {
+            throw Libgit2Error.from(addError, context: "commit-graph add commits")
+        }
+
+        let commitError = git_commit_graph_writer_commit(writer)
+        guard commitError == 0 else {
+            throw Libgit2Error.from(commitError, context: "commit-graph write")
+        }
+    }
+}
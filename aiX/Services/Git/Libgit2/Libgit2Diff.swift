@@ -69,6 +69,23 @@ struct Libgit2DiffDelta: Sendable {
         case typeChange
         case unreadable
         case conflicted
+
+        init(from status: git_delta_t) {
+            switch status {
+            case GIT_DELTA_UNMODIFIED: self = .unmodified
+            case GIT_DELTA_ADDED: self = .added
+            case GIT_DELTA_DELETED: self = .deleted
+            case GIT_DELTA_MODIFIED: self = .modified
+            case GIT_DELTA_RENAMED: self = .renamed
+            case GIT_DELTA_COPIED: self = .copied
+            case GIT_DELTA_IGNORED: self = .ignored
+            case GIT_DELTA_UNTRACKED: self = .untracked
+            case GIT_DELTA_TYPECHANGE: self = .typeChange
+            case GIT_DELTA_UNREADABLE: self = .unreadable
+            case GIT_DELTA_CONFLICTED: self = .conflicted
+            default: self = .unmodified
+            }
+        }
     }
 }
 
@@ -84,26 +101,44 @@ extension Libgit2Repository {
 
     /// Get diff between index and workdir (unstaged changes)
     func diffIndexToWorkdir() throws -> [Libgit2DiffDelta] {
+        let diff = try lazyDiffIndexToWorkdir()
+        return diff.files.map(diff.delta(for:))
+    }
+
+    /// Get diff between HEAD and index (staged changes)
+    func diffHeadToIndex() throws -> [Libgit2DiffDelta] {
+        guard let diff = try lazyDiffHeadToIndex() else { return [] }
+        return diff.files.map(diff.delta(for:))
+    }
+
+    /// Get diff for a specific file
+    func diffFile(_ filePath: String) throws -> Libgit2DiffDelta? {
+        // Restricting the diff to the path keeps libgit2 from examining every other file
+        let diff = try lazyDiffIndexToWorkdir(paths: [filePath])
+        return diff.file(forPath: filePath).map(diff.delta(for:))
+    }
+
+    /// Unstaged changes as a lazy diff: files are listed without generating any patches.
+    /// A non-empty `paths` restricts the diff to exactly those paths.
+    func lazyDiffIndexToWorkdir(paths: [String] = []) throws -> Libgit2LazyDiff {
         guard let ptr = pointer else {
             throw Libgit2Error.notARepository(path)
         }
 
         var diff: OpaquePointer?
-        var opts = git_diff_options()
-        git_diff_options_init(&opts, UInt32(GIT_DIFF_OPTIONS_VERSION))
-        opts.flags = UInt32(GIT_DIFF_INCLUDE_UNTRACKED.rawValue)
-
-        let diffError = git_diff_index_to_workdir(&diff, ptr, nil, &opts)
+        let diffError = Self.withDiffOptions(paths: paths, flags: UInt32(GIT_DIFF_INCLUDE_UNTRACKED.rawValue)) { opts in
+            git_diff_index_to_workdir(&diff, ptr, nil, &opts)
+        }
         guard diffError == 0, let d = diff else {
             throw Libgit2Error.from(diffError, context: "diff index to workdir")
         }
-        defer { git_diff_free(d) }
 
-        return try parseDiff(d)
+        return Libgit2LazyDiff(repository: self, diff: d)
     }
 
-    /// Get diff between HEAD and index (staged changes)
-    func diffHeadToIndex() throws -> [Libgit2DiffDelta] {
+    /// Staged changes as a lazy diff (nil without a HEAD).
+    /// A non-empty `paths` restricts the diff to exactly those paths.
+    func lazyDiffHeadToIndex(paths: [String] = []) throws -> Libgit2LazyDiff? {
         guard let ptr = pointer else {
             throw Libgit2Error.notARepository(path)
         }
@@ -112,8 +147,8 @@ extension Libgit2Repository {
         var head: OpaquePointer?
         let headError = git_repository_head(&head, ptr)
         guard headError == 0, let h = head else {
-            // No HEAD - return empty diff
-            return []
+            // No HEAD - no staged diff
+            return nil
         }
         defer { git_reference_free(h) }
 
@@ -131,43 +166,21 @@ extension Libgit2Repository {
         }
         defer { git_tree_free(t) }
 
-        var diff: OpaquePointer?
-        var opts = git_diff_options()
-        git_diff_options_init(&opts, UInt32(GIT_DIFF_OPTIONS_VERSION))
-
-        let diffError = git_diff_tree_to_index(&diff, ptr, t, nil, &opts)
-        guard diffError == 0, let d = diff else {
-            throw Libgit2Error.from(diffError, context: "diff tree to index")
-        }
-        defer { git_diff_free(d) }
-
-        return try parseDiff(d)
-    }
-
-    /// Get diff for a specific file
-    func diffFile(_ filePath: String) throws -> Libgit2DiffDelta? {
-        let allDiffs = try diffIndexToWorkdir()
-        return allDiffs.first { $0.newPath == filePath || $0.oldPath == filePath }
+        return try lazyDiffTreeToIndex(t, paths: paths)
     }
 
-    /// Get diff stats (files changed, insertions, deletions)
-    func diffStats() throws -> Libgit2DiffStats {
+    /// Staged and unstaged changes together (`git diff HEAD`) as a lazy diff; on an unborn
+    /// branch the index is diffed against the empty tree.
+    /// A non-empty `paths` restricts the diff to exactly those paths.
+    func lazyDiffHeadToWorkdir(paths: [String] = []) throws -> Libgit2LazyDiff {
         guard let ptr = pointer else {
             throw Libgit2Error.notARepository(path)
         }
 
-        // Get staged diff
-        var stagedDiff: OpaquePointer?
-        var opts = git_diff_options()
-        git_diff_options_init(&opts, UInt32(GIT_DIFF_OPTIONS_VERSION))
-
-        // Get HEAD tree
-        var head: OpaquePointer?
         var tree: OpaquePointer? = nil
-
+        var head: OpaquePointer?
         if git_repository_head(&head, ptr) == 0, let h = head {
             defer { git_reference_free(h) }
-
             var commit: OpaquePointer?
             if git_reference_peel(&commit, h, GIT_OBJECT_COMMIT) == 0, let c = commit {
                 defer { git_commit_free(c) }
@@ -177,49 +190,46 @@ extension Libgit2Repository {
                 }
             }
         }
-
         defer { if let t = tree { git_tree_free(t) } }
 
-        // Diff tree to index (staged)
-        let stagedError = git_diff_tree_to_index(&stagedDiff, ptr, tree, nil, &opts)
-        if stagedError != 0 {
-            stagedDiff = nil
+        var diff: OpaquePointer?
+        let diffError = Self.withDiffOptions(paths: paths, flags: UInt32(GIT_DIFF_INCLUDE_UNTRACKED.rawValue)) { opts in
+            git_diff_tree_to_workdir_with_index(&diff, ptr, tree, &opts)
         }
-        defer { if let d = stagedDiff { git_diff_free(d) } }
-
-        // Diff index to workdir (unstaged)
-        var unstagedDiff: OpaquePointer?
-        opts.flags = UInt32(GIT_DIFF_INCLUDE_UNTRACKED.rawValue)
-        let unstagedError = git_diff_index_to_workdir(&unstagedDiff, ptr, nil, &opts)
-        if unstagedError != 0 {
-            unstagedDiff = nil
+        guard diffError == 0, let d = diff else {
+            throw Libgit2Error.from(diffError, context: "diff tree to workdir")
         }
-        defer { if let d = unstagedDiff { git_diff_free(d) } }
 
-        var totalFiles = 0
-        var totalInsertions = 0
-        var totalDeletions = 0
+        return Libgit2LazyDiff(repository: self, diff: d)
+    }
 
-        // Process staged diff
-        if let d = stagedDiff {
-            var stats: OpaquePointer?
-            if git_diff_get_stats(&stats, d) == 0, let s = stats {
-                defer { git_diff_stats_free(s) }
-                totalFiles += git_diff_stats_files_changed(s)
-                totalInsertions += git_diff_stats_insertions(s)
-                totalDeletions += git_diff_stats_deletions(s)
+    /// Line stats for the given changed paths, as reported by status. Both diffs are restricted
+    /// to those paths, so libgit2 neither re-walks the worktree nor builds patches for other files.
+    /// Staged changes on an unborn branch are diffed against the empty tree.
+    func diffStats(stagedPaths: [String], unstagedPaths: [String]) throws -> Libgit2DiffStats {
+        var diffs: [Libgit2LazyDiff] = []
+        if !stagedPaths.isEmpty {
+            if let staged = try lazyDiffHeadToIndex(paths: stagedPaths) {
+                diffs.append(staged)
+            } else {
+                diffs.append(try lazyDiffTreeToIndex(nil, paths: stagedPaths))
             }
         }
+        if !unstagedPaths.isEmpty {
+            diffs.append(try lazyDiffIndexToWorkdir(paths: unstagedPaths))
+        }
 
-        // Process unstaged diff
-        if let d = unstagedDiff {
-            var stats: OpaquePointer?
-            if git_diff_get_stats(&stats, d) == 0, let s = stats {
-                defer { git_diff_stats_free(s) }
-                totalFiles += git_diff_stats_files_changed(s)
-                totalInsertions += git_diff_stats_insertions(s)
-                totalDeletions += git_diff_stats_deletions(s)
+        var totalFiles = 0
+        var totalInsertions = 0
+        var totalDeletions = 0
+        for diff in diffs {
+            totalFiles += diff.files.count
+            for file in diff.files where !file.isBinary {
+                let stats = diff.lineStats(for: file)
+                totalInsertions += stats.additions
+                totalDeletions += stats.deletions
             }
+            diff.releasePatches()
         }
 
         return Libgit2DiffStats(
@@ -229,117 +239,113 @@ extension Libgit2Repository {
         )
     }
 
-    // MARK: - Private Helpers
+    /// Line stats for every change in `status` (the old side of staged renames included)
+    func diffStats(for status: Libgit2StatusSummary) throws -> Libgit2DiffStats {
+        var stagedPaths: [String] = []
+        var unstagedPaths: [String] = []
+        for entry in status.entries {
+            if entry.status.isStaged {
+                stagedPaths.append(entry.path)
+                if let oldPath = entry.oldPath, oldPath != entry.path {
+                    stagedPaths.append(oldPath)
+                }
+            }
+            if entry.status.isModified {
+                unstagedPaths.append(entry.path)
+            }
+        }
+        return try diffStats(stagedPaths: stagedPaths, unstagedPaths: unstagedPaths)
+    }
 
-    private func parseDiff(_ diff: OpaquePointer) throws -> [Libgit2DiffDelta] {
-        var deltas: [Libgit2DiffDelta] = []
+    private func lazyDiffTreeToIndex(_ tree: OpaquePointer?, paths: [String]) throws -> Libgit2LazyDiff {
+        guard let ptr = pointer else {
+            throw Libgit2Error.notARepository(path)
+        }
 
-        let numDeltas = git_diff_num_deltas(diff)
-        for i in 0..<numDeltas {
-            guard let delta = git_diff_get_delta(diff, i) else { continue }
+        var diff: OpaquePointer?
+        let diffError = Self.withDiffOptions(paths: paths, flags: 0) { opts in
+            git_diff_tree_to_index(&diff, ptr, tree, nil, &opts)
+        }
+        guard diffError == 0, let d = diff else {
+            throw Libgit2Error.from(diffError, context: "diff tree to index")
+        }
 
-            let status = parseDeltaStatus(delta.pointee.status)
-            let oldPath = delta.pointee.old_file.path.map { String(cString: $0) }
-            let newPath = delta.pointee.new_file.path.map { String(cString: $0) }
-            let isBinary = (delta.pointee.flags & UInt32(GIT_DIFF_FLAG_BINARY.rawValue)) != 0
+        return Libgit2LazyDiff(repository: self, diff: d)
+    }
 
-            // Get hunks and lines
-            var hunks: [Libgit2DiffHunk] = []
-            var additions = 0
-            var deletions = 0
+    // Diff options with `paths` as a literal pathspec; the C strings live for the duration of `body`
+    private static func withDiffOptions(
+        paths: [String],
+        flags: UInt32,
+        _ body: (inout git_diff_options) -> Int32
+    ) -> Int32 {
+        var opts = git_diff_options()
+        git_diff_options_init(&opts, UInt32(GIT_DIFF_OPTIONS_VERSION))
+        opts.flags = flags
 
-            // Use patch to get detailed line info
-            var patch: OpaquePointer?
-            if git_patch_from_diff(&patch, diff, i) == 0, let p = patch {
-                defer { git_patch_free(p) }
-
-                let numHunks = git_patch_num_hunks(p)
-                for h in 0..<numHunks {
-                    var hunk: UnsafePointer<git_diff_hunk>?
-                    var hunkLines: Int = 0
-
-                    guard git_patch_get_hunk(&hunk, &hunkLines, p, h) == 0, let hunkPtr = hunk else {
-                        continue
-                    }
-
-                    var lines: [Libgit2DiffLine] = []
-                    for l in 0..<hunkLines {
-                        var line: UnsafePointer<git_diff_line>?
-                        guard git_patch_get_line_in_hunk(&line, p, h, l) == 0, let linePtr = line else {
-                            continue
-                        }
-
-                        let origin = Libgit2LineOrigin(from: linePtr.pointee.origin)
-                        let content: String
-                        if let contentPtr = linePtr.pointee.content {
-                            let buffer = UnsafeRawBufferPointer(
-                                start: contentPtr,
-                                count: linePtr.pointee.content_len
-                            )
-                            content = String(decoding: buffer, as: UTF8.self)
-                        } else {
-                            content = ""
-                        }
-
-                        let oldLine = linePtr.pointee.old_lineno > 0 ? Int(linePtr.pointee.old_lineno) : nil
-                        let newLine = linePtr.pointee.new_lineno > 0 ? Int(linePtr.pointee.new_lineno) : nil
-
-                        lines.append(Libgit2DiffLine(
-                            origin: origin,
-                            oldLineNumber: oldLine,
-                            newLineNumber: newLine,
-                            content: content
-                        ))
-
-                        if origin == .addition { additions += 1 }
-                        if origin == .deletion { deletions += 1 }
-                    }
-
-                    let header = withUnsafePointer(to: hunkPtr.pointee.header) { ptr in
-                        ptr.withMemoryRebound(to: CChar.self, capacity: Int(GIT_DIFF_HUNK_HEADER_SIZE)) {
-                            String(cString: $0)
-                        }
-                    }
-                    hunks.append(Libgit2DiffHunk(
-                        header: header,
-                        oldStart: Int(hunkPtr.pointee.old_start),
-                        oldLines: Int(hunkPtr.pointee.old_lines),
-                        newStart: Int(hunkPtr.pointee.new_start),
-                        newLines: Int(hunkPtr.pointee.new_lines),
-                        lines: lines
-                    ))
-                }
+        var cStrings = paths.map { strdup($0) }
+        defer { cStrings.forEach { free($0) } }
+
+        return cStrings.withUnsafeMutableBufferPointer { buffer -> Int32 in
+            if !paths.isEmpty {
+                opts.flags |= UInt32(GIT_DIFF_DISABLE_PATHSPEC_MATCH.rawValue)
+                opts.pathspec.strings = buffer.baseAddress
+                opts.pathspec.count = paths.count
             }
+            return body(&opts)
+        }
+    }
 
-            deltas.append(Libgit2DiffDelta(
-                oldPath: oldPath,
-                newPath: newPath,
-                status: status,
-                hunks: hunks,
-                additions: additions,
-                deletions: deletions,
-                isBinary: isBinary
-            ))
+    /// Blob OIDs on both sides of `diff HEAD -- <path>` for each path: the HEAD tree entry
+    /// (or the index entry on an unborn branch) and the hashed, filtered worktree file.
+    /// A side that doesn't exist (added or deleted file) is nil.
+    func diffBlobOids(forPaths paths: [String]) -> [String: (old: String?, new: String?)] {
+        guard let ptr = pointer else { return [:] }
+
+        var tree: OpaquePointer? = nil
+        var headObject: OpaquePointer?
+        if git_revparse_single(&headObject, ptr, "HEAD^{tree}") == 0 {
+            tree = headObject
         }
+        defer { if let t = tree { git_object_free(t) } }
 
-        return deltas
-    }
+        var index: OpaquePointer? = nil
+        if tree == nil {
+            index = try? getIndex()
+        }
+        defer { if let idx = index { git_index_free(idx) } }
 
-    private func parseDeltaStatus(_ status: git_delta_t) -> Libgit2DiffDelta.DeltaStatus {
-        switch status {
-        case GIT_DELTA_UNMODIFIED: return .unmodified
-        case GIT_DELTA_ADDED: return .added
-        case GIT_DELTA_DELETED: return .deleted
-        case GIT_DELTA_MODIFIED: return .modified
-        case GIT_DELTA_RENAMED: return .renamed
-        case GIT_DELTA_COPIED: return .copied
-        case GIT_DELTA_IGNORED: return .ignored
-        case GIT_DELTA_UNTRACKED: return .untracked
-        case GIT_DELTA_TYPECHANGE: return .typeChange
-        case GIT_DELTA_UNREADABLE: return .unreadable
-        case GIT_DELTA_CONFLICTED: return .conflicted
-        default: return .unmodified
+        func format(_ oid: UnsafePointer<git_oid>) -> String {
+            var oidStr = [CChar](repeating: 0, count: 41)
+            git_oid_tostr(&oidStr, 41, oid)
+            return String(cString: oidStr)
         }
+
+        var result: [String: (old: String?, new: String?)] = [:]
+        result.reserveCapacity(paths.count)
+
+        for path in paths {
+            var old: String?
+            if let t = tree {
+                var entry: OpaquePointer?
+                if git_tree_entry_bypath(&entry, t, path) == 0, let e = entry {
+                    old = git_tree_entry_id(e).map(format)
+                    git_tree_entry_free(e)
+                }
+            } else if let idx = index, let entry = git_index_get_bypath(idx, path, 0) {
+                old = withUnsafePointer(to: entry.pointee.id) { format($0) }
+            }
+
+            var new: String?
+            var oid = git_oid()
+            if git_repository_hashfile(&oid, ptr, path, GIT_OBJECT_BLOB, nil) == 0 {
+                new = format(&oid)
+            }
+
+            result[path] = (old, new)
+        }
+
+        return result
     }
 
     /// Get unified diff string for HEAD (staged + unstaged changes)
@@ -0,0 +1,207 @@
+import Foundation
+import Clibgit2
+
+/// File-level entry of a lazy diff: everything libgit2 knows without generating a patch
+struct Libgit2DiffFile: Sendable {
+    let index: Int
+    let oldPath: String?
+    let newPath: String?
+    let status: Libgit2DiffDelta.DeltaStatus
+    let isBinary: Bool
+
+    var path: String? { newPath ?? oldPath }
+}
+
+/// Diff whose patches are generated on demand.
+///
+/// Listing files only walks the delta array of the retained `git_diff`; a file's patch is
+/// built the first time its stats or hunks are requested, and hunk lines are converted to
+/// Swift values one hunk at a time. A small number of recent patches are kept alive.
+final class Libgit2LazyDiff: @unchecked Sendable {
+    // git_diff borrows the repository, so it must outlive the diff
+    private let repository: Libgit2Repository
+    private let diff: OpaquePointer
+    private let lock = NSLock()
+
+    private var patches: [Int: OpaquePointer] = [:]
+    private var patchOrder: [Int] = []
+    private let maxRetainedPatches = 32
+
+    let files: [Libgit2DiffFile]
+
+    /// Takes ownership of `diff`
+    init(repository: Libgit2Repository, diff: OpaquePointer) {
+        self.repository = repository
+        self.diff = diff
+
+        let count = git_diff_num_deltas(diff)
+        var files: [Libgit2DiffFile] = []
+        files.reserveCapacity(count)
+        for i in 0..<count {
+            guard let delta = git_diff_get_delta(diff, i) else { continue }
+            files.append(Libgit2DiffFile(
+                index: i,
+                oldPath: delta.pointee.old_file.path.map { String(cString: $0) },
+                newPath: delta.pointee.new_file.path.map { String(cString: $0) },
+                status: Libgit2DiffDelta.DeltaStatus(from: delta.pointee.status),
+                isBinary: (delta.pointee.flags & UInt32(GIT_DIFF_FLAG_BINARY.rawValue)) != 0
+            ))
+        }
+        self.files = files
+    }
+
+    deinit {
+        for patch in patches.values {
+            git_patch_free(patch)
+        }
+        git_diff_free(diff)
+    }
+
+    func file(forPath path: String) -> Libgit2DiffFile? {
+        files.first { $0.newPath == path || $0.oldPath == path }
+    }
+
+    // MARK: - Per-file materialization
+
+    /// Added and deleted line counts for one file (generates its patch)
+    func lineStats(for file: Libgit2DiffFile) -> (additions: Int, deletions: Int) {
+        withPatch(file.index) { patch -> (additions: Int, deletions: Int) in
+            var context = 0
+            var additions = 0
+            var deletions = 0
+            guard git_patch_line_stats(&context, &additions, &deletions, patch) == 0 else { return (0, 0) }
+            return (additions, deletions)
+        } ?? (0, 0)
+    }
+
+    /// Hunk headers and ranges for one file, without line contents
+    func hunkHeaders(for file: Libgit2DiffFile) -> [Libgit2DiffHunk] {
+        withPatch(file.index) { patch in
+            (0..<git_patch_num_hunks(patch)).compactMap { hunkIndex in
+                Self.hunk(hunkIndex, in: patch, includeLines: false)
+            }
+        } ?? []
+    }
+
+    /// One hunk with its lines
+    func hunk(_ hunkIndex: Int, for file: Libgit2DiffFile) -> Libgit2DiffHunk? {
+        withPatch(file.index) { patch in
+            guard hunkIndex < git_patch_num_hunks(patch) else { return nil }
+            return Self.hunk(hunkIndex, in: patch, includeLines: true)
+        } ?? nil
+    }
+
+    /// Fully materialized delta for one file
+    func delta(for file: Libgit2DiffFile) -> Libgit2DiffDelta {
+        let hunks = withPatch(file.index) { patch in
+            (0..<git_patch_num_hunks(patch)).compactMap { hunkIndex in
+                Self.hunk(hunkIndex, in: patch, includeLines: true)
+            }
+        } ?? []
+
+        var additions = 0
+        var deletions = 0
+        for hunk in hunks {
+            for line in hunk.lines {
+                if line.origin == .addition { additions += 1 }
+                if line.origin == .deletion { deletions += 1 }
+            }
+        }
+
+        return Libgit2DiffDelta(
+            oldPath: file.oldPath,
+            newPath: file.newPath,
+            status: file.status,
+            hunks: hunks,
+            additions: additions,
+            deletions: deletions,
+            isBinary: file.isBinary
+        )
+    }
+
+    /// Release retained patches; files can still be materialized again later
+    func releasePatches() {
+        lock.lock()
+        defer { lock.unlock() }
+        for patch in patches.values {
+            git_patch_free(patch)
+        }
+        patches.removeAll()
+        patchOrder.removeAll()
+    }
+
+    // MARK: - Private
+
+    private func withPatch<T>(_ deltaIndex: Int, _ body: (OpaquePointer) -> T) -> T? {
+        lock.lock()
+        defer { lock.unlock() }
+
+        if let patch = patches[deltaIndex] {
+            return body(patch)
+        }
+
+        var patch: OpaquePointer?
+        guard git_patch_from_diff(&patch, diff, deltaIndex) == 0, let p = patch else {
+            return nil
+        }
+
+        patches[deltaIndex] = p
+        patchOrder.append(deltaIndex)
+        if patchOrder.count > maxRetainedPatches {
+            let evicted = patchOrder.removeFirst()
+            if let old = patches.removeValue(forKey: evicted) {
+                git_patch_free(old)
+            }
+        }
+        return body(p)
+    }
+
+    private static func hunk(_ hunkIndex: Int, in patch: OpaquePointer, includeLines: Bool) -> Libgit2DiffHunk? {
+        var hunk: UnsafePointer<git_diff_hunk>?
+        var hunkLines: Int = 0
+        guard git_patch_get_hunk(&hunk, &hunkLines, patch, hunkIndex) == 0, let hunkPtr = hunk else {
+            return nil
+        }
+
+        var lines: [Libgit2DiffLine] = []
+        if includeLines {
+            lines.reserveCapacity(hunkLines)
+            for l in 0..<hunkLines {
+                var line: UnsafePointer<git_diff_line>?
+                guard git_patch_get_line_in_hunk(&line, patch, hunkIndex, l) == 0, let linePtr = line else {
+                    continue
+                }
+
+                let content: String
+                if let contentPtr = linePtr.pointee.content {
+                    let buffer = UnsafeRawBufferPointer(start: contentPtr, count: linePtr.pointee.content_len)
+                    content = String(decoding: buffer, as: UTF8.self)
+                } else {
+                    content = ""
+                }
+
+                lines.append(Libgit2DiffLine(
+                    origin: Libgit2LineOrigin(from: linePtr.pointee.origin),
+                    oldLineNumber: linePtr.pointee.old_lineno > 0 ? Int(linePtr.pointee.old_lineno) : nil,
+                    newLineNumber: linePtr.pointee.new_lineno > 0 ? Int(linePtr.pointee.new_lineno) : nil,
+                    content: content
+                ))
+            }
+        }
+
+        let header = withUnsafePointer(to: hunkPtr.pointee.header) { ptr in
+            ptr.withMemoryRebound(to: CChar.self, capacity: Int(GIT_DIFF_HUNK_HEADER_SIZE)) {
+                String(cString: $0)
+            }
+        }
+
+        return Libgit2DiffHunk(
+            header: header,
+            oldStart: Int(hunkPtr.pointee.old_start),
+            oldLines: Int(hunkPtr.pointee.old_lines),
+            newStart: Int(hunkPtr.pointee.new_start),
+            newLines: Int(hunkPtr.pointee.new_lines),
+            lines: lines
+        )
+    }
+}
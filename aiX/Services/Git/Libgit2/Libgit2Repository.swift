@@ -42,6 +42,13 @@ final class Libgit2Repository {
         return String(cString: path)
     }
 
+    /// Get the common .git directory shared by all worktrees of the repository
+    var commondir: String? {
+        guard let ptr = pointer else { return nil }
+        guard let path = git_repository_commondir(ptr) else { return nil }
+        return String(cString: path)
+    }
+
     /// Initialize from an existing repository path
     init(path: String) throws {
         Libgit2Service.shared.ensureInitialized()
@@ -160,6 +167,20 @@ final class Libgit2Repository {
         return reference
     }
 
+    /// Get the commit OID HEAD resolves to (nil for unborn branches)
+    func headOid() -> String? {
+        guard let ptr = pointer else { return nil }
+
+        var oid = git_oid()
+        guard git_reference_name_to_id(&oid, ptr, "HEAD") == 0 else { return nil }
+
+        var buffer = [CChar](repeating: 0, count: Int(GIT_OID_HEXSZ) + 1)
+        _ = buffer.withUnsafeMutableBufferPointer { buf in
+            git_oid_tostr(buf.baseAddress, buf.count, &oid)
+        }
+        return String(cString: buffer)
+    }
+
     /// Get the current branch name (nil if HEAD is detached)
     func currentBranchName() throws -> String? {
         guard !isHeadDetached else { return nil }
@@ -0,0 +1,225 @@
+import Foundation
+
+/// Pool of warm libgit2 repository handles keyed by gitdir.
+///
+/// A handle keeps libgit2's config, index and ODB/pack caches between operations, so
+/// repeated status, branch and graph queries skip `git_repository_open`. libgit2 forbids
+/// using one `git_repository` from several threads at once, so a handle is checked out
+/// exclusively for the duration of a body; bodies run on a bounded operation queue rather
+/// than on ad-hoc detached tasks. Idle handles of a worktree are dropped when its
+/// GitIndexWatcher reports an index or HEAD change.
+final class Libgit2RepositoryPool: @unchecked Sendable {
+    static let shared = Libgit2RepositoryPool()
+
+    struct Stats: Sendable {
+        var opens = 0
+        var hits = 0
+        var misses = 0
+        var evictions = 0
+        var invalidations = 0
+    }
+
+    private struct IdleHandle {
+        let repository: Libgit2Repository
+        let generation: Int
+        var lastUsed: UInt64
+    }
+
+    private let lock = NSLock()
+    private let workers: OperationQueue
+
+    private var idle: [String: [IdleHandle]] = [:]
+    private var idleCount = 0
+    // Bumped on invalidation so handles checked out before it aren't returned to the pool
+    private var generations: [String: Int] = [:]
+    // Requested path -> gitdir, so routing a request doesn't re-run discovery
+    private var gitdirs: [String: String] = [:]
+    // Index watch per gitdir; token is nil while the subscription is being set up
+    private var watchTokens: [String: (worktreePath: String, token: UUID?)] = [:]
+    private var clock: UInt64 = 0
+    private var counters = Stats()
+
+    private let maxIdleHandles: Int
+    private let maxIdlePerRepository: Int
+
+    init(
+        workerCount: Int = min(max(ProcessInfo.processInfo.activeProcessorCount, 2), 6),
+        maxIdleHandles: Int = 32,
+        maxIdlePerRepository: Int = 2
+    ) {
+        self.workers = OperationQueue()
+        self.workers.name = "win.aiX.libgit2-pool"
+        self.workers.maxConcurrentOperationCount = workerCount
+        self.workers.qualityOfService = .utility
+        self.maxIdleHandles = maxIdleHandles
+        self.maxIdlePerRepository = maxIdlePerRepository
+    }
+
+    var stats: Stats {
+        lock.lock()
+        defer { lock.unlock() }
+        return counters
+    }
+
+    /// Run `body` on a pool worker with exclusive use of a handle for the repository at `path`.
+    /// The handle must not escape `body`.
+    func withRepository<T>(
+        at path: String,
+        _ body: @escaping @Sendable (Libgit2Repository) throws -> T
+    ) async throws -> T {
+        try await withCheckedThrowingContinuation { continuation in
+            workers.addOperation { [self] in
+                do {
+                    let (repository, key, generation) = try checkout(path)
+                    defer { checkin(repository, key: key, generation: generation) }
+                    continuation.resume(returning: try body(repository))
+                } catch {
+                    continuation.resume(throwing: error)
+                }
+            }
+        }
+    }
+
+    /// Drop idle handles of a repository (e.g. after an external change)
+    func invalidate(path: String) {
+        lock.lock()
+        let key = gitdirs[Self.normalize(path)]
+        lock.unlock()
+        if let key {
+            invalidate(key: key)
+        }
+    }
+
+    func invalidateAll() {
+        lock.lock()
+        defer { lock.unlock() }
+        for key in idle.keys {
+            generations[key, default: 0] += 1
+        }
+        idle.removeAll()
+        idleCount = 0
+    }
+
+    // MARK: - Checkout
+
+    private func checkout(_ path: String) throws -> (Libgit2Repository, String, Int) {
+        let normalized = Self.normalize(path)
+
+        lock.lock()
+        if let key = gitdirs[normalized], var handles = idle[key], let handle = handles.popLast() {
+            idle[key] = handles.isEmpty ? nil : handles
+            idleCount -= 1
+            counters.hits += 1
+            lock.unlock()
+            return (handle.repository, key, handle.generation)
+        }
+        counters.misses += 1
+        lock.unlock()
+
+        let repository = try Libgit2Repository(path: path)
+        let key = repository.gitdir.map(Self.normalize) ?? normalized
+
+        lock.lock()
+        counters.opens += 1
+        gitdirs[normalized] = key
+        let generation = generations[key, default: 0]
+        lock.unlock()
+
+        // Same path form as other subscribers so the watcher is shared
+        watchIndex(key: key, worktreePath: Self.normalize(repository.workdir ?? path))
+        return (repository, key, generation)
+    }
+
+    private func checkin(_ repository: Libgit2Repository, key: String, generation: Int) {
+        lock.lock()
+        guard generations[key, default: 0] == generation,
+              (idle[key]?.count ?? 0) < maxIdlePerRepository else {
+            lock.unlock()
+            return
+        }
+
+        clock += 1
+        idle[key, default: []].append(IdleHandle(repository: repository, generation: generation, lastUsed: clock))
+        idleCount += 1
+        let evicted = evictIfNeeded()
+        lock.unlock()
+
+        for watch in evicted {
+            unwatchIndex(watch)
+        }
+    }
+
+    // Called with the lock held; returns index watches of repositories left without idle handles
+    private func evictIfNeeded() -> [(worktreePath: String, token: UUID)] {
+        var evicted: [(worktreePath: String, token: UUID)] = []
+        while idleCount > maxIdleHandles {
+            var oldest: (key: String, index: Int, lastUsed: UInt64)?
+            for (key, handles) in idle {
+                for (index, handle) in handles.enumerated() where handle.lastUsed < (oldest?.lastUsed ?? .max) {
+                    oldest = (key, index, handle.lastUsed)
+                }
+            }
+            guard let oldest else { break }
+
+            idle[oldest.key]?.remove(at: oldest.index)
+            idleCount -= 1
+            counters.evictions += 1
+            if idle[oldest.key]?.isEmpty == true {
+                idle[oldest.key] = nil
+                if let watch = watchTokens.removeValue(forKey: oldest.key), let token = watch.token {
+                    evicted.append((watch.worktreePath, token))
+                }
+            }
+        }
+        return evicted
+    }
+
+    // MARK: - Invalidation
+
+    private func invalidate(key: String) {
+        lock.lock()
+        generations[key, default: 0] += 1
+        let dropped = idle.removeValue(forKey: key)?.count ?? 0
+        idleCount -= dropped
+        counters.invalidations += 1
+        lock.unlock()
+    }
+
+    private func watchIndex(key: String, worktreePath: String) {
+        lock.lock()
+        // Reserve the slot so concurrent misses don't subscribe twice
+        guard watchTokens[key] == nil else {
+            lock.unlock()
+            return
+        }
+        watchTokens[key] = (worktreePath, nil)
+        lock.unlock()
+
+        Task {
+            let token = await GitIndexWatchCenter.shared.addSubscriber(worktreePath: worktreePath) { [weak self] in
+                self?.invalidate(key: key)
+            }
+            self.lock.lock()
+            let stillWanted = self.watchTokens[key] != nil
+            if stillWanted {
+                self.watchTokens[key] = (worktreePath, token)
+            }
+            self.lock.unlock()
+
+            if !stillWanted {
+                await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: worktreePath, id: token)
+            }
+        }
+    }
+
+    private func unwatchIndex(_ watch: (worktreePath: String, token: UUID)) {
+        Task {
+            await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: watch.worktreePath, id: watch.token)
+        }
+    }
+
+    private static func normalize(_ path: String) -> String {
+        let standardized = (path as NSString).standardizingPath
+        return standardized.hasSuffix("/") && standardized.count > 1 ? String(standardized.dropLast()) : standardized
+    }
+}
@@ -0,0 +1,79 @@
+import Foundation
+import Clibgit2
+
+/// Time-sorted revision walk that is read a page at a time.
+///
+/// The `git_revwalk` is kept between pages, so reading page N doesn't re-walk the N - 1
+/// pages before it. Not thread-safe: like its repository, a walk must not be used from
+/// two threads at once.
+final class Libgit2RevisionWalk {
+    // git_revwalk borrows the repository, so it must outlive the walk
+    private let repository: Libgit2Repository
+    private let walk: OpaquePointer
+
+    private(set) var isExhausted = false
+
+    /// Walk from HEAD (or `tips` when given), excluding everything reachable from `hidden`
+    init(repository: Libgit2Repository, tips: [String]? = nil, hiding hidden: [String] = []) throws {
+        guard let ptr = repository.pointer else {
+            throw Libgit2Error.notARepository(repository.path)
+        }
+
+        var revwalk: OpaquePointer?
+        let walkError = git_revwalk_new(&revwalk, ptr)
+        guard walkError == 0, let walk = revwalk else {
+            throw Libgit2Error.from(walkError, context: "revwalk new")
+        }
+        self.repository = repository
+        self.walk = walk
+
+        git_revwalk_sorting(walk, UInt32(GIT_SORT_TIME.rawValue))
+
+        if let tips {
+            for tip in tips {
+                var oid = git_oid()
+                guard git_oid_fromstr(&oid, tip) == 0 else { continue }
+                git_revwalk_push(walk, &oid)
+            }
+        } else if git_revwalk_push_head(walk) != 0 {
+            // No HEAD - empty repo
+            isExhausted = true
+        }
+
+        for hide in hidden {
+            var oid = git_oid()
+            guard git_oid_fromstr(&oid, hide) == 0 else { continue }
+            git_revwalk_hide(walk, &oid)
+        }
+    }
+
+    deinit {
+        git_revwalk_free(walk)
+    }
+
+    /// Next commits of the walk, at most `maxCount`; fewer only once the walk is exhausted
+    func next(maxCount: Int) -> [Libgit2CommitInfo] {
+        guard !isExhausted, let ptr = repository.pointer else { return [] }
+
+        var result: [Libgit2CommitInfo] = []
+        result.reserveCapacity(maxCount)
+        var oid = git_oid()
+
+        while result.count < maxCount {
+            guard git_revwalk_next(&oid, walk) == 0 else {
+                isExhausted = true
+                break
+            }
+
+            var commit: OpaquePointer?
+            guard git_commit_lookup(&commit, ptr, &oid) == 0, let c = commit else {
+                continue
+            }
+            defer { git_commit_free(c) }
+
+            result.append(repository.parseCommit(c, oid: &oid))
+        }
+
+        return result
+    }
+}
@@ -43,7 +43,7 @@ struct Libgit2FileStatus: OptionSet, Sendable {
 }
 
 /// Status entry for a single file
-struct Libgit2StatusEntry: Sendable {
+struct Libgit2StatusEntry: Sendable, Equatable {
     let path: String
     let oldPath: String?  // For renames
     let status: Libgit2FileStatus
@@ -92,11 +92,24 @@ struct Libgit2StatusSummary: Sendable {
     }
 }
 
+extension Libgit2StatusSummary {
+    /// Categorize entries into the staged/modified/untracked/conflicted lists
+    init(entries: [Libgit2StatusEntry]) {
+        self.init(
+            entries: entries,
+            staged: entries.filter { $0.category == .staged },
+            modified: entries.filter { $0.category == .modified },
+            untracked: entries.filter { $0.category == .untracked },
+            conflicted: entries.filter { $0.category == .conflicted }
+        )
+    }
+}
+
 /// Status operations extension for Libgit2Repository
 extension Libgit2Repository {
 
-    /// Get repository status
-    func status(includeUntracked: Bool = true, includeIgnored: Bool = false) throws -> Libgit2StatusSummary {
+    /// Get repository status, optionally limited to `paths` (files or directories)
+    func status(includeUntracked: Bool = true, includeIgnored: Bool = false, paths: [String] = []) throws -> Libgit2StatusSummary {
         guard let ptr = pointer else {
             throw Libgit2Error.notARepository(path)
         }
@@ -115,8 +128,20 @@ extension Libgit2Repository {
             opts.flags |= UInt32(GIT_STATUS_OPT_INCLUDE_IGNORED.rawValue)
         }
 
+        var cStrings = paths.map { strdup($0) }
+        defer { cStrings.forEach { free($0) } }
+
         var statusList: OpaquePointer?
-        let listError = git_status_list_new(&statusList, ptr, &opts)
+        let listError = cStrings.withUnsafeMutableBufferPointer { buffer -> Int32 in
+            if !paths.isEmpty {
+                // Literal paths: names with glob characters ("[id].tsx") match only themselves.
+                // A directory still matches everything under it.
+                opts.flags |= UInt32(GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH.rawValue)
+                opts.pathspec.strings = buffer.baseAddress
+                opts.pathspec.count = paths.count
+            }
+            return git_status_list_new(&statusList, ptr, &opts)
+        }
         guard listError == 0, let list = statusList else {
             throw Libgit2Error.from(listError, context: "status list")
         }
@@ -167,19 +192,42 @@ extension Libgit2Repository {
             ))
         }
 
-        // Categorize entries
-        let staged = entries.filter { $0.category == .staged }
-        let modified = entries.filter { $0.category == .modified }
-        let untracked = entries.filter { $0.category == .untracked }
-        let conflicted = entries.filter { $0.category == .conflicted }
+        return Libgit2StatusSummary(entries: entries)
+    }
 
-        return Libgit2StatusSummary(
-            entries: entries,
-            staged: staged,
-            modified: modified,
-            untracked: untracked,
-            conflicted: conflicted
-        )
+    /// Status of a single file, without walking the worktree or detecting renames.
+    /// Clean and nonexistent paths give an empty set; nil means the path isn't a single
+    /// file (e.g. a directory) and needs a pathspec-limited `status(paths:)` instead.
+    func fileStatus(_ filePath: String) -> Libgit2FileStatus? {
+        guard let ptr = pointer else { return nil }
+
+        var flags: UInt32 = 0
+        let error = git_status_file(&flags, ptr, filePath)
+        if error == 0 {
+            return Libgit2FileStatus(rawValue: flags)
+        }
+        if error == Int32(GIT_ENOTFOUND.rawValue) {
+            return []
+        }
+        return nil
+    }
+
+    /// Paths from `paths` that are ignored and not in the index, i.e. whose changes status never reports.
+    /// Tracked files stay reported even when an ignore rule matches them.
+    func untrackedIgnoredPaths(_ paths: [String]) -> Set<String> {
+        guard let ptr = pointer, let index = try? getIndex() else { return [] }
+        defer { git_index_free(index) }
+
+        var ignored: Set<String> = []
+        for path in paths {
+            var isIgnored: Int32 = 0
+            guard git_ignore_path_is_ignored(&isIgnored, ptr, path) == 0, isIgnored == 1,
+                  git_index_get_bypath(index, path, 0) == nil else {
+                continue
+            }
+            ignored.insert(path)
+        }
+        return ignored
     }
 
     /// Check if working directory is clean
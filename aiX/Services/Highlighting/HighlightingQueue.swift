@@ -7,73 +7,245 @@
 
 import Foundation
 import SwiftUI
+import CryptoKit
 import CodeEditLanguages
 import CodeEditSourceEditor
 
-/// Manages syntax highlighting with concurrency limits to prevent CPU overload
+/// Manages syntax highlighting with concurrency limits to prevent CPU overload.
+///
+/// Requests beyond `maxConcurrent` wait suspended (no polling) in a queue ordered by task priority, newest first:
+/// a code block that just scrolled into view is highlighted before ones requested earlier. A code block that goes
+/// offscreen cancels its task, which removes its request from the queue at once; when the queue is full the oldest,
+/// lowest-priority request is dropped. Results are cached in a byte-bounded LRU keyed by a digest of the code,
+/// the language and the theme.
 actor HighlightingQueue {
     static let shared = HighlightingQueue()
 
-    // Cache for highlighted results (keyed by content hash + language)
-    private var cache: [Int: AttributedString] = [:]
-    private let maxCacheSize = 100
+    struct Stats: Sendable {
+        var queueDepth = 0
+        var maxQueueDepth = 0
+        var hits = 0
+        var misses = 0
+        var dropped = 0
+        var started = 0
+        var totalWait: TimeInterval = 0
+        var cachedBytes = 0
+
+        var hitRate: Double {
+            let lookups = hits + misses
+            return lookups == 0 ? 0 : Double(hits) / Double(lookups)
+        }
+
+        var averageWait: TimeInterval {
+            started == 0 ? 0 : totalWait / Double(started)
+        }
+    }
+
+    private struct CacheKey: Hashable {
+        let digest: SHA256.Digest
+        let languageId: String
+        let themeName: String
+    }
+
+    private struct CacheEntry {
+        let value: AttributedString
+        let cost: Int
+        var lastUsed: UInt64
+    }
+
+    private struct Waiter {
+        let id: UInt64
+        let priority: UInt8
+        let enqueuedAt: Date
+        let continuation: CheckedContinuation<Bool, Never>
+    }
+
+    // Cache for highlighted results, bounded by estimated size
+    private var cache: [CacheKey: CacheEntry] = [:]
+    private var cacheBytes = 0
+    private var cacheClock: UInt64 = 0
+    private let maxCacheBytes = 16 * 1024 * 1024
 
     // Concurrency control
     private var activeCount = 0
     private let maxConcurrent = 2
+    private var waiters: [Waiter] = []
+    private var nextWaiterId: UInt64 = 0
+    private let maxQueued = 64
+
+    // Identical requests in flight share one highlight
+    private var inFlight: [CacheKey: Task<AttributedString?, Never>] = [:]
+
+    private var counters = Stats()
 
     // Internal highlighter
     private let highlighter = TreeSitterHighlighter()
 
     private init() {}
 
-    /// Highlight code with queuing and caching
+    var stats: Stats {
+        var stats = counters
+        stats.queueDepth = waiters.count
+        stats.cachedBytes = cacheBytes
+        return stats
+    }
+
+    /// Highlight code with queuing and caching. Returns nil when cancelled, dropped from the queue, or on failure.
     func highlight(
         code: String,
         language: CodeLanguage,
-        theme: EditorTheme
+        theme: EditorTheme,
+        themeName: String
     ) async -> AttributedString? {
-        // Generate cache key from content and language
-        let cacheKey = code.hashValue ^ language.id.hashValue
+        let key = CacheKey(
+            digest: SHA256.hash(data: Data(code.utf8)),
+            languageId: language.id.rawValue,
+            themeName: themeName
+        )
 
         // Check cache first
-        if let cached = cache[cacheKey] {
-            return cached
+        if let cached = cache[key] {
+            counters.hits += 1
+            cacheClock += 1
+            cache[key]?.lastUsed = cacheClock
+            return cached.value
         }
+        counters.misses += 1
 
-        // Wait if at concurrency limit
-        while activeCount >= maxConcurrent {
-            await Task.yield()
-            // Check for cancellation while waiting
-            if Task.isCancelled { return nil }
+        if let running = inFlight[key] {
+            return await running.value
         }
 
-        // Check cancellation before starting work
-        guard !Task.isCancelled else { return nil }
+        // Wait for a slot; the priority of the requesting task orders the queue
+        let priority = Task.currentPriority.rawValue
+        guard await acquireSlot(priority: priority) else { return nil }
 
-        activeCount += 1
-        defer { activeCount -= 1 }
-
-        do {
-            let result = try await highlighter.highlightCode(code, language: language, theme: theme)
+        // Another request for the same code may have finished or started while this one waited
+        if let cached = cache[key] {
+            releaseSlot()
+            return cached.value
+        }
+        if let running = inFlight[key] {
+            releaseSlot()
+            return await running.value
+        }
 
-            // Store in cache
-            if cache.count >= maxCacheSize {
-                // Remove oldest entry (simple LRU approximation)
-                if let firstKey = cache.keys.first {
-                    cache.removeValue(forKey: firstKey)
-                }
-            }
-            cache[cacheKey] = result
+        let task = Task { [highlighter] () -> AttributedString? in
+            try? await highlighter.highlightCode(code, language: language, theme: theme)
+        }
+        inFlight[key] = task
+        let result = await task.value
+        inFlight[key] = nil
+        releaseSlot()
 
-            return result
-        } catch {
-            return nil
+        if let result {
+            store(result, for: key, cost: Self.estimatedCost(of: code))
         }
+        return result
     }
 
     /// Clear the cache (e.g., when theme changes)
     func clearCache() {
         cache.removeAll()
+        cacheBytes = 0
+    }
+
+    // MARK: - Scheduling
+
+    private func acquireSlot(priority: UInt8) async -> Bool {
+        guard !Task.isCancelled else { return false }
+        if activeCount < maxConcurrent {
+            activeCount += 1
+            counters.started += 1
+            return true
+        }
+
+        nextWaiterId += 1
+        let id = nextWaiterId
+        return await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                enqueue(Waiter(id: id, priority: priority, enqueuedAt: Date(), continuation: continuation))
+            }
+        } onCancel: {
+            Task { await self.cancelWaiter(id) }
+        }
+    }
+
+    private func enqueue(_ waiter: Waiter) {
+        // Cancelled before it could be queued
+        if Task.isCancelled {
+            waiter.continuation.resume(returning: false)
+            return
+        }
+
+        waiters.append(waiter)
+        counters.maxQueueDepth = max(counters.maxQueueDepth, waiters.count)
+
+        if waiters.count > maxQueued, let index = indexOfNext(lowest: true) {
+            let dropped = waiters.remove(at: index)
+            counters.dropped += 1
+            dropped.continuation.resume(returning: false)
+        }
+    }
+
+    private func cancelWaiter(_ id: UInt64) {
+        guard let index = waiters.firstIndex(where: { $0.id == id }) else { return }
+        let waiter = waiters.remove(at: index)
+        waiter.continuation.resume(returning: false)
+    }
+
+    /// Hand the slot to the next waiter, or free it
+    private func releaseSlot() {
+        guard let index = indexOfNext(lowest: false) else {
+            activeCount -= 1
+            return
+        }
+        let waiter = waiters.remove(at: index)
+        counters.started += 1
+        counters.totalWait += Date().timeIntervalSince(waiter.enqueuedAt)
+        waiter.continuation.resume(returning: true)
+    }
+
+    // Highest priority, newest first; or with `lowest`, the lowest priority, oldest first.
+    // The queue is short (bounded by `maxQueued`), so a scan beats maintaining a heap.
+    private func indexOfNext(lowest: Bool) -> Int? {
+        guard !waiters.isEmpty else { return nil }
+        var best = 0
+        for index in waiters.indices.dropFirst() {
+            let candidate = waiters[index]
+            let current = waiters[best]
+            if lowest {
+                if candidate.priority < current.priority {
+                    best = index
+                }
+            } else if candidate.priority >= current.priority {
+                best = index
+            }
+        }
+        return best
+    }
+
+    // MARK: - Cache
+
+    private func store(_ value: AttributedString, for key: CacheKey, cost: Int) {
+        guard cost <= maxCacheBytes / 4 else { return }
+
+        cacheClock += 1
+        if let previous = cache.updateValue(CacheEntry(value: value, cost: cost, lastUsed: cacheClock), forKey: key) {
+            cacheBytes -= previous.cost
+        }
+        cacheBytes += cost
+
+        // Evict least recently used entries until under budget
+        while cacheBytes > maxCacheBytes,
+              let oldest = cache.min(by: { $0.value.lastUsed < $1.value.lastUsed }) {
+            cache.removeValue(forKey: oldest.key)
+            cacheBytes -= oldest.value.cost
+        }
+    }
+
+    // Attributed strings hold the text plus per-run attributes; roughly a few bytes per source byte
+    private static func estimatedCost(of code: String) -> Int {
+        code.utf8.count * 4 + 256
     }
 }
@@ -0,0 +1,310 @@
+//
+//  FileContentIndexService.swift
+//  aizen
+//
+//  Optional trigram index narrowing content search to candidate files
+//
+
+import Foundation
+import CryptoKit
+import os.log
+
+actor FileContentIndexService {
+    static let shared = FileContentIndexService()
+
+    private struct WorktreeState {
+        let storeKey: String
+        // Clean index entries (stage 0, worktree matches the index) -> blob ordinal
+        var pathOrdinals: [String: UInt32]
+        // Files modified in the worktree relative to the index when it was last read; always scanned
+        var modifiedPaths: Set<String>
+    }
+
+    private let logger = Logger.forCategory("ContentIndex")
+    private var stores: [String: TrigramIndexStore] = [:]
+    private var worktrees: [String: WorktreeState] = [:]
+    private var updateTasks: [String: Task<Void, Never>] = [:]
+    // Worktree edits don't touch the git index. Files touched since the last update (reported
+    // by FSEvents or an in-app save) no longer match their blob postings and are always scanned.
+    private var fileWatchers: [String: WorktreeFileEventWatcher] = [:]
+    private var touchedPaths: [String: Set<String>] = [:]
+    // FSEvents dropped events, so the modified set is re-read before the next query
+    private var needsModifiedRefresh: Set<String> = []
+    private let extractionChunkSize = 64
+
+    private init() {}
+
+    // MARK: - Queries
+
+    /// Narrow `files` to those that can contain a match, or nil if the worktree has no index yet
+    /// (an index build is scheduled in that case) or the query has no usable trigrams.
+    func candidates(
+        for query: String,
+        options: FileContentSearchOptions,
+        in files: [FileSearchIndexResult],
+        worktreePath: String
+    ) async -> [FileSearchIndexResult]? {
+        guard let state = worktrees[worktreePath], let store = stores[state.storeKey] else {
+            scheduleUpdate(for: worktreePath)
+            return nil
+        }
+
+        guard let literal = FileContentSearcher.prefilterLiteral(for: query, options: options) else { return nil }
+        let trigrams = Trigram.query(literal)
+        guard !trigrams.isEmpty else { return nil }
+
+        if needsModifiedRefresh.contains(worktreePath) {
+            needsModifiedRefresh.remove(worktreePath)
+            guard let modified = await Self.gitPaths(worktreePath, arguments: ["ls-files", "--modified", "-z"]) else {
+                needsModifiedRefresh.insert(worktreePath)
+                return nil
+            }
+            touchedPaths[worktreePath, default: []].formUnion(modified)
+        }
+
+        let touched = touchedPaths[worktreePath] ?? []
+        let matchingOrdinals = store.candidates(containingAll: trigrams)
+        return files.filter { file in
+            // Untracked, conflicted and locally modified files aren't covered by blob postings
+            guard let ordinal = state.pathOrdinals[file.relativePath],
+                  !state.modifiedPaths.contains(file.relativePath),
+                  !touched.contains(file.relativePath) else {
+                return true
+            }
+            return matchingOrdinals.contains(ordinal)
+        }
+    }
+
+    // MARK: - Maintenance
+
+    /// Build or incrementally update the index for a worktree. Only blobs the shared store
+    /// hasn't seen (from any worktree of the repository) have their contents read.
+    func scheduleUpdate(for worktreePath: String) {
+        guard updateTasks[worktreePath] == nil else { return }
+        updateTasks[worktreePath] = Task {
+            await self.update(worktreePath)
+            self.updateTasks[worktreePath] = nil
+        }
+    }
+
+    /// Refresh after a git index/HEAD change, but only for worktrees that already have an index
+    func handleGitIndexChange(for worktreePath: String) {
+        guard worktrees[worktreePath] != nil else { return }
+        scheduleUpdate(for: worktreePath)
+    }
+
+    /// Scan a file saved from inside the app directly, without waiting for its FSEvents delivery
+    func noteFileChanged(atPath path: String) {
+        for worktreePath in fileWatchers.keys where path.hasPrefix(worktreePath + "/") {
+            touchedPaths[worktreePath, default: []].insert(String(path.dropFirst(worktreePath.count + 1)))
+        }
+    }
+
+    func removeWorktree(_ worktreePath: String) {
+        updateTasks.removeValue(forKey: worktreePath)?.cancel()
+        worktrees.removeValue(forKey: worktreePath)
+        fileWatchers.removeValue(forKey: worktreePath)?.stop()
+        touchedPaths.removeValue(forKey: worktreePath)
+        needsModifiedRefresh.remove(worktreePath)
+    }
+
+    private func handleFileEvents(worktreePath: String, paths: [String], mustRescan: Bool) {
+        guard fileWatchers[worktreePath] != nil else { return }
+        touchedPaths[worktreePath, default: []].formUnion(paths)
+        if mustRescan {
+            needsModifiedRefresh.insert(worktreePath)
+        }
+    }
+
+    private func startFileWatcher(for worktreePath: String) {
+        guard fileWatchers[worktreePath] == nil else { return }
+        let watcher = WorktreeFileEventWatcher(worktreePath: worktreePath)
+        watcher.start(latency: 0.05) { [worktreePath] paths, mustRescan in
+            Task {
+                await FileContentIndexService.shared.handleFileEvents(
+                    worktreePath: worktreePath,
+                    paths: paths,
+                    mustRescan: mustRescan
+                )
+            }
+        }
+        fileWatchers[worktreePath] = watcher
+    }
+
+    private func update(_ worktreePath: String) async {
+        guard let repo = try? Libgit2Repository(path: worktreePath),
+              let commondir = repo.commondir else {
+            return
+        }
+        let storeKey = (commondir as NSString).standardizingPath
+        let store = self.store(for: storeKey)
+
+        // Edits before this point show up in `ls-files --modified` below; later ones arrive as events
+        startFileWatcher(for: worktreePath)
+        let touchedBefore = touchedPaths.updateValue([], forKey: worktreePath) ?? []
+        var completed = false
+        defer {
+            // The old state stays in use, so it still needs the paths touched before this update
+            if !completed {
+                touchedPaths[worktreePath, default: []].formUnion(touchedBefore)
+            }
+        }
+
+        async let staged = Self.gitPaths(worktreePath, arguments: ["ls-files", "--stage", "-z"])
+        async let modified = Self.gitPaths(worktreePath, arguments: ["ls-files", "--modified", "-z"])
+        guard let staged = await staged, let modified = await modified else { return }
+        let modifiedPaths = Set(modified)
+
+        // "<mode> <oid> <stage>\t<path>"; conflicted entries and symlinks stay unmapped
+        var entries: [(path: String, oid: String)] = []
+        entries.reserveCapacity(staged.count)
+        for record in staged {
+            guard let tab = record.firstIndex(of: "\t") else { continue }
+            let fields = record[..<tab].split(separator: " ")
+            guard fields.count == 3, fields[2] == "0", fields[0] != "120000", fields[0] != "160000" else { continue }
+            entries.append((String(record[record.index(after: tab)...]), String(fields[1])))
+        }
+
+        // One worktree path per unseen blob; identical blobs in other worktrees are reused
+        var unseen: [String: String] = [:]
+        for entry in entries where store.ordinal(forBlob: entry.oid) == nil && !modifiedPaths.contains(entry.path) {
+            unseen[entry.oid] = unseen[entry.oid] ?? entry.path
+        }
+
+        if !unseen.isEmpty {
+            logger.debug("Indexing \(unseen.count) new blobs for \(worktreePath, privacy: .public)")
+            let extracted = await Self.extractTrigrams(
+                unseen.map { (oid: $0.key, path: $0.value) },
+                basePath: worktreePath,
+                chunkSize: extractionChunkSize
+            )
+            guard !Task.isCancelled else { return }
+            for blob in extracted {
+                store.addBlob(oid: blob.oid, trigrams: blob.trigrams)
+            }
+            store.flush()
+        }
+
+        var pathOrdinals: [String: UInt32] = [:]
+        pathOrdinals.reserveCapacity(entries.count)
+        for entry in entries {
+            if let ordinal = store.ordinal(forBlob: entry.oid) {
+                pathOrdinals[entry.path] = ordinal
+            }
+        }
+
+        completed = true
+        worktrees[worktreePath] = WorktreeState(
+            storeKey: storeKey,
+            pathOrdinals: pathOrdinals,
+            modifiedPaths: modifiedPaths
+        )
+    }
+
+    private func store(for key: String) -> TrigramIndexStore {
+        if let store = stores[key] { return store }
+
+        let directory = AppCacheDirectory.url(for: key, in: "trigram-index", isDirectory: true)
+        let store = TrigramIndexStore(directory: directory)
+        stores[key] = store
+        return store
+    }
+
+    // MARK: - Helpers
+
+    private struct ExtractedBlob: Sendable {
+        let oid: String
+        // nil: too large to index, always scanned
+        let trigrams: [UInt32]?
+    }
+
+    // Read blob contents from the clean worktree files, in parallel chunks
+    private static func extractTrigrams(
+        _ blobs: [(oid: String, path: String)],
+        basePath: String,
+        chunkSize: Int
+    ) async -> [ExtractedBlob] {
+        await withTaskGroup(of: [ExtractedBlob].self) { group in
+            for start in stride(from: 0, to: blobs.count, by: chunkSize) {
+                let chunk = Array(blobs[start..<min(start + chunkSize, blobs.count)])
+                group.addTask {
+                    chunk.compactMap { blob in
+                        guard !Task.isCancelled else { return nil }
+                        let path = (basePath as NSString).appendingPathComponent(blob.path)
+                        return extractBlob(oid: blob.oid, path: path)
+                    }
+                }
+            }
+
+            var extracted: [ExtractedBlob] = []
+            extracted.reserveCapacity(blobs.count)
+            for await partial in group {
+                extracted.append(contentsOf: partial)
+            }
+            return extracted
+        }
+    }
+
+    private static func extractBlob(oid: String, path: String) -> ExtractedBlob? {
+        var info = stat()
+        guard stat(path, &info) == 0 else { return nil }
+        guard info.st_size <= off_t(Trigram.maxIndexedFileSize) else {
+            return ExtractedBlob(oid: oid, trigrams: nil)
+        }
+
+        guard let data = try? Data(contentsOf: URL(fileURLWithPath: path), options: .alwaysMapped) else {
+            return nil
+        }
+
+        let trigrams = data.withUnsafeBytes { raw -> [UInt32]? in
+            // Postings are stored under the OID, in a store shared by every worktree. The file
+            // must still hold exactly that blob: an edit after `ls-files` ran, or a smudge filter
+            // (autocrlf, LFS), would otherwise leave the blob with the wrong trigrams for good.
+            guard isBlob(raw, oid: oid) else { return nil }
+
+            let bytes = raw.bindMemory(to: UInt8.self)
+            // Binary blobs are never content search results, so they get no postings
+            if let base = bytes.baseAddress, memchr(base, 0, min(bytes.count, 8 * 1024)) != nil {
+                return []
+            }
+            return Trigram.extract(from: bytes)
+        }
+        // Left unindexed; the path stays unmapped and is always scanned
+        guard let trigrams else { return nil }
+        return ExtractedBlob(oid: oid, trigrams: trigrams)
+    }
+
+    /// Whether `bytes` hash to the blob `oid` ("blob <size>\0" + contents; SHA-1 or SHA-256)
+    static func isBlob(_ bytes: UnsafeRawBufferPointer, oid: String) -> Bool {
+        let header = Data("blob \(bytes.count)\0".utf8)
+        let digest: [UInt8]
+        switch oid.utf8.count {
+        case 40:
+            var hasher = Insecure.SHA1()
+            hasher.update(data: header)
+            hasher.update(bufferPointer: bytes)
+            digest = Array(hasher.finalize())
+        case 64:
+            var hasher = SHA256()
+            hasher.update(data: header)
+            hasher.update(bufferPointer: bytes)
+            digest = Array(hasher.finalize())
+        default:
+            return false
+        }
+        return digest.map { String(format: "%02x", $0) }.joined() == oid.lowercased()
+    }
+
+    private static func gitPaths(_ path: String, arguments: [String]) async -> [String]? {
+        guard let result = try? await ProcessExecutor.shared.executeWithOutput(
+            executable: "/usr/bin/git",
+            arguments: ["-C", path] + arguments
+        ), result.succeeded else {
+            return nil
+        }
+
+        return result.stdout
+            .split(separator: "\0", omittingEmptySubsequences: true)
+            .map(String.init)
+    }
+}
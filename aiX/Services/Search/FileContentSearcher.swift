@@ -0,0 +1,439 @@
+//
+//  FileContentSearcher.swift
+//  aizen
+//
+//  In-process "find in files" over the FileSearchService index
+//
+
+import Foundation
+import Darwin
+
+struct FileContentSearchOptions: Sendable {
+    var caseSensitive = false
+    var isRegex = false
+    /// Files larger than this are skipped
+    var maxFileSize = 8 * 1024 * 1024
+    var maxMatchesPerFile = 200
+    var maxResults = 10_000
+    /// Narrow the scan with the worktree's trigram index once it has been built
+    var useContentIndex = true
+}
+
+/// One matching line
+struct FileContentSearchMatch: Identifiable, Sendable {
+    let basePath: String
+    let relativePath: String
+    /// 1-based
+    let lineNumber: Int
+    let lineText: String
+    /// Match ranges within `lineText` (UTF-16, ready for NSAttributedString highlighting)
+    let matchRanges: [NSRange]
+
+    var path: String {
+        (basePath as NSString).appendingPathComponent(relativePath)
+    }
+
+    var id: String { "\(basePath)\u{0}\(relativePath):\(lineNumber)" }
+}
+
+/// Compiled query that scans individual files. Immutable and safe to share across tasks.
+struct FileContentSearcher: @unchecked Sendable {
+    private static let mmapThreshold = 64 * 1024
+    private static let binaryProbeLength = 8 * 1024
+    private static let maxLineTextBytes = 512
+
+    private let options: FileContentSearchOptions
+    // Literal query, or a literal every regex match must contain (used to skip files early)
+    private let literal: LiteralFinder?
+    private let regex: NSRegularExpression?
+
+    init?(query: String, options: FileContentSearchOptions) {
+        guard !query.isEmpty else { return nil }
+        self.options = options
+
+        // The byte-level finder folds ASCII case only; other case-insensitive literals need
+        // Unicode case folding, so they are matched as an escaped regex instead
+        let literalNeedsRegex = !options.isRegex && !options.caseSensitive && !query.allSatisfy(\.isASCII)
+        if options.isRegex || literalNeedsRegex {
+            var regexOptions: NSRegularExpression.Options = [.anchorsMatchLines]
+            if !options.caseSensitive {
+                regexOptions.insert(.caseInsensitive)
+            }
+            let pattern = options.isRegex ? query : NSRegularExpression.escapedPattern(for: query)
+            guard let regex = try? NSRegularExpression(pattern: pattern, options: regexOptions) else { return nil }
+            self.regex = regex
+            self.literal = Self.prefilterLiteral(for: query, options: options).map {
+                LiteralFinder(needle: Array($0.utf8), caseSensitive: options.caseSensitive)
+            }
+        } else {
+            self.regex = nil
+            self.literal = LiteralFinder(needle: Array(query.utf8), caseSensitive: options.caseSensitive)
+        }
+    }
+
+    // MARK: - Scanning
+
+    func scan(_ file: FileSearchIndexResult) -> [FileContentSearchMatch] {
+        let path = file.path
+
+        var info = stat()
+        guard stat(path, &info) == 0,
+              (info.st_mode & S_IFMT) == S_IFREG,
+              info.st_size > 0,
+              info.st_size <= off_t(options.maxFileSize) else {
+            return []
+        }
+
+        let url = URL(fileURLWithPath: path)
+        let readOptions: Data.ReadingOptions = info.st_size >= off_t(Self.mmapThreshold) ? .alwaysMapped : []
+        guard let data = try? Data(contentsOf: url, options: readOptions) else { return [] }
+
+        return data.withUnsafeBytes { raw -> [FileContentSearchMatch] in
+            let bytes = raw.bindMemory(to: UInt8.self)
+            guard let base = bytes.baseAddress else { return [] }
+
+            // Binary files: NUL byte near the start, like git and ripgrep
+            if memchr(base, 0, min(bytes.count, Self.binaryProbeLength)) != nil {
+                return []
+            }
+
+            if let regex {
+                if let literal, literal.firstIndex(in: base, from: 0, to: bytes.count) == nil {
+                    return []
+                }
+                return scanRegex(regex, bytes: bytes, file: file)
+            }
+
+            guard let literal else { return [] }
+            return scanLiteral(literal, base: base, count: bytes.count, file: file)
+        }
+    }
+
+    private func scanLiteral(
+        _ literal: LiteralFinder,
+        base: UnsafePointer<UInt8>,
+        count: Int,
+        file: FileSearchIndexResult
+    ) -> [FileContentSearchMatch] {
+        var matches: [FileContentSearchMatch] = []
+        var lineNumber = 1
+        var countedUpTo = 0
+        var lineStart = 0
+        var position = 0
+
+        while position < count, let hit = literal.firstIndex(in: base, from: position, to: count) {
+            // Advance line bookkeeping to the hit
+            while let newline = memchr(base + countedUpTo, Int32(UInt8(ascii: "\n")), hit - countedUpTo) {
+                lineNumber += 1
+                countedUpTo = base.distance(to: newline.assumingMemoryBound(to: UInt8.self)) + 1
+                lineStart = countedUpTo
+            }
+            countedUpTo = hit
+
+            let lineEnd = memchr(base + hit, Int32(UInt8(ascii: "\n")), count - hit)
+                .map { base.distance(to: $0.assumingMemoryBound(to: UInt8.self)) } ?? count
+
+            // Collect every occurrence on this line
+            var byteRanges = [hit..<(hit + literal.length)]
+            var next = hit + literal.length
+            while next < lineEnd, let another = literal.firstIndex(in: base, from: next, to: lineEnd) {
+                byteRanges.append(another..<(another + literal.length))
+                next = another + literal.length
+            }
+
+            matches.append(makeMatch(
+                file: file,
+                lineNumber: lineNumber,
+                line: UnsafeBufferPointer(start: base + lineStart, count: lineEnd - lineStart),
+                lineStart: lineStart,
+                byteRanges: byteRanges
+            ))
+            if matches.count >= options.maxMatchesPerFile { break }
+
+            position = lineEnd + 1
+        }
+
+        return matches
+    }
+
+    private func scanRegex(
+        _ regex: NSRegularExpression,
+        bytes: UnsafeBufferPointer<UInt8>,
+        file: FileSearchIndexResult
+    ) -> [FileContentSearchMatch] {
+        let text = String(decoding: bytes, as: UTF8.self) as NSString
+        let newline = unichar(UInt8(ascii: "\n"))
+
+        var matches: [FileContentSearchMatch] = []
+        var lineNumber = 1
+        var countedUpTo = 0
+        var currentLine: NSRange?
+        var currentRanges: [NSRange] = []
+
+        func flushLine() {
+            guard let line = currentLine else { return }
+            let lineText = text.substring(with: line).trimmingCharacters(in: .newlines)
+            matches.append(FileContentSearchMatch(
+                basePath: file.basePath,
+                relativePath: file.relativePath,
+                lineNumber: lineNumber,
+                lineText: lineText,
+                matchRanges: currentRanges
+            ))
+            currentLine = nil
+            currentRanges.removeAll()
+        }
+
+        regex.enumerateMatches(in: text as String, range: NSRange(location: 0, length: text.length)) { result, _, stop in
+            guard let range = result?.range, range.length > 0 else { return }
+
+            let lineRange = text.lineRange(for: NSRange(location: range.location, length: 0))
+            if lineRange.location != currentLine?.location {
+                flushLine()
+                if matches.count >= options.maxMatchesPerFile {
+                    stop.pointee = true
+                    return
+                }
+                while countedUpTo < lineRange.location {
+                    if text.character(at: countedUpTo) == newline { lineNumber += 1 }
+                    countedUpTo += 1
+                }
+                currentLine = lineRange
+            }
+
+            let clipped = NSIntersectionRange(range, lineRange)
+            currentRanges.append(NSRange(location: clipped.location - lineRange.location, length: clipped.length))
+        }
+        if matches.count < options.maxMatchesPerFile {
+            flushLine()
+        }
+
+        return matches
+    }
+
+    private func makeMatch(
+        file: FileSearchIndexResult,
+        lineNumber: Int,
+        line: UnsafeBufferPointer<UInt8>,
+        lineStart: Int,
+        byteRanges: [Range<Int>]
+    ) -> FileContentSearchMatch {
+        var visible = line.prefix(Self.maxLineTextBytes)
+        if visible.last == UInt8(ascii: "\r") {
+            visible = visible.dropLast()
+        }
+
+        // Convert byte offsets into UTF-16 offsets of the (possibly truncated) line text
+        func utf16Offset(_ byteOffset: Int) -> Int {
+            let clamped = min(max(byteOffset - lineStart, 0), visible.count)
+            return String(decoding: visible.prefix(clamped), as: UTF8.self).utf16.count
+        }
+
+        let ranges = byteRanges.compactMap { range -> NSRange? in
+            let lower = utf16Offset(range.lowerBound)
+            let upper = utf16Offset(range.upperBound)
+            return upper > lower ? NSRange(location: lower, length: upper - lower) : nil
+        }
+
+        return FileContentSearchMatch(
+            basePath: file.basePath,
+            relativePath: file.relativePath,
+            lineNumber: lineNumber,
+            lineText: String(decoding: visible, as: UTF8.self),
+            matchRanges: ranges
+        )
+    }
+
+    // MARK: - Regex Prefilter
+
+    /// Text every match of `query` must contain, for prefilters that fold ASCII case only
+    /// (the byte scan and the trigram index), or nil when no such text is safe to use
+    static func prefilterLiteral(for query: String, options: FileContentSearchOptions) -> String? {
+        if options.isRegex {
+            return requiredLiteral(inPattern: query, caseSensitive: options.caseSensitive)
+        }
+        return options.caseSensitive || query.allSatisfy(\.isASCII) ? query : nil
+    }
+
+    /// Longest plain run of at least 3 characters every match must contain, or nil when the
+    /// pattern has alternation or nothing safe to extract. Anything the scan can't prove is
+    /// literal text (counted repetition, `(?` group syntax, code point and property escapes)
+    /// gives up rather than guess, since a wrong literal silently drops real matches.
+    static func requiredLiteral(inPattern pattern: String, caseSensitive: Bool = true) -> String? {
+        // NSRegularExpression folds case with Unicode rules, the prefilter only with ASCII ones
+        guard caseSensitive || pattern.allSatisfy(\.isASCII) else { return nil }
+
+        let characters = Array(pattern)
+        guard !characters.contains("|") else { return nil }
+
+        var best = ""
+        var run = ""
+        var index = 0
+        var classDepth = 0
+        // Best run found outside each open group
+        var enclosingBests: [String] = []
+
+        func endRun() {
+            if run.count > best.count { best = run }
+            run = ""
+        }
+
+        while index < characters.count {
+            let char = characters[index]
+            let next = index + 1 < characters.count ? characters[index + 1] : nil
+
+            if classDepth > 0 {
+                if char == "\\" {
+                    index += 1
+                } else if char == "[" {
+                    classDepth += 1
+                } else if char == "]" {
+                    classDepth -= 1
+                }
+                index += 1
+                continue
+            }
+
+            switch char {
+            case "\\":
+                guard let next else { return nil }
+                if !next.isLetter, !next.isNumber {
+                    // Escaped punctuation is literal
+                    run.append(next)
+                } else if "xuUpPNQck0".contains(next) {
+                    // Hex, code point, property, named, quoted and named-backreference escapes carry their own text
+                    return nil
+                } else {
+                    // \d, \w, \s, \b, backreferences and the like match no fixed text
+                    endRun()
+                }
+                index += 2
+                continue
+            case "{", "}":
+                return nil
+            case "[":
+                endRun()
+                classDepth += 1
+            case "(":
+                if next == "?" { return nil }
+                endRun()
+                enclosingBests.append(best)
+                best = ""
+            case ")":
+                endRun()
+                let inner = best
+                best = enclosingBests.popLast() ?? ""
+                // An optional group contributes nothing required
+                if next != "*", next != "?", inner.count > best.count {
+                    best = inner
+                }
+            case ".", "^", "$", "+":
+                endRun()
+            case "*", "?":
+                // The preceding character is optional
+                if !run.isEmpty { run.removeLast() }
+                endRun()
+            default:
+                if next == "*" || next == "?" || next == "{" {
+                    endRun()
+                } else {
+                    run.append(char)
+                }
+            }
+            index += 1
+        }
+        endRun()
+        guard enclosingBests.isEmpty else { return nil }
+
+        return best.count >= 3 ? best : nil
+    }
+}
+
+/// Byte-level substring finder. Case-sensitive queries use `memmem`; case-insensitive ones
+/// scan 16 bytes at a time for either case of the needle's first byte, then verify.
+private struct LiteralFinder: Sendable {
+    private let needle: [UInt8]
+    private let foldedNeedle: [UInt8]
+    private let caseSensitive: Bool
+
+    var length: Int { needle.count }
+
+    init(needle: [UInt8], caseSensitive: Bool) {
+        self.needle = needle
+        self.foldedNeedle = needle.map(Self.asciiLower)
+        self.caseSensitive = caseSensitive
+    }
+
+    func firstIndex(in base: UnsafePointer<UInt8>, from start: Int, to end: Int) -> Int? {
+        guard end - start >= needle.count, !needle.isEmpty else { return nil }
+
+        if caseSensitive {
+            return needle.withUnsafeBytes { raw -> Int? in
+                guard let hit = memmem(base + start, end - start, raw.baseAddress, raw.count) else { return nil }
+                return base.distance(to: hit.assumingMemoryBound(to: UInt8.self))
+            }
+        }
+
+        let lower = foldedNeedle[0]
+        let upper = Self.asciiUpper(lower)
+        let lastStart = end - needle.count
+        var position = start
+
+        while position <= lastStart {
+            guard let candidate = Self.firstIndex(of: lower, or: upper, in: base, from: position, to: lastStart + 1) else {
+                return nil
+            }
+            if matchesFolded(base + candidate) {
+                return candidate
+            }
+            position = candidate + 1
+        }
+        return nil
+    }
+
+    private func matchesFolded(_ pointer: UnsafePointer<UInt8>) -> Bool {
+        for index in 1..<foldedNeedle.count where Self.asciiLower(pointer[index]) != foldedNeedle[index] {
+            return false
+        }
+        return true
+    }
+
+    private static func firstIndex(
+        of first: UInt8,
+        or second: UInt8,
+        in base: UnsafePointer<UInt8>,
+        from start: Int,
+        to end: Int
+    ) -> Int? {
+        let firstVector = SIMD16<UInt8>(repeating: first)
+        let secondVector = SIMD16<UInt8>(repeating: second)
+        var position = start
+
+        while position + 16 <= end {
+            let chunk = UnsafeRawPointer(base + position).loadUnaligned(as: SIMD16<UInt8>.self)
+            let mask = (chunk .== firstVector) .| (chunk .== secondVector)
+            if any(mask) {
+                for lane in 0..<16 where mask[lane] {
+                    return position + lane
+                }
+            }
+            position += 16
+        }
+
+        while position < end {
+            if base[position] == first || base[position] == second {
+                return position
+            }
+            position += 1
+        }
+        return nil
+    }
+
+    private static func asciiLower(_ byte: UInt8) -> UInt8 {
+        (byte >= UInt8(ascii: "A") && byte <= UInt8(ascii: "Z")) ? byte | 0x20 : byte
+    }
+
+    private static func asciiUpper(_ byte: UInt8) -> UInt8 {
+        (byte >= UInt8(ascii: "a") && byte <= UInt8(ascii: "z")) ? byte & ~0x20 : byte
+    }
+}
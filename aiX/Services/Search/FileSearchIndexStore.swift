@@ -0,0 +1,220 @@
+//
+//  FileSearchIndexStore.swift
+//  aizen
+//
+//  Persistent per-worktree file path index, stored as a memory-mappable snapshot
+//
+
+import Foundation
+
+/// Git state a snapshot was built from
+struct FileSearchIndexKey: Equatable, Sendable {
+    /// Commit HEAD resolved to (empty for unborn branches)
+    var head: String
+    /// Checksum trailer of the git index file; empty when git didn't write one (`index.skipHash`)
+    var indexChecksum: String
+    /// Size and modification time (nanoseconds) of the git index file, which change with every
+    /// index write even when the trailer is left zero
+    var indexSize: UInt64
+    var indexModified: Int64
+}
+
+/// File list of a worktree at a given git state.
+///
+/// `tracked` mirrors the git index. `stagedAdded`/`stagedRemoved` record how the index
+/// differed from the `anchor` commit when the snapshot was taken, so a later index state
+/// can be derived from a single `git diff --cached <anchor>` instead of a full listing.
+struct FileSearchIndexSnapshot: Sendable {
+    var key: FileSearchIndexKey
+    var anchor: String
+    var tracked: [String]
+    var untracked: [String]
+    var stagedAdded: [String]
+    var stagedRemoved: [String]
+
+    var allPaths: [String] {
+        tracked + untracked
+    }
+}
+
+enum FileSearchIndexStore {
+    // Layout: magic, version, four section counts (UInt32 LE), then NUL-terminated UTF-8
+    // strings: head, index checksum, index size, index mtime, anchor, followed by the four
+    // path sections in order.
+    private static let magic: UInt32 = 0x4158_4649 // "AXFI"
+    private static let version: UInt32 = 2
+    private static let headerSize = 6 * MemoryLayout<UInt32>.size
+    private static let indexChecksumLength = 20
+
+    static func snapshotURL(worktreePath: String, cacheRoot: URL? = nil) -> URL {
+        AppCacheDirectory.url(for: worktreePath, in: "file-index", suffix: "-v\(version).bin", root: cacheRoot)
+    }
+
+    // MARK: - Key
+
+    /// Resolve the current HEAD and index state. Cheap: one repository open, a stat and a 20 byte read.
+    static func currentKey(worktreePath: String) -> FileSearchIndexKey? {
+        guard let repo = try? Libgit2Repository(path: worktreePath),
+              let gitdir = repo.gitdir else {
+            return nil
+        }
+
+        let indexPath = (gitdir as NSString).appendingPathComponent("index")
+        var info = stat()
+        let hasIndex = stat(indexPath, &info) == 0
+        let modified = Int64(info.st_mtimespec.tv_sec) * 1_000_000_000 + Int64(info.st_mtimespec.tv_nsec)
+        return FileSearchIndexKey(
+            head: repo.headOid() ?? "",
+            indexChecksum: self.readIndexChecksum(at: indexPath) ?? "",
+            indexSize: hasIndex ? UInt64(info.st_size) : 0,
+            indexModified: hasIndex ? modified : 0
+        )
+    }
+
+    private static func readIndexChecksum(at path: String) -> String? {
+        guard let handle = FileHandle(forReadingAtPath: path) else { return nil }
+        defer { try? handle.close() }
+
+        guard let size = try? handle.seekToEnd(), size >= UInt64(indexChecksumLength) else { return nil }
+        try? handle.seek(toOffset: size - UInt64(indexChecksumLength))
+        // The last 20 bytes: the whole SHA-1 trailer, or the tail of a SHA-256 one. With
+        // `index.skipHash` (set by `feature.manyFiles`) git leaves it zero.
+        guard let trailer = try? handle.read(upToCount: indexChecksumLength),
+              trailer.count == indexChecksumLength,
+              trailer.contains(where: { $0 != 0 }) else {
+            return nil
+        }
+        return trailer.map { String(format: "%02x", $0) }.joined()
+    }
+
+    // MARK: - Load / Save
+
+    static func load(worktreePath: String, cacheRoot: URL? = nil) -> FileSearchIndexSnapshot? {
+        let url = self.snapshotURL(worktreePath: worktreePath, cacheRoot: cacheRoot)
+        guard let data = try? Data(contentsOf: url, options: .alwaysMapped) else { return nil }
+        return self.decode(data)
+    }
+
+    static func save(_ snapshot: FileSearchIndexSnapshot, worktreePath: String, cacheRoot: URL? = nil) {
+        let url = self.snapshotURL(worktreePath: worktreePath, cacheRoot: cacheRoot)
+        let dir = url.deletingLastPathComponent()
+        try? FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+
+        let tmp = dir.appendingPathComponent(".tmp-\(UUID().uuidString).bin", isDirectory: false)
+        do {
+            try self.encode(snapshot).write(to: tmp, options: [.atomic])
+            _ = try FileManager.default.replaceItemAt(url, withItemAt: tmp)
+        } catch {
+            try? FileManager.default.removeItem(at: tmp)
+        }
+    }
+
+    static func remove(worktreePath: String, cacheRoot: URL? = nil) {
+        let url = self.snapshotURL(worktreePath: worktreePath, cacheRoot: cacheRoot)
+        try? FileManager.default.removeItem(at: url)
+    }
+
+    // MARK: - Encoding
+
+    private static func encode(_ snapshot: FileSearchIndexSnapshot) -> Data {
+        let sections = [snapshot.tracked, snapshot.untracked, snapshot.stagedAdded, snapshot.stagedRemoved]
+
+        var estimated = headerSize + 128
+        for section in sections {
+            estimated += section.reduce(0) { $0 + $1.utf8.count + 1 }
+        }
+
+        var data = Data()
+        data.reserveCapacity(estimated)
+
+        func appendUInt32(_ value: UInt32) {
+            withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+        }
+
+        func appendString(_ value: String) {
+            data.append(contentsOf: value.utf8)
+            data.append(0)
+        }
+
+        appendUInt32(magic)
+        appendUInt32(version)
+        for section in sections {
+            appendUInt32(UInt32(section.count))
+        }
+
+        appendString(snapshot.key.head)
+        appendString(snapshot.key.indexChecksum)
+        appendString(String(snapshot.key.indexSize))
+        appendString(String(snapshot.key.indexModified))
+        appendString(snapshot.anchor)
+        for section in sections {
+            for path in section {
+                appendString(path)
+            }
+        }
+
+        return data
+    }
+
+    private static func decode(_ data: Data) -> FileSearchIndexSnapshot? {
+        data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> FileSearchIndexSnapshot? in
+            guard raw.count >= headerSize else { return nil }
+
+            func readUInt32(at offset: Int) -> UInt32 {
+                UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: offset, as: UInt32.self))
+            }
+
+            guard readUInt32(at: 0) == magic, readUInt32(at: 4) == version else { return nil }
+            let counts = (0..<4).map { Int(readUInt32(at: 8 + $0 * 4)) }
+
+            var cursor = headerSize
+
+            // Reads the next NUL-terminated string directly out of the mapped bytes
+            func nextString() -> String? {
+                guard cursor < raw.count, let base = raw.baseAddress else { return nil }
+                let start = base + cursor
+                guard let end = memchr(start, 0, raw.count - cursor) else { return nil }
+                let length = start.distance(to: UnsafeRawPointer(end))
+                let bytes = UnsafeRawBufferPointer(start: start, count: length)
+                cursor += length + 1
+                return String(decoding: bytes, as: UTF8.self)
+            }
+
+            func nextSection(_ count: Int) -> [String]? {
+                var section: [String] = []
+                section.reserveCapacity(count)
+                for _ in 0..<count {
+                    guard let value = nextString() else { return nil }
+                    section.append(value)
+                }
+                return section
+            }
+
+            guard let head = nextString(),
+                  let checksum = nextString(),
+                  let indexSize = nextString().flatMap({ UInt64($0) }),
+                  let indexModified = nextString().flatMap({ Int64($0) }),
+                  let anchor = nextString(),
+                  let tracked = nextSection(counts[0]),
+                  let untracked = nextSection(counts[1]),
+                  let stagedAdded = nextSection(counts[2]),
+                  let stagedRemoved = nextSection(counts[3]) else {
+                return nil
+            }
+
+            return FileSearchIndexSnapshot(
+                key: FileSearchIndexKey(
+                    head: head,
+                    indexChecksum: checksum,
+                    indexSize: indexSize,
+                    indexModified: indexModified
+                ),
+                anchor: anchor,
+                tracked: tracked,
+                untracked: untracked,
+                stagedAdded: stagedAdded,
+                stagedRemoved: stagedRemoved
+            )
+        }
+    }
+}
@@ -0,0 +1,319 @@
+//
+//  FileSearchMatcher.swift
+//  aizen
+//
+//  Packed candidate arena and parallel fuzzy scorer for quick-open
+//
+
+import Foundation
+
+/// Immutable, precomputed view of an index used for scoring.
+/// All paths are lowercased once into a single UTF-8 arena, with a character-set bitmask
+/// per path so candidates missing any query character are rejected with one AND.
+final class FileSearchCandidateIndex: Sendable {
+    let entries: [FileSearchIndexResult]
+    private let bytes: [UInt8]
+    // offsets[i]..<offsets[i + 1] is the lowercased relative path of entries[i]
+    private let offsets: [UInt32]
+    private let fileNameStarts: [UInt32]
+    private let masks: [UInt64]
+
+    var count: Int { entries.count }
+
+    convenience init(entries: [FileSearchIndexResult]) {
+        self.init(base: nil, appending: entries[...])
+    }
+
+    // Packs only `newEntries`; everything from `base` is copied as-is
+    private init(base: FileSearchCandidateIndex?, appending newEntries: ArraySlice<FileSearchIndexResult>) {
+        var entries = base?.entries ?? []
+        var bytes = base?.bytes ?? []
+        var offsets = Array(base?.offsets.dropLast() ?? [])
+        var fileNameStarts = base?.fileNameStarts ?? []
+        var masks = base?.masks ?? []
+        entries.append(contentsOf: newEntries)
+        bytes.reserveCapacity(bytes.count + newEntries.count * 48)
+        offsets.reserveCapacity(entries.count + 1)
+        fileNameStarts.reserveCapacity(entries.count)
+        masks.reserveCapacity(entries.count)
+
+        for entry in newEntries {
+            let start = bytes.count
+            var nameStart = start
+            var mask: UInt64 = 0
+            for byte in entry.relativePath.lowercased().utf8 {
+                if byte == UInt8(ascii: "/") {
+                    nameStart = bytes.count + 1
+                }
+                mask |= Self.maskBit(byte)
+                bytes.append(byte)
+            }
+            offsets.append(UInt32(start))
+            fileNameStarts.append(UInt32(nameStart))
+            masks.append(mask)
+        }
+        offsets.append(UInt32(bytes.count))
+
+        self.entries = entries
+        self.bytes = bytes
+        self.offsets = offsets
+        self.fileNameStarts = fileNameStarts
+        self.masks = masks
+    }
+
+    /// Whether the index was built from exactly the listing in `results`.
+    /// Passing back the array the index was built from is O(1); any other listing is compared entry by entry.
+    func matches(_ results: [FileSearchIndexResult]) -> Bool {
+        results.count == entries.count && isPrefix(of: results)
+    }
+
+    /// Whether `results` starts with this index's listing, as it does while a walk is still appending to it
+    func isPrefix(of results: [FileSearchIndexResult]) -> Bool {
+        guard results.count >= entries.count else { return false }
+        let sharesStorage = results.withUnsafeBufferPointer { lhs in
+            entries.withUnsafeBufferPointer { rhs in lhs.baseAddress == rhs.baseAddress }
+        }
+        return sharesStorage || results.prefix(entries.count).elementsEqual(entries) { $0.relativePath == $1.relativePath }
+    }
+
+    /// A new index holding this listing followed by `newEntries`, packing only the new paths
+    func appending(_ newEntries: ArraySlice<FileSearchIndexResult>) -> FileSearchCandidateIndex {
+        FileSearchCandidateIndex(base: self, appending: newEntries)
+    }
+
+    /// The same arena over `results`, an equal listing held in different storage,
+    /// so later `matches` calls with that array take the O(1) path
+    func sharingEntries(_ results: [FileSearchIndexResult]) -> FileSearchCandidateIndex {
+        FileSearchCandidateIndex(base: self, entries: results)
+    }
+
+    private init(base: FileSearchCandidateIndex, entries: [FileSearchIndexResult]) {
+        self.entries = entries
+        self.bytes = base.bytes
+        self.offsets = base.offsets
+        self.fileNameStarts = base.fileNameStarts
+        self.masks = base.masks
+    }
+
+    // MARK: - Search
+
+    /// Score every candidate against `query`, in parallel chunks, keeping the best `limit`.
+    func search(query: String, limit: Int) async -> [FileSearchIndexResult] {
+        let lowercaseQuery = query.lowercased()
+        let queryBytes = Array(lowercaseQuery.utf8)
+        guard !queryBytes.isEmpty, limit > 0, !entries.isEmpty else { return [] }
+
+        let queryLength = lowercaseQuery.count
+        let queryMask = queryBytes.reduce(UInt64(0)) { $0 | Self.maskBit($1) }
+
+        let chunkCount = entries.count < 16_384 ? 1 : ProcessInfo.processInfo.activeProcessorCount * 2
+        let chunkSize = (entries.count + chunkCount - 1) / chunkCount
+
+        let heap = await withTaskGroup(of: FileSearchTopK.self) { group in
+            for chunkStart in stride(from: 0, to: entries.count, by: chunkSize) {
+                let range = chunkStart..<min(chunkStart + chunkSize, entries.count)
+                group.addTask {
+                    self.score(range: range, query: queryBytes, queryLength: queryLength, queryMask: queryMask, limit: limit)
+                }
+            }
+
+            var merged = FileSearchTopK(capacity: limit)
+            for await partial in group {
+                merged.merge(partial)
+            }
+            return merged
+        }
+
+        return heap.sortedDescending().map { hit in
+            var result = entries[hit.index]
+            result.matchScore = hit.score
+            return result
+        }
+    }
+
+    private func score(
+        range: Range<Int>,
+        query: [UInt8],
+        queryLength: Int,
+        queryMask: UInt64,
+        limit: Int
+    ) -> FileSearchTopK {
+        var heap = FileSearchTopK(capacity: limit)
+        guard !Task.isCancelled else { return heap }
+
+        bytes.withUnsafeBufferPointer { arena in
+            query.withUnsafeBufferPointer { query in
+                for index in range {
+                    guard queryMask & ~masks[index] == 0 else { continue }
+
+                    let start = Int(offsets[index])
+                    let end = Int(offsets[index + 1])
+
+                    // A file name match implies a path match, so no path match rejects both
+                    guard let pathScore = Self.fuzzyScore(query, queryLength: queryLength, arena: arena, start: start, end: end) else {
+                        continue
+                    }
+
+                    let fileNameScore = Self.fuzzyScore(
+                        query,
+                        queryLength: queryLength,
+                        arena: arena,
+                        start: Int(fileNameStarts[index]),
+                        end: end
+                    )
+                    let totalScore = max(fileNameScore ?? 0, pathScore * 0.6)
+                    if totalScore > 0 {
+                        heap.insert(score: totalScore, index: index)
+                    }
+                }
+            }
+        }
+
+        return heap
+    }
+
+    // MARK: - Scoring
+
+    // Byte-level port of the original String fuzzy matcher; the arena is already lowercased.
+    // Nil when the query doesn't match; a match can score 0 or less after the length penalty.
+    private static func fuzzyScore(
+        _ query: UnsafeBufferPointer<UInt8>,
+        queryLength: Int,
+        arena: UnsafeBufferPointer<UInt8>,
+        start: Int,
+        end: Int
+    ) -> Double? {
+        let targetLength = end - start
+        guard targetLength >= query.count, let base = arena.baseAddress, let queryBase = query.baseAddress else {
+            return nil
+        }
+
+        if memcmp(base + start, queryBase, query.count) == 0 {
+            // Bonus for exact match, then prefix match
+            return targetLength == query.count ? 1000.0 : 500.0 + Double(queryLength)
+        }
+
+        var score: Double = 0
+        var queryIndex = 0
+        var lastMatchIndex = -2
+        var consecutiveMatches = 0
+
+        var targetIndex = start
+        while targetIndex < end && queryIndex < query.count {
+            if arena[targetIndex] == query[queryIndex] {
+                // Base score for match
+                score += 10.0
+
+                // Bonus for consecutive matches
+                if lastMatchIndex == targetIndex - 1 {
+                    consecutiveMatches += 1
+                    score += Double(consecutiveMatches) * 5.0
+                } else {
+                    consecutiveMatches = 0
+                }
+
+                // Bonus for matching start of word
+                if targetIndex == start {
+                    score += 15.0
+                } else {
+                    let prev = arena[targetIndex - 1]
+                    if prev == UInt8(ascii: "/") || prev == UInt8(ascii: ".") {
+                        score += 15.0
+                    }
+                }
+
+                lastMatchIndex = targetIndex
+                queryIndex += 1
+            }
+            targetIndex += 1
+        }
+
+        guard queryIndex == query.count else { return nil }
+
+        // Penalty for longer paths (prefer shorter paths)
+        return score - Double(targetLength) * 0.1
+    }
+
+    // a-z, 0-9, common path punctuation, then one bucket each for other ASCII and non-ASCII bytes
+    private static func maskBit(_ byte: UInt8) -> UInt64 {
+        switch byte {
+        case UInt8(ascii: "a")...UInt8(ascii: "z"):
+            return 1 << UInt64(byte - UInt8(ascii: "a"))
+        case UInt8(ascii: "0")...UInt8(ascii: "9"):
+            return 1 << UInt64(26 + byte - UInt8(ascii: "0"))
+        case UInt8(ascii: "."): return 1 << 36
+        case UInt8(ascii: "_"): return 1 << 37
+        case UInt8(ascii: "-"): return 1 << 38
+        case UInt8(ascii: "/"): return 1 << 39
+        case UInt8(ascii: " "): return 1 << 40
+        case 0x80...: return 1 << 42
+        default: return 1 << 41
+        }
+    }
+}
+
+/// Bounded min-heap keeping the `capacity` highest scoring candidates.
+/// Ties prefer the lower index so results stay in listing order.
+struct FileSearchTopK: Sendable {
+    struct Hit: Sendable {
+        let score: Double
+        let index: Int
+    }
+
+    let capacity: Int
+    private(set) var hits: [Hit] = []
+
+    init(capacity: Int) {
+        self.capacity = capacity
+        hits.reserveCapacity(capacity)
+    }
+
+    mutating func insert(score: Double, index: Int) {
+        let hit = Hit(score: score, index: index)
+        if hits.count < capacity {
+            hits.append(hit)
+            siftUp(hits.count - 1)
+        } else if let worst = hits.first, Self.isWorse(worst, than: hit) {
+            hits[0] = hit
+            siftDown(0)
+        }
+    }
+
+    mutating func merge(_ other: FileSearchTopK) {
+        for hit in other.hits {
+            insert(score: hit.score, index: hit.index)
+        }
+    }
+
+    func sortedDescending() -> [Hit] {
+        hits.sorted { Self.isWorse($1, than: $0) }
+    }
+
+    private static func isWorse(_ lhs: Hit, than rhs: Hit) -> Bool {
+        lhs.score != rhs.score ? lhs.score < rhs.score : lhs.index > rhs.index
+    }
+
+    private mutating func siftUp(_ index: Int) {
+        var child = index
+        while child > 0 {
+            let parent = (child - 1) / 2
+            guard Self.isWorse(hits[child], than: hits[parent]) else { return }
+            hits.swapAt(child, parent)
+            child = parent
+        }
+    }
+
+    private mutating func siftDown(_ index: Int) {
+        var parent = index
+        while true {
+            let left = parent * 2 + 1
+            let right = left + 1
+            var worst = parent
+            if left < hits.count && Self.isWorse(hits[left], than: hits[worst]) { worst = left }
+            if right < hits.count && Self.isWorse(hits[right], than: hits[worst]) { worst = right }
+            guard worst != parent else { return }
+            hits.swapAt(parent, worst)
+            parent = worst
+        }
+    }
+}
@@ -28,11 +28,47 @@ actor FileSearchService {
     private let maxCachedDirectories = 4
     private var recentFiles: [String: [String]] = [:]
     private let maxRecentFiles = 10
+    private var indexWatchTokens: [String: UUID] = [:]
+    private var snapshotRefreshTasks: [String: (id: UUID, task: Task<Void, Never>)] = [:]
+    // Changes seen while a refresh runs; it runs once more before finishing
+    private var snapshotRefreshPending: Set<String> = []
+    private var candidateIndexes: [String: FileSearchCandidateIndex] = [:]
+    // Staged delta size beyond which a snapshot is re-anchored on the current HEAD
+    private let maxSnapshotDelta = 2_000
+
+    // Always ignored by the manual indexing fallback, on top of the repository's own rules
+    private static let defaultIgnorePatterns: [String] = [
+        ".git",
+        "node_modules",
+        ".build",
+        "DerivedData",
+        ".swiftpm",
+        "Pods",
+        "Carthage",
+        ".DS_Store",
+        "*.xcodeproj",
+        "*.xcworkspace",
+        "xcuserdata",
+        "__pycache__",
+        ".venv",
+        "venv",
+        ".env",
+        "dist",
+        "build",
+        ".next",
+        ".nuxt",
+        "target",
+        "vendor"
+    ]
 
     private init() {}
 
-    // Index files in directory recursively with gitignore support
-    func indexDirectory(_ path: String) async throws -> [FileSearchIndexResult] {
+    // Index files in directory recursively with gitignore support.
+    // `onPartialResults` receives each new batch of files while a slow manual walk is in progress.
+    func indexDirectory(
+        _ path: String,
+        onPartialResults: (@Sendable ([FileSearchIndexResult]) -> Void)? = nil
+    ) async throws -> [FileSearchIndexResult] {
         // Check cache first
         if let cached = cachedResults[path] {
             touchCacheKey(path)
@@ -42,11 +78,16 @@ actor FileSearchService {
         let results: [FileSearchIndexResult]
 
         // Prefer git-aware indexing for speed + correctness (respects .gitignore).
-        if FileManager.default.fileExists(atPath: (path as NSString).appendingPathComponent(".git")),
-           let gitResults = await indexDirectoryWithGitLsFiles(path) {
+        // The persisted snapshot makes reopening a worktree instant and is patched from
+        // the staged delta instead of relisting the whole tree when the index changes.
+        let isGitWorktree = FileManager.default.fileExists(atPath: (path as NSString).appendingPathComponent(".git"))
+        if isGitWorktree, let snapshot = await loadGitSnapshot(path) {
+            results = makeResults(snapshot, basePath: path)
+            await watchGitIndex(for: path)
+        } else if isGitWorktree, let gitResults = await indexDirectoryWithGitLsFiles(path) {
             results = gitResults
         } else {
-            results = await indexDirectoryManually(path)
+            results = await indexDirectoryManually(path, onPartialResults: onPartialResults)
         }
 
         // Cache results
@@ -56,56 +97,237 @@ actor FileSearchService {
         return results
     }
 
-    // Directory indexing with gitignore patterns
-    private func indexDirectoryManually(_ path: String) async -> [FileSearchIndexResult] {
-        var results: [FileSearchIndexResult] = []
-        let fileManager = FileManager.default
-        let gitignorePatterns = loadGitignorePatterns(at: path)
-
-        guard let enumerator = fileManager.enumerator(
-            at: URL(fileURLWithPath: path),
-            includingPropertiesForKeys: [.isDirectoryKey, .isHiddenKey],
-            options: [.skipsPackageDescendants]
-        ) else {
-            return []
+    // MARK: - Git Snapshot Index
+
+    // Load the persisted snapshot for a worktree, patching or rebuilding it if the git state moved
+    private func loadGitSnapshot(_ path: String) async -> FileSearchIndexSnapshot? {
+        guard let key = FileSearchIndexStore.currentKey(worktreePath: path) else { return nil }
+
+        if let stored = FileSearchIndexStore.load(worktreePath: path) {
+            if stored.key == key {
+                // Untracked files don't touch the index; pick them up in the background
+                scheduleSnapshotRefresh(for: path)
+                return stored
+            }
+            if let patched = await patchGitSnapshot(stored, key: key, path: path) {
+                FileSearchIndexStore.save(patched, worktreePath: path)
+                return patched
+            }
         }
 
-        let basePath = path
+        guard let rebuilt = await buildGitSnapshot(path, key: key) else { return nil }
+        FileSearchIndexStore.save(rebuilt, worktreePath: path)
+        return rebuilt
+    }
+
+    private func buildGitSnapshot(_ path: String, key: FileSearchIndexKey) async -> FileSearchIndexSnapshot? {
+        async let tracked = Self.gitPaths(path, arguments: ["ls-files", "--cached", "-z"])
+        async let untracked = Self.gitPaths(path, arguments: ["ls-files", "--others", "--exclude-standard", "-z"])
+        async let delta = Self.stagedDelta(path, base: key.head)
+
+        guard let tracked = await tracked, let untracked = await untracked else { return nil }
+        let staged = await delta
+
+        return FileSearchIndexSnapshot(
+            key: key,
+            anchor: staged == nil ? "" : key.head,
+            tracked: tracked,
+            untracked: untracked,
+            stagedAdded: staged?.added ?? [],
+            stagedRemoved: staged?.removed ?? []
+        )
+    }
+
+    // Derive the current index listing from the snapshot's anchor tree and a fresh staged delta:
+    // tracked' = (tracked - oldAdded + oldRemoved) - newRemoved + newAdded
+    private func patchGitSnapshot(
+        _ stored: FileSearchIndexSnapshot,
+        key: FileSearchIndexKey,
+        path: String
+    ) async -> FileSearchIndexSnapshot? {
+        guard !stored.anchor.isEmpty else { return nil }
+
+        async let delta = Self.stagedDelta(path, base: stored.anchor)
+        async let untracked = Self.gitPaths(path, arguments: ["ls-files", "--others", "--exclude-standard", "-z"])
+
+        guard let delta = await delta, let untracked = await untracked else { return nil }
+
+        var snapshot = stored
+        snapshot.key = key
+        snapshot.untracked = untracked
+
+        let oldAdded = Set(stored.stagedAdded)
+        let oldRemoved = Set(stored.stagedRemoved)
+        let newAdded = Set(delta.added)
+        let newRemoved = Set(delta.removed)
+
+        if oldAdded != newAdded || oldRemoved != newRemoved {
+            let dropped = oldAdded.union(newRemoved)
+            var tracked = dropped.isEmpty ? stored.tracked : stored.tracked.filter { !dropped.contains($0) }
+            tracked.append(contentsOf: oldRemoved.subtracting(newRemoved))
+            tracked.append(contentsOf: delta.added)
+            snapshot.tracked = tracked
+        }
+        snapshot.stagedAdded = delta.added
+        snapshot.stagedRemoved = delta.removed
+
+        // Keep future deltas small by moving the anchor once HEAD has drifted far from it
+        if delta.added.count + delta.removed.count > maxSnapshotDelta,
+           !key.head.isEmpty, key.head != stored.anchor,
+           let headDelta = await Self.stagedDelta(path, base: key.head) {
+            snapshot.anchor = key.head
+            snapshot.stagedAdded = headDelta.added
+            snapshot.stagedRemoved = headDelta.removed
+        }
+
+        return snapshot
+    }
+
+    // Re-sync a cached worktree after a git index/HEAD change or a snapshot hit
+    private func refreshGitSnapshot(for path: String) async {
+        guard let key = FileSearchIndexStore.currentKey(worktreePath: path),
+              let stored = FileSearchIndexStore.load(worktreePath: path) else {
+            return
+        }
 
-        while let fileURL = enumerator.nextObject() as? URL {
-            // Skip hidden files and directories
-            if let resourceValues = try? fileURL.resourceValues(forKeys: [.isHiddenKey]),
-               resourceValues.isHidden == true {
-                continue
+        let updated: FileSearchIndexSnapshot?
+        if stored.key == key {
+            if let untracked = await Self.gitPaths(path, arguments: ["ls-files", "--others", "--exclude-standard", "-z"]),
+               untracked != stored.untracked {
+                var snapshot = stored
+                snapshot.untracked = untracked
+                updated = snapshot
+            } else {
+                updated = nil
             }
+        } else if let patched = await patchGitSnapshot(stored, key: key, path: path) {
+            updated = patched
+        } else {
+            updated = await buildGitSnapshot(path, key: key)
+        }
 
-            let isDirectory = fileURL.hasDirectoryPath
+        guard let updated else { return }
+        FileSearchIndexStore.save(updated, worktreePath: path)
+        if cachedResults[path] != nil {
+            cachedResults[path] = makeResults(updated, basePath: path)
+        }
+    }
 
-            // Skip directories - only index files
-            if isDirectory {
-                let dirName = fileURL.lastPathComponent
-                let dirRelativePath = fileURL.path.replacingOccurrences(of: basePath + "/", with: "")
-                if matchesGitignore(dirRelativePath, patterns: gitignorePatterns) || matchesGitignore(dirName, patterns: gitignorePatterns) {
-                    enumerator.skipDescendants()
-                }
-                continue
+    private func scheduleSnapshotRefresh(for path: String) {
+        guard snapshotRefreshTasks[path] == nil else {
+            snapshotRefreshPending.insert(path)
+            return
+        }
+
+        let id = UUID()
+        let task = Task {
+            repeat {
+                self.snapshotRefreshPending.remove(path)
+                await self.refreshGitSnapshot(for: path)
+            } while self.snapshotRefreshPending.contains(path) && !Task.isCancelled
+
+            // A cancelled refresh may have been replaced by a newer one
+            if self.snapshotRefreshTasks[path]?.id == id {
+                self.snapshotRefreshTasks[path] = nil
+            }
+        }
+        snapshotRefreshTasks[path] = (id, task)
+    }
+
+    private func watchGitIndex(for path: String) async {
+        guard indexWatchTokens[path] == nil else { return }
+
+        let token = await GitIndexWatchCenter.shared.addSubscriber(worktreePath: path) {
+            Task {
+                await FileSearchService.shared.handleGitIndexChange(for: path)
             }
+        }
+
+        // Another indexDirectory call may have subscribed while we were suspended
+        if indexWatchTokens[path] != nil {
+            await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: path, id: token)
+            return
+        }
+        indexWatchTokens[path] = token
+    }
+
+    private func unwatchGitIndex(for path: String) {
+        guard let token = indexWatchTokens.removeValue(forKey: path) else { return }
+        snapshotRefreshTasks.removeValue(forKey: path)?.task.cancel()
+        snapshotRefreshPending.remove(path)
+        Task {
+            await GitIndexWatchCenter.shared.removeSubscriber(worktreePath: path, id: token)
+        }
+    }
+
+    private func handleGitIndexChange(for path: String) {
+        guard indexWatchTokens[path] != nil else { return }
+        scheduleSnapshotRefresh(for: path)
+        Task {
+            await FileContentIndexService.shared.handleGitIndexChange(for: path)
+        }
+    }
+
+    private func makeResults(_ snapshot: FileSearchIndexSnapshot, basePath: String) -> [FileSearchIndexResult] {
+        var items: [FileSearchIndexResult] = []
+        items.reserveCapacity(snapshot.tracked.count + snapshot.untracked.count)
+        for rel in snapshot.tracked {
+            items.append(FileSearchIndexResult(basePath: basePath, relativePath: rel, isDirectory: false))
+        }
+        for rel in snapshot.untracked {
+            items.append(FileSearchIndexResult(basePath: basePath, relativePath: rel, isDirectory: false))
+        }
+        return items
+    }
 
-            let fileName = fileURL.lastPathComponent
-            let fullPath = fileURL.path
-            let relativePath = fullPath.replacingOccurrences(of: basePath + "/", with: "")
+    private static func gitPaths(_ path: String, arguments: [String]) async -> [String]? {
+        guard let result = try? await ProcessExecutor.shared.executeWithOutput(
+            executable: "/usr/bin/git",
+            arguments: ["-C", path] + arguments
+        ), result.succeeded else {
+            return nil
+        }
+
+        return result.stdout
+            .split(separator: "\0", omittingEmptySubsequences: true)
+            .map(String.init)
+    }
 
-            // Skip if matches gitignore patterns
-            if matchesGitignore(relativePath, patterns: gitignorePatterns) || matchesGitignore(fileName, patterns: gitignorePatterns) {
-                continue
+    // Paths the index adds/removes relative to `base` (`git diff --cached --name-status -z` pairs)
+    private static func stagedDelta(_ path: String, base: String) async -> (added: [String], removed: [String])? {
+        guard !base.isEmpty,
+              let fields = await gitPaths(path, arguments: ["diff", "--cached", "--name-status", "--no-renames", "-z", base]) else {
+            return nil
+        }
+
+        var added: [String] = []
+        var removed: [String] = []
+        var index = 0
+        while index + 1 < fields.count {
+            switch fields[index] {
+            case "A": added.append(fields[index + 1])
+            case "D": removed.append(fields[index + 1])
+            default: break
             }
+            index += 2
+        }
+        return (added, removed)
+    }
 
-            let result = FileSearchIndexResult(
-                basePath: basePath,
-                relativePath: relativePath,
-                isDirectory: false
-            )
-            results.append(result)
+    // Directory indexing with compiled gitignore rules (root, nested and .git/info/exclude),
+    // walked in parallel and reported in batches as they arrive
+    private func indexDirectoryManually(
+        _ path: String,
+        onPartialResults: (@Sendable ([FileSearchIndexResult]) -> Void)?
+    ) async -> [FileSearchIndexResult] {
+        let matcher = GitignoreMatcher.root(at: path, defaultPatterns: Self.defaultIgnorePatterns)
+        let walker = ParallelDirectoryWalker(rootPath: path, matcher: matcher)
+
+        var results: [FileSearchIndexResult] = []
+        for await batch in walker.walk() {
+            let found = batch.map { FileSearchIndexResult(basePath: path, relativePath: $0, isDirectory: false) }
+            results.append(contentsOf: found)
+            onPartialResults?(found)
         }
 
         return results
@@ -136,78 +358,6 @@ actor FileSearchService {
         }
     }
 
-    // Load gitignore patterns from .gitignore file (manual indexing fallback)
-    private func loadGitignorePatterns(at path: String) -> [String] {
-        // Start with common patterns that should always be ignored
-        var gitignorePatterns: [String] = [
-            ".git",
-            "node_modules",
-            ".build",
-            "DerivedData",
-            ".swiftpm",
-            "Pods",
-            "Carthage",
-            ".DS_Store",
-            "*.xcodeproj",
-            "*.xcworkspace",
-            "xcuserdata",
-            "__pycache__",
-            ".venv",
-            "venv",
-            ".env",
-            "dist",
-            "build",
-            ".next",
-            ".nuxt",
-            "target",
-            "vendor"
-        ]
-
-        let gitignorePath = (path as NSString).appendingPathComponent(".gitignore")
-
-        if let content = try? String(contentsOfFile: gitignorePath, encoding: .utf8) {
-            let filePatterns = content
-                .components(separatedBy: .newlines)
-                .map { $0.trimmingCharacters(in: .whitespaces) }
-                .filter { !$0.isEmpty && !$0.hasPrefix("#") && !$0.hasPrefix("!") }
-
-            gitignorePatterns.append(contentsOf: filePatterns)
-        }
-
-        return gitignorePatterns
-    }
-
-    // Check if path matches gitignore patterns - simplified matching
-    private func matchesGitignore(_ path: String, patterns: [String]) -> Bool {
-        let pathComponents = path.components(separatedBy: "/")
-
-        for pattern in patterns {
-            var cleanPattern = pattern
-                .trimmingCharacters(in: CharacterSet(charactersIn: "/"))
-
-            // Handle glob patterns like *.log
-            if cleanPattern.hasPrefix("*") {
-                let suffix = String(cleanPattern.dropFirst())
-                if path.hasSuffix(suffix) || pathComponents.last?.hasSuffix(suffix) == true {
-                    return true
-                }
-                continue
-            }
-
-            // Check if any path component matches the pattern exactly
-            if pathComponents.contains(cleanPattern) {
-                return true
-            }
-
-            // Check if path starts with pattern (for directory patterns)
-            if path.hasPrefix(cleanPattern + "/") || path == cleanPattern {
-                return true
-            }
-        }
-
-        return false
-    }
-
     // Fuzzy search with scoring
     func search(query: String, in results: [FileSearchIndexResult], worktreePath: String, limit: Int = 200) async -> [FileSearchIndexResult] {
         guard !query.isEmpty else {
@@ -217,36 +367,93 @@ actor FileSearchService {
             return Array(results.prefix(limit))
         }
 
-        let lowercaseQuery = query.lowercased()
-        var scoredResults: [FileSearchIndexResult] = []
-        scoredResults.reserveCapacity(min(limit * 4, 1000))
+        let index = candidateIndex(for: worktreePath, results: results)
+        return await index.search(query: query, limit: limit)
+    }
 
-        for var result in results {
-            let relativePath = result.relativePath.lowercased()
-            let fileName = lastPathComponentLowercased(relativePath)
+    // MARK: - Content Search
+
+    // Search file contents across one or more worktrees, reusing their file indexes.
+    // Matches stream per file as soon as they are found; cancelling the consuming task stops the scan.
+    nonisolated func searchContents(
+        query: String,
+        in worktreePaths: [String],
+        options: FileContentSearchOptions = FileContentSearchOptions()
+    ) -> AsyncStream<[FileContentSearchMatch]> {
+        AsyncStream { continuation in
+            let task = Task {
+                defer { continuation.finish() }
+                guard let searcher = FileContentSearcher(query: query, options: options) else { return }
+
+                var remaining = options.maxResults
+                for worktreePath in worktreePaths {
+                    guard !Task.isCancelled, remaining > 0 else { break }
+                    guard var files = try? await self.indexDirectory(worktreePath) else { continue }
+                    if options.useContentIndex,
+                       let candidates = await FileContentIndexService.shared.candidates(
+                           for: query,
+                           options: options,
+                           in: files,
+                           worktreePath: worktreePath
+                       ) {
+                        files = candidates
+                    }
+                    remaining = await Self.scanContents(files, searcher: searcher, limit: remaining, continuation: continuation)
+                }
+            }
 
-            // Score filename match (higher weight)
-            let fileNameScore = fuzzyMatch(query: lowercaseQuery, target: fileName)
+            continuation.onTermination = { _ in
+                task.cancel()
+            }
+        }
+    }
 
-            // Score relative path match (lower weight)
-            let pathScore = fuzzyMatch(query: lowercaseQuery, target: relativePath) * 0.6
+    // Scan files in parallel, a chunk per task with bounded width; returns the unused result budget
+    private static func scanContents(
+        _ files: [FileSearchIndexResult],
+        searcher: FileContentSearcher,
+        limit: Int,
+        continuation: AsyncStream<[FileContentSearchMatch]>.Continuation
+    ) async -> Int {
+        let chunkSize = 64
+        let width = max(ProcessInfo.processInfo.activeProcessorCount, 2)
+        var remaining = limit
+
+        await withTaskGroup(of: [FileContentSearchMatch].self) { group in
+            var chunkStarts = stride(from: 0, to: files.count, by: chunkSize).makeIterator()
+
+            func addNextChunk() {
+                guard let start = chunkStarts.next() else { return }
+                let chunk = files[start..<min(start + chunkSize, files.count)]
+                group.addTask {
+                    var matches: [FileContentSearchMatch] = []
+                    for file in chunk {
+                        guard !Task.isCancelled else { break }
+                        matches.append(contentsOf: searcher.scan(file))
+                    }
+                    return matches
+                }
+            }
 
-            let totalScore = max(fileNameScore, pathScore)
-            if totalScore > 0 {
-                result.matchScore = totalScore
-                scoredResults.append(result)
+            for _ in 0..<width {
+                addNextChunk()
             }
 
-            // Keep memory and sort cost bounded for very large repos.
-            if scoredResults.count >= max(limit * 6, 600) {
-                scoredResults.sort { $0.matchScore > $1.matchScore }
-                scoredResults = Array(scoredResults.prefix(limit))
+            for await matches in group {
+                if !matches.isEmpty {
+                    let emitted = matches.count <= remaining ? matches : Array(matches.prefix(remaining))
+                    continuation.yield(emitted)
+                    remaining -= emitted.count
+                }
+                if Task.isCancelled || remaining <= 0 {
+                    group.cancelAll()
+                    break
+                }
+                addNextChunk()
             }
         }
 
-        // Sort by score (higher is better)
-        scoredResults.sort { $0.matchScore > $1.matchScore }
-        return Array(scoredResults.prefix(limit))
+        return remaining
     }
 
     // Track recently opened files
@@ -278,6 +485,8 @@ actor FileSearchService {
         cachedResults.removeValue(forKey: path)
         cacheOrder.removeAll { $0 == path }
         recentFiles.removeValue(forKey: path)
+        candidateIndexes.removeValue(forKey: path)
+        unwatchGitIndex(for: path)
     }
 
     // Clear all caches
@@ -285,6 +494,10 @@ actor FileSearchService {
         cachedResults.removeAll()
         cacheOrder.removeAll()
         recentFiles.removeAll()
+        candidateIndexes.removeAll()
+        for path in Array(indexWatchTokens.keys) {
+            unwatchGitIndex(for: path)
+        }
     }
 
     // MARK: - Private Helpers
@@ -300,77 +513,24 @@ actor FileSearchService {
             cacheOrder.removeFirst()
             cachedResults.removeValue(forKey: evictKey)
             recentFiles.removeValue(forKey: evictKey)
+            candidateIndexes.removeValue(forKey: evictKey)
+            unwatchGitIndex(for: evictKey)
         }
     }
 
-    private func lastPathComponentLowercased(_ path: String) -> String {
-        if let slash = path.lastIndex(of: "/") {
-            return String(path[path.index(after: slash)...])
-        }
-        return path
-    }
-
-    // Fuzzy matching algorithm with scoring
-    private func fuzzyMatch(query: String, target: String) -> Double {
-        guard !query.isEmpty else { return 0 }
-
-        var score: Double = 0
-        var queryIndex = query.startIndex
-        var lastMatchIndex: String.Index?
-        var consecutiveMatches = 0
-
-        // Bonus for exact match
-        if target == query {
-            return 1000.0
-        }
-
-        // Bonus for prefix match
-        if target.hasPrefix(query) {
-            return 500.0 + Double(query.count)
-        }
-
-        // Fuzzy matching (avoid O(n^2) String indexing)
-        var targetIndex = target.startIndex
-        while targetIndex < target.endIndex {
-            let targetChar = target[targetIndex]
-            if queryIndex < query.endIndex && targetChar == query[queryIndex] {
-                // Base score for match
-                score += 10.0
-
-                // Bonus for consecutive matches
-                if let last = lastMatchIndex, target.index(after: last) == targetIndex {
-                    consecutiveMatches += 1
-                    score += Double(consecutiveMatches) * 5.0
-                } else {
-                    consecutiveMatches = 0
-                }
-
-                // Bonus for matching start of word
-                if targetIndex == target.startIndex {
-                    score += 15.0
-                } else {
-                    let prev = target[target.index(before: targetIndex)]
-                    if prev == "/" || prev == "." {
-                        score += 15.0
-                    }
-                }
-
-                // Uppercase bonus intentionally omitted here; the target is lowercased for speed.
-
-                lastMatchIndex = targetIndex
-                queryIndex = query.index(after: queryIndex)
-            }
-
-            targetIndex = target.index(after: targetIndex)
-        }
-
-        // Check if all query characters were matched
-        if queryIndex == query.endIndex {
-            // Penalty for longer paths (prefer shorter paths)
-            score -= Double(target.count) * 0.1
-            return score
+    // Packed arena for the listing being searched; rebuilt only when the listing changes,
+    // and extended in place while a manual walk keeps appending to it
+    private func candidateIndex(for worktreePath: String, results: [FileSearchIndexResult]) -> FileSearchCandidateIndex {
+        let index: FileSearchCandidateIndex
+        if let cached = candidateIndexes[worktreePath], cached.isPrefix(of: results) {
+            // Adopting the caller's array keeps the next lookup with it O(1)
+            index = cached.count == results.count
+                ? cached.sharingEntries(results)
+                : cached.appending(results[cached.count...])
+        } else {
+            index = FileSearchCandidateIndex(entries: results)
         }
-
-        return 0
+        candidateIndexes[worktreePath] = index
+        return index
     }
 }
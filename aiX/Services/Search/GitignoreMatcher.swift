@@ -0,0 +1,378 @@
+//
+//  GitignoreMatcher.swift
+//  aizen
+//
+//  Compiled .gitignore rules for the manual indexing walk
+//
+
+import Foundation
+
+/// One compiled line of an ignore file
+struct GitignoreRule: Sendable {
+    enum Segment: Sendable {
+        case literal(String)
+        /// "*" followed by a literal, e.g. "*.log"
+        case suffix([UInt8])
+        case glob([GlobToken])
+        /// "**" as a whole path segment
+        case anyDirectories
+    }
+
+    enum GlobToken: Sendable, Equatable {
+        case byte(UInt8)
+        case any
+        case star
+        case set([ClosedRange<UInt8>], negated: Bool)
+    }
+
+    let segments: [Segment]
+    let negated: Bool
+    let directoryOnly: Bool
+    /// Patterns with a leading or inner "/" match from the ignore file's directory;
+    /// the rest match the last path component at any depth.
+    let anchored: Bool
+
+    init?(line: Substring) {
+        var text = Array(line.utf8)
+        if text.last == UInt8(ascii: "\r") { text.removeLast() }
+
+        // Trailing spaces are ignored unless escaped
+        while text.last == UInt8(ascii: " ") && !(text.count >= 2 && text[text.count - 2] == UInt8(ascii: "\\")) {
+            text.removeLast()
+        }
+        guard let first = text.first, first != UInt8(ascii: "#") else { return nil }
+
+        var negated = false
+        if first == UInt8(ascii: "!") {
+            negated = true
+            text.removeFirst()
+        } else if first == UInt8(ascii: "\\"), text.count > 1,
+                  text[1] == UInt8(ascii: "!") || text[1] == UInt8(ascii: "#") {
+            text.removeFirst()
+        }
+
+        var directoryOnly = false
+        if text.last == UInt8(ascii: "/") {
+            directoryOnly = true
+            text.removeLast()
+        }
+
+        let anchored = text.contains(UInt8(ascii: "/"))
+        if text.first == UInt8(ascii: "/") {
+            text.removeFirst()
+        }
+
+        let segments = text
+            .split(separator: UInt8(ascii: "/"), omittingEmptySubsequences: true)
+            .map { Self.compileSegment(Array($0)) }
+        guard !segments.isEmpty else { return nil }
+
+        self.segments = segments
+        self.negated = negated
+        self.directoryOnly = directoryOnly
+        self.anchored = anchored
+    }
+
+    /// Literal name for unanchored rules without wildcards, used for hashed lookup
+    var unanchoredLiteral: String? {
+        guard !anchored, segments.count == 1, case .literal(let name) = segments[0] else { return nil }
+        return name
+    }
+
+    // MARK: - Matching
+
+    /// `components` is the path relative to the ignore file's directory
+    func matches(_ components: ArraySlice<String>, isDirectory: Bool) -> Bool {
+        if directoryOnly && !isDirectory { return false }
+        guard let last = components.last else { return false }
+
+        if !anchored {
+            return Self.matchSegment(segments[0], last)
+        }
+        return matchSegments(from: segments.startIndex, components)
+    }
+
+    private func matchSegments(from index: Int, _ components: ArraySlice<String>) -> Bool {
+        guard index < segments.count else { return components.isEmpty }
+
+        if case .anyDirectories = segments[index] {
+            // Trailing "/**" matches everything inside, but not the directory itself
+            if index == segments.count - 1 {
+                return !components.isEmpty
+            }
+            var rest = components
+            while true {
+                if matchSegments(from: index + 1, rest) { return true }
+                guard !rest.isEmpty else { return false }
+                rest = rest.dropFirst()
+            }
+        }
+
+        guard let first = components.first, Self.matchSegment(segments[index], first) else { return false }
+        return matchSegments(from: index + 1, components.dropFirst())
+    }
+
+    private static func matchSegment(_ segment: Segment, _ name: String) -> Bool {
+        switch segment {
+        case .literal(let literal):
+            return name == literal
+        case .suffix(let suffix):
+            let utf8 = name.utf8
+            return utf8.count >= suffix.count && utf8.suffix(suffix.count).elementsEqual(suffix)
+        case .glob(let tokens):
+            return matchGlob(tokens, Array(name.utf8))
+        case .anyDirectories:
+            return true
+        }
+    }
+
+    // Iterative wildcard match, backtracking only to the most recent "*"
+    private static func matchGlob(_ tokens: [GlobToken], _ name: [UInt8]) -> Bool {
+        var tokenIndex = 0
+        var nameIndex = 0
+        var starToken = -1
+        var starName = 0
+
+        while nameIndex < name.count {
+            if tokenIndex < tokens.count {
+                let byte = name[nameIndex]
+                var advanced = false
+                switch tokens[tokenIndex] {
+                case .star:
+                    starToken = tokenIndex
+                    starName = nameIndex
+                    tokenIndex += 1
+                    continue
+                case .any:
+                    advanced = true
+                case .byte(let expected):
+                    advanced = byte == expected
+                case .set(let ranges, let negated):
+                    advanced = ranges.contains { $0.contains(byte) } != negated
+                }
+                if advanced {
+                    tokenIndex += 1
+                    nameIndex += 1
+                    continue
+                }
+            }
+
+            guard starToken >= 0 else { return false }
+            tokenIndex = starToken + 1
+            starName += 1
+            nameIndex = starName
+        }
+
+        while tokenIndex < tokens.count, tokens[tokenIndex] == .star {
+            tokenIndex += 1
+        }
+        return tokenIndex == tokens.count
+    }
+
+    // MARK: - Compilation
+
+    private static func compileSegment(_ bytes: [UInt8]) -> Segment {
+        if bytes == Array("**".utf8) {
+            return .anyDirectories
+        }
+
+        let tokens = compileGlob(bytes)
+        let hasWildcard = tokens.contains { token in
+            if case .byte = token { return false }
+            return true
+        }
+
+        if !hasWildcard {
+            return .literal(String(decoding: bytes, as: UTF8.self))
+        }
+
+        if tokens.first == .star {
+            let rest = tokens.dropFirst()
+            var literal: [UInt8] = []
+            for token in rest {
+                guard case .byte(let byte) = token else { return .glob(tokens) }
+                literal.append(byte)
+            }
+            return .suffix(literal)
+        }
+
+        return .glob(tokens)
+    }
+
+    private static func compileGlob(_ bytes: [UInt8]) -> [GlobToken] {
+        var tokens: [GlobToken] = []
+        var index = 0
+
+        while index < bytes.count {
+            let byte = bytes[index]
+            switch byte {
+            case UInt8(ascii: "*"):
+                // Consecutive stars inside a segment behave like a single one
+                if tokens.last != .star { tokens.append(.star) }
+                index += 1
+            case UInt8(ascii: "?"):
+                tokens.append(.any)
+                index += 1
+            case UInt8(ascii: "\\") where index + 1 < bytes.count:
+                tokens.append(.byte(bytes[index + 1]))
+                index += 2
+            case UInt8(ascii: "["):
+                if let compiled = compileSet(bytes, from: index + 1) {
+                    tokens.append(compiled.token)
+                    index = compiled.next
+                } else {
+                    tokens.append(.byte(byte))
+                    index += 1
+                }
+            default:
+                tokens.append(.byte(byte))
+                index += 1
+            }
+        }
+
+        return tokens
+    }
+
+    private static func compileSet(_ bytes: [UInt8], from start: Int) -> (token: GlobToken, next: Int)? {
+        var index = start
+        var negated = false
+        if index < bytes.count, bytes[index] == UInt8(ascii: "!") || bytes[index] == UInt8(ascii: "^") {
+            negated = true
+            index += 1
+        }
+
+        var ranges: [ClosedRange<UInt8>] = []
+        var isFirst = true
+        while index < bytes.count {
+            var lower = bytes[index]
+            if lower == UInt8(ascii: "]") && !isFirst {
+                return (.set(ranges, negated: negated), index + 1)
+            }
+            if lower == UInt8(ascii: "\\"), index + 1 < bytes.count {
+                index += 1
+                lower = bytes[index]
+            }
+            isFirst = false
+
+            if index + 2 < bytes.count, bytes[index + 1] == UInt8(ascii: "-"), bytes[index + 2] != UInt8(ascii: "]") {
+                let upper = bytes[index + 2]
+                if lower <= upper { ranges.append(lower...upper) }
+                index += 3
+            } else {
+                ranges.append(lower...lower)
+                index += 1
+            }
+        }
+
+        // Unterminated class: treat "[" literally
+        return nil
+    }
+}
+
+/// Rules from a single ignore file, rooted at the directory that contains it
+struct GitignoreRuleSet: Sendable {
+    /// Number of path components between the walk root and the ignore file's directory
+    let depth: Int
+    private let rules: [GitignoreRule]
+    // Unanchored literal names ("node_modules", ".DS_Store") resolve by hash lookup;
+    // only the remaining rules are tested one by one.
+    private let literalRules: [String: [Int]]
+    private let patternRules: [Int]
+
+    init(depth: Int, lines: [Substring]) {
+        self.depth = depth
+        let rules = lines.compactMap { GitignoreRule(line: $0) }
+        self.rules = rules
+
+        var literalRules: [String: [Int]] = [:]
+        var patternRules: [Int] = []
+        for (index, rule) in rules.enumerated() {
+            if let literal = rule.unanchoredLiteral {
+                literalRules[literal, default: []].append(index)
+            } else {
+                patternRules.append(index)
+            }
+        }
+        self.literalRules = literalRules
+        self.patternRules = patternRules
+    }
+
+    init?(depth: Int, contentsOf path: String) {
+        guard let content = try? String(contentsOfFile: path, encoding: .utf8) else { return nil }
+        self.init(depth: depth, lines: content.split(separator: "\n", omittingEmptySubsequences: true))
+    }
+
+    var isEmpty: Bool { rules.isEmpty }
+
+    /// Verdict of the last matching rule: true = ignored, false = re-included, nil = no rule matched
+    func verdict(for components: ArraySlice<String>, isDirectory: Bool) -> Bool? {
+        let relative = components.dropFirst(depth)
+        guard let name = relative.last else { return nil }
+
+        var best = -1
+        if let candidates = literalRules[name] {
+            for index in candidates.reversed() where !rules[index].directoryOnly || isDirectory {
+                best = index
+                break
+            }
+        }
+
+        for index in patternRules.reversed() {
+            guard index > best else { break }
+            if rules[index].matches(relative, isDirectory: isDirectory) {
+                best = index
+                break
+            }
+        }
+
+        guard best >= 0 else { return nil }
+        return !rules[best].negated
+    }
+}
+
+/// Stack of rule sets from the walk root down to the current directory.
+/// Deeper ignore files take precedence, and within a file the last matching line wins.
+struct GitignoreMatcher: Sendable {
+    private var ruleSets: [GitignoreRuleSet]
+
+    /// Root matcher: built-in defaults, then `.git/info/exclude`, then the root `.gitignore`
+    static func root(at path: String, defaultPatterns: [String]) -> GitignoreMatcher {
+        var ruleSets = [GitignoreRuleSet(depth: 0, lines: defaultPatterns.map { Substring($0) })]
+
+        let excludePath = (path as NSString).appendingPathComponent(".git/info/exclude")
+        if let exclude = GitignoreRuleSet(depth: 0, contentsOf: excludePath), !exclude.isEmpty {
+            ruleSets.append(exclude)
+        }
+
+        let gitignorePath = (path as NSString).appendingPathComponent(".gitignore")
+        if let gitignore = GitignoreRuleSet(depth: 0, contentsOf: gitignorePath), !gitignore.isEmpty {
+            ruleSets.append(gitignore)
+        }
+
+        return GitignoreMatcher(ruleSets: ruleSets)
+    }
+
+    /// Matcher for the children of `directoryPath`, picking up its `.gitignore` if present
+    func descending(into directoryPath: String, depth: Int) -> GitignoreMatcher {
+        let gitignorePath = (directoryPath as NSString).appendingPathComponent(".gitignore")
+        guard let nested = GitignoreRuleSet(depth: depth, contentsOf: gitignorePath), !nested.isEmpty else {
+            return self
+        }
+
+        var matcher = self
+        matcher.ruleSets.append(nested)
+        return matcher
+    }
+
+    /// `components` is the full path relative to the walk root. Parents are expected to have been
+    /// checked already, matching git's rule that files under an excluded directory stay excluded.
+    func isIgnored(_ components: [String], isDirectory: Bool) -> Bool {
+        let slice = components[...]
+        for ruleSet in ruleSets.reversed() {
+            if let verdict = ruleSet.verdict(for: slice, isDirectory: isDirectory) {
+                return verdict
+            }
+        }
+        return false
+    }
+}
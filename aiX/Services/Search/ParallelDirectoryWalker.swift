@@ -0,0 +1,264 @@
+//
+//  ParallelDirectoryWalker.swift
+//  aizen
+//
+//  Multi-threaded readdir walker used by the manual indexing fallback
+//
+
+import Foundation
+import Darwin
+
+/// Walks a directory tree on several threads and streams relative file paths in batches.
+///
+/// Each worker owns a deque of pending directories: it pushes subdirectories onto its own
+/// deque and pops the most recent one (depth first, good locality); idle workers steal the
+/// oldest entries from other workers (breadth first, large subtrees). Entry types come from
+/// `readdir`'s `d_type`, so regular trees are walked without a stat per file.
+final class ParallelDirectoryWalker: @unchecked Sendable {
+    private struct WorkItem {
+        let path: String
+        let components: [String]
+        let matcher: GitignoreMatcher
+    }
+
+    private final class WorkDeque: @unchecked Sendable {
+        private var items: [WorkItem] = []
+        private var head = 0
+        private let lock = NSLock()
+
+        func push(_ item: WorkItem) {
+            lock.lock()
+            defer { lock.unlock() }
+            items.append(item)
+        }
+
+        func popLast() -> WorkItem? {
+            lock.lock()
+            defer { lock.unlock() }
+            guard items.count > head else { return nil }
+            let item = items.removeLast()
+            compactIfDrained()
+            return item
+        }
+
+        func stealFirst() -> WorkItem? {
+            lock.lock()
+            defer { lock.unlock() }
+            guard items.count > head else { return nil }
+            let item = items[head]
+            head += 1
+            compactIfDrained()
+            return item
+        }
+
+        private func compactIfDrained() {
+            if head == items.count {
+                items.removeAll(keepingCapacity: true)
+                head = 0
+            } else if head > 1024 && head * 2 > items.count {
+                items.removeFirst(head)
+                head = 0
+            }
+        }
+    }
+
+    // Bundle directories listed but not descended into, like FileManager's skipsPackageDescendants
+    private static let packageExtensions: Set<String> = [
+        "app", "appex", "bundle", "framework", "kext", "plugin", "xcframework",
+        "xcodeproj", "xcworkspace", "playground", "xcarchive"
+    ]
+
+    private let rootPath: String
+    private let rootMatcher: GitignoreMatcher
+    private let workerCount: Int
+    private let batchSize: Int
+    private let flushInterval: UInt64
+
+    private let deques: [WorkDeque]
+    private let idleCondition = NSCondition()
+    // Directories queued or being read; the walk is done when this reaches zero.
+    // Both are guarded by idleCondition's lock.
+    private var pendingDirectories = 0
+    private var isCancelled = false
+
+    init(
+        rootPath: String,
+        matcher: GitignoreMatcher,
+        workerCount: Int = min(max(ProcessInfo.processInfo.activeProcessorCount, 2), 8),
+        batchSize: Int = 2_048,
+        flushInterval: TimeInterval = 0.025
+    ) {
+        self.rootPath = rootPath
+        self.rootMatcher = matcher
+        self.workerCount = workerCount
+        self.batchSize = batchSize
+        self.flushInterval = UInt64(flushInterval * 1_000_000_000)
+        self.deques = (0..<workerCount).map { _ in WorkDeque() }
+    }
+
+    /// Stream batches of relative file paths. Batches are flushed when full or every
+    /// `flushInterval`, so the first results arrive long before large trees finish.
+    func walk() -> AsyncStream<[String]> {
+        AsyncStream { continuation in
+            continuation.onTermination = { [weak self] _ in
+                self?.cancel()
+            }
+
+            pendingDirectories = 1
+            deques[0].push(WorkItem(path: rootPath, components: [], matcher: rootMatcher))
+
+            let group = DispatchGroup()
+            for workerIndex in 0..<workerCount {
+                group.enter()
+                Thread.detachNewThread { [self] in
+                    self.runWorker(workerIndex, continuation: continuation)
+                    group.leave()
+                }
+            }
+
+            group.notify(queue: .global(qos: .utility)) {
+                continuation.finish()
+            }
+        }
+    }
+
+    func cancel() {
+        idleCondition.lock()
+        isCancelled = true
+        idleCondition.broadcast()
+        idleCondition.unlock()
+    }
+
+    // MARK: - Workers
+
+    private func runWorker(_ workerIndex: Int, continuation: AsyncStream<[String]>.Continuation) {
+        var batch: [String] = []
+        batch.reserveCapacity(batchSize)
+        var lastFlush = DispatchTime.now().uptimeNanoseconds
+
+        func flush() {
+            guard !batch.isEmpty else { return }
+            continuation.yield(batch)
+            batch.removeAll(keepingCapacity: true)
+            lastFlush = DispatchTime.now().uptimeNanoseconds
+        }
+
+        while let item = nextWorkItem(for: workerIndex) {
+            readDirectory(item, workerIndex: workerIndex, into: &batch)
+            finishDirectory()
+
+            if batch.count >= batchSize || DispatchTime.now().uptimeNanoseconds - lastFlush >= flushInterval {
+                flush()
+            }
+        }
+
+        flush()
+    }
+
+    private func nextWorkItem(for workerIndex: Int) -> WorkItem? {
+        while true {
+            if let item = deques[workerIndex].popLast() {
+                return item
+            }
+            for offset in 1..<max(workerCount, 2) {
+                let victim = (workerIndex + offset) % workerCount
+                if victim != workerIndex, let item = deques[victim].stealFirst() {
+                    return item
+                }
+            }
+
+            idleCondition.lock()
+            if isCancelled || pendingDirectories == 0 {
+                idleCondition.unlock()
+                return nil
+            }
+            // Woken by new work, completion or cancellation; the timeout guards a missed signal
+            idleCondition.wait(until: Date(timeIntervalSinceNow: 0.01))
+            idleCondition.unlock()
+        }
+    }
+
+    private func enqueueDirectory(_ item: WorkItem, workerIndex: Int) {
+        idleCondition.lock()
+        pendingDirectories += 1
+        idleCondition.unlock()
+
+        deques[workerIndex].push(item)
+
+        idleCondition.lock()
+        idleCondition.signal()
+        idleCondition.unlock()
+    }
+
+    private func finishDirectory() {
+        idleCondition.lock()
+        pendingDirectories -= 1
+        if pendingDirectories == 0 {
+            idleCondition.broadcast()
+        }
+        idleCondition.unlock()
+    }
+
+    private var cancelled: Bool {
+        idleCondition.lock()
+        defer { idleCondition.unlock() }
+        return isCancelled
+    }
+
+    private func readDirectory(_ item: WorkItem, workerIndex: Int, into batch: inout [String]) {
+        guard !cancelled, let dir = opendir(item.path) else { return }
+        defer { closedir(dir) }
+
+        var names: [(name: String, type: UInt8)] = []
+        var hasGitignore = false
+
+        while let entry = readdir(dir) {
+            let name = withUnsafeBytes(of: &entry.pointee.d_name) { raw in
+                String(decoding: raw.prefix(Int(entry.pointee.d_namlen)), as: UTF8.self)
+            }
+            if name == ".gitignore" {
+                hasGitignore = true
+            }
+            // Skip hidden entries (and "." / "..")
+            guard !name.hasPrefix(".") else { continue }
+            names.append((name, entry.pointee.d_type))
+        }
+
+        let matcher = hasGitignore
+            ? item.matcher.descending(into: item.path, depth: item.components.count)
+            : item.matcher
+        let prefix = item.components.isEmpty ? "" : item.components.joined(separator: "/") + "/"
+
+        for (name, type) in names {
+            let childPath = item.path + "/" + name
+            var childComponents = item.components
+            childComponents.append(name)
+
+            let isDirectory: Bool
+            switch Int32(type) {
+            case DT_DIR:
+                isDirectory = true
+            case DT_UNKNOWN:
+                var info = stat()
+                isDirectory = lstat(childPath, &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR
+            default:
+                // Symlinks are listed as files and not followed
+                isDirectory = false
+            }
+
+            if matcher.isIgnored(childComponents, isDirectory: isDirectory) {
+                continue
+            }
+
+            if isDirectory {
+                if let ext = name.split(separator: ".").last, name.contains("."),
+                   Self.packageExtensions.contains(ext.lowercased()) {
+                    continue
+                }
+                enqueueDirectory(WorkItem(path: childPath, components: childComponents, matcher: matcher), workerIndex: workerIndex)
+            } else {
+                batch.append(prefix + name)
+            }
+        }
+    }
+}
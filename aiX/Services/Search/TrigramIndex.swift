@@ -0,0 +1,389 @@
+//
+//  TrigramIndex.swift
+//  aizen
+//
+//  Content-addressed trigram posting lists for indexed content search
+//
+
+import Foundation
+
+enum Trigram {
+    /// Files larger than this are recorded as unindexed and always scanned
+    static let maxIndexedFileSize = 8 * 1024 * 1024
+
+    // Trigrams are ASCII case-folded so one index serves case-sensitive and insensitive queries
+    @inline(__always)
+    private static func fold(_ byte: UInt8) -> UInt8 {
+        (byte >= UInt8(ascii: "A") && byte <= UInt8(ascii: "Z")) ? byte | 0x20 : byte
+    }
+
+    /// Sorted, de-duplicated trigrams of `bytes`
+    static func extract(from bytes: UnsafeBufferPointer<UInt8>) -> [UInt32] {
+        guard bytes.count >= 3 else { return [] }
+
+        var seen = Set<UInt32>()
+        seen.reserveCapacity(min(bytes.count, 1 << 14))
+
+        var window = (UInt32(fold(bytes[0])) << 8) | UInt32(fold(bytes[1]))
+        for index in 2..<bytes.count {
+            window = ((window << 8) | UInt32(fold(bytes[index]))) & 0xFF_FFFF
+            seen.insert(window)
+        }
+        return seen.sorted()
+    }
+
+    /// Trigrams every match of `literal` must contain
+    static func query(_ literal: String) -> [UInt32] {
+        let bytes = Array(literal.utf8)
+        return bytes.withUnsafeBufferPointer { extract(from: $0) }
+    }
+}
+
+/// Immutable, memory-mapped posting lists for blob ordinals in `startOrdinal..<endOrdinal`.
+///
+/// Layout: header (magic, version, start, end, trigram count, reserved; UInt32 LE), a table
+/// sorted by trigram of (trigram UInt32, count UInt32, offset UInt64), then the postings as
+/// LEB128 varints of ordinal deltas.
+struct TrigramPostingSegment {
+    private static let magic: UInt32 = 0x4158_5453 // "AXTS"
+    private static let version: UInt32 = 1
+    private static let headerSize = 24
+    private static let entrySize = 16
+
+    let startOrdinal: UInt32
+    let endOrdinal: UInt32
+    private let data: Data
+    private let trigramCount: Int
+
+    init?(url: URL) {
+        guard let data = try? Data(contentsOf: url, options: .alwaysMapped),
+              data.count >= Self.headerSize else {
+            return nil
+        }
+
+        let header = data.withUnsafeBytes { raw in
+            (0..<6).map { UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: $0 * 4, as: UInt32.self)) }
+        }
+        guard header[0] == Self.magic, header[1] == Self.version else { return nil }
+
+        let trigramCount = Int(header[4])
+        guard data.count >= Self.headerSize + trigramCount * Self.entrySize else { return nil }
+
+        self.data = data
+        self.startOrdinal = header[2]
+        self.endOrdinal = header[3]
+        self.trigramCount = trigramCount
+    }
+
+    /// Ordinals of blobs containing `trigram`, ascending
+    func postings(for trigram: UInt32) -> [UInt32] {
+        data.withUnsafeBytes { raw in
+            var low = 0
+            var high = trigramCount
+            while low < high {
+                let mid = (low + high) / 2
+                let key = entry(raw, at: mid).trigram
+                if key < trigram {
+                    low = mid + 1
+                } else {
+                    high = mid
+                }
+            }
+            guard low < trigramCount else { return [] }
+            let found = entry(raw, at: low)
+            guard found.trigram == trigram else { return [] }
+            return decode(raw, count: found.count, offset: found.offset)
+        }
+    }
+
+    /// Every posting list, for merging segments
+    func allPostings(into postings: inout [UInt32: [UInt32]]) {
+        data.withUnsafeBytes { raw in
+            for index in 0..<trigramCount {
+                let found = entry(raw, at: index)
+                postings[found.trigram, default: []].append(contentsOf: decode(raw, count: found.count, offset: found.offset))
+            }
+        }
+    }
+
+    private func entry(_ raw: UnsafeRawBufferPointer, at index: Int) -> (trigram: UInt32, count: Int, offset: Int) {
+        let base = Self.headerSize + index * Self.entrySize
+        let trigram = UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: base, as: UInt32.self))
+        let count = UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: base + 4, as: UInt32.self))
+        let offset = UInt64(littleEndian: raw.loadUnaligned(fromByteOffset: base + 8, as: UInt64.self))
+        return (trigram, Int(count), Int(offset))
+    }
+
+    private func decode(_ raw: UnsafeRawBufferPointer, count: Int, offset: Int) -> [UInt32] {
+        var result: [UInt32] = []
+        result.reserveCapacity(count)
+        var cursor = offset
+        var previous: UInt32 = 0
+
+        for _ in 0..<count {
+            var value: UInt32 = 0
+            var shift: UInt32 = 0
+            while cursor < raw.count {
+                let byte = raw[cursor]
+                cursor += 1
+                value |= UInt32(byte & 0x7F) << shift
+                if byte & 0x80 == 0 { break }
+                shift += 7
+            }
+            previous &+= value
+            result.append(previous)
+        }
+        return result
+    }
+
+    static func write(
+        _ postings: [UInt32: [UInt32]],
+        startOrdinal: UInt32,
+        endOrdinal: UInt32,
+        to url: URL
+    ) throws {
+        let trigrams = postings.keys.sorted()
+
+        var body = Data()
+        var table = Data()
+        table.reserveCapacity(trigrams.count * entrySize)
+
+        func appendLE<T: FixedWidthInteger>(_ value: T, to data: inout Data) {
+            withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+        }
+
+        for trigram in trigrams {
+            let list = postings[trigram] ?? []
+            appendLE(trigram, to: &table)
+            appendLE(UInt32(list.count), to: &table)
+            appendLE(UInt64(body.count), to: &table)
+
+            var previous: UInt32 = 0
+            for ordinal in list {
+                var delta = ordinal &- previous
+                previous = ordinal
+                while delta >= 0x80 {
+                    body.append(UInt8(delta & 0x7F) | 0x80)
+                    delta >>= 7
+                }
+                body.append(UInt8(delta))
+            }
+        }
+
+        var file = Data()
+        file.reserveCapacity(headerSize + table.count + body.count)
+        appendLE(magic, to: &file)
+        appendLE(version, to: &file)
+        appendLE(startOrdinal, to: &file)
+        appendLE(endOrdinal, to: &file)
+        appendLE(UInt32(trigrams.count), to: &file)
+        appendLE(UInt32(0), to: &file)
+
+        // Offsets in the table are relative to the body; rebase them onto the file
+        let bodyStart = UInt64(headerSize + table.count)
+        table.withUnsafeMutableBytes { raw in
+            for index in 0..<trigrams.count {
+                let position = index * entrySize + 8
+                let relative = UInt64(littleEndian: raw.loadUnaligned(fromByteOffset: position, as: UInt64.self))
+                raw.storeBytes(of: (relative + bodyStart).littleEndian, toByteOffset: position, as: UInt64.self)
+            }
+        }
+        file.append(table)
+        file.append(body)
+
+        try file.write(to: url, options: [.atomic])
+    }
+}
+
+/// Trigram index for all blobs of one repository, shared by its worktrees.
+///
+/// Blobs are identified by OID and numbered in the order they were indexed; `blobs.bin` is an
+/// append-only table of (OID, flags). Postings live in an on-disk base segment, a smaller
+/// delta segment that absorbs incremental updates, and an in-memory tail not yet flushed.
+final class TrigramIndexStore {
+    private static let blobRecordSize = 41
+    private static let unindexedFlag: UInt8 = 1
+
+    let directory: URL
+    private var blobOids: [String] = []
+    private var ordinals: [String: UInt32] = [:]
+    private var unindexed: Set<UInt32> = []
+
+    private var baseSegment: TrigramPostingSegment?
+    private var deltaSegment: TrigramPostingSegment?
+    private var pendingPostings: [UInt32: [UInt32]] = [:]
+    private var persistedBlobCount = 0
+
+    private var blobsURL: URL { directory.appendingPathComponent("blobs.bin") }
+    private var baseURL: URL { directory.appendingPathComponent("base.seg") }
+    private var deltaURL: URL { directory.appendingPathComponent("delta.seg") }
+
+    init(directory: URL) {
+        self.directory = directory
+        load()
+    }
+
+    func ordinal(forBlob oid: String) -> UInt32? {
+        ordinals[oid]
+    }
+
+    /// Register a blob's trigrams; `trigrams == nil` marks it unindexed (always a candidate)
+    @discardableResult
+    func addBlob(oid: String, trigrams: [UInt32]?) -> UInt32 {
+        if let existing = ordinals[oid] { return existing }
+
+        let ordinal = UInt32(blobOids.count)
+        blobOids.append(oid)
+        ordinals[oid] = ordinal
+
+        if let trigrams {
+            for trigram in trigrams {
+                pendingPostings[trigram, default: []].append(ordinal)
+            }
+        } else {
+            unindexed.insert(ordinal)
+        }
+        return ordinal
+    }
+
+    /// Ordinals that may contain every trigram (ascending), including unindexed blobs
+    func candidates(containingAll trigrams: [UInt32]) -> Set<UInt32> {
+        var lists = trigrams.map { postings(for: $0) }
+        lists.sort { $0.count < $1.count }
+
+        var result = lists.first ?? []
+        for list in lists.dropFirst() {
+            guard !result.isEmpty else { break }
+            result = Self.intersect(result, list)
+        }
+
+        var candidates = Set(result)
+        candidates.formUnion(unindexed)
+        return candidates
+    }
+
+    private func postings(for trigram: UInt32) -> [UInt32] {
+        var list = baseSegment?.postings(for: trigram) ?? []
+        if let deltaSegment {
+            list.append(contentsOf: deltaSegment.postings(for: trigram))
+        }
+        if let pending = pendingPostings[trigram] {
+            list.append(contentsOf: pending)
+        }
+        return list
+    }
+
+    private static func intersect(_ lhs: [UInt32], _ rhs: [UInt32]) -> [UInt32] {
+        var result: [UInt32] = []
+        result.reserveCapacity(min(lhs.count, rhs.count))
+        var left = 0
+        var right = 0
+        while left < lhs.count && right < rhs.count {
+            if lhs[left] == rhs[right] {
+                result.append(lhs[left])
+                left += 1
+                right += 1
+            } else if lhs[left] < rhs[right] {
+                left += 1
+            } else {
+                right += 1
+            }
+        }
+        return result
+    }
+
+    // MARK: - Persistence
+
+    /// Persist blobs added since the last flush. Small updates rewrite only the delta segment;
+    /// once the delta covers a large share of the blobs it is merged into the base.
+    func flush() {
+        guard blobOids.count > persistedBlobCount else { return }
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        let end = UInt32(blobOids.count)
+        let baseEnd = baseSegment?.endOrdinal ?? 0
+        let deltaCount = Int(end - baseEnd)
+        let mergeIntoBase = deltaCount > 20_000 || deltaCount > Int(baseEnd) / 4
+
+        do {
+            var postings: [UInt32: [UInt32]] = [:]
+            if mergeIntoBase {
+                baseSegment?.allPostings(into: &postings)
+            }
+            deltaSegment?.allPostings(into: &postings)
+            for (trigram, list) in pendingPostings {
+                postings[trigram, default: []].append(contentsOf: list)
+            }
+
+            if mergeIntoBase {
+                try TrigramPostingSegment.write(postings, startOrdinal: 0, endOrdinal: end, to: baseURL)
+                try? FileManager.default.removeItem(at: deltaURL)
+                baseSegment = TrigramPostingSegment(url: baseURL)
+                deltaSegment = nil
+            } else {
+                try TrigramPostingSegment.write(postings, startOrdinal: baseEnd, endOrdinal: end, to: deltaURL)
+                deltaSegment = TrigramPostingSegment(url: deltaURL)
+            }
+
+            try appendBlobRecords()
+            pendingPostings.removeAll()
+        } catch {
+            // Keep the pending tail in memory; the next flush retries
+        }
+    }
+
+    private func appendBlobRecords() throws {
+        var records = Data()
+        records.reserveCapacity((blobOids.count - persistedBlobCount) * Self.blobRecordSize)
+        for ordinal in persistedBlobCount..<blobOids.count {
+            var oid = Array(blobOids[ordinal].utf8.prefix(40))
+            oid.append(contentsOf: repeatElement(0, count: 40 - oid.count))
+            records.append(contentsOf: oid)
+            records.append(unindexed.contains(UInt32(ordinal)) ? Self.unindexedFlag : 0)
+        }
+
+        if !FileManager.default.fileExists(atPath: blobsURL.path) {
+            FileManager.default.createFile(atPath: blobsURL.path, contents: nil)
+        }
+        let handle = try FileHandle(forWritingTo: blobsURL)
+        defer { try? handle.close() }
+        try handle.truncate(atOffset: UInt64(persistedBlobCount * Self.blobRecordSize))
+        try handle.seekToEnd()
+        try handle.write(contentsOf: records)
+        persistedBlobCount = blobOids.count
+    }
+
+    private func load() {
+        baseSegment = TrigramPostingSegment(url: baseURL)
+        deltaSegment = TrigramPostingSegment(url: deltaURL)
+
+        // A delta segment must continue the base; otherwise it is stale
+        if let delta = deltaSegment, delta.startOrdinal != (baseSegment?.endOrdinal ?? 0) {
+            deltaSegment = nil
+        }
+        let covered = Int(deltaSegment?.endOrdinal ?? baseSegment?.endOrdinal ?? 0)
+
+        guard covered > 0, let data = try? Data(contentsOf: blobsURL, options: .alwaysMapped),
+              data.count >= covered * Self.blobRecordSize else {
+            baseSegment = nil
+            deltaSegment = nil
+            return
+        }
+
+        // Blob records beyond the persisted postings were never flushed; drop them
+        blobOids.reserveCapacity(covered)
+        data.withUnsafeBytes { raw in
+            for ordinal in 0..<covered {
+                let offset = ordinal * Self.blobRecordSize
+                let oid = String(decoding: UnsafeRawBufferPointer(rebasing: raw[offset..<(offset + 40)]), as: UTF8.self)
+                blobOids.append(oid)
+                ordinals[oid] = UInt32(ordinal)
+                if raw[offset + 40] == Self.unindexedFlag {
+                    unindexed.insert(UInt32(ordinal))
+                }
+            }
+        }
+
+        persistedBlobCount = covered
+    }
+}
@@ -8,6 +8,17 @@
 import Foundation
 
 enum CostUsageCacheIO {
+    // Layout: header (magic, version UInt32; last scan time Int64), then records of
+    // (kind UInt32, payload length UInt32, payload). Little endian throughout.
+    fileprivate static let magic: UInt32 = 0x5543_5841 // "AXCU"
+    fileprivate static let version: UInt32 = 2
+    fileprivate static let headerSize = 16
+    fileprivate static let lastScanOffset = 8
+
+    // Appended records are rewritten compactly once the table outgrows its live data this much
+    private static let compactionRatio = 4
+    private static let compactionMinBytes = 256 * 1024
+
     private static func defaultCacheRoot() -> URL {
         let root = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first!
         return root.appendingPathComponent("aiX", isDirectory: true)
@@ -17,64 +28,416 @@ enum CostUsageCacheIO {
         let root = cacheRoot ?? self.defaultCacheRoot()
         return root
             .appendingPathComponent("cost-usage", isDirectory: true)
-            .appendingPathComponent("\(provider.rawValue)-v1.json", isDirectory: false)
+            .appendingPathComponent("\(provider.rawValue)-v\(version).bin", isDirectory: false)
     }
 
     static func load(provider: UsageProvider, cacheRoot: URL? = nil) -> CostUsageCache {
         let url = self.cacheFileURL(provider: provider, cacheRoot: cacheRoot)
-        if let decoded = self.loadCache(at: url) { return decoded }
-        return CostUsageCache()
-    }
-
-    private static func loadCache(at url: URL) -> CostUsageCache? {
-        guard let data = try? Data(contentsOf: url) else { return nil }
-        guard let decoded = try? JSONDecoder().decode(CostUsageCache.self, from: data)
-        else { return nil }
-        guard decoded.version == 1 else { return nil }
-        return decoded
+        guard let data = try? Data(contentsOf: url, options: .alwaysMapped),
+              let cache = CostUsageCache(table: data) else {
+            return CostUsageCache()
+        }
+        return cache
     }
 
-    static func save(provider: UsageProvider, cache: CostUsageCache, cacheRoot: URL? = nil) {
+    /// Append the records added since `cache` was loaded, or rewrite the table when there is
+    /// no usable one on disk or it is mostly superseded records
+    static func save(provider: UsageProvider, cache: inout CostUsageCache, cacheRoot: URL? = nil) {
         let url = self.cacheFileURL(provider: provider, cacheRoot: cacheRoot)
+
+        let isCompact = cache.storedLength < compactionMinBytes
+            || cache.storedLength < compactionRatio * cache.compactedLength()
+        if cache.storedLength > 0, isCompact, self.append(cache, to: url) {
+            cache.didStore(length: cache.storedLength + cache.pending.count)
+            return
+        }
+
         let dir = url.deletingLastPathComponent()
         try? FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
 
-        let tmp = dir.appendingPathComponent(".tmp-\(UUID().uuidString).json", isDirectory: false)
-        let data = (try? JSONEncoder().encode(cache)) ?? Data()
+        let tmp = dir.appendingPathComponent(".tmp-\(UUID().uuidString).bin", isDirectory: false)
+        let data = cache.compactedTable()
         do {
             try data.write(to: tmp, options: [.atomic])
             _ = try FileManager.default.replaceItemAt(url, withItemAt: tmp)
+            cache.didStore(length: data.count)
         } catch {
             try? FileManager.default.removeItem(at: tmp)
         }
+
+        // Superseded JSON cache
+        let legacy = dir.appendingPathComponent("\(provider.rawValue)-v1.json", isDirectory: false)
+        try? FileManager.default.removeItem(at: legacy)
+    }
+
+    private static func append(_ cache: CostUsageCache, to url: URL) -> Bool {
+        guard let handle = try? FileHandle(forUpdating: url) else { return false }
+        defer { try? handle.close() }
+
+        do {
+            // Not the table that was loaded
+            guard try handle.seekToEnd() >= UInt64(cache.storedLength) else { return false }
+
+            // Drops a torn record left by an interrupted write
+            try handle.truncate(atOffset: UInt64(cache.storedLength))
+            try handle.seek(toOffset: UInt64(cache.storedLength))
+            try handle.write(contentsOf: cache.pending)
+
+            var lastScan = Data()
+            lastScan.appendInteger(cache.lastScanUnixMs)
+            try handle.seek(toOffset: UInt64(lastScanOffset))
+            try handle.write(contentsOf: lastScan)
+            return true
+        } catch {
+            return false
+        }
     }
 }
 
-struct CostUsageCache: Codable, Sendable {
-    var version: Int = 1
+/// Parsed usage of local logs.
+///
+/// On disk this is an append-only table. String records intern file paths and model names,
+/// numbered in record order. A file record holds a log's scan state (mtime, size, parsed
+/// offset, Codex running totals) and the tokens parsed from it in that scan, per day and
+/// model; later records for the same log add to earlier ones unless the log was parsed again
+/// from the start. A refresh appends records for the logs it parsed and rewrites the scan
+/// time in place. Loading maps the table and replays it; a record cut short by an
+/// interrupted write ends the table and is overwritten by the next append.
+struct CostUsageCache: Sendable {
+    private enum RecordKind: UInt32 {
+        case string = 1
+        case file = 2
+    }
+
+    private struct FileFlags: OptionSet {
+        let rawValue: UInt32
+
+        static let restarted = FileFlags(rawValue: 1 << 0)
+        static let hasModel = FileFlags(rawValue: 1 << 1)
+        static let hasTotals = FileFlags(rawValue: 1 << 2)
+    }
+
     var lastScanUnixMs: Int64 = 0
 
     // filePath -> file usage
-    var files: [String: CostUsageFileUsage] = [:]
+    private(set) var files: [String: CostUsageFileUsage] = [:]
 
     // dayKey -> model -> packed usage
-    var days: [String: [String: [Int]]] = [:]
+    private(set) var days: [String: [String: [Int]]] = [:]
+
+    private var strings: [String] = []
+    private var stringIds: [String: UInt32] = [:]
+
+    // Intact bytes of the table on disk; 0 when there is none
+    fileprivate private(set) var storedLength = 0
+    // Records not written yet
+    fileprivate private(set) var pending = Data()
+
+    init() {}
+
+    /// Record a parse of the log at `path`. `usage.days` holds the tokens found by this parse;
+    /// when `restarted`, the log was parsed from the start and replaces what was recorded before.
+    mutating func update(path: String, usage: CostUsageFileUsage, restarted: Bool) {
+        self.apply(path: path, usage: usage, restarted: restarted)
+        self.appendFileRecord(path: path, usage: usage, restarted: restarted)
+    }
+
+    private mutating func apply(path: String, usage: CostUsageFileUsage, restarted: Bool) {
+        var fileDays = files[path]?.days ?? [:]
+        if restarted {
+            Self.merge(fileDays, into: &days, sign: -1)
+            fileDays = [:]
+        }
+        Self.merge(usage.days, into: &days, sign: 1)
+        Self.merge(usage.days, into: &fileDays, sign: 1)
+
+        var stored = usage
+        stored.days = fileDays
+        files[path] = stored
+    }
+
+    fileprivate mutating func didStore(length: Int) {
+        storedLength = length
+        pending = Data()
+    }
+
+    // MARK: - Encoding
+
+    private mutating func intern(_ string: String) -> UInt32 {
+        if let id = stringIds[string] { return id }
+        let id = UInt32(strings.count)
+        strings.append(string)
+        stringIds[string] = id
+        Self.appendRecord(.string, to: &pending) { $0.append(contentsOf: string.utf8) }
+        return id
+    }
+
+    // Payload: path id, flags, model id (UInt32); mtime, size, parsed offset, input, cached,
+    // output totals (Int64); entry count (UInt32); entries of day (yyyyMMdd), model id, value
+    // count (UInt32) and values (Int64)
+    private mutating func appendFileRecord(path: String, usage: CostUsageFileUsage, restarted: Bool) {
+        var flags: FileFlags = restarted ? [.restarted] : []
+        if usage.lastModel != nil {
+            flags.insert(.hasModel)
+        }
+        if usage.lastTotals != nil {
+            flags.insert(.hasTotals)
+        }
+
+        let pathId = intern(path)
+        let modelId = usage.lastModel.map { intern($0) } ?? 0
+        var entries: [(day: UInt32, model: UInt32, values: [Int])] = []
+        for (dayKey, models) in usage.days {
+            guard let day = Self.dayNumber(dayKey) else { continue }
+            for (model, packed) in models {
+                entries.append((day, intern(model), packed))
+            }
+        }
+
+        Self.appendRecord(.file, to: &pending) { payload in
+            payload.appendInteger(pathId)
+            payload.appendInteger(flags.rawValue)
+            payload.appendInteger(modelId)
+            payload.appendInteger(usage.mtimeUnixMs)
+            payload.appendInteger(usage.size)
+            payload.appendInteger(usage.parsedBytes)
+            payload.appendInteger(Int64(usage.lastTotals?.input ?? 0))
+            payload.appendInteger(Int64(usage.lastTotals?.cached ?? 0))
+            payload.appendInteger(Int64(usage.lastTotals?.output ?? 0))
+            payload.appendInteger(UInt32(entries.count))
+            for entry in entries {
+                payload.appendInteger(entry.day)
+                payload.appendInteger(entry.model)
+                payload.appendInteger(UInt32(entry.values.count))
+                for value in entry.values {
+                    payload.appendInteger(Int64(value))
+                }
+            }
+        }
+    }
+
+    private static func appendRecord(_ kind: RecordKind, to data: inout Data, payload: (inout Data) -> Void) {
+        let start = data.count
+        data.appendInteger(kind.rawValue)
+        data.appendInteger(UInt32(0))
+        payload(&data)
+        let length = UInt32(data.count - start - 8)
+        data.withUnsafeMutableBytes { raw in
+            raw.storeBytes(of: length.littleEndian, toByteOffset: start + 4, as: UInt32.self)
+        }
+    }
 
-    // rootPath -> mtime (for Claude roots)
-    var roots: [String: Int64]?
+    /// Approximate size of the table holding only live records
+    fileprivate func compactedLength() -> Int {
+        var length = CostUsageCacheIO.headerSize
+        length += strings.reduce(0) { $0 + 8 + $1.utf8.count }
+        for usage in files.values {
+            length += 8 + 64
+            for models in usage.days.values {
+                length += models.values.reduce(0) { $0 + 12 + 8 * $1.count }
+            }
+        }
+        return length
+    }
+
+    /// The whole table, one record per log
+    fileprivate func compactedTable() -> Data {
+        var compacted = CostUsageCache()
+        for (path, usage) in files {
+            compacted.update(path: path, usage: usage, restarted: false)
+        }
+
+        var data = Data()
+        data.reserveCapacity(CostUsageCacheIO.headerSize + compacted.pending.count)
+        data.appendInteger(CostUsageCacheIO.magic)
+        data.appendInteger(CostUsageCacheIO.version)
+        data.appendInteger(lastScanUnixMs)
+        data.append(compacted.pending)
+        return data
+    }
+
+    // MARK: - Decoding
+
+    init?(table data: Data) {
+        let loaded = data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> Bool in
+            var header = CostUsageTableReader(raw: raw, cursor: 0, end: raw.count)
+            guard header.readUInt32() == CostUsageCacheIO.magic,
+                  header.readUInt32() == CostUsageCacheIO.version,
+                  let lastScan = header.readInt64() else {
+                return false
+            }
+            self.lastScanUnixMs = lastScan
+
+            var dayKeys: [UInt32: String] = [:]
+            var cursor = CostUsageCacheIO.headerSize
+            replay: while cursor + 8 <= raw.count {
+                var record = CostUsageTableReader(raw: raw, cursor: cursor, end: raw.count)
+                guard let kind = record.readUInt32(), let length = record.readUInt32() else { break }
+                let payloadEnd = record.cursor + Int(length)
+                guard payloadEnd <= raw.count else { break }
+
+                var payload = CostUsageTableReader(raw: raw, cursor: record.cursor, end: payloadEnd)
+                switch RecordKind(rawValue: kind) {
+                case .string:
+                    let bytes = UnsafeRawBufferPointer(rebasing: raw[payload.cursor..<payloadEnd])
+                    let string = String(decoding: bytes, as: UTF8.self)
+                    stringIds[string] = UInt32(strings.count)
+                    strings.append(string)
+                case .file:
+                    guard let file = Self.readFileRecord(&payload, strings: strings, dayKeys: &dayKeys) else {
+                        break replay
+                    }
+                    self.apply(path: file.path, usage: file.usage, restarted: file.restarted)
+                case nil:
+                    break
+                }
+                cursor = payloadEnd
+            }
+
+            self.storedLength = cursor
+            return true
+        }
+        guard loaded else { return nil }
+    }
+
+    private static func readFileRecord(
+        _ payload: inout CostUsageTableReader,
+        strings: [String],
+        dayKeys: inout [UInt32: String]
+    ) -> (path: String, usage: CostUsageFileUsage, restarted: Bool)? {
+        func string(_ id: UInt32?) -> String? {
+            guard let id, Int(id) < strings.count else { return nil }
+            return strings[Int(id)]
+        }
+
+        guard let path = string(payload.readUInt32()),
+              let rawFlags = payload.readUInt32(),
+              let modelId = payload.readUInt32(),
+              let mtime = payload.readInt64(),
+              let size = payload.readInt64(),
+              let parsedBytes = payload.readInt64(),
+              let input = payload.readInt64(),
+              let cached = payload.readInt64(),
+              let output = payload.readInt64(),
+              let entryCount = payload.readUInt32() else {
+            return nil
+        }
+        let flags = FileFlags(rawValue: rawFlags)
+
+        var days: [String: [String: [Int]]] = [:]
+        for _ in 0..<entryCount {
+            guard let day = payload.readUInt32(),
+                  let model = string(payload.readUInt32()),
+                  let valueCount = payload.readUInt32() else {
+                return nil
+            }
+            var values: [Int] = []
+            values.reserveCapacity(Int(valueCount))
+            for _ in 0..<valueCount {
+                guard let value = payload.readInt64() else { return nil }
+                values.append(Int(value))
+            }
+
+            let dayKey = dayKeys[day] ?? Self.dayKey(day)
+            dayKeys[day] = dayKey
+            days[dayKey, default: [:]][model] = values
+        }
+
+        var lastModel: String?
+        if flags.contains(.hasModel) {
+            guard let model = string(modelId) else { return nil }
+            lastModel = model
+        }
+        let usage = CostUsageFileUsage(
+            mtimeUnixMs: mtime,
+            size: size,
+            days: days,
+            parsedBytes: parsedBytes,
+            lastModel: lastModel,
+            lastTotals: flags.contains(.hasTotals)
+                ? CostUsageCodexTotals(input: Int(input), cached: Int(cached), output: Int(output))
+                : nil)
+        return (path, usage, flags.contains(.restarted))
+    }
+
+    // MARK: - Day keys
+
+    // "yyyy-MM-dd" <-> yyyyMMdd
+    private static func dayNumber(_ dayKey: String) -> UInt32? {
+        var value: UInt32 = 0
+        for byte in dayKey.utf8 where byte != UInt8(ascii: "-") {
+            guard (UInt8(ascii: "0")...UInt8(ascii: "9")).contains(byte) else { return nil }
+            value = value * 10 + UInt32(byte - UInt8(ascii: "0"))
+        }
+        return value
+    }
+
+    private static func dayKey(_ number: UInt32) -> String {
+        String(format: "%04d-%02d-%02d", number / 10_000, number / 100 % 100, number % 100)
+    }
+
+    // MARK: - Merging
+
+    private static func merge(
+        _ fileDays: [String: [String: [Int]]],
+        into out: inout [String: [String: [Int]]],
+        sign: Int
+    ) {
+        for (dayKey, models) in fileDays {
+            for (model, packed) in models {
+                out[dayKey, default: [:]][model, default: []].mergePacked(packed, sign: sign)
+            }
+        }
+    }
 }
 
-struct CostUsageFileUsage: Codable, Sendable {
+struct CostUsageFileUsage: Sendable {
     var mtimeUnixMs: Int64
     var size: Int64
     var days: [String: [String: [Int]]]
-    var parsedBytes: Int64?
+    var parsedBytes: Int64
     var lastModel: String?
     var lastTotals: CostUsageCodexTotals?
 }
 
-struct CostUsageCodexTotals: Codable, Sendable {
+struct CostUsageCodexTotals: Sendable {
     var input: Int
     var cached: Int
     var output: Int
 }
+
+/// Bounds-checked reads from a mapped cache table
+private struct CostUsageTableReader {
+    let raw: UnsafeRawBufferPointer
+    var cursor: Int
+    let end: Int
+
+    mutating func readUInt32() -> UInt32? {
+        guard cursor + 4 <= end else { return nil }
+        defer { cursor += 4 }
+        return UInt32(littleEndian: raw.loadUnaligned(fromByteOffset: cursor, as: UInt32.self))
+    }
+
+    mutating func readInt64() -> Int64? {
+        guard cursor + 8 <= end else { return nil }
+        defer { cursor += 8 }
+        return Int64(littleEndian: raw.loadUnaligned(fromByteOffset: cursor, as: Int64.self))
+    }
+}
+
+extension [Int] {
+    fileprivate mutating func mergePacked(_ other: [Int], sign: Int) {
+        if count < other.count {
+            append(contentsOf: repeatElement(0, count: other.count - count))
+        }
+        for idx in other.indices {
+            self[idx] = Swift.max(0, self[idx] + sign * other[idx])
+        }
+    }
+}
+
+extension Data {
+    fileprivate mutating func appendInteger<T: FixedWidthInteger>(_ value: T) {
+        withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+}
@@ -0,0 +1,187 @@
+//
+//  CostUsageJsonObject.swift
+//  aizen
+//
+//  Field lookups in raw JSON bytes for usage logs
+//
+
+import Foundation
+
+/// A JSON object inside a raw log line, read in place.
+///
+/// Lookups walk the object's own members and skip over nested values without decoding them,
+/// so pulling a few token counts out of a line allocates nothing but the strings asked for.
+/// Malformed input makes lookups return nil. The bytes must outlive the object.
+struct CostUsageJsonObject {
+    private let bytes: UnsafeRawBufferPointer
+    // Index of the opening brace
+    private let start: Int
+
+    init?(_ bytes: UnsafeRawBufferPointer) {
+        self.init(bytes, at: Self.skipWhitespace(bytes, from: 0))
+    }
+
+    private init?(_ bytes: UnsafeRawBufferPointer, at start: Int) {
+        guard start < bytes.count, bytes[start] == UInt8(ascii: "{") else { return nil }
+        self.bytes = bytes
+        self.start = start
+    }
+
+    // MARK: - Lookups
+
+    func object(_ key: StaticString) -> CostUsageJsonObject? {
+        guard let value = valueIndex(for: key) else { return nil }
+        return CostUsageJsonObject(bytes, at: value)
+    }
+
+    func string(_ key: StaticString) -> String? {
+        guard let value = valueIndex(for: key),
+              bytes[value] == UInt8(ascii: "\""),
+              let end = Self.skipString(bytes, from: value) else {
+            return nil
+        }
+        let contents = UnsafeRawBufferPointer(rebasing: bytes[(value + 1)..<(end - 1)])
+        if !contents.contains(UInt8(ascii: "\\")) {
+            return String(decoding: contents, as: UTF8.self)
+        }
+        // Escaped strings are rare in the fields read here; let Foundation unescape them
+        let literal = Data(UnsafeRawBufferPointer(rebasing: bytes[value..<end]))
+        return (try? JSONSerialization.jsonObject(with: literal, options: .fragmentsAllowed)) as? String
+    }
+
+    /// Integer value of a number member; a fractional part is dropped
+    func int(_ key: StaticString) -> Int? {
+        guard var index = valueIndex(for: key) else { return nil }
+        let negative = bytes[index] == UInt8(ascii: "-")
+        if negative {
+            index += 1
+        }
+
+        var value = 0
+        var digits = 0
+        while index < bytes.count, (UInt8(ascii: "0")...UInt8(ascii: "9")).contains(bytes[index]) {
+            value = value &* 10 &+ Int(bytes[index] - UInt8(ascii: "0"))
+            digits += 1
+            index += 1
+        }
+        guard digits > 0 else { return nil }
+        return negative ? -value : value
+    }
+
+    /// Whether the member is a string equal to `value`, compared without decoding
+    func has(_ key: StaticString, string value: StaticString) -> Bool {
+        guard let index = valueIndex(for: key), bytes[index] == UInt8(ascii: "\"") else { return false }
+        let count = value.utf8CodeUnitCount
+        guard index + count + 1 < bytes.count, bytes[index + count + 1] == UInt8(ascii: "\"") else { return false }
+        return memcmp(bytes.baseAddress! + index + 1, value.utf8Start, count) == 0
+    }
+
+    // MARK: - Members
+
+    // Index of the first byte of `key`'s value
+    private func valueIndex(for key: StaticString) -> Int? {
+        var index = start + 1
+        while true {
+            index = Self.skipWhitespace(bytes, from: index)
+            guard index < bytes.count, bytes[index] == UInt8(ascii: "\""),
+                  let keyEnd = Self.skipString(bytes, from: index) else {
+                return nil
+            }
+            let matches = keyEnd - index - 2 == key.utf8CodeUnitCount
+                && memcmp(bytes.baseAddress! + index + 1, key.utf8Start, key.utf8CodeUnitCount) == 0
+
+            index = Self.skipWhitespace(bytes, from: keyEnd)
+            guard index < bytes.count, bytes[index] == UInt8(ascii: ":") else { return nil }
+            index = Self.skipWhitespace(bytes, from: index + 1)
+            guard index < bytes.count else { return nil }
+            if matches {
+                return index
+            }
+
+            guard let valueEnd = Self.skipValue(bytes, from: index) else { return nil }
+            index = Self.skipWhitespace(bytes, from: valueEnd)
+            guard index < bytes.count, bytes[index] == UInt8(ascii: ",") else { return nil }
+            index += 1
+        }
+    }
+
+    // MARK: - Skipping
+
+    private static func skipWhitespace(_ bytes: UnsafeRawBufferPointer, from index: Int) -> Int {
+        var index = index
+        while index < bytes.count {
+            switch bytes[index] {
+            case UInt8(ascii: " "), UInt8(ascii: "\t"), UInt8(ascii: "\n"), UInt8(ascii: "\r"):
+                index += 1
+            default:
+                return index
+            }
+        }
+        return index
+    }
+
+    // Index past the closing quote of the string opening at `index`
+    private static func skipString(_ bytes: UnsafeRawBufferPointer, from index: Int) -> Int? {
+        guard let base = bytes.baseAddress else { return nil }
+        var searchFrom = index + 1
+        while searchFrom < bytes.count {
+            guard let found = memchr(base + searchFrom, Int32(UInt8(ascii: "\"")), bytes.count - searchFrom) else {
+                return nil
+            }
+            let quote = base.distance(to: UnsafeRawPointer(found))
+            // A quote preceded by an odd number of backslashes is escaped
+            var backslashes = 0
+            while quote - backslashes - 1 > index, bytes[quote - backslashes - 1] == UInt8(ascii: "\\") {
+                backslashes += 1
+            }
+            if backslashes % 2 == 0 {
+                return quote + 1
+            }
+            searchFrom = quote + 1
+        }
+        return nil
+    }
+
+    // Index past the value starting at `index`
+    private static func skipValue(_ bytes: UnsafeRawBufferPointer, from index: Int) -> Int? {
+        switch bytes[index] {
+        case UInt8(ascii: "\""):
+            return skipString(bytes, from: index)
+        case UInt8(ascii: "{"), UInt8(ascii: "["):
+            var depth = 0
+            var cursor = index
+            while cursor < bytes.count {
+                switch bytes[cursor] {
+                case UInt8(ascii: "\""):
+                    guard let end = skipString(bytes, from: cursor) else { return nil }
+                    cursor = end
+                    continue
+                case UInt8(ascii: "{"), UInt8(ascii: "["):
+                    depth += 1
+                case UInt8(ascii: "}"), UInt8(ascii: "]"):
+                    depth -= 1
+                    if depth == 0 {
+                        return cursor + 1
+                    }
+                default:
+                    break
+                }
+                cursor += 1
+            }
+            return nil
+        default:
+            // Number, true, false or null
+            var cursor = index
+            while cursor < bytes.count {
+                switch bytes[cursor] {
+                case UInt8(ascii: ","), UInt8(ascii: "}"), UInt8(ascii: "]"),
+                     UInt8(ascii: " "), UInt8(ascii: "\t"), UInt8(ascii: "\n"), UInt8(ascii: "\r"):
+                    return cursor
+                default:
+                    cursor += 1
+                }
+            }
+            return cursor
+        }
+    }
+}
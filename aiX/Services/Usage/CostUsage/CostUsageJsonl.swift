@@ -8,11 +8,15 @@
 import Foundation
 
 enum CostUsageJsonl {
-    struct Line: Sendable {
-        let bytes: Data
+    struct Line {
+        /// Valid only during the `onLine` call; empty when the line was truncated
+        let bytes: UnsafeRawBufferPointer
         let wasTruncated: Bool
     }
 
+    /// Calls `onLine` for each newline-terminated line from `offset` on and returns the offset
+    /// past the last one. A final line without a newline may still be being written; it is left
+    /// for the next scan. Lines within a read chunk are handed out in place, without copying.
     @discardableResult
     static func scan(
         fileURL: URL,
@@ -29,52 +33,74 @@ enum CostUsageJsonl {
             try handle.seek(toOffset: UInt64(startOffset))
         }
 
-        var buffer = Data()
-        buffer.reserveCapacity(64 * 1024)
+        let keepBytes = min(maxLineBytes, prefixBytes)
+
+        // A line continued from the previous chunk
+        var carry: [UInt8] = []
+        var carryBytes = 0
+        var carryTruncated = false
 
-        var current = Data()
-        current.reserveCapacity(4 * 1024)
-        var lineBytes = 0
-        var truncated = false
         var bytesRead: Int64 = 0
+        var completeBytes: Int64 = 0
 
-        func flushLine() {
-            guard lineBytes > 0 else { return }
-            let line = Line(bytes: current, wasTruncated: truncated)
-            onLine(line)
-            current.removeAll(keepingCapacity: true)
-            lineBytes = 0
-            truncated = false
+        func emit(_ bytes: UnsafeRawBufferPointer) {
+            guard !bytes.isEmpty else { return }
+            if bytes.count > keepBytes {
+                onLine(Line(bytes: UnsafeRawBufferPointer(start: nil, count: 0), wasTruncated: true))
+            } else {
+                onLine(Line(bytes: bytes, wasTruncated: false))
+            }
         }
 
-        while true {
-            let chunk = try handle.read(upToCount: 256 * 1024) ?? Data()
-            if chunk.isEmpty {
-                flushLine()
-                break
+        func appendCarry(_ bytes: UnsafeRawBufferPointer) {
+            carryBytes += bytes.count
+            if carryBytes > keepBytes {
+                carryTruncated = true
+                carry.removeAll(keepingCapacity: true)
+            } else if !carryTruncated {
+                carry.append(contentsOf: bytes)
             }
+        }
 
-            bytesRead += Int64(chunk.count)
-            buffer.append(chunk)
+        func emitCarry() {
+            if carryTruncated {
+                onLine(Line(bytes: UnsafeRawBufferPointer(start: nil, count: 0), wasTruncated: true))
+            } else {
+                carry.withUnsafeBytes { emit($0) }
+            }
+            carry.removeAll(keepingCapacity: true)
+            carryBytes = 0
+            carryTruncated = false
+        }
 
-            while true {
-                guard let nl = buffer.firstIndex(of: 0x0A) else { break }
-                let linePart = buffer[..<nl]
-                buffer.removeSubrange(...nl)
+        while true {
+            let chunk = try handle.read(upToCount: 256 * 1024) ?? Data()
+            if chunk.isEmpty { break }
+            let chunkOffset = bytesRead
+            bytesRead += Int64(chunk.count)
 
-                lineBytes += linePart.count
-                if !truncated {
-                    if lineBytes > maxLineBytes || lineBytes > prefixBytes {
-                        truncated = true
-                        current.removeAll(keepingCapacity: true)
+            chunk.withUnsafeBytes { raw in
+                guard let base = raw.baseAddress else { return }
+                var lineStart = 0
+                while lineStart < raw.count {
+                    guard let newline = memchr(base + lineStart, 0x0A, raw.count - lineStart) else {
+                        appendCarry(UnsafeRawBufferPointer(rebasing: raw[lineStart...]))
+                        return
+                    }
+                    let lineEnd = base.distance(to: UnsafeRawPointer(newline))
+                    let part = UnsafeRawBufferPointer(rebasing: raw[lineStart..<lineEnd])
+                    if carryBytes == 0 {
+                        emit(part)
                     } else {
-                        current.append(contentsOf: linePart)
+                        appendCarry(part)
+                        emitCarry()
                     }
+                    lineStart = lineEnd + 1
+                    completeBytes = chunkOffset + Int64(lineStart)
                 }
-                flushLine()
             }
         }
 
-        return startOffset + bytesRead
+        return startOffset + completeBytes
     }
 }
@@ -37,6 +37,9 @@ enum CostUsageScanner {
         let parsedBytes: Int64
     }
 
+    // Scans append to the cache tables; one at a time
+    private static let scanLock = NSLock()
+
     static func loadDailyReport(
         provider: UsageProvider,
         since: Date,
@@ -45,6 +48,8 @@ enum CostUsageScanner {
         options: Options = Options()
     ) -> UsageDailyReport {
         let range = CostUsageDayRange(since: since, until: until)
+        self.scanLock.lock()
+        defer { self.scanLock.unlock() }
 
         switch provider {
         case .codex:
@@ -168,71 +173,59 @@ enum CostUsageScanner {
                 guard !line.bytes.isEmpty else { return }
                 guard !line.wasTruncated else { return }
 
-                guard
-                    line.bytes.containsAscii(#""type":"event_msg""#)
-                    || line.bytes.containsAscii(#""type":"turn_context""#)
-                else { return }
+                let isEventMsg = line.bytes.containsAscii(#""type":"event_msg""#)
+                guard isEventMsg || line.bytes.containsAscii(#""type":"turn_context""#) else { return }
 
-                if line.bytes.containsAscii(#""type":"event_msg""#), !line.bytes.containsAscii(#""token_count""#) {
+                if isEventMsg, !line.bytes.containsAscii(#""token_count""#) {
                     return
                 }
 
-                guard
-                    let obj = (try? JSONSerialization.jsonObject(with: line.bytes)) as? [String: Any],
-                    let type = obj["type"] as? String
-                else { return }
+                guard let obj = CostUsageJsonObject(line.bytes) else { return }
+                let isTurnContext = obj.has("type", string: "turn_context")
+                guard isTurnContext || obj.has("type", string: "event_msg") else { return }
 
-                guard let tsText = obj["timestamp"] as? String else { return }
+                guard let tsText = obj.string("timestamp") else { return }
                 guard let dayKey = Self.dayKeyFromTimestamp(tsText) ?? Self.dayKeyFromParsedISO(tsText) else { return }
 
-                if type == "turn_context" {
-                    if let payload = obj["payload"] as? [String: Any] {
-                        if let model = payload["model"] as? String {
+                if isTurnContext {
+                    if let payload = obj.object("payload") {
+                        if let model = payload.string("model") {
                             currentModel = model
-                        } else if let info = payload["info"] as? [String: Any], let model = info["model"] as? String {
+                        } else if let model = payload.object("info")?.string("model") {
                             currentModel = model
                         }
                     }
                     return
                 }
 
-                guard type == "event_msg" else { return }
-                guard let payload = obj["payload"] as? [String: Any] else { return }
-                guard (payload["type"] as? String) == "token_count" else { return }
+                guard let payload = obj.object("payload") else { return }
+                guard payload.has("type", string: "token_count") else { return }
 
-                let info = payload["info"] as? [String: Any]
-                let modelFromInfo = info?["model"] as? String
-                    ?? info?["model_name"] as? String
-                    ?? payload["model"] as? String
-                    ?? obj["model"] as? String
+                let info = payload.object("info")
+                let modelFromInfo = info?.string("model")
+                    ?? info?.string("model_name")
+                    ?? payload.string("model")
+                    ?? obj.string("model")
                 let model = modelFromInfo ?? currentModel ?? "gpt-5"
 
-                func toInt(_ v: Any?) -> Int {
-                    if let n = v as? NSNumber { return n.intValue }
-                    return 0
-                }
-
-                let total = (info?["total_token_usage"] as? [String: Any])
-                let last = (info?["last_token_usage"] as? [String: Any])
-
                 var deltaInput = 0
                 var deltaCached = 0
                 var deltaOutput = 0
 
-                if let total {
-                    let input = toInt(total["input_tokens"])
-                    let cached = toInt(total["cached_input_tokens"] ?? total["cache_read_input_tokens"])
-                    let output = toInt(total["output_tokens"])
+                if let total = info?.object("total_token_usage") {
+                    let input = total.int("input_tokens") ?? 0
+                    let cached = total.int("cached_input_tokens") ?? total.int("cache_read_input_tokens") ?? 0
+                    let output = total.int("output_tokens") ?? 0
 
                     let prev = previousTotals
                     deltaInput = max(0, input - (prev?.input ?? 0))
                     deltaCached = max(0, cached - (prev?.cached ?? 0))
                     deltaOutput = max(0, output - (prev?.output ?? 0))
                     previousTotals = CostUsageCodexTotals(input: input, cached: cached, output: output)
-                } else if let last {
-                    deltaInput = max(0, toInt(last["input_tokens"]))
-                    deltaCached = max(0, toInt(last["cached_input_tokens"] ?? last["cache_read_input_tokens"]))
-                    deltaOutput = max(0, toInt(last["output_tokens"]))
+                } else if let last = info?.object("last_token_usage") {
+                    deltaInput = max(0, last.int("input_tokens") ?? 0)
+                    deltaCached = max(0, last.int("cached_input_tokens") ?? last.int("cache_read_input_tokens") ?? 0)
+                    deltaOutput = max(0, last.int("output_tokens") ?? 0)
                 } else {
                     return
                 }
@@ -254,7 +247,7 @@ enum CostUsageScanner {
         now: Date,
         options: Options
     ) -> UsageDailyReport {
-        let cache = CostUsageCacheIO.load(provider: .codex, cacheRoot: options.cacheRoot)
+        var cache = CostUsageCacheIO.load(provider: .codex, cacheRoot: options.cacheRoot)
         let nowMs = Int64(now.timeIntervalSince1970 * 1000)
         let minInterval = Int64(max(1, options.refreshMinIntervalSeconds) * 1000)
         if nowMs - cache.lastScanUnixMs < minInterval {
@@ -267,45 +260,19 @@ enum CostUsageScanner {
             scanSinceKey: range.scanSinceKey,
             scanUntilKey: range.scanUntilKey)
 
-        var mutable = cache
-        for file in files {
-            let path = file.path
-            guard let attrs = try? FileManager.default.attributesOfItem(atPath: path) else { continue }
-            let mtime = (attrs[.modificationDate] as? Date)?.timeIntervalSince1970 ?? 0
-            let size = (attrs[.size] as? NSNumber)?.int64Value ?? 0
-            let mtimeMs = Int64(mtime * 1000)
-
-            if let existing = mutable.files[path],
-               existing.mtimeUnixMs == mtimeMs,
-               existing.size == size {
-                continue
-            }
-
-            let existing = mutable.files[path]
-            let startOffset = existing?.parsedBytes ?? 0
+        Self.scanChangedFiles(files, cache: &cache) { file, previous in
             let parsed = Self.parseCodexFile(
                 fileURL: file,
                 range: range,
-                startOffset: startOffset,
-                initialModel: existing?.lastModel,
-                initialTotals: existing?.lastTotals)
-
-            let usage = CostUsageFileUsage(
-                mtimeUnixMs: mtimeMs,
-                size: size,
-                days: parsed.days,
-                parsedBytes: parsed.parsedBytes,
-                lastModel: parsed.lastModel,
-                lastTotals: parsed.lastTotals)
-            mutable.files[path] = usage
-
-            let fileDays = usage.days
-            mutable.days = Self.applyFileDays(cache: mutable.days, fileDays: fileDays, sign: 1)
+                startOffset: previous?.parsedBytes ?? 0,
+                initialModel: previous?.lastModel,
+                initialTotals: previous?.lastTotals)
+            return (parsed.days, parsed.parsedBytes, parsed.lastModel, parsed.lastTotals)
         }
 
-        mutable.lastScanUnixMs = nowMs
-        CostUsageCacheIO.save(provider: .codex, cache: mutable, cacheRoot: options.cacheRoot)
-        return self.buildCodexReportFromCache(cache: mutable, range: range)
+        cache.lastScanUnixMs = nowMs
+        CostUsageCacheIO.save(provider: .codex, cache: &cache, cacheRoot: options.cacheRoot)
+        return self.buildCodexReportFromCache(cache: cache, range: range)
     }
 
     private static func buildCodexReportFromCache(
@@ -443,27 +410,21 @@ enum CostUsageScanner {
                 guard line.bytes.containsAscii(#""usage""#) else { return }
 
                 guard
-                    let obj = (try? JSONSerialization.jsonObject(with: line.bytes)) as? [String: Any],
-                    let type = obj["type"] as? String,
-                    type == "assistant"
+                    let obj = CostUsageJsonObject(line.bytes),
+                    obj.has("type", string: "assistant")
                 else { return }
 
-                guard let tsText = obj["timestamp"] as? String else { return }
+                guard let tsText = obj.string("timestamp") else { return }
                 guard let dayKey = Self.dayKeyFromTimestamp(tsText) ?? Self.dayKeyFromParsedISO(tsText) else { return }
 
-                guard let message = obj["message"] as? [String: Any] else { return }
-                guard let model = message["model"] as? String else { return }
-                guard let usage = message["usage"] as? [String: Any] else { return }
+                guard let message = obj.object("message") else { return }
+                guard let model = message.string("model") else { return }
+                guard let usage = message.object("usage") else { return }
 
-                func toInt(_ v: Any?) -> Int {
-                    if let n = v as? NSNumber { return n.intValue }
-                    return 0
-                }
-
-                let input = max(0, toInt(usage["input_tokens"]))
-                let cacheCreate = max(0, toInt(usage["cache_creation_input_tokens"]))
-                let cacheRead = max(0, toInt(usage["cache_read_input_tokens"]))
-                let output = max(0, toInt(usage["output_tokens"]))
+                let input = max(0, usage.int("input_tokens") ?? 0)
+                let cacheCreate = max(0, usage.int("cache_creation_input_tokens") ?? 0)
+                let cacheRead = max(0, usage.int("cache_read_input_tokens") ?? 0)
+                let output = max(0, usage.int("output_tokens") ?? 0)
                 if input == 0, cacheCreate == 0, cacheRead == 0, output == 0 { return }
 
                 let tokens = ClaudeTokens(input: input, cacheRead: cacheRead, cacheCreate: cacheCreate, output: output)
@@ -473,76 +434,31 @@ enum CostUsageScanner {
         return ClaudeParseResult(days: days, parsedBytes: parsedBytes)
     }
 
-    private final class ClaudeScanState {
-        var cache: CostUsageCache
-        var processedFiles: Set<String> = []
-
-        init(cache: CostUsageCache) {
-            self.cache = cache
-        }
-    }
-
-    private static func processClaudeFile(
-        url: URL,
-        range: CostUsageDayRange,
-        state: ClaudeScanState
-    ) {
-        let path = url.path
-        guard state.processedFiles.contains(path) == false else { return }
-        state.processedFiles.insert(path)
-
-        guard let attrs = try? FileManager.default.attributesOfItem(atPath: path) else { return }
-        let mtime = (attrs[.modificationDate] as? Date)?.timeIntervalSince1970 ?? 0
-        let size = (attrs[.size] as? NSNumber)?.int64Value ?? 0
-        let mtimeMs = Int64(mtime * 1000)
-
-        if let existing = state.cache.files[path],
-           existing.mtimeUnixMs == mtimeMs,
-           existing.size == size {
-            return
-        }
-
-        let existing = state.cache.files[path]
-        let startOffset = existing?.parsedBytes ?? 0
-        let parsed = Self.parseClaudeFile(fileURL: url, range: range, startOffset: startOffset)
-        let usage = CostUsageFileUsage(
-            mtimeUnixMs: mtimeMs,
-            size: size,
-            days: parsed.days,
-            parsedBytes: parsed.parsedBytes,
-            lastModel: nil,
-            lastTotals: nil)
-        state.cache.files[path] = usage
-        state.cache.days = Self.applyFileDays(cache: state.cache.days, fileDays: usage.days, sign: 1)
-    }
-
-    private static func scanClaudeRoot(
-        root: URL,
-        range: CostUsageDayRange,
-        state: ClaudeScanState
-    ) {
+    private static func listClaudeProjectFiles(roots: [URL]) -> [URL] {
         let fm = FileManager.default
-        guard let items = try? fm.contentsOfDirectory(
-            at: root,
-            includingPropertiesForKeys: [.isDirectoryKey],
-            options: [.skipsHiddenFiles])
-        else { return }
-
-        for item in items {
-            let path = item.path
-            if state.processedFiles.contains(path) { continue }
-            guard let attrs = try? fm.attributesOfItem(atPath: path) else { continue }
-            let isDir = (attrs[.type] as? FileAttributeType) == .typeDirectory
-            if !isDir { continue }
-
-            // Scan all jsonl files under this project directory
-            if let subItems = try? fm.subpathsOfDirectory(atPath: path) {
+        var seen: Set<String> = []
+        var out: [URL] = []
+
+        for root in roots {
+            guard let items = try? fm.contentsOfDirectory(
+                at: root,
+                includingPropertiesForKeys: [.isDirectoryKey],
+                options: [.skipsHiddenFiles])
+            else { continue }
+
+            for item in items where (try? item.resourceValues(forKeys: [.isDirectoryKey]))?.isDirectory == true {
+                // Scan all jsonl files under this project directory
+                guard let subItems = try? fm.subpathsOfDirectory(atPath: item.path) else { continue }
                 for subPath in subItems where subPath.hasSuffix(".jsonl") {
-                    let url = URL(fileURLWithPath: path).appendingPathComponent(subPath)
-                    Self.processClaudeFile(url: url, range: range, state: state)
+                    let url = item.appendingPathComponent(subPath)
+                    if seen.insert(url.path).inserted {
+                        out.append(url)
+                    }
                 }
             }
         }
+
+        return out
     }
 
     private static func loadClaudeDaily(
@@ -550,7 +466,7 @@ enum CostUsageScanner {
         now: Date,
         options: Options
     ) -> UsageDailyReport {
-        let cache = CostUsageCacheIO.load(provider: .claude, cacheRoot: options.cacheRoot)
+        var cache = CostUsageCacheIO.load(provider: .claude, cacheRoot: options.cacheRoot)
         let nowMs = Int64(now.timeIntervalSince1970 * 1000)
         let minInterval = Int64(max(1, options.refreshMinIntervalSeconds) * 1000)
         if nowMs - cache.lastScanUnixMs < minInterval {
@@ -558,17 +474,16 @@ enum CostUsageScanner {
         }
 
         let roots = self.defaultClaudeProjectsRoots(options: options)
-        var mutable = cache
-        let scanState = ClaudeScanState(cache: mutable)
+        let files = self.listClaudeProjectFiles(roots: roots)
 
-        for root in roots {
-            Self.scanClaudeRoot(root: root, range: range, state: scanState)
+        Self.scanChangedFiles(files, cache: &cache) { file, previous in
+            let parsed = Self.parseClaudeFile(fileURL: file, range: range, startOffset: previous?.parsedBytes ?? 0)
+            return (parsed.days, parsed.parsedBytes, nil, nil)
         }
 
-        mutable = scanState.cache
-        mutable.lastScanUnixMs = nowMs
-        CostUsageCacheIO.save(provider: .claude, cache: mutable, cacheRoot: options.cacheRoot)
-        return self.buildClaudeReportFromCache(cache: mutable, range: range)
+        cache.lastScanUnixMs = nowMs
+        CostUsageCacheIO.save(provider: .claude, cache: &cache, cacheRoot: options.cacheRoot)
+        return self.buildClaudeReportFromCache(cache: cache, range: range)
     }
 
     private static func buildClaudeReportFromCache(
@@ -636,33 +551,58 @@ enum CostUsageScanner {
         return UsageDailyReport(data: entries, summary: summary)
     }
 
-    // MARK: - Cache helpers
-
-    private static func applyFileDays(
-        cache: [String: [String: [Int]]],
-        fileDays: [String: [String: [Int]]],
-        sign: Int
-    ) -> [String: [String: [Int]]] {
-        var out = cache
-        for (dayKey, models) in fileDays {
-            var outModels = out[dayKey] ?? [:]
-            for (model, packed) in models {
-                let existing = outModels[model] ?? []
-                outModels[model] = Self.mergePacked(existing, packed, sign: sign)
+    // MARK: - File scanning
+
+    private typealias FileParse = (
+        days: [String: [String: [Int]]],
+        parsedBytes: Int64,
+        lastModel: String?,
+        lastTotals: CostUsageCodexTotals?
+    )
+
+    /// Stat `files` and parse the ones that changed since the cache saw them, in parallel,
+    /// then record the results in file order. `parse` resumes from `previous` when given and
+    /// must be safe to call concurrently.
+    private static func scanChangedFiles(
+        _ files: [URL],
+        cache: inout CostUsageCache,
+        parse: (URL, _ previous: CostUsageFileUsage?) -> FileParse
+    ) {
+        guard !files.isEmpty else { return }
+        let known = cache.files
+        var results = [(usage: CostUsageFileUsage, restarted: Bool)?](repeating: nil, count: files.count)
+
+        results.withUnsafeMutableBufferPointer { slots in
+            DispatchQueue.concurrentPerform(iterations: files.count) { index in
+                let path = files[index].path
+                var info = stat()
+                guard stat(path, &info) == 0, (info.st_mode & S_IFMT) == S_IFREG else { return }
+                let size = Int64(info.st_size)
+                let mtimeMs = Int64(info.st_mtimespec.tv_sec) * 1000 + Int64(info.st_mtimespec.tv_nsec) / 1_000_000
+
+                let existing = known[path]
+                if let existing, existing.mtimeUnixMs == mtimeMs, existing.size == size {
+                    return
+                }
+
+                // A log smaller than what was parsed was rewritten; parse it again from the start
+                let restarted = existing.map { size < $0.parsedBytes } ?? false
+                let parsed = parse(files[index], restarted ? nil : existing)
+                let usage = CostUsageFileUsage(
+                    mtimeUnixMs: mtimeMs,
+                    size: size,
+                    days: parsed.days,
+                    parsedBytes: parsed.parsedBytes,
+                    lastModel: parsed.lastModel,
+                    lastTotals: parsed.lastTotals)
+                slots[index] = (usage, restarted)
             }
-            out[dayKey] = outModels
         }
-        return out
-    }
 
-    private static func mergePacked(_ a: [Int], _ b: [Int], sign: Int) -> [Int] {
-        let count = max(a.count, b.count)
-        var out = Array(repeating: 0, count: count)
-        for idx in 0..<count {
-            let next = (a[safe: idx] ?? 0) + sign * (b[safe: idx] ?? 0)
-            out[idx] = max(0, next)
+        for (file, result) in zip(files, results) {
+            guard let result else { continue }
+            cache.update(path: file.path, usage: result.usage, restarted: result.restarted)
         }
-        return out
     }
 
     // MARK: - Date parsing
@@ -687,10 +627,10 @@ enum CostUsageScanner {
     }
 }
 
-extension Data {
-    fileprivate func containsAscii(_ needle: String) -> Bool {
-        guard let n = needle.data(using: .utf8) else { return false }
-        return self.range(of: n) != nil
+extension UnsafeRawBufferPointer {
+    fileprivate func containsAscii(_ needle: StaticString) -> Bool {
+        guard let base = baseAddress, count >= needle.utf8CodeUnitCount else { return false }
+        return memmem(base, count, needle.utf8Start, needle.utf8CodeUnitCount) != nil
     }
 }
 
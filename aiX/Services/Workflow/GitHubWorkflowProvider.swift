@@ -5,6 +5,7 @@
 //  GitHub Actions workflow provider using gh CLI
 //
 
+import CryptoKit
 import Foundation
 import os.log
 
@@ -14,6 +15,21 @@ actor GitHubWorkflowProvider: WorkflowProviderProtocol {
     private let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "win.aiX", category: "GitHubWorkflow")
     private let ghPath: String
 
+    private struct CachedJobLog {
+        // Whole log, kept only once the job has finished so later tails don't refetch it
+        let data: Data?
+        // Digest of the bytes handed out so far, to check that a refetched log continues them
+        let readLength: Int
+        let readDigest: SHA256.Digest
+    }
+
+    // Per job, most recently used last; finished logs are held within a byte budget
+    private var jobLogs: [String: CachedJobLog] = [:]
+    private var jobLogOrder: [String] = []
+    private var cachedLogBytes = 0
+    private static let maxCachedJobLogs = 32
+    private static let maxCachedLogBytes = 16 * 1024 * 1024
+
     init() {
         // Find gh binary
         if FileManager.default.fileExists(atPath: "/opt/homebrew/bin/gh") {
@@ -210,12 +226,74 @@ actor GitHubWorkflowProvider: WorkflowProviderProtocol {
         return formatter
     }()
 
-    func getStructuredLogs(repoPath: String, runId: String, jobId: String, steps: [WorkflowStep]) async throws -> WorkflowLogs {
-        // Use gh api to get raw logs for the job
-        // Note: This only works after job completion - returns 404 for in-progress jobs
-        let result = try await executeGH(["api", "repos/{owner}/{repo}/actions/jobs/\(jobId)/logs"], workingDirectory: repoPath)
-        let rawLogs = result.stdout
+    func getLogTail(repoPath: String, runId: String, job: WorkflowJob, offset: Int, firstLineId: Int) async throws -> WorkflowLogTail {
+        let jobFinished = job.status == .completed
+        let previous = jobLogs[job.id]
+
+        let log: Data
+        let isCached: Bool
+        if let data = previous?.data {
+            // A finished job's log doesn't change; serve later tails from the cache
+            log = data
+            isCached = true
+        } else {
+            // Note: This only works after job completion - returns 404 for in-progress jobs.
+            // The endpoint redirects to the whole log file and can't serve a byte range, so
+            // the log is downloaded whole; once the job has finished it comes from the cache.
+            logger.debug("Fetching log for job \(job.id)")
+            log = try await readOutput(
+                ghPath,
+                arguments: ["api", "repos/{owner}/{repo}/actions/jobs/\(job.id)/logs"],
+                environment: ShellEnvironment.loadUserShellEnvironment(),
+                workingDirectory: repoPath
+            )
+            isCached = false
+        }
+
+        // Start over if the log no longer begins with what was read from it before
+        var isReset = offset > log.count
+        var hasher = SHA256()
+        if !isReset && offset > 0 && !isCached {
+            hasher.update(data: log.prefix(offset))
+            isReset = !(previous.map { $0.readLength == offset && $0.readDigest == hasher.finalize() } ?? false)
+        }
+
+        let start = isReset ? 0 : offset
+        let (text, end) = completeLines(of: log, from: start, jobFinished: jobFinished)
+        if !isCached {
+            if isReset { hasher = SHA256() }
+            hasher.update(data: log[start..<end])
+            cacheJobLog(jobId: job.id, data: jobFinished ? log : nil, readLength: end, readDigest: hasher.finalize())
+        }
+        return WorkflowLogTail(
+            text: text,
+            lines: parseLogLines(text, firstLineId: isReset ? 0 : firstLineId, steps: job.steps),
+            nextOffset: end,
+            isReset: isReset
+        )
+    }
+
+    private func cacheJobLog(jobId: String, data: Data?, readLength: Int, readDigest: SHA256.Digest) {
+        removeCachedJobLog(jobId)
+        // A log larger than the whole budget is refetched instead of evicting everything else
+        let kept = data.flatMap { $0.count <= Self.maxCachedLogBytes ? $0 : nil }
+        jobLogOrder.append(jobId)
+        jobLogs[jobId] = CachedJobLog(data: kept, readLength: readLength, readDigest: readDigest)
+        cachedLogBytes += kept?.count ?? 0
+
+        while jobLogOrder.count > Self.maxCachedJobLogs || cachedLogBytes > Self.maxCachedLogBytes {
+            removeCachedJobLog(jobLogOrder[0])
+        }
+    }
 
+    private func removeCachedJobLog(_ jobId: String) {
+        guard let removed = jobLogs.removeValue(forKey: jobId) else { return }
+        jobLogOrder.removeAll { $0 == jobId }
+        cachedLogBytes -= removed.data?.count ?? 0
+    }
+
+    /// Log lines with the step each belongs to, numbered from `firstLineId`
+    private func parseLogLines(_ rawLogs: String, firstLineId: Int, steps: [WorkflowStep]) -> [WorkflowLogLine] {
         // Sort steps by start time (descending) for proper matching
         let sortedSteps = steps.sorted { step1, step2 in
             guard let start1 = step1.startedAt, let start2 = step2.startedAt else {
@@ -226,10 +304,10 @@ actor GitHubWorkflowProvider: WorkflowProviderProtocol {
 
         // Parse log lines and correlate with steps
         var logLines: [WorkflowLogLine] = []
-        logLines.reserveCapacity(rawLogs.count / 80)
+        logLines.reserveCapacity(rawLogs.utf8.count / 80)
 
         let lines = rawLogs.components(separatedBy: .newlines)
-        var lineIndex = 0
+        var lineIndex = firstLineId
 
         for line in lines {
             guard !line.isEmpty else { continue }
@@ -303,13 +381,7 @@ actor GitHubWorkflowProvider: WorkflowProviderProtocol {
             lineIndex += 1
         }
 
-        return WorkflowLogs(
-            runId: runId,
-            jobId: jobId,
-            lines: logLines,
-            rawContent: rawLogs,
-            lastUpdated: Date()
-        )
+        return logLines
     }
 
     // MARK: - Auth
@@ -196,26 +196,58 @@ actor GitLabWorkflowProvider: WorkflowProviderProtocol {
         }
     }
 
-    func getStructuredLogs(repoPath: String, runId: String, jobId: String, steps: [WorkflowStep]) async throws -> WorkflowLogs {
-        // GitLab doesn't have steps like GitHub, so just return the job trace as a single block
-        let result = try await executeGLab(["api", "projects/:id/jobs/\(jobId)/trace"], workingDirectory: repoPath)
-        let rawLogs = result.stdout
-
-        let lines = rawLogs.components(separatedBy: .newlines).enumerated().map { index, line in
-            WorkflowLogLine(
-                id: index,
-                stepName: "Job Output",
-                content: line
-            )
+    func getLogTail(repoPath: String, runId: String, job: WorkflowJob, offset: Int, firstLineId: Int) async throws -> WorkflowLogTail {
+        let jobFinished = job.status == .completed
+        let tracePath = "projects/:id/jobs/\(job.id)/trace"
+        let env = ShellEnvironment.loadUserShellEnvironment()
+
+        if offset > 0 {
+            // Ask for the trace from one byte early: that byte is the line break the last tail
+            // ended on, so an unchanged trace is still a valid range and a replaced one shows up
+            do {
+                let response = try await readOutput(
+                    glabPath,
+                    arguments: ["api", tracePath, "--include", "--header", "Range: bytes=\(offset - 1)-"],
+                    environment: env,
+                    workingDirectory: repoPath
+                )
+
+                if let http = Self.splitHTTPResponse(response), http.status == 206 || http.status == 200 {
+                    // 206 when the range was honored; 200 is the whole trace
+                    let bodyStart = http.status == 206 ? offset - 1 : 0
+                    let breakIndex = offset - 1 - bodyStart
+                    if breakIndex < http.body.count, http.body[breakIndex] == 0x0A {
+                        let (text, end) = completeLines(of: http.body, from: breakIndex + 1, jobFinished: jobFinished)
+                        return WorkflowLogTail(text: text, lines: [], nextOffset: bodyStart + end, isReset: false)
+                    }
+                    logger.debug("Trace for job \(job.id) doesn't continue at \(offset), reloading it")
+                } else {
+                    logger.error("Unexpected response to trace range request for job \(job.id), reloading the whole trace")
+                }
+            } catch {
+                logger.error("Trace range request for job \(job.id) failed, reloading the whole trace: \(error.localizedDescription)")
+            }
         }
 
-        return WorkflowLogs(
-            runId: runId,
-            jobId: jobId,
-            lines: lines,
-            rawContent: rawLogs,
-            lastUpdated: Date()
-        )
+        let trace = try await readOutput(glabPath, arguments: ["api", tracePath], environment: env, workingDirectory: repoPath)
+        let (text, end) = completeLines(of: trace, from: 0, jobFinished: jobFinished)
+        // GitLab jobs have no steps; the log view reads sections from the text itself
+        return WorkflowLogTail(text: text, lines: [], nextOffset: end, isReset: offset > 0)
+    }
+
+    /// Status code and body of `glab api --include` output
+    private static func splitHTTPResponse(_ response: Data) -> (status: Int, body: Data)? {
+        guard let headerEnd = response.range(of: Data("\r\n\r\n".utf8))
+                ?? response.range(of: Data("\n\n".utf8)),
+              let statusLineEnd = response.firstIndex(of: 0x0A) else {
+            return nil
+        }
+
+        // e.g. "HTTP/1.1 206 Partial Content"
+        let statusLine = String(decoding: response[..<statusLineEnd], as: UTF8.self)
+        let fields = statusLine.split(separator: " ")
+        guard fields.count >= 2, let status = Int(fields[1]) else { return nil }
+        return (status, Data(response[headerEnd.upperBound...]))
     }
 
     // MARK: - Auth
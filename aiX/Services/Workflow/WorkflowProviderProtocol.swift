@@ -25,7 +25,7 @@ protocol WorkflowProviderProtocol {
 
     // Logs
     func getRunLogs(repoPath: String, runId: String, jobId: String?) async throws -> String
-    func getStructuredLogs(repoPath: String, runId: String, jobId: String, steps: [WorkflowStep]) async throws -> WorkflowLogs
+    func getLogTail(repoPath: String, runId: String, job: WorkflowJob, offset: Int, firstLineId: Int) async throws -> WorkflowLogTail
 
     // Auth
     func checkAuthentication() async -> Bool
@@ -42,6 +42,45 @@ extension WorkflowProviderProtocol {
         )
     }
 
+    /// Run a command and collect its stdout as bytes
+    func readOutput(
+        _ executable: String,
+        arguments: [String],
+        environment: [String: String]? = nil,
+        workingDirectory: String
+    ) async throws -> Data {
+        let output = try await ProcessExecutor.shared.executeOutputStream(
+            executable: executable,
+            arguments: arguments,
+            environment: environment,
+            workingDirectory: workingDirectory
+        )
+
+        var data = Data()
+        for await chunk in output {
+            data.append(chunk)
+        }
+
+        if await output.waitForExit() != 0 {
+            throw WorkflowError.executionFailed(output.stderr)
+        }
+        return data
+    }
+
+    /// The lines of `log` from `offset` on, and the offset past them. A last line without a
+    /// line break may still be being written, so it's left for the next tail unless the job
+    /// has finished.
+    func completeLines(of log: Data, from offset: Int, jobFinished: Bool) -> (text: String, end: Int) {
+        guard offset < log.count else { return ("", offset) }
+
+        var end = log.count
+        if !jobFinished {
+            guard let newline = log[offset...].lastIndex(of: 0x0A) else { return ("", offset) }
+            end = newline + 1
+        }
+        return (String(decoding: log[offset..<end], as: UTF8.self), end)
+    }
+
     func parseJSON<T: Decodable>(_ data: Data, as type: T.Type) throws -> T {
         let decoder = JSONDecoder()
         decoder.keyDecodingStrategy = .convertFromSnakeCase
@@ -24,10 +24,12 @@ class WorkflowService: ObservableObject {
     @Published var selectedRun: WorkflowRun?
     @Published var selectedRunJobs: [WorkflowJob] = []
     @Published var runLogs: String = ""
-    @Published var structuredLogs: WorkflowLogs?
+    @Published var jobLogs: WorkflowLogs?
     @Published var isLoadingLogs: Bool = false
 
     private var currentLogJobId: String?
+    // Job whose log tail is shown and where its next tail starts
+    private var logTail: (jobId: String, offset: Int)?
 
     @Published var cliAvailability: CLIAvailability?
 
@@ -158,7 +160,9 @@ class WorkflowService: ObservableObject {
         selectedRun = run
         selectedRunJobs = []
         runLogs = ""
+        jobLogs = nil
         currentLogJobId = nil
+        logTail = nil
         stopLogPolling()
 
         // Capture values for background tasks
@@ -198,8 +202,9 @@ class WorkflowService: ObservableObject {
         selectedRun = nil
         selectedRunJobs = []
         runLogs = ""
-        structuredLogs = nil
+        jobLogs = nil
         currentLogJobId = nil
+        logTail = nil
         stopLogPolling()
     }
 
@@ -261,7 +266,8 @@ class WorkflowService: ObservableObject {
         // Optimistically update the UI to show cancelling state
         if selectedRun?.id == run.id {
             runLogs = "Cancelling workflow run...\n\nThis may take a moment."
-            structuredLogs = nil
+            jobLogs = nil
+            logTail = nil
         }
 
         isLoading = true
@@ -297,6 +303,7 @@ class WorkflowService: ObservableObject {
                 }
 
                 runLogs = "Workflow run cancelled."
+                jobLogs = nil
             }
 
             // Refresh in background to get actual status
@@ -319,10 +326,12 @@ class WorkflowService: ObservableObject {
             error = workflowError
             logger.error("Failed to cancel run: \(workflowError.localizedDescription)")
             runLogs = "Failed to cancel: \(workflowError.localizedDescription)"
+            jobLogs = nil
         } catch {
             self.error = .executionFailed(error.localizedDescription)
             logger.error("Failed to cancel run: \(error.localizedDescription)")
             runLogs = "Failed to cancel."
+            jobLogs = nil
         }
 
         isLoading = false
@@ -333,13 +342,14 @@ class WorkflowService: ObservableObject {
 
     func loadLogs(runId: String, jobId: String? = nil) async {
         // Skip reload if same job logs already loaded
-        if let jobId = jobId, jobId == currentLogJobId, !runLogs.isEmpty {
+        if let jobId = jobId, jobId == currentLogJobId, !runLogs.isEmpty || jobLogs != nil {
             return
         }
 
         isLoadingLogs = true
         currentLogJobId = jobId
-        structuredLogs = nil
+        jobLogs = nil
+        logTail = nil
 
         // Capture values for background task
         let providerImpl = currentProvider
@@ -353,34 +363,34 @@ class WorkflowService: ObservableObject {
             if let jobId = jobId, let job = jobs.first(where: { $0.id == jobId }) {
                 if job.status == .queued || job.status == .waiting || job.status == .pending {
                     runLogs = "Waiting for job to start...\n\nLogs will be available when the job completes."
+                    jobLogs = nil
                     isLoadingLogs = false
                     return
                 }
                 if job.status == .inProgress || job.conclusion == nil {
                     runLogs = "Job is running...\n\nLogs will be available when the job completes."
+                    jobLogs = nil
                     isLoadingLogs = false
                     return
                 }
             } else if selectedRun?.isInProgress == true {
                 // No job found but run is in progress
                 runLogs = "Workflow is running...\n\nLogs will be available when jobs complete."
+                jobLogs = nil
                 isLoadingLogs = false
                 return
             }
         }
 
         do {
-            // Try to get structured logs if we have a job ID and steps
-            if let jobId = jobId,
-               let job = jobs.first(where: { $0.id == jobId }),
-               !job.steps.isEmpty {
-                let structured = try await Task.detached {
-                    try await providerImpl?.getStructuredLogs(repoPath: path, runId: runId, jobId: jobId, steps: job.steps)
+            // A job's log is read as a tail from its start, so polling can continue from there
+            if let jobId = jobId, let job = jobs.first(where: { $0.id == jobId }) {
+                let tail = try await Task.detached {
+                    try await providerImpl?.getLogTail(repoPath: path, runId: runId, job: job, offset: 0, firstLineId: 0)
                 }.value
 
-                if let structured = structured {
-                    structuredLogs = structured
-                    runLogs = structured.rawContent
+                if let tail = tail {
+                    showLogTail(tail, runId: runId, job: job)
                     isLoadingLogs = false
                     return
                 }
@@ -392,9 +402,11 @@ class WorkflowService: ObservableObject {
             }.value
             logger.debug("Loaded plain text logs, length: \(logs.count)")
             runLogs = logs.isEmpty ? "No logs available for this job." : logs
+            jobLogs = nil
         } catch {
             logger.error("Failed to load logs: \(error.localizedDescription)")
             runLogs = "Failed to load logs: \(error.localizedDescription)"
+            jobLogs = nil
         }
 
         isLoadingLogs = false
@@ -405,7 +417,8 @@ class WorkflowService: ObservableObject {
         await loadLogs(runId: run.id)
     }
 
-    /// Load logs during polling - only fetches for completed jobs (GitHub) or any status (GitLab)
+    /// Load logs during polling - only fetches for completed jobs (GitHub) or any status (GitLab).
+    /// Only the part of the log added since the last poll is fetched and shown.
     private func loadLogsForPolling(runId: String, jobId: String) async {
         // Capture values for background task
         let providerImpl = currentProvider
@@ -413,6 +426,7 @@ class WorkflowService: ObservableObject {
         let path = repoPath
         let jobs = selectedRunJobs
         let currentContent = runLogs
+        let currentLogs = jobLogs
 
         // Check job status - GitHub logs only available after completion
         // GitLab provides streaming logs, so skip this check for GitLab
@@ -421,21 +435,24 @@ class WorkflowService: ObservableObject {
                 if job.status == .queued || job.status == .waiting || job.status == .pending {
                     if !runLogs.contains("Waiting for job") {
                         runLogs = "Waiting for job to start...\n\nLogs will be available when the job completes."
-                        structuredLogs = nil
+                        jobLogs = nil
+                        logTail = nil
                     }
                     return
                 }
                 if job.status == .inProgress || job.conclusion == nil {
                     if !runLogs.contains("Job is running") {
                         runLogs = "Job is running...\n\nLogs will be available when the job completes."
-                        structuredLogs = nil
+                        jobLogs = nil
+                        logTail = nil
                     }
                     return
                 }
             } else if selectedRun?.isInProgress == true {
                 if !runLogs.contains("Workflow is running") {
                     runLogs = "Workflow is running...\n\nLogs will be available when jobs complete."
-                    structuredLogs = nil
+                    jobLogs = nil
+                    logTail = nil
                 }
                 return
             }
@@ -443,19 +460,20 @@ class WorkflowService: ObservableObject {
 
         // Fetch logs
         do {
-            if let job = jobs.first(where: { $0.id == jobId }), !job.steps.isEmpty {
-                let structured = try await Task.detached {
-                    try await providerImpl?.getStructuredLogs(repoPath: path, runId: runId, jobId: jobId, steps: job.steps)
+            if let job = jobs.first(where: { $0.id == jobId }) {
+                let continued = logTail?.jobId == jobId ? logTail : nil
+                let offset = continued?.offset ?? 0
+                let firstLineId = continued == nil ? 0 : jobLogs?.lineCount ?? 0
+                let tail = try await Task.detached {
+                    try await providerImpl?.getLogTail(repoPath: path, runId: runId, job: job, offset: offset, firstLineId: firstLineId)
                 }.value
 
-                if let structured = structured {
-                    if structured.rawContent != currentContent {
-                        structuredLogs = structured
-                        runLogs = structured.rawContent
-                        currentLogJobId = jobId
-                    }
-                    return
+                // Shown logs changed while fetching; the tail no longer applies
+                if let tail = tail, runLogs == currentContent,
+                   jobLogs?.buffer === currentLogs?.buffer, jobLogs?.chunkCount == currentLogs?.chunkCount {
+                    showLogTail(tail, runId: runId, job: job)
                 }
+                return
             }
 
             // Fallback to plain text logs
@@ -465,7 +483,8 @@ class WorkflowService: ObservableObject {
 
             if logs != currentContent {
                 runLogs = logs
-                structuredLogs = nil
+                jobLogs = nil
+                logTail = nil
             }
         } catch {
             // Error fetching completed job logs
@@ -473,6 +492,32 @@ class WorkflowService: ObservableObject {
         }
     }
 
+    /// Show a job's log tail: appended in place to the log shown for the job, or in its place
+    /// when the tail starts over or the job's log isn't shown yet
+    private func showLogTail(_ tail: WorkflowLogTail, runId: String, job: WorkflowJob) {
+        let continues = !tail.isReset && logTail?.jobId == job.id
+        currentLogJobId = job.id
+
+        if continues, let current = jobLogs {
+            logTail = (job.id, tail.nextOffset)
+            guard !tail.text.isEmpty else { return }
+            jobLogs = current.appending(tail)
+            return
+        }
+
+        guard !tail.text.isEmpty else {
+            runLogs = "No logs available for this job."
+            jobLogs = nil
+            logTail = nil
+            return
+        }
+
+        logTail = (job.id, tail.nextOffset)
+        runLogs = ""
+        // Jobs without steps (GitLab) show the plain text, which carries its own sections
+        jobLogs = WorkflowLogs(runId: runId, jobId: job.id, hasSteps: !job.steps.isEmpty, tail: tail)
+    }
+
     // MARK: - Auto Refresh
 
     private func startAutoRefresh() {
@@ -244,14 +244,100 @@ struct WorkflowLogLine: Identifiable, Hashable, Sendable {
     }
 }
 
+/// A job's log as shown at one point. The content lives in a grow-only `WorkflowLogBuffer`
+/// that later tails are appended to in place; a value only sees the content up to its own
+/// counts, so it stays valid while the log grows.
 struct WorkflowLogs: Sendable {
     let runId: String
     let jobId: String?
-    let lines: [WorkflowLogLine]
-    let rawContent: String
+    /// Whether the log also comes parsed into `lines` (jobs with steps)
+    let hasSteps: Bool
+    let buffer: WorkflowLogBuffer
+    let chunkCount: Int
+    let lineCount: Int
+    let byteCount: Int
     let lastUpdated: Date
 
-    var content: String { rawContent }
+    init(runId: String, jobId: String?, hasSteps: Bool, tail: WorkflowLogTail) {
+        let buffer = WorkflowLogBuffer()
+        buffer.append(tail)
+        self.init(runId: runId, jobId: jobId, hasSteps: hasSteps, buffer: buffer)
+    }
+
+    private init(runId: String, jobId: String?, hasSteps: Bool, buffer: WorkflowLogBuffer) {
+        self.runId = runId
+        self.jobId = jobId
+        self.hasSteps = hasSteps
+        self.buffer = buffer
+        let counts = buffer.counts
+        self.chunkCount = counts.chunks
+        self.lineCount = counts.lines
+        self.byteCount = counts.bytes
+        self.lastUpdated = Date()
+    }
+
+    /// Text in the order it arrived, one chunk per tail, each ending on a whole line
+    var chunks: ArraySlice<String> { buffer.chunks(upTo: chunkCount) }
+
+    var lines: ArraySlice<WorkflowLogLine> { buffer.lines(upTo: lineCount) }
+
+    /// The whole text, copied out of the buffer
+    var content: String { chunks.joined() }
+
+    /// Append a tail to the buffer in place. Call on the latest value only.
+    func appending(_ tail: WorkflowLogTail) -> WorkflowLogs {
+        buffer.append(tail)
+        return WorkflowLogs(runId: runId, jobId: jobId, hasSteps: hasSteps, buffer: buffer)
+    }
+}
+
+/// Grow-only storage behind `WorkflowLogs`. Appends never copy what is already stored:
+/// text is kept as a list of chunks and lines in one array that only grows.
+final class WorkflowLogBuffer: @unchecked Sendable {
+    private var storedChunks: [String] = []
+    private var storedLines: [WorkflowLogLine] = []
+    private var storedByteCount = 0
+    private let lock = NSLock()
+
+    func append(_ tail: WorkflowLogTail) {
+        lock.lock()
+        defer { lock.unlock() }
+        if !tail.text.isEmpty {
+            storedChunks.append(tail.text)
+            storedByteCount += tail.text.utf8.count
+        }
+        storedLines.append(contentsOf: tail.lines)
+    }
+
+    var counts: (chunks: Int, lines: Int, bytes: Int) {
+        lock.lock()
+        defer { lock.unlock() }
+        return (storedChunks.count, storedLines.count, storedByteCount)
+    }
+
+    func chunks(upTo count: Int) -> ArraySlice<String> {
+        lock.lock()
+        defer { lock.unlock() }
+        return storedChunks[..<count]
+    }
+
+    func lines(upTo count: Int) -> ArraySlice<WorkflowLogLine> {
+        lock.lock()
+        defer { lock.unlock() }
+        return storedLines[..<count]
+    }
+}
+
+/// Log output a job added since an offset into its log
+struct WorkflowLogTail: Sendable {
+    /// Complete lines only; a line still being written comes with the next tail
+    let text: String
+    /// `text` parsed into lines, for providers whose jobs have steps
+    let lines: [WorkflowLogLine]
+    /// Byte offset to ask for the next tail from
+    let nextOffset: Int
+    /// The log no longer continues what was read before, so this tail is the whole log
+    let isReset: Bool
 }
 
 // MARK: - Errors
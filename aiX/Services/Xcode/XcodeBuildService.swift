@@ -11,9 +11,13 @@ import os.log
 actor XcodeBuildService {
     private let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "win.aiX", category: "XcodeBuildService")
 
-    private var currentProcess: Process?
+    private var currentOutput: ProcessOutputStream?
     private var isCancelled = false
 
+    // Only this much of the build log is kept, from the end
+    private static let maxLogBytes = 1 << 20
+    private static let maxDiagnosticLines = 1000
+
     // MARK: - Build and Run
 
     func buildAndRun(
@@ -40,13 +44,9 @@ actor XcodeBuildService {
         continuation: AsyncStream<BuildPhase>.Continuation
     ) async {
         isCancelled = false
-        let startTime = Date()
 
         continuation.yield(.building(progress: nil))
 
-        let process = Process()
-        process.executableURL = URL(fileURLWithPath: "/usr/bin/xcodebuild")
-
         // Build arguments
         var arguments: [String] = []
 
@@ -67,121 +67,75 @@ actor XcodeBuildService {
         // Build action - for simulators, this will also install the app
         arguments.append("build")
 
-        process.arguments = arguments
-
         // Set environment
         var environment = ShellEnvironment.loadUserShellEnvironment()
         environment["NSUnbufferedIO"] = "YES" // Ensure unbuffered output
-        process.environment = environment
-
-        // Set up pipes
-        let stdoutPipe = Pipe()
-        let stderrPipe = Pipe()
-        process.standardOutput = stdoutPipe
-        process.standardError = stderrPipe
-
-        var outputLog = ""
-        var errorLog = ""
-        let outputLock = NSLock()
-
-        // Read stdout
-        stdoutPipe.fileHandleForReading.readabilityHandler = { handle in
-            let data = handle.availableData
-            guard !data.isEmpty else {
-                handle.readabilityHandler = nil
-                return
-            }
-
-            if let output = String(data: data, encoding: .utf8) {
-                outputLock.lock()
-                outputLog += output
-                outputLock.unlock()
 
-                // Parse progress from output
-                let progress = self.parseProgress(from: output)
-                if let progress = progress {
-                    continuation.yield(.building(progress: progress))
-                }
-            }
+        let output: ProcessOutputStream
+        do {
+            output = try await ProcessExecutor.shared.executeOutputStream(
+                executable: "/usr/bin/xcodebuild",
+                arguments: arguments,
+                environment: environment
+            )
+        } catch {
+            logger.error("Failed to start build process: \(error.localizedDescription)")
+            continuation.yield(.failed(error: error.localizedDescription, log: ""))
+            continuation.finish()
+            return
         }
-
-        // Read stderr
-        stderrPipe.fileHandleForReading.readabilityHandler = { handle in
-            let data = handle.availableData
-            guard !data.isEmpty else {
-                handle.readabilityHandler = nil
-                return
+        currentOutput = output
+
+        // Read line by line as xcodebuild writes. Only a tail of the log is kept; diagnostic
+        // lines are collected as they stream so errors from early in a long build survive.
+        var logLines: [String] = []
+        var logStart = 0
+        var logBytes = 0
+        var droppedLines = 0
+        var diagnosticLines: [String] = []
+        var lastProgress: String?
+        for await line in output.lines {
+            logLines.append(line)
+            logBytes += line.utf8.count + 1
+            while logBytes > Self.maxLogBytes, logStart < logLines.count - 1 {
+                logBytes -= logLines[logStart].utf8.count + 1
+                logStart += 1
+                droppedLines += 1
             }
-
-            if let output = String(data: data, encoding: .utf8) {
-                outputLock.lock()
-                errorLog += output
-                outputLock.unlock()
+            if logStart > 1024, logStart * 2 > logLines.count {
+                logLines.removeFirst(logStart)
+                logStart = 0
             }
-        }
-
-        currentProcess = process
 
-        do {
-            try process.run()
-
-            // Use async termination instead of blocking waitUntilExit
-            await withCheckedContinuation { (terminationContinuation: CheckedContinuation<Void, Never>) in
-                process.terminationHandler = { proc in
-                    // Clean up handlers
-                    stdoutPipe.fileHandleForReading.readabilityHandler = nil
-                    stderrPipe.fileHandleForReading.readabilityHandler = nil
-
-                    // Read any remaining data
-                    let remainingStdout = stdoutPipe.fileHandleForReading.readDataToEndOfFile()
-                    let remainingStderr = stderrPipe.fileHandleForReading.readDataToEndOfFile()
-
-                    outputLock.lock()
-                    if let str = String(data: remainingStdout, encoding: .utf8) {
-                        outputLog += str
-                    }
-                    if let str = String(data: remainingStderr, encoding: .utf8) {
-                        errorLog += str
-                    }
-                    let fullLog = outputLog + errorLog
-                    outputLock.unlock()
-
-                    let duration = Date().timeIntervalSince(startTime)
-
-                    if proc.terminationStatus == 0 {
-                        continuation.yield(.succeeded)
-                    } else {
-                        let errors = self.parseBuildErrors(from: fullLog)
-                        let errorSummary = errors.first?.message ?? "Build failed with exit code \(proc.terminationStatus)"
-                        continuation.yield(.failed(error: errorSummary, log: fullLog))
-                    }
-
-                    // Close pipes to release file descriptors
-                    try? stdoutPipe.fileHandleForReading.close()
-                    try? stderrPipe.fileHandleForReading.close()
-
-                    terminationContinuation.resume()
-                }
+            if diagnosticLines.count < Self.maxDiagnosticLines, isDiagnostic(line) {
+                diagnosticLines.append(line)
             }
 
-            // Check if cancelled after waiting
-            if isCancelled {
-                outputLock.lock()
-                let fullLog = outputLog + errorLog
-                outputLock.unlock()
-                continuation.yield(.failed(error: "Build cancelled", log: fullLog))
+            if let progress = parseProgress(fromLine: line), progress != lastProgress {
+                lastProgress = progress
+                continuation.yield(.building(progress: progress))
             }
+        }
 
-        } catch {
-            stdoutPipe.fileHandleForReading.readabilityHandler = nil
-            stderrPipe.fileHandleForReading.readabilityHandler = nil
-            try? stdoutPipe.fileHandleForReading.close()
-            try? stderrPipe.fileHandleForReading.close()
-            logger.error("Failed to start build process: \(error.localizedDescription)")
-            continuation.yield(.failed(error: error.localizedDescription, log: ""))
+        let exitCode = await output.waitForExit()
+        var fullLog = droppedLines > 0 ? "... \(droppedLines) earlier lines omitted ...\n" : ""
+        for line in logLines[logStart...] {
+            fullLog += line
+            fullLog += "\n"
         }
+        fullLog += output.stderr
 
-        currentProcess = nil
+        if isCancelled {
+            continuation.yield(.failed(error: "Build cancelled", log: fullLog))
+        } else if exitCode == 0 {
+            continuation.yield(.succeeded)
+        } else {
+            let errors = parseBuildErrors(from: diagnosticLines.joined(separator: "\n") + "\n" + output.stderr)
+            let errorSummary = errors.first?.message ?? "Build failed with exit code \(exitCode)"
+            continuation.yield(.failed(error: errorSummary, log: fullLog))
+        }
+
+        currentOutput = nil
         continuation.finish()
     }
 
@@ -189,55 +143,51 @@ actor XcodeBuildService {
 
     func cancelBuild() {
         isCancelled = true
-        currentProcess?.terminate()
+        currentOutput?.cancel()
     }
 
     // MARK: - Progress Parsing
 
-    private nonisolated func parseProgress(from output: String) -> String? {
-        let lines = output.components(separatedBy: "\n")
-
-        for line in lines.reversed() {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
+    private nonisolated func parseProgress(fromLine line: String) -> String? {
+        let trimmed = line.trimmingCharacters(in: .whitespaces)
 
-            // CompileSwift normal /path/to/File.swift
-            if trimmed.hasPrefix("CompileSwift") {
-                if let fileName = extractFileName(from: trimmed) {
-                    return "Compiling \(fileName)"
-                }
+        // CompileSwift normal /path/to/File.swift
+        if trimmed.hasPrefix("CompileSwift") {
+            if let fileName = extractFileName(from: trimmed) {
+                return "Compiling \(fileName)"
             }
+        }
 
-            // CompileC normal /path/to/File.m
-            if trimmed.hasPrefix("CompileC") {
-                if let fileName = extractFileName(from: trimmed) {
-                    return "Compiling \(fileName)"
-                }
+        // CompileC normal /path/to/File.m
+        if trimmed.hasPrefix("CompileC") {
+            if let fileName = extractFileName(from: trimmed) {
+                return "Compiling \(fileName)"
             }
+        }
 
-            // Ld /path/to/binary
-            if trimmed.hasPrefix("Ld ") {
-                return "Linking..."
-            }
+        // Ld /path/to/binary
+        if trimmed.hasPrefix("Ld ") {
+            return "Linking..."
+        }
 
-            // CodeSign /path/to/app
-            if trimmed.hasPrefix("CodeSign ") {
-                return "Signing..."
-            }
+        // CodeSign /path/to/app
+        if trimmed.hasPrefix("CodeSign ") {
+            return "Signing..."
+        }
 
-            // ProcessInfoPlistFile
-            if trimmed.hasPrefix("ProcessInfoPlistFile") {
-                return "Processing Info.plist"
-            }
+        // ProcessInfoPlistFile
+        if trimmed.hasPrefix("ProcessInfoPlistFile") {
+            return "Processing Info.plist"
+        }
 
-            // CopySwiftLibs
-            if trimmed.hasPrefix("CopySwiftLibs") {
-                return "Copying Swift libraries"
-            }
+        // CopySwiftLibs
+        if trimmed.hasPrefix("CopySwiftLibs") {
+            return "Copying Swift libraries"
+        }
 
-            // Touch
-            if trimmed.hasPrefix("Touch ") {
-                return "Finishing..."
-            }
+        // Touch
+        if trimmed.hasPrefix("Touch ") {
+            return "Finishing..."
         }
 
         return nil
@@ -258,6 +208,11 @@ actor XcodeBuildService {
 
     // MARK: - Error Parsing
 
+    // Cheap check for lines `parseBuildErrors` can match
+    private nonisolated func isDiagnostic(_ line: String) -> Bool {
+        line.contains(": error:") || line.contains(": warning:") || line.contains(": note:")
+    }
+
     private nonisolated func parseBuildErrors(from log: String) -> [BuildError] {
         var errors: [BuildError] = []
         let lines = log.components(separatedBy: "\n")
@@ -0,0 +1,191 @@
+//
+//  ANSILogDocument.swift
+//  aizen
+//
+//  Line-indexed ANSI log that styles lines lazily in chunks
+//
+
+import Foundation
+
+/// Raw log bytes with a line index. Lines are styled on demand, a chunk of lines at a
+/// time: the parser state at the start of every chunk is checkpointed, so styling a line
+/// replays at most one chunk. Appending a log tail only indexes the new bytes; nothing
+/// already complete is re-parsed. Safe to append from one thread while reading from another.
+final class ANSILogDocument: @unchecked Sendable {
+    static let chunkLineCount = 256
+
+    private let lock = NSLock()
+    private var bytes: [UInt8] = []
+    // Start offset of every line; the last line runs to the end of `bytes`
+    private var lineStarts: [Int] = [0]
+    // Parser state at the start of chunk N; valid once chunk N's first line is complete
+    private var checkpoints: [ANSIStateMachine] = [ANSIStateMachine()]
+    private var styledChunks: [Int: (lines: [ANSIStyledLine], lastUsed: UInt64)] = [:]
+    private var clock: UInt64 = 0
+    private let maxCachedChunks: Int
+
+    init(maxCachedChunks: Int = 16) {
+        self.maxCachedChunks = maxCachedChunks
+    }
+
+    convenience init(_ text: String) {
+        self.init()
+        append(text)
+    }
+
+    /// Number of lines, not counting the empty line after a trailing newline
+    var lineCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return unlockedLineCount
+    }
+
+    var byteCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return bytes.count
+    }
+
+    func append(_ text: String) {
+        var text = text
+        text.withUTF8 { append($0) }
+    }
+
+    func append(_ data: Data) {
+        data.withUnsafeBytes { append($0.bindMemory(to: UInt8.self)) }
+    }
+
+    func append(_ chunk: UnsafeBufferPointer<UInt8>) {
+        lock.lock()
+        defer { lock.unlock() }
+        appendLocked(chunk)
+    }
+
+    /// If the document holds a prefix of `text`, append the rest and return true.
+    /// Returns false (leaving the document unchanged) when `text` doesn't extend it.
+    func extend(to text: String) -> Bool {
+        var text = text
+        return text.withUTF8 { full in
+            lock.lock()
+            defer { lock.unlock() }
+
+            let count = bytes.count
+            guard full.count >= count else { return false }
+            if count > 0 {
+                let matches = bytes.withUnsafeBufferPointer { existing in
+                    memcmp(existing.baseAddress!, full.baseAddress!, count) == 0
+                }
+                guard matches else { return false }
+            }
+            appendLocked(UnsafeBufferPointer(rebasing: full[count...]))
+            return true
+        }
+    }
+
+    private func appendLocked(_ chunk: UnsafeBufferPointer<UInt8>) {
+        guard !chunk.isEmpty else { return }
+
+        // The line that was last may grow, so its chunk's styling is stale
+        let lastChunk = (lineStarts.count - 1) / Self.chunkLineCount
+        styledChunks = styledChunks.filter { $0.key < lastChunk }
+
+        let offset = bytes.count
+        bytes.append(contentsOf: chunk)
+        for index in 0..<chunk.count where chunk[index] == 0x0A {
+            lineStarts.append(offset + index + 1)
+        }
+    }
+
+    /// Styled line at `index`; a blank line if out of range
+    func line(at index: Int) -> ANSIStyledLine {
+        lock.lock()
+        defer { lock.unlock() }
+        guard index >= 0 && index < unlockedLineCount else { return ANSIStyledLine(runs: []) }
+
+        let chunk = index / Self.chunkLineCount
+        clock += 1
+        if let cached = styledChunks[chunk] {
+            styledChunks[chunk]?.lastUsed = clock
+            return cached.lines[index - chunk * Self.chunkLineCount]
+        }
+
+        let lines = styleChunk(chunk)
+        styledChunks[chunk] = (lines, clock)
+        evictIfNeeded()
+        return lines[index - chunk * Self.chunkLineCount]
+    }
+
+    /// Byte length of the line at `index`, without its line break; 0 if out of range
+    func lineLength(at index: Int) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        guard index >= 0 && index < unlockedLineCount else { return 0 }
+        let end = index + 1 < lineStarts.count ? lineStarts[index + 1] - 1 : bytes.count
+        return end - lineStarts[index]
+    }
+
+    /// The lines in `range` as stored, escape sequences included, joined by line breaks
+    func text(lines range: Range<Int>) -> String {
+        lock.lock()
+        defer { lock.unlock() }
+        let range = range.clamped(to: 0..<unlockedLineCount)
+        guard !range.isEmpty else { return "" }
+
+        let start = lineStarts[range.lowerBound]
+        let end = range.upperBound < lineStarts.count ? lineStarts[range.upperBound] - 1 : bytes.count
+        return bytes.withUnsafeBufferPointer { buffer in
+            String(decoding: UnsafeBufferPointer(rebasing: buffer[start..<end]), as: UTF8.self)
+        }
+    }
+
+    // MARK: - Styling
+
+    private var unlockedLineCount: Int {
+        if bytes.isEmpty { return 0 }
+        return lineStarts.last == bytes.count ? lineStarts.count - 1 : lineStarts.count
+    }
+
+    private func styleChunk(_ chunk: Int) -> [ANSIStyledLine] {
+        var machine = checkpoint(for: chunk)
+        let first = chunk * Self.chunkLineCount
+        let last = min(first + Self.chunkLineCount, unlockedLineCount)
+
+        return bytes.withUnsafeBufferPointer { buffer in
+            (first..<last).map { machine.styledLine(lineBytes($0, in: buffer)) }
+        }
+    }
+
+    private func checkpoint(for chunk: Int) -> ANSIStateMachine {
+        if chunk < checkpoints.count {
+            return checkpoints[chunk]
+        }
+        bytes.withUnsafeBufferPointer { buffer in
+            while checkpoints.count <= chunk {
+                var machine = checkpoints[checkpoints.count - 1]
+                let first = (checkpoints.count - 1) * Self.chunkLineCount
+                for line in first..<(first + Self.chunkLineCount) {
+                    machine.skipLine(lineBytes(line, in: buffer))
+                }
+                checkpoints.append(machine)
+            }
+        }
+        return checkpoints[chunk]
+    }
+
+    // Line content without its newline (and the carriage return before it)
+    private func lineBytes(_ line: Int, in buffer: UnsafeBufferPointer<UInt8>) -> UnsafeBufferPointer<UInt8> {
+        let start = lineStarts[line]
+        var end = line + 1 < lineStarts.count ? lineStarts[line + 1] - 1 : buffer.count
+        if end > start && buffer[end - 1] == 0x0D {
+            end -= 1
+        }
+        return UnsafeBufferPointer(rebasing: buffer[start..<end])
+    }
+
+    private func evictIfNeeded() {
+        while styledChunks.count > maxCachedChunks,
+              let oldest = styledChunks.min(by: { $0.value.lastUsed < $1.value.lastUsed })?.key {
+            styledChunks.removeValue(forKey: oldest)
+        }
+    }
+}
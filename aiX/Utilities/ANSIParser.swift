@@ -74,7 +74,7 @@ struct ANSIColorProvider {
 
 // MARK: - ANSI Color Definitions
 
-enum ANSIColor {
+enum ANSIColor: Equatable {
     case `default`
     case black, red, green, yellow, blue, magenta, cyan, white
     case brightBlack, brightRed, brightGreen, brightYellow
@@ -135,7 +135,7 @@ enum ANSIColor {
 
 // MARK: - Text Style
 
-struct ANSITextStyle {
+struct ANSITextStyle: Equatable {
     var foreground: ANSIColor = .default
     var background: ANSIColor = .default
     var bold: Bool = false
@@ -153,6 +153,115 @@ struct ANSITextStyle {
         dim = false
         strikethrough = false
     }
+
+    /// Apply SGR (Select Graphic Rendition) parameters; no parameters means reset
+    mutating func applySGR(_ params: [Int]) {
+        if params.isEmpty {
+            reset()
+            return
+        }
+
+        var i = 0
+        while i < params.count {
+            let code = params[i]
+
+            switch code {
+            case 0: reset()
+            case 1: bold = true
+            case 2: dim = true
+            case 3: italic = true
+            case 4: underline = true
+            case 9: strikethrough = true
+            case 21: bold = false
+            case 22: bold = false; dim = false
+            case 23: italic = false
+            case 24: underline = false
+            case 29: strikethrough = false
+
+            // Foreground colors
+            case 30: foreground = .black
+            case 31: foreground = .red
+            case 32: foreground = .green
+            case 33: foreground = .yellow
+            case 34: foreground = .blue
+            case 35: foreground = .magenta
+            case 36: foreground = .cyan
+            case 37: foreground = .white
+            case 39: foreground = .default
+
+            // Background colors
+            case 40: background = .black
+            case 41: background = .red
+            case 42: background = .green
+            case 43: background = .yellow
+            case 44: background = .blue
+            case 45: background = .magenta
+            case 46: background = .cyan
+            case 47: background = .white
+            case 49: background = .default
+
+            // Bright foreground
+            case 90: foreground = .brightBlack
+            case 91: foreground = .brightRed
+            case 92: foreground = .brightGreen
+            case 93: foreground = .brightYellow
+            case 94: foreground = .brightBlue
+            case 95: foreground = .brightMagenta
+            case 96: foreground = .brightCyan
+            case 97: foreground = .brightWhite
+
+            // Bright background
+            case 100: background = .brightBlack
+            case 101: background = .brightRed
+            case 102: background = .brightGreen
+            case 103: background = .brightYellow
+            case 104: background = .brightBlue
+            case 105: background = .brightMagenta
+            case 106: background = .brightCyan
+            case 107: background = .brightWhite
+
+            // 256 color / RGB
+            case 38:
+                if i + 1 < params.count {
+                    if params[i + 1] == 5, i + 2 < params.count {
+                        // 256 color palette
+                        foreground = .palette(UInt8(clamping: params[i + 2]))
+                        i += 2
+                    } else if params[i + 1] == 2, i + 4 < params.count {
+                        // RGB
+                        foreground = .rgb(
+                            UInt8(clamping: params[i + 2]),
+                            UInt8(clamping: params[i + 3]),
+                            UInt8(clamping: params[i + 4])
+                        )
+                        i += 4
+                    }
+                }
+
+            case 48:
+                if i + 1 < params.count {
+                    if params[i + 1] == 5, i + 2 < params.count {
+                        // 256 color palette
+                        background = .palette(UInt8(clamping: params[i + 2]))
+                        i += 2
+                    } else if params[i + 1] == 2, i + 4 < params.count {
+                        // RGB
+                        background = .rgb(
+                            UInt8(clamping: params[i + 2]),
+                            UInt8(clamping: params[i + 3]),
+                            UInt8(clamping: params[i + 4])
+                        )
+                        i += 4
+                    }
+                }
+
+            default:
+                break
+            }
+
+            i += 1
+        }
+    }
 }
 
 // MARK: - ANSI Parser
@@ -160,37 +269,42 @@ struct ANSITextStyle {
 struct ANSIParser {
     // MARK: - Parsing Cache
 
-    private static var parseCache: [Int: AttributedString] = [:]
+    private static var parseCache: [String: (value: AttributedString, lastUsed: UInt64)] = [:]
+    private static var cacheClock: UInt64 = 0
     private static let maxCacheSize = 100
+    // Larger inputs (full logs) aren't worth keeping a second copy of
+    private static let maxCachedInputLength = 64 * 1024
     private static var cacheAccessQueue = DispatchQueue(label: "com.aizen.ansiparser.cache", attributes: .concurrent)
 
     /// Parse ANSI-encoded string to AttributedString with caching
     static func parse(_ input: String) -> AttributedString {
-        // Try to get from cache first
-        let hash = input.hashValue
-        var cachedResult: AttributedString?
+        guard input.utf8.count <= maxCachedInputLength else {
+            return parseInternal(input)
+        }
 
+        var cachedResult: AttributedString?
         cacheAccessQueue.sync {
-            cachedResult = parseCache[hash]
+            cachedResult = parseCache[input]?.value
         }
 
         if let cached = cachedResult {
+            cacheAccessQueue.async(flags: .barrier) {
+                cacheClock += 1
+                parseCache[input]?.lastUsed = cacheClock
+            }
             return cached
         }
 
-        // Parse normally if not in cache
         let result = parseInternal(input)
 
-        // Add to cache with size limit
+        // Add to cache, evicting the least recently used entry
         cacheAccessQueue.async(flags: .barrier) {
-            if parseCache.count >= maxCacheSize {
-                // Remove oldest entry (simple FIFO)
-                let oldestKey = parseCache.keys.min()
-                if let key = oldestKey {
-                    parseCache.removeValue(forKey: key)
-                }
+            if parseCache.count >= maxCacheSize,
+               let oldest = parseCache.min(by: { $0.value.lastUsed < $1.value.lastUsed })?.key {
+                parseCache.removeValue(forKey: oldest)
             }
-            parseCache[hash] = result
+            cacheClock += 1
+            parseCache[input] = (result, cacheClock)
         }
 
         return result
@@ -199,42 +313,16 @@ struct ANSIParser {
     /// Internal parse method without caching
     private static func parseInternal(_ input: String) -> AttributedString {
         var result = AttributedString()
-        var style = ANSITextStyle()
-        var currentText = ""
-
-        // Regex to match ANSI escape sequences
-        let pattern = "\u{001B}\\[([0-9;]*)m"
-        let regex = try? NSRegularExpression(pattern: pattern, options: [])
-
-        var lastEnd = input.startIndex
-
-        let nsString = input as NSString
-        let matches = regex?.matches(in: input, options: [], range: NSRange(location: 0, length: nsString.length)) ?? []
-
-        for match in matches {
-            // Get text before this escape sequence
-            if let swiftRange = Range(match.range, in: input) {
-                let textBefore = String(input[lastEnd..<swiftRange.lowerBound])
-                if !textBefore.isEmpty {
-                    result.append(styledString(textBefore, style: style))
-                }
-
-                // Parse the escape sequence
-                if let codeRange = Range(match.range(at: 1), in: input) {
-                    let codes = String(input[codeRange])
-                    parseEscapeCodes(codes, style: &style)
-                }
+        var machine = ANSIStateMachine()
+        var input = input
 
-                lastEnd = swiftRange.upperBound
+        input.withUTF8 { bytes in
+            machine.feed(bytes) { range, style in
+                let text = String(decoding: UnsafeBufferPointer(rebasing: bytes[range]), as: UTF8.self)
+                result.append(styledString(text, style: style))
             }
         }
 
-        // Append remaining text
-        let remaining = String(input[lastEnd...])
-        if !remaining.isEmpty {
-            result.append(styledString(remaining, style: style))
-        }
-
         return result
     }
 
@@ -285,119 +373,23 @@ struct ANSIParser {
     }
 
     static func parseEscapeCodes(_ codes: String, style: inout ANSITextStyle) {
-        let parts = codes.split(separator: ";").compactMap { Int($0) }
-
-        if parts.isEmpty {
-            style.reset()
-            return
-        }
-
-        var i = 0
-        while i < parts.count {
-            let code = parts[i]
-
-            switch code {
-            case 0: style.reset()
-            case 1: style.bold = true
-            case 2: style.dim = true
-            case 3: style.italic = true
-            case 4: style.underline = true
-            case 9: style.strikethrough = true
-            case 21: style.bold = false
-            case 22: style.bold = false; style.dim = false
-            case 23: style.italic = false
-            case 24: style.underline = false
-            case 29: style.strikethrough = false
-
-            // Foreground colors
-            case 30: style.foreground = .black
-            case 31: style.foreground = .red
-            case 32: style.foreground = .green
-            case 33: style.foreground = .yellow
-            case 34: style.foreground = .blue
-            case 35: style.foreground = .magenta
-            case 36: style.foreground = .cyan
-            case 37: style.foreground = .white
-            case 39: style.foreground = .default
-
-            // Background colors
-            case 40: style.background = .black
-            case 41: style.background = .red
-            case 42: style.background = .green
-            case 43: style.background = .yellow
-            case 44: style.background = .blue
-            case 45: style.background = .magenta
-            case 46: style.background = .cyan
-            case 47: style.background = .white
-            case 49: style.background = .default
-
-            // Bright foreground
-            case 90: style.foreground = .brightBlack
-            case 91: style.foreground = .brightRed
-            case 92: style.foreground = .brightGreen
-            case 93: style.foreground = .brightYellow
-            case 94: style.foreground = .brightBlue
-            case 95: style.foreground = .brightMagenta
-            case 96: style.foreground = .brightCyan
-            case 97: style.foreground = .brightWhite
-
-            // Bright background
-            case 100: style.background = .brightBlack
-            case 101: style.background = .brightRed
-            case 102: style.background = .brightGreen
-            case 103: style.background = .brightYellow
-            case 104: style.background = .brightBlue
-            case 105: style.background = .brightMagenta
-            case 106: style.background = .brightCyan
-            case 107: style.background = .brightWhite
-
-            // 256 color / RGB
-            case 38:
-                if i + 1 < parts.count {
-                    if parts[i + 1] == 5, i + 2 < parts.count {
-                        // 256 color palette
-                        style.foreground = .palette(UInt8(parts[i + 2]))
-                        i += 2
-                    } else if parts[i + 1] == 2, i + 4 < parts.count {
-                        // RGB
-                        style.foreground = .rgb(
-                            UInt8(parts[i + 2]),
-                            UInt8(parts[i + 3]),
-                            UInt8(parts[i + 4])
-                        )
-                        i += 4
-                    }
-                }
-
-            case 48:
-                if i + 1 < parts.count {
-                    if parts[i + 1] == 5, i + 2 < parts.count {
-                        // 256 color palette
-                        style.background = .palette(UInt8(parts[i + 2]))
-                        i += 2
-                    } else if parts[i + 1] == 2, i + 4 < parts.count {
-                        // RGB
-                        style.background = .rgb(
-                            UInt8(parts[i + 2]),
-                            UInt8(parts[i + 3]),
-                            UInt8(parts[i + 4])
-                        )
-                        i += 4
-                    }
-                }
-
-            default:
-                break
-            }
-
-            i += 1
-        }
+        style.applySGR(codes.split(separator: ";").compactMap { Int($0) })
     }
 
     /// Strip all ANSI escape codes from string
     static func stripANSI(_ input: String) -> String {
-        let pattern = "\u{001B}\\[[0-9;]*m"
-        return input.replacingOccurrences(of: pattern, with: "", options: .regularExpression)
+        var machine = ANSIStateMachine()
+        var input = input
+        var output: [UInt8] = []
+
+        input.withUTF8 { bytes in
+            output.reserveCapacity(bytes.count)
+            machine.feed(bytes) { range, _ in
+                output.append(contentsOf: UnsafeBufferPointer(rebasing: bytes[range]))
+            }
+        }
+
+        return String(decoding: output, as: UTF8.self)
     }
 }
 
@@ -419,89 +411,33 @@ struct ANSITextView: View {
     }
 }
 
-// MARK: - Parsed Line for Lazy Rendering
-
-struct ANSIParsedLine: Identifiable {
-    let id: Int
-    let attributedString: AttributedString
-    let rawText: String
-}
-
-// MARK: - Line-Based Parser for Lazy Loading
-
-extension ANSIParser {
-    /// Parse log text into lines for lazy rendering
-    static func parseLines(_ text: String) -> [ANSIParsedLine] {
-        let lines = text.components(separatedBy: "\n")
-        var result: [ANSIParsedLine] = []
-        result.reserveCapacity(lines.count)
-
-        // Track style across lines (ANSI codes can span lines)
-        var currentStyle = ANSITextStyle()
-
-        for (index, line) in lines.enumerated() {
-            let (attributed, newStyle) = parseLine(line, initialStyle: currentStyle)
-            result.append(ANSIParsedLine(
-                id: index,
-                attributedString: attributed,
-                rawText: stripANSI(line)
-            ))
-            currentStyle = newStyle
-        }
+// MARK: - Styled Line Rendering
 
-        return result
-    }
-
-    /// Parse a single line with initial style state, returns attributed string and final style
-    private static func parseLine(_ input: String, initialStyle: ANSITextStyle) -> (AttributedString, ANSITextStyle) {
+extension ANSIStyledLine {
+    /// Attributed string for display; empty lines render as a space to keep their height
+    var attributedString: AttributedString {
+        guard !runs.isEmpty else { return AttributedString(" ") }
         var result = AttributedString()
-        var style = initialStyle
-
-        let pattern = "\u{001B}\\[([0-9;]*)m"
-        let regex = try? NSRegularExpression(pattern: pattern, options: [])
-
-        var lastEnd = input.startIndex
-        let nsString = input as NSString
-        let matches = regex?.matches(in: input, options: [], range: NSRange(location: 0, length: nsString.length)) ?? []
-
-        for match in matches {
-            if let swiftRange = Range(match.range, in: input) {
-                let textBefore = String(input[lastEnd..<swiftRange.lowerBound])
-                if !textBefore.isEmpty {
-                    result.append(styledString(textBefore, style: style))
-                }
-
-                if let codeRange = Range(match.range(at: 1), in: input) {
-                    let codes = String(input[codeRange])
-                    parseEscapeCodes(codes, style: &style)
-                }
-
-                lastEnd = swiftRange.upperBound
-            }
-        }
-
-        let remaining = String(input[lastEnd...])
-        if !remaining.isEmpty {
-            result.append(styledString(remaining, style: style))
+        for run in runs {
+            result.append(ANSIParser.styledString(run.text, style: run.style))
         }
-
-        // Return empty space if line is empty for proper line height
-        if result.characters.isEmpty {
-            result = AttributedString(" ")
-        }
-
-        return (result, style)
+        return result
     }
 }
 
 // MARK: - Lazy ANSI Log View
 
+/// Log view that indexes lines up front and styles only the rows on screen.
+/// When `logs` grows by a tail, only the new bytes are indexed.
 struct ANSILazyLogView: View {
     let logs: String
     let fontSize: CGFloat
 
-    @State private var parsedLines: [ANSIParsedLine] = []
+    @State private var document: ANSILogDocument?
+    @State private var lineCount = 0
+    @State private var byteCount = 0
     @State private var isProcessing = true
+    @State private var loadTask: Task<Void, Never>?
 
     init(_ logs: String, fontSize: CGFloat = 11) {
         self.logs = logs
@@ -520,44 +456,80 @@ struct ANSILazyLogView: View {
                 }
                 .frame(maxWidth: .infinity, maxHeight: .infinity)
                 .background(Color(nsColor: .textBackgroundColor))
-            } else if parsedLines.isEmpty {
-                Text("No logs available")
-                    .foregroundStyle(.secondary)
-                    .frame(maxWidth: .infinity, maxHeight: .infinity)
-            } else {
+            } else if let document, lineCount > 0 {
                 ScrollViewReader { proxy in
                     ScrollView([.horizontal, .vertical]) {
                         LazyVStack(alignment: .leading, spacing: 0) {
-                            ForEach(parsedLines) { line in
-                                Text(line.attributedString)
-                                    .font(.system(size: fontSize, design: .monospaced))
-                                    .textSelection(.enabled)
-                                    .frame(maxWidth: .infinity, alignment: .leading)
-                                    .id(line.id)
+                            ForEach(0..<lineCount, id: \.self) { index in
+                                ANSILogLineView(
+                                    document: document,
+                                    index: index,
+                                    // The last line may still grow
+                                    revision: index == lineCount - 1 ? byteCount : 0,
+                                    fontSize: fontSize
+                                )
+                                .id(index)
                             }
                         }
                         .padding(12)
                     }
                     .background(Color(nsColor: .textBackgroundColor))
                 }
+            } else {
+                Text("No logs available")
+                    .foregroundStyle(.secondary)
+                    .frame(maxWidth: .infinity, maxHeight: .infinity)
             }
         }
         .onChange(of: logs) { newLogs in
-            parseLogsAsync(newLogs)
+            loadLogs(newLogs)
         }
         .onAppear {
-            parseLogsAsync(logs)
+            loadLogs(logs)
+        }
+        .onDisappear {
+            loadTask?.cancel()
         }
     }
 
-    private func parseLogsAsync(_ text: String) {
-        isProcessing = true
-        Task.detached(priority: .userInitiated) {
-            let lines = ANSIParser.parseLines(text)
+    private func loadLogs(_ text: String) {
+        loadTask?.cancel()
+        let current = document
+        if current == nil {
+            isProcessing = true
+        }
+
+        loadTask = Task.detached(priority: .userInitiated) {
+            let loaded: ANSILogDocument
+            if let current, current.extend(to: text) {
+                loaded = current
+            } else {
+                loaded = ANSILogDocument(text)
+            }
+            guard !Task.isCancelled else { return }
+
+            let lines = loaded.lineCount
+            let bytes = loaded.byteCount
             await MainActor.run {
-                parsedLines = lines
+                document = loaded
+                lineCount = lines
+                byteCount = bytes
                 isProcessing = false
             }
         }
     }
 }
+
+private struct ANSILogLineView: View {
+    let document: ANSILogDocument
+    let index: Int
+    let revision: Int
+    let fontSize: CGFloat
+
+    var body: some View {
+        Text(document.line(at: index).attributedString)
+            .font(.system(size: fontSize, design: .monospaced))
+            .textSelection(.enabled)
+            .frame(maxWidth: .infinity, alignment: .leading)
+    }
+}
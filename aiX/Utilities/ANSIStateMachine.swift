@@ -0,0 +1,181 @@
+//
+//  ANSIStateMachine.swift
+//  aizen
+//
+//  Byte-level ANSI escape sequence parser producing styled runs
+//
+
+import Foundation
+
+// MARK: - Styled Output
+
+/// Text printed with a single style
+struct ANSIStyledRun {
+    let text: String
+    let style: ANSITextStyle
+}
+
+/// One log line with escape sequences removed and styling kept as runs
+struct ANSIStyledLine {
+    let runs: [ANSIStyledRun]
+
+    /// Plain text of the line
+    var text: String {
+        runs.count == 1 ? runs[0].text : runs.map(\.text).joined()
+    }
+}
+
+// MARK: - State Machine
+
+/// Resumable ANSI parser. Bytes can be fed in any split (mid-sequence included); SGR state
+/// and any partially read sequence carry over to the next call, so a stream is parsed once.
+/// SGR sequences update `style`, other CSI/OSC/charset sequences are dropped.
+struct ANSIStateMachine {
+    private enum State {
+        case ground
+        case escape
+        case charset
+        case csi
+        case osc
+        case oscEscape
+    }
+
+    private(set) var style = ANSITextStyle()
+
+    private var state: State = .ground
+    private var params: [Int] = []
+    private var currentParam = 0
+    private var hasCurrentParam = false
+    private var isPrivate = false
+
+    init(style: ANSITextStyle = ANSITextStyle()) {
+        self.style = style
+    }
+
+    /// Feed bytes, reporting each printable range (indices into `bytes`) with its style
+    mutating func feed(_ bytes: UnsafeBufferPointer<UInt8>, text: (Range<Int>, ANSITextStyle) -> Void) {
+        let end = bytes.count
+        var i = 0
+
+        while i < end {
+            if state == .ground {
+                let start = i
+                while i < end && bytes[i] != 0x1B {
+                    i += 1
+                }
+                if i > start {
+                    text(start..<i, style)
+                }
+                if i < end {
+                    state = .escape
+                    i += 1
+                }
+                continue
+            }
+
+            let byte = bytes[i]
+            i += 1
+
+            switch state {
+            case .ground:
+                break
+
+            case .escape:
+                switch byte {
+                case 0x5B: // [
+                    state = .csi
+                    params.removeAll(keepingCapacity: true)
+                    currentParam = 0
+                    hasCurrentParam = false
+                    isPrivate = false
+                case 0x5D: // ]
+                    state = .osc
+                case 0x28, 0x29: // ( ) designate charset, one more byte follows
+                    state = .charset
+                case 0x0A:
+                    state = .ground
+                    i -= 1
+                default:
+                    state = .ground
+                }
+
+            case .charset:
+                state = .ground
+
+            case .csi:
+                switch byte {
+                case 0x30...0x39:
+                    currentParam = min(currentParam * 10 + Int(byte - 0x30), 65_535)
+                    hasCurrentParam = true
+                case 0x3B, 0x3A: // ; :
+                    params.append(currentParam)
+                    currentParam = 0
+                    hasCurrentParam = false
+                case 0x3C...0x3F: // private markers (< = > ?)
+                    isPrivate = true
+                case 0x20...0x2F: // intermediates
+                    break
+                case 0x40...0x7E: // final byte
+                    if hasCurrentParam || !params.isEmpty {
+                        params.append(currentParam)
+                    }
+                    if byte == 0x6D && !isPrivate { // m
+                        style.applySGR(params)
+                    }
+                    state = .ground
+                case 0x0A:
+                    // Malformed sequence; don't swallow the next line
+                    state = .ground
+                    i -= 1
+                default:
+                    break
+                }
+
+            case .osc:
+                if byte == 0x07 { // BEL
+                    state = .ground
+                } else if byte == 0x1B {
+                    state = .oscEscape
+                } else if byte == 0x0A {
+                    state = .ground
+                    i -= 1
+                }
+
+            case .oscEscape:
+                // ESC \ terminates; anything else starts a new sequence
+                if byte == 0x5C {
+                    state = .ground
+                } else {
+                    state = .escape
+                    i -= 1
+                }
+            }
+        }
+    }
+
+    /// Drop a sequence left unfinished at the end of a line
+    mutating func endLine() {
+        state = .ground
+    }
+
+    /// Parse one line's bytes into runs, advancing the style state
+    mutating func styledLine(_ bytes: UnsafeBufferPointer<UInt8>) -> ANSIStyledLine {
+        var runs: [ANSIStyledRun] = []
+        feed(bytes) { range, style in
+            let text = String(decoding: UnsafeBufferPointer(rebasing: bytes[range]), as: UTF8.self)
+            if let last = runs.last, last.style == style {
+                runs[runs.count - 1] = ANSIStyledRun(text: last.text + text, style: style)
+            } else {
+                runs.append(ANSIStyledRun(text: text, style: style))
+            }
+        }
+        endLine()
+        return ANSIStyledLine(runs: runs)
+    }
+
+    /// Advance the style state over a line without producing output
+    mutating func skipLine(_ bytes: UnsafeBufferPointer<UInt8>) {
+        feed(bytes) { _, _ in }
+        endLine()
+    }
+}
@@ -0,0 +1,35 @@
+//
+//  AppCacheDirectory.swift
+//  aizen
+//
+//  Locations in the app's caches directory keyed by repository or worktree path
+//
+
+import CryptoKit
+import Foundation
+
+enum AppCacheDirectory {
+    /// The app's folder in the user's caches directory
+    static var root: URL {
+        FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first!
+            .appendingPathComponent("aiX", isDirectory: true)
+    }
+
+    /// Fixed-length file name for `key`: the first 16 bytes of its SHA-256, in hex
+    static func name(for key: String) -> String {
+        SHA256.hash(data: Data(key.utf8)).prefix(16).map { String(format: "%02x", $0) }.joined()
+    }
+
+    /// `<root>/<subdirectory>/<name(for: key)><suffix>`
+    static func url(
+        for key: String,
+        in subdirectory: String,
+        suffix: String = "",
+        isDirectory: Bool = false,
+        root: URL? = nil
+    ) -> URL {
+        (root ?? self.root)
+            .appendingPathComponent(subdirectory, isDirectory: true)
+            .appendingPathComponent(name(for: key) + suffix, isDirectory: isDirectory)
+    }
+}
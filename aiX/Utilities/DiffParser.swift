@@ -7,133 +7,205 @@
 
 import Foundation
 
-enum DiffParser {
-    /// Parse unified diff output into DiffLine array
-    static func parseUnifiedDiff(_ diffOutput: String) -> [DiffLine] {
-        var parsed: [DiffLine] = []
-        parsed.reserveCapacity(max(256, diffOutput.count / 48))
-
-        var lineCounter = 0
-        var oldLineNum = 0
-        var newLineNum = 0
-
-        diffOutput.enumerateLines { line, _ in
-            if line.hasPrefix("@@") {
-                // Hunk header
-                for component in line.split(separator: " ") {
-                    if component.hasPrefix("-") && !component.hasPrefix("---") {
-                        let rangeStr = component.dropFirst()
-                        if let numPart = rangeStr.split(separator: ",").first,
-                           let start = Int(numPart) {
-                            oldLineNum = start - 1
-                        }
-                    } else if component.hasPrefix("+") && !component.hasPrefix("+++") {
-                        let rangeStr = component.dropFirst()
-                        if let numPart = rangeStr.split(separator: ",").first,
-                           let start = Int(numPart) {
-                            newLineNum = start - 1
-                        }
-                    }
-                }
+/// Byte-level unified diff parser. Raw output is appended to one buffer as it arrives and
+/// each diff line is recorded as an offset/length into it with integer line numbers, so
+/// nothing is split or copied per line. Feed chunks with `consume`, then call `finish`.
+struct StreamingDiffParser {
+    private var text = ContiguousArray<UInt8>()
+    private var lines = ContiguousArray<CompactDiff.Line>()
+    // Start of the first line not yet terminated by a newline
+    private var pendingStart = 0
+    private var oldLineNumber: Int32 = 0
+    private var newLineNumber: Int32 = 0
+
+    var lineCount: Int { lines.count }
+
+    /// Lines parsed so far, sharing the parser's buffers until either side mutates
+    var snapshot: CompactDiff {
+        CompactDiff(text: text, lines: lines)
+    }
 
-                parsed.append(DiffLine(
-                    lineNumber: lineCounter,
-                    oldLineNumber: nil,
-                    newLineNumber: nil,
-                    content: line,
-                    type: .header
-                ))
-                lineCounter += 1
-                return
-            }
+    init(capacity: Int = 0) {
+        text.reserveCapacity(capacity)
+        lines.reserveCapacity(max(256, capacity / 48))
+    }
 
-            if line.hasPrefix("+++") || line.hasPrefix("---") ||
-                line.hasPrefix("diff ") || line.hasPrefix("index ") {
-                // Skip file headers
-                return
-            }
+    mutating func consume<Bytes: Sequence>(_ chunk: Bytes) where Bytes.Element == UInt8 {
+        text.append(contentsOf: chunk)
+        parseCompleteLines()
+    }
 
-            if line.hasPrefix("+") {
-                newLineNum += 1
-                parsed.append(DiffLine(
-                    lineNumber: lineCounter,
-                    oldLineNumber: nil,
-                    newLineNumber: String(newLineNum),
-                    content: String(line.dropFirst()),
-                    type: .added
-                ))
-                lineCounter += 1
-                return
-            }
+    mutating func consume(_ chunk: String) {
+        text.append(contentsOf: chunk.utf8)
+        parseCompleteLines()
+    }
 
-            if line.hasPrefix("-") {
-                oldLineNum += 1
-                parsed.append(DiffLine(
-                    lineNumber: lineCounter,
-                    oldLineNumber: String(oldLineNum),
-                    newLineNumber: nil,
-                    content: String(line.dropFirst()),
-                    type: .deleted
-                ))
-                lineCounter += 1
-                return
-            }
+    /// Parse the trailing line if the output didn't end with a newline
+    mutating func finish() {
+        if pendingStart < text.count {
+            parseLine(start: pendingStart, end: text.count)
+            pendingStart = text.count
+        }
+    }
 
-            if line.hasPrefix(" ") {
-                oldLineNum += 1
-                newLineNum += 1
-                parsed.append(DiffLine(
-                    lineNumber: lineCounter,
-                    oldLineNumber: String(oldLineNum),
-                    newLineNumber: String(newLineNum),
-                    content: String(line.dropFirst()),
-                    type: .context
-                ))
-                lineCounter += 1
+    private mutating func parseCompleteLines() {
+        let newline = UInt8(ascii: "\n")
+        var start = pendingStart
+        var index = start
+        let count = text.count
+
+        while index < count {
+            // Scan with memchr over the unparsed tail
+            let found: Int? = text.withUnsafeBufferPointer { buffer in
+                guard let base = buffer.baseAddress,
+                      let hit = memchr(base + index, Int32(newline), count - index) else {
+                    return nil
+                }
+                return UnsafeRawPointer(base).distance(to: UnsafeRawPointer(hit))
             }
+            guard let end = found else { break }
+            parseLine(start: start, end: end)
+            start = end + 1
+            index = start
         }
 
-        return parsed
+        pendingStart = start
     }
 
-    /// Split multi-file diff output by file path
-    static func splitDiffByFile(_ diffOutput: String) -> [String: [DiffLine]] {
-        var result: [String: [DiffLine]] = [:]
+    private mutating func parseLine(start: Int, end lineEnd: Int) {
+        var end = lineEnd
+        if end > start && text[end - 1] == UInt8(ascii: "\r") {
+            end -= 1
+        }
+        guard end > start else { return }
 
-        var currentFilePath: String?
-        var currentChunkLines: [String] = []
-        currentChunkLines.reserveCapacity(256)
+        let first = text[start]
+        let length = end - start
 
-        func flushCurrentChunk() {
-            guard let path = currentFilePath, !path.isEmpty, !currentChunkLines.isEmpty else {
-                currentFilePath = nil
-                currentChunkLines.removeAll(keepingCapacity: true)
-                return
+        func hasPrefix(_ prefix: StaticString) -> Bool {
+            guard length >= prefix.utf8CodeUnitCount else { return false }
+            let bytes = prefix.utf8Start
+            for offset in 0..<prefix.utf8CodeUnitCount where text[start + offset] != bytes[offset] {
+                return false
             }
+            return true
+        }
 
-            let chunkText = currentChunkLines.joined(separator: "\n")
-            let lines = parseUnifiedDiff(chunkText)
-            if !lines.isEmpty {
-                result[path] = lines
-            }
+        switch first {
+        case UInt8(ascii: "@") where hasPrefix("@@"):
+            parseHunkHeader(start: start, end: end)
+            append(start: start, end: end, old: 0, new: 0, type: .header)
+        case UInt8(ascii: "+") where !hasPrefix("+++"):
+            newLineNumber += 1
+            append(start: start + 1, end: end, old: 0, new: newLineNumber, type: .added)
+        case UInt8(ascii: "-") where !hasPrefix("---"):
+            oldLineNumber += 1
+            append(start: start + 1, end: end, old: oldLineNumber, new: 0, type: .deleted)
+        case UInt8(ascii: " "):
+            oldLineNumber += 1
+            newLineNumber += 1
+            append(start: start + 1, end: end, old: oldLineNumber, new: newLineNumber, type: .context)
+        default:
+            // File headers ("diff ", "index ", "+++", "---") and metadata lines are skipped
+            break
+        }
+    }
 
-            currentFilePath = nil
-            currentChunkLines.removeAll(keepingCapacity: true)
+    // "@@ -a[,b] +c[,d] @@": the next lines are numbered from a and c
+    private mutating func parseHunkHeader(start: Int, end: Int) {
+        var index = start + 2
+        while index < end {
+            let byte = text[index]
+            if byte == UInt8(ascii: "-") || byte == UInt8(ascii: "+") {
+                var value: Int32 = 0
+                var digits = index + 1
+                while digits < end, text[digits] >= UInt8(ascii: "0"), text[digits] <= UInt8(ascii: "9") {
+                    value = value &* 10 &+ Int32(text[digits] - UInt8(ascii: "0"))
+                    digits += 1
+                }
+                if digits > index + 1 {
+                    if byte == UInt8(ascii: "-") {
+                        oldLineNumber = value - 1
+                    } else {
+                        newLineNumber = value - 1
+                        return
+                    }
+                }
+                index = digits
+            } else {
+                index += 1
+            }
         }
+    }
+
+    private mutating func append(start: Int, end: Int, old: Int32, new: Int32, type: DiffLineType) {
+        lines.append(CompactDiff.Line(
+            textStart: UInt32(start),
+            textLength: UInt32(max(0, end - start)),
+            lineNumber: Int32(lines.count),
+            oldLineNumber: old,
+            newLineNumber: new,
+            type: UInt8(CompactDiff.types.firstIndex(of: type) ?? 2)
+        ))
+    }
+}
+
+enum DiffParser {
+    /// Parse unified diff output into a compact, offset-based diff
+    static func parse(_ diffOutput: Data) -> CompactDiff {
+        var parser = StreamingDiffParser(capacity: diffOutput.count)
+        parser.consume(diffOutput)
+        parser.finish()
+        return parser.snapshot
+    }
 
-        diffOutput.enumerateLines { line, _ in
-            if line.hasPrefix("diff --git ") {
-                flushCurrentChunk()
-                currentChunkLines.append(line)
-                currentFilePath = parseFilePathFromDiffHeader(line)
-                return
+    /// Parse unified diff output into DiffLine array
+    static func parseUnifiedDiff(_ diffOutput: String) -> [DiffLine] {
+        parse(Data(diffOutput.utf8)).diffLines()
+    }
+
+    /// Split multi-file diff output by file path
+    static func splitDiffByFile(_ diffOutput: String) -> [String: [DiffLine]] {
+        splitByFile(Data(diffOutput.utf8)).mapValues { $0.diffLines() }
+    }
+
+    /// Split multi-file diff output by file path, parsing each file's section in place
+    static func splitByFile(_ diffOutput: Data) -> [String: CompactDiff] {
+        var result: [String: CompactDiff] = [:]
+        let marker = Array("diff --git ".utf8)
+
+        diffOutput.withUnsafeBytes { raw in
+            let bytes = raw.bindMemory(to: UInt8.self)
+            guard !bytes.isEmpty else { return }
+
+            // Offsets of lines starting with "diff --git "
+            var sectionStarts: [Int] = []
+            var lineStart = 0
+            while lineStart < bytes.count {
+                if bytes.count - lineStart >= marker.count,
+                   memcmp(bytes.baseAddress! + lineStart, marker, marker.count) == 0 {
+                    sectionStarts.append(lineStart)
+                }
+                guard let newline = memchr(bytes.baseAddress! + lineStart, 0x0A, bytes.count - lineStart) else { break }
+                lineStart = UnsafeRawPointer(bytes.baseAddress!).distance(to: UnsafeRawPointer(newline)) + 1
             }
 
-            guard currentFilePath != nil else { return }
-            currentChunkLines.append(line)
+            for (position, start) in sectionStarts.enumerated() {
+                let end = position + 1 < sectionStarts.count ? sectionStarts[position + 1] : bytes.count
+                let headerEnd = memchr(bytes.baseAddress! + start, 0x0A, end - start)
+                    .map { UnsafeRawPointer(bytes.baseAddress!).distance(to: UnsafeRawPointer($0)) } ?? end
+                let header = String(decoding: UnsafeBufferPointer(rebasing: bytes[start..<headerEnd]), as: UTF8.self)
+                guard let path = parseFilePathFromDiffHeader(header), !path.isEmpty else { continue }
+
+                var parser = StreamingDiffParser(capacity: end - start)
+                parser.consume(UnsafeBufferPointer(rebasing: bytes[start..<end]))
+                parser.finish()
+                if parser.lineCount > 0 {
+                    result[path] = parser.snapshot
+                }
+            }
         }
 
-        flushCurrentChunk()
         return result
     }
 
@@ -221,13 +221,16 @@ actor ProcessExecutor {
         }
     }
 
-    /// Execute a process and stream output via AsyncStream
-    func executeStreaming(
+    /// Launch a process and read its stdout on demand, with backpressure: at most `bufferLimit`
+    /// bytes are read ahead of the consumer. See `ProcessOutputStream`.
+    func executeOutputStream(
         executable: String,
         arguments: [String] = [],
         environment: [String: String]? = nil,
-        workingDirectory: String? = nil
-    ) -> (process: Process, stream: AsyncStream<StreamOutput>) {
+        workingDirectory: String? = nil,
+        bufferLimit: Int = 1 << 20,
+        maxOutputBytes: Int? = nil
+    ) throws -> ProcessOutputStream {
         let process = Process()
         process.executableURL = URL(fileURLWithPath: executable)
         process.arguments = arguments
@@ -245,87 +248,22 @@ actor ProcessExecutor {
         process.standardOutput = stdoutPipe
         process.standardError = stderrPipe
 
-        let stream = AsyncStream<StreamOutput> { continuation in
-            stdoutPipe.fileHandleForReading.readabilityHandler = { handle in
-                let data = handle.availableData
-                guard !data.isEmpty else {
-                    handle.readabilityHandler = nil
-                    try? handle.close()
-                    return
-                }
-                if let text = String(data: data, encoding: .utf8) {
-                    continuation.yield(.stdout(text))
-                }
-            }
-
-            stderrPipe.fileHandleForReading.readabilityHandler = { handle in
-                let data = handle.availableData
-                guard !data.isEmpty else {
-                    handle.readabilityHandler = nil
-                    try? handle.close()
-                    return
-                }
-                if let text = String(data: data, encoding: .utf8) {
-                    continuation.yield(.stderr(text))
-                }
-            }
-
-            process.terminationHandler = { proc in
-                // Clean up handlers
-                stdoutPipe.fileHandleForReading.readabilityHandler = nil
-                stderrPipe.fileHandleForReading.readabilityHandler = nil
-
-                // Read any remaining data
-                let remainingStdout = stdoutPipe.fileHandleForReading.readDataToEndOfFile()
-                let remainingStderr = stderrPipe.fileHandleForReading.readDataToEndOfFile()
-
-                if !remainingStdout.isEmpty, let text = String(data: remainingStdout, encoding: .utf8) {
-                    continuation.yield(.stdout(text))
-                }
-                if !remainingStderr.isEmpty, let text = String(data: remainingStderr, encoding: .utf8) {
-                    continuation.yield(.stderr(text))
-                }
-
-                continuation.yield(.terminated(proc.terminationStatus))
-                try? stdoutPipe.fileHandleForReading.close()
-                try? stderrPipe.fileHandleForReading.close()
-                continuation.finish()
-            }
-
-            continuation.onTermination = { _ in
-                if process.isRunning {
-                    process.terminate()
-                }
-                stdoutPipe.fileHandleForReading.readabilityHandler = nil
-                stderrPipe.fileHandleForReading.readabilityHandler = nil
-                try? stdoutPipe.fileHandleForReading.close()
-                try? stderrPipe.fileHandleForReading.close()
-            }
-
-            do {
-                try process.run()
-            } catch {
-                stdoutPipe.fileHandleForReading.readabilityHandler = nil
-                stderrPipe.fileHandleForReading.readabilityHandler = nil
-                try? stdoutPipe.fileHandleForReading.close()
-                try? stderrPipe.fileHandleForReading.close()
-                continuation.yield(.error(error.localizedDescription))
-                continuation.finish()
-            }
+        let output = ProcessOutputStream(
+            process: process,
+            stdout: stdoutPipe,
+            stderr: stderrPipe,
+            bufferLimit: bufferLimit,
+            maxOutputBytes: maxOutputBytes
+        )
+        do {
+            try output.start()
+        } catch {
+            throw ProcessExecutorError.executionFailed(error.localizedDescription)
         }
-
-        return (process, stream)
+        return output
     }
 }
 
-/// Output types for streaming execution
-enum StreamOutput: Sendable {
-    case stdout(String)
-    case stderr(String)
-    case terminated(Int32)
-    case error(String)
-}
-
 /// Thread-safe data collector for process output
 private final class DataCollector: @unchecked Sendable {
     private var stdoutData = Data()
@@ -0,0 +1,307 @@
+//
+//  ProcessOutputStream.swift
+//  aizen
+//
+//  Pull-based process output with a bounded read-ahead buffer
+//
+
+import Foundation
+
+/// Stdout of a running process as a sequence of byte chunks, read as the consumer asks for them.
+///
+/// A reader thread reads ahead into a buffer of at most `bufferLimit` bytes. Once the buffer is
+/// full it stops reading until the consumer takes a chunk, so a fast producer fills its pipe and
+/// blocks instead of growing memory here. Stderr is kept up to `bufferLimit` bytes (the rest is
+/// read and discarded, so the process never stalls on it). With `maxOutputBytes`, the process is
+/// terminated once that much stdout has been read and `wasTruncated` is set.
+///
+/// Iterate the chunks directly, or `lines` for newline-framed text. Cancelling the consuming
+/// task terminates the process; a consumer that stops early otherwise must call `cancel()`.
+final class ProcessOutputStream: AsyncSequence, @unchecked Sendable {
+    typealias Element = Data
+
+    let process: Process
+
+    private let stdoutHandle: FileHandle
+    private let stderrHandle: FileHandle
+    private let bufferLimit: Int
+    private let maxOutputBytes: Int?
+    private static let chunkSize = 64 * 1024
+
+    private let condition = NSCondition()
+    private var chunks: [Data] = []
+    private var bufferedBytes = 0
+    private var totalBytes = 0
+    private var waiter: CheckedContinuation<Data?, Never>?
+    private var readerFinished = false
+    private var isCancelled = false
+    private var truncated = false
+
+    private var stderrData = Data()
+    private var exitStatus: Int32?
+    private var exitWaiters: [CheckedContinuation<Int32, Never>] = []
+
+    init(process: Process, stdout: Pipe, stderr: Pipe, bufferLimit: Int, maxOutputBytes: Int?) {
+        self.process = process
+        self.stdoutHandle = stdout.fileHandleForReading
+        self.stderrHandle = stderr.fileHandleForReading
+        self.bufferLimit = max(bufferLimit, Self.chunkSize)
+        self.maxOutputBytes = maxOutputBytes
+    }
+
+    /// Launch the process and start reading
+    func start() throws {
+        // read(upToCount:) throws a Swift error where availableData raises an ObjC exception,
+        // which a handler still queued when didExit closes the handle would otherwise hit
+        stderrHandle.readabilityHandler = { [weak self] handle in
+            do {
+                guard let data = try handle.read(upToCount: Self.chunkSize), !data.isEmpty else {
+                    handle.readabilityHandler = nil
+                    return
+                }
+                self?.appendStderr(data)
+            } catch {
+                // Closed by didExit
+                handle.readabilityHandler = nil
+            }
+        }
+
+        process.terminationHandler = { [weak self] proc in
+            self?.didExit(proc.terminationStatus)
+        }
+
+        do {
+            try process.run()
+        } catch {
+            stderrHandle.readabilityHandler = nil
+            try? stdoutHandle.close()
+            try? stderrHandle.close()
+            throw error
+        }
+
+        Thread.detachNewThread { [self] in
+            self.readStdout()
+        }
+    }
+
+    // MARK: - Consumer
+
+    struct AsyncIterator: AsyncIteratorProtocol {
+        fileprivate let stream: ProcessOutputStream
+
+        func next() async -> Data? {
+            await stream.nextChunk()
+        }
+    }
+
+    func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(stream: self)
+    }
+
+    /// Stdout split into lines (without the line break), decoded as UTF-8
+    var lines: ProcessOutputLines {
+        ProcessOutputLines(stream: self)
+    }
+
+    /// Exit status, once the process has exited
+    func waitForExit() async -> Int32 {
+        await withCheckedContinuation { continuation in
+            condition.lock()
+            defer { condition.unlock() }
+            if let exitStatus {
+                continuation.resume(returning: exitStatus)
+            } else {
+                exitWaiters.append(continuation)
+            }
+        }
+    }
+
+    /// Stderr collected so far, up to the buffer limit
+    var stderr: String {
+        condition.lock()
+        defer { condition.unlock() }
+        return String(decoding: stderrData, as: UTF8.self)
+    }
+
+    /// Whether stdout was cut off at `maxOutputBytes`
+    var wasTruncated: Bool {
+        condition.lock()
+        defer { condition.unlock() }
+        return truncated
+    }
+
+    /// Stop reading and terminate the process
+    func cancel() {
+        condition.lock()
+        isCancelled = true
+        waiter?.resume(returning: nil)
+        waiter = nil
+        condition.broadcast()
+        condition.unlock()
+
+        if process.isRunning {
+            process.terminate()
+        }
+    }
+
+    private func nextChunk() async -> Data? {
+        await withTaskCancellationHandler {
+            await withCheckedContinuation { (continuation: CheckedContinuation<Data?, Never>) in
+                condition.lock()
+                defer { condition.unlock() }
+
+                if !chunks.isEmpty {
+                    let chunk = chunks.removeFirst()
+                    bufferedBytes -= chunk.count
+                    // Room in the buffer again
+                    condition.signal()
+                    continuation.resume(returning: chunk)
+                } else if readerFinished || isCancelled {
+                    continuation.resume(returning: nil)
+                } else {
+                    waiter = continuation
+                }
+            }
+        } onCancel: {
+            self.cancel()
+        }
+    }
+
+    // MARK: - Reader
+
+    private func readStdout() {
+        while true {
+            condition.lock()
+            while bufferedBytes >= bufferLimit && !isCancelled {
+                condition.wait()
+            }
+            let stop = isCancelled
+            condition.unlock()
+            if stop { break }
+
+            guard let read = try? stdoutHandle.read(upToCount: Self.chunkSize), !read.isEmpty else { break }
+
+            condition.lock()
+            var data = read
+            if let maxOutputBytes, totalBytes + data.count > maxOutputBytes {
+                data = data.prefix(maxOutputBytes - totalBytes)
+                truncated = true
+            }
+            totalBytes += data.count
+            if !data.isEmpty {
+                if let waiter {
+                    self.waiter = nil
+                    waiter.resume(returning: data)
+                } else {
+                    chunks.append(data)
+                    bufferedBytes += data.count
+                }
+            }
+            let reachedLimit = truncated
+            condition.unlock()
+
+            if reachedLimit {
+                if process.isRunning {
+                    process.terminate()
+                }
+                break
+            }
+        }
+
+        condition.lock()
+        readerFinished = true
+        if chunks.isEmpty, let waiter {
+            self.waiter = nil
+            waiter.resume(returning: nil)
+        }
+        condition.unlock()
+        try? stdoutHandle.close()
+    }
+
+    private func appendStderr(_ data: Data) {
+        condition.lock()
+        defer { condition.unlock() }
+        let room = bufferLimit - stderrData.count
+        if room > 0 {
+            stderrData.append(data.prefix(room))
+        }
+    }
+
+    private func didExit(_ status: Int32) {
+        // Whatever stderr is left in the pipe
+        stderrHandle.readabilityHandler = nil
+        if let remaining = try? stderrHandle.readToEnd() {
+            appendStderr(remaining)
+        }
+        try? stderrHandle.close()
+
+        condition.lock()
+        exitStatus = status
+        let waiters = exitWaiters
+        exitWaiters.removeAll()
+        condition.unlock()
+
+        for waiter in waiters {
+            waiter.resume(returning: status)
+        }
+    }
+}
+
+/// Lines of a `ProcessOutputStream`. Chunks are framed in one growing byte buffer that is
+/// reused for the whole stream; a trailing `\r` is dropped.
+struct ProcessOutputLines: AsyncSequence {
+    typealias Element = String
+
+    fileprivate let stream: ProcessOutputStream
+
+    struct AsyncIterator: AsyncIteratorProtocol {
+        private let chunks: ProcessOutputStream.AsyncIterator
+        private var buffer: [UInt8] = []
+        // Start of the first line not returned yet
+        private var lineStart = 0
+        // Bytes before this index hold no line break after `lineStart`
+        private var scanStart = 0
+        private var isFinished = false
+
+        fileprivate init(stream: ProcessOutputStream) {
+            self.chunks = stream.makeAsyncIterator()
+            buffer.reserveCapacity(64 * 1024)
+        }
+
+        mutating func next() async -> String? {
+            while true {
+                if let newline = buffer[max(lineStart, scanStart)...].firstIndex(of: 0x0A) {
+                    let line = Self.decode(buffer[lineStart..<newline])
+                    lineStart = newline + 1
+                    return line
+                }
+
+                // Keep only the partial line, in the same storage; it was scanned already,
+                // so a long line without a break is not rescanned for every chunk
+                buffer.removeSubrange(0..<lineStart)
+                lineStart = 0
+                scanStart = buffer.count
+
+                guard !isFinished else { return nil }
+                guard let chunk = await chunks.next() else {
+                    isFinished = true
+                    guard !buffer.isEmpty else { return nil }
+                    let line = Self.decode(buffer[...])
+                    buffer.removeAll(keepingCapacity: true)
+                    scanStart = 0
+                    return line
+                }
+                buffer.append(contentsOf: chunk)
+            }
+        }
+
+        private static func decode(_ bytes: ArraySlice<UInt8>) -> String {
+            let trimmed = bytes.last == 0x0D ? bytes.dropLast() : bytes
+            return String(decoding: trimmed, as: UTF8.self)
+        }
+    }
+
+    func makeAsyncIterator() -> AsyncIterator {
+        AsyncIterator(stream: stream)
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  WorktreeFileEventWatcher.swift
+//  aizen
+//
+//  FSEvents stream reporting changed file paths inside a worktree
+//
+
+import Foundation
+import CoreServices
+
+/// Reports worktree-relative paths of changed files. Changes under `.git` are left to
+/// GitIndexWatcher. `mustRescan` is set when FSEvents coalesced or dropped events and
+/// the reported paths can't be trusted to be complete.
+final class WorktreeFileEventWatcher: @unchecked Sendable {
+    private let rootPath: String
+    private let queue = DispatchQueue(label: "win.aiX.worktree-file-events", qos: .utility)
+    private let lock = NSLock()
+    private var stream: FSEventStreamRef?
+    private var onChange: (@Sendable (_ paths: [String], _ mustRescan: Bool) -> Void)?
+
+    private static let rescanFlags = FSEventStreamEventFlags(
+        kFSEventStreamEventFlagMustScanSubDirs |
+        kFSEventStreamEventFlagUserDropped |
+        kFSEventStreamEventFlagKernelDropped |
+        kFSEventStreamEventFlagRootChanged
+    )
+
+    init(worktreePath: String) {
+        // FSEvents reports resolved paths (e.g. /private/var/...)
+        let resolved = URL(fileURLWithPath: worktreePath).resolvingSymlinksInPath().path
+        self.rootPath = resolved.hasSuffix("/") ? String(resolved.dropLast()) : resolved
+    }
+
+    deinit {
+        stop()
+    }
+
+    @discardableResult
+    func start(
+        latency: TimeInterval = 0.2,
+        onChange: @escaping @Sendable (_ paths: [String], _ mustRescan: Bool) -> Void
+    ) -> Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        guard stream == nil else { return true }
+
+        self.onChange = onChange
+
+        var context = FSEventStreamContext(
+            version: 0,
+            info: Unmanaged.passUnretained(self).toOpaque(),
+            retain: nil,
+            release: nil,
+            copyDescription: nil
+        )
+        let flags = FSEventStreamCreateFlags(
+            kFSEventStreamCreateFlagFileEvents |
+            kFSEventStreamCreateFlagNoDefer |
+            kFSEventStreamCreateFlagUseCFTypes
+        )
+
+        guard let newStream = FSEventStreamCreate(
+            kCFAllocatorDefault,
+            Self.callback,
+            &context,
+            [rootPath] as CFArray,
+            FSEventStreamEventId(kFSEventStreamEventIdSinceNow),
+            latency,
+            flags
+        ) else {
+            self.onChange = nil
+            return false
+        }
+
+        FSEventStreamSetDispatchQueue(newStream, queue)
+        guard FSEventStreamStart(newStream) else {
+            FSEventStreamInvalidate(newStream)
+            FSEventStreamRelease(newStream)
+            self.onChange = nil
+            return false
+        }
+
+        stream = newStream
+        return true
+    }
+
+    func stop() {
+        lock.lock()
+        let current = stream
+        stream = nil
+        onChange = nil
+        lock.unlock()
+
+        guard let current else { return }
+        FSEventStreamStop(current)
+        FSEventStreamInvalidate(current)
+        FSEventStreamRelease(current)
+    }
+
+    private static let callback: FSEventStreamCallback = { _, info, count, eventPaths, eventFlags, _ in
+        guard let info else { return }
+        let watcher = Unmanaged<WorktreeFileEventWatcher>.fromOpaque(info).takeUnretainedValue()
+        let paths = unsafeBitCast(eventPaths, to: NSArray.self) as? [String] ?? []
+        watcher.handle(paths: paths, flags: UnsafeBufferPointer(start: eventFlags, count: count))
+    }
+
+    private func handle(paths: [String], flags: UnsafeBufferPointer<FSEventStreamEventFlags>) {
+        let prefix = rootPath + "/"
+        var relativePaths: [String] = []
+        var mustRescan = false
+
+        for (path, flag) in zip(paths, flags) {
+            if flag & Self.rescanFlags != 0 {
+                mustRescan = true
+                continue
+            }
+            guard path.hasPrefix(prefix) else { continue }
+            let relativePath = String(path.dropFirst(prefix.count))
+            if relativePath == ".git" || relativePath.hasPrefix(".git/") {
+                continue
+            }
+            relativePaths.append(relativePath)
+        }
+
+        guard !relativePaths.isEmpty || mustRescan else { return }
+
+        lock.lock()
+        let handler = onChange
+        lock.unlock()
+        handler?(relativePaths, mustRescan)
+    }
+}
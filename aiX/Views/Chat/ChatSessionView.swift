@@ -50,7 +50,7 @@ struct ChatSessionView: View {
             VStack(spacing: 0) {
                 ZStack(alignment: .bottomTrailing) {
                     ChatMessageList(
-                        timelineItems: viewModel.timelineItems,
+                        timeline: viewModel.timeline,
                         isProcessing: viewModel.isProcessing,
                         isSessionInitializing: viewModel.isSessionInitializing,
                         selectedAgent: viewModel.selectedAgent,
@@ -268,7 +268,7 @@ struct ChatSessionView: View {
     }
 
     private var shouldShowScrollToBottom: Bool {
-        !viewModel.isNearBottom && !viewModel.timelineItems.isEmpty
+        !viewModel.isNearBottom && viewModel.hasTimelineItems
     }
 
     private func scrollToBottom() {
@@ -6,13 +6,9 @@
 //
 
 import Foundation
-import ObjectiveC
 import SwiftUI
 import Combine
 
-// MARK: - Timeline Index Storage
-private var timelineIndexKey: UInt8 = 0
-
 extension ChatSessionViewModel {
     struct ScrollRequest: Equatable {
         let id: UUID
@@ -20,37 +16,14 @@ extension ChatSessionViewModel {
         let force: Bool
     }
 
-    // MARK: - Timeline Index (O(1) Lookup)
-
-    /// Dictionary for O(1) timeline item lookups by ID
-    private var timelineIndex: [String: Int] {
-        get {
-            objc_getAssociatedObject(self, &timelineIndexKey) as? [String: Int] ?? [:]
-        }
-        set {
-            objc_setAssociatedObject(self, &timelineIndexKey, newValue, .OBJC_ASSOCIATION_RETAIN_NONATOMIC)
-        }
-    }
-
-    /// Rebuild the timeline index from current items (uses stableId for consistent lookups)
-    private func rebuildTimelineIndex() {
-        // Use uniquingKeysWith to handle duplicates gracefully (keep last index)
-        timelineIndex = Dictionary(
-            timelineItems.enumerated().map { ($1.stableId, $0) },
-            uniquingKeysWith: { _, new in new }
-        )
-    }
-
     // MARK: - Timeline
 
     /// Full rebuild - used only for initial load or major state changes
     func rebuildTimeline() {
         // Build timeline and deduplicate by stableId (keep first occurrence)
-        var seen = Set<String>()
-        timelineItems = (messages.map { .message($0) } + toolCalls.map { .toolCall($0) })
+        let items: [TimelineItem] = (messages.map { .message($0) } + toolCalls.map { .toolCall($0) })
             .sorted { $0.timestamp < $1.timestamp }
-            .filter { seen.insert($0.stableId).inserted }
-        rebuildTimelineIndex()
+        timeline.replaceAll(with: items)
     }
 
     /// Rebuild timeline with tool call grouping by message boundaries
@@ -185,8 +158,7 @@ extension ChatSessionViewModel {
             items.append(.message(sysMsg))
         }
 
-        timelineItems = items
-        rebuildTimelineIndex()
+        timeline.replaceAll(with: items)
     }
 
     /// Create turn summary from all tool calls in the turn
@@ -248,8 +220,9 @@ extension ChatSessionViewModel {
             }
         }
 
+        // Keyed by the turn's first tool call so regrouping keeps the same row
         return TurnSummary(
-            id: UUID().uuidString,
+            id: toolCalls.min { $0.timestamp < $1.timestamp }?.id ?? UUID().uuidString,
             timestamp: endTime,
             duration: duration,
             toolCallCount: toolCalls.count,
@@ -270,7 +243,8 @@ extension ChatSessionViewModel {
     }
 
     /// Sync messages incrementally - update existing or insert new
-    /// When a new agent message is added, triggers timeline rebuild to group preceding tool calls
+    /// When a new agent message is added, the preceding tool calls are grouped: in place while
+    /// streaming, otherwise by a timeline rebuild
     func syncMessages(_ newMessages: [MessageItem]) {
         let newIds = Set(newMessages.map { $0.id })
         let addedIds = newIds.subtracting(previousMessageIds)
@@ -281,9 +255,14 @@ extension ChatSessionViewModel {
         let newAgentMessageAdded = newMessages.contains { msg in
             addedIds.contains(msg.id) && msg.role == .agent
         }
+        let groupedInPlace = newAgentMessageAdded && groupToolCallsInPlace(
+            addedIds: addedIds,
+            removedIds: removedIds,
+            in: newMessages
+        )
 
         // If a new agent message arrived, rebuild with grouping to collapse previous tool calls
-        if newAgentMessageAdded {
+        if newAgentMessageAdded && !groupedInPlace {
             let isStreaming = currentAgentSession?.isStreaming ?? false
             // Skip animation during streaming to prevent layout issues
             if isStreaming {
@@ -297,82 +276,69 @@ extension ChatSessionViewModel {
             return
         }
 
-        var didMutate = false
-
         let updateBlock = { [self] in
-            // 0. Remove any messages that no longer exist
-            if !removedIds.isEmpty {
-                timelineItems.removeAll { removedIds.contains($0.stableId) }
-                didMutate = true
-            }
-
-            // 1. Insert new messages FIRST (changes structure/indices)
-            for newMsg in newMessages where addedIds.contains(newMsg.id) {
-                insertTimelineItem(.message(newMsg))
-                didMutate = true
-            }
+            timeline.remove(ids: removedIds)
 
-            // 2. Rebuild index IMMEDIATELY after structural changes
-            if hasStructuralChanges {
-                rebuildTimelineIndex()
-            }
-
-            // 3. Update existing messages AFTER index is fresh
-            for newMsg in newMessages where previousMessageIds.contains(newMsg.id) {
-                if let idx = timelineIndex[newMsg.id], idx < timelineItems.count {
-                    timelineItems[idx] = .message(newMsg)
-                    didMutate = true
+            for newMsg in newMessages {
+                if addedIds.contains(newMsg.id) {
+                    timeline.insert(.message(newMsg))
+                } else {
+                    timeline.update(.message(newMsg))
                 }
             }
         }
 
-        // Only animate structural changes after initial load
-        if hasStructuralChanges && !previousMessageIds.isEmpty {
+        // Only animate structural changes after initial load, and not while streaming in a group
+        if hasStructuralChanges && !previousMessageIds.isEmpty && !groupedInPlace {
             withAnimation(.easeInOut(duration: 0.2)) { updateBlock() }
         } else {
             updateBlock()
         }
 
-        // Force publish for in-place mutations (content updates during streaming).
-        if didMutate {
-            timelineItems = timelineItems
-        }
-
         // Update tracked IDs for next sync
         previousMessageIds = newIds
     }
 
+    /// Group the tool call rows before a single newly arrived agent message without rebuilding
+    /// the timeline. Only used while streaming, when the turn's calls are still individual rows;
+    /// returns false when a full regroup is needed.
+    private func groupToolCallsInPlace(addedIds: Set<String>, removedIds: Set<String>, in newMessages: [MessageItem]) -> Bool {
+        guard currentAgentSession?.isStreaming == true,
+              removedIds.isEmpty,
+              addedIds.count == 1,
+              let message = newMessages.last(where: { addedIds.contains($0.id) }) else {
+            return false
+        }
+
+        let previousAgentMessageId = newMessages.last {
+            $0.role == .agent && $0.id != message.id && $0.timestamp <= message.timestamp
+        }?.id
+        return timeline.groupToolCalls(before: message.timestamp) { calls in
+            createGroupFromBuffer(toolCalls: calls, messageId: previousAgentMessageId, isCompletedTurn: true)
+        }
+    }
+
     /// Sync tool calls incrementally - update existing or insert new
     func syncToolCalls(_ newToolCalls: [ToolCall]) {
         let newIds = Set(newToolCalls.map { $0.id })
         let addedIds = newIds.subtracting(previousToolCallIds)
         let removedIds = previousToolCallIds.subtracting(newIds)
         let hasStructuralChanges = !addedIds.isEmpty || !removedIds.isEmpty
-        var didMutate = false
 
         let updateBlock = { [self] in
-            // 0. Remove any tool calls that no longer exist
-            if !removedIds.isEmpty {
-                timelineItems.removeAll { removedIds.contains($0.stableId) }
-                didMutate = true
-            }
-
-            // 1. Insert new tool calls FIRST (changes structure/indices)
-            for newCall in newToolCalls where addedIds.contains(newCall.id) {
-                insertTimelineItem(.toolCall(newCall))
-                didMutate = true
-            }
-
-            // 2. Rebuild index IMMEDIATELY after structural changes
-            if hasStructuralChanges {
-                rebuildTimelineIndex()
-            }
-
-            // 3. Update existing tool calls AFTER index is fresh
-            for newCall in newToolCalls where previousToolCallIds.contains(newCall.id) {
-                if let idx = timelineIndex[newCall.id], idx < timelineItems.count {
-                    timelineItems[idx] = .toolCall(newCall)
-                    didMutate = true
+            timeline.remove(ids: removedIds)
+
+            for newCall in newToolCalls {
+                let changed: Bool
+                if addedIds.contains(newCall.id) {
+                    timeline.insert(.toolCall(newCall))
+                    changed = true
+                } else {
+                    changed = timeline.update(toolCall: newCall)
+                }
+                // Children render inside their parent's row
+                if changed, let parentId = newCall.parentToolCallId {
+                    timeline.refreshRow(containingToolCall: parentId)
                 }
             }
         }
@@ -385,40 +351,10 @@ extension ChatSessionViewModel {
             updateBlock()
         }
 
-        // Force publish for in-place mutations.
-        if didMutate {
-            timelineItems = timelineItems
-        }
-
         // Update tracked IDs for next sync
         previousToolCallIds = newIds
     }
 
-    /// Insert timeline item maintaining sorted order by timestamp
-    private func insertTimelineItem(_ item: TimelineItem) {
-        // Skip if item already exists (prevent duplicates)
-        if timelineItems.contains(where: { $0.stableId == item.stableId }) {
-            return
-        }
-
-        let timestamp = item.timestamp
-
-        // Binary search for insert position
-        var low = 0
-        var high = timelineItems.count
-
-        while low < high {
-            let mid = (low + high) / 2
-            if timelineItems[mid].timestamp < timestamp {
-                low = mid + 1
-            } else {
-                high = mid
-            }
-        }
-
-        timelineItems.insert(item, at: low)
-    }
-
     // MARK: - Tool Call Grouping
 
     /// Get child tool calls for a parent Task
@@ -38,7 +38,8 @@ class ChatSessionViewModel: ObservableObject {
     @Published var currentAgentSession: AgentSession?
     @Published var currentPermissionRequest: RequestPermissionRequest?
     @Published var attachments: [ChatAttachment] = []
-    @Published var timelineItems: [TimelineItem] = []
+    let timeline = ChatTimelineStore()
+    @Published private(set) var hasTimelineItems = false
 
     // Track previous IDs for incremental sync (avoids storing full duplicate arrays)
     var previousMessageIds: Set<String> = []
@@ -154,6 +155,11 @@ class ChatSessionViewModel: ObservableObject {
 
         self.agentSwitcher = AgentSwitcher(viewContext: viewContext, session: session)
 
+        timeline.$rows
+            .map { !$0.isEmpty }
+            .removeDuplicates()
+            .assign(to: &$hasTimelineItems)
+
         setupNotificationObservers()
         setupInputTextObserver()
     }
@@ -357,7 +363,7 @@ class ChatSessionViewModel: ObservableObject {
         // Clear tracked IDs and timeline (messages/toolCalls are computed from session)
         previousMessageIds = []
         previousToolCallIds = []
-        timelineItems = []
+        timeline.removeAll()
 
         setupAgentSession()
         pendingAgentSwitch = nil
@@ -377,7 +383,7 @@ class ChatSessionViewModel: ObservableObject {
             // Clear timeline
             previousMessageIds = []
             previousToolCallIds = []
-            timelineItems = []
+            timeline.removeAll()
 
             // Restart the session
             let worktreePath = worktree.path ?? ""
@@ -0,0 +1,286 @@
+//
+//  ChatTimelineStore.swift
+//  aizen
+//
+//  Ordered, indexed chat timeline with per-row updates
+//
+
+import Foundation
+import Combine
+
+/// One row of the chat timeline. Content updates publish from the row itself, so only
+/// that row re-renders; the store's row list changes only on inserts and removals.
+@MainActor
+final class TimelineRow: ObservableObject, Identifiable {
+    let id: String
+    @Published fileprivate(set) var item: TimelineItem
+
+    init(_ item: TimelineItem) {
+        self.id = item.stableId
+        self.item = item
+    }
+}
+
+/// Timeline items ordered by timestamp with an id → position index.
+///
+/// Appends (the streaming case) and in-place updates are O(1). A mid-timeline insert or
+/// removal shifts the array and marks positions after it stale; they are re-indexed on
+/// the next lookup. Grouping the tool calls before a new agent message touches only those
+/// rows. Replacing the whole timeline (regrouping) keeps rows whose stable id
+/// survives, so unchanged rows keep their identity and view state.
+@MainActor
+final class ChatTimelineStore: ObservableObject {
+    @Published private(set) var rows: [TimelineRow] = []
+
+    private var positions: [String: Int] = [:]
+    // Positions at or after this index are stale
+    private var staleFrom: Int?
+    // Tool call id -> stable id of the group row that renders it
+    private var groupMembership: [String: String] = [:]
+
+    var isEmpty: Bool { rows.isEmpty }
+    var count: Int { rows.count }
+    var items: [TimelineItem] { rows.map(\.item) }
+
+    func contains(_ id: String) -> Bool {
+        position(of: id) != nil
+    }
+
+    func item(withId id: String) -> TimelineItem? {
+        position(of: id).map { rows[$0].item }
+    }
+
+    // MARK: - Mutations
+
+    /// Insert keeping timestamp order; no-op if an item with the same stable id exists
+    func insert(_ item: TimelineItem) {
+        let id = item.stableId
+        guard position(of: id) == nil else { return }
+
+        let index: Int
+        if let last = rows.last, last.item.timestamp > item.timestamp {
+            index = insertionIndex(for: item.timestamp)
+        } else {
+            index = rows.count
+        }
+
+        rows.insert(TimelineRow(item), at: index)
+        if index == rows.count - 1 {
+            positions[id] = index
+        } else {
+            markStale(from: index)
+        }
+        trackGroupMembership(of: item)
+    }
+
+    /// Replace an existing item in place. Returns false if it isn't in the timeline.
+    @discardableResult
+    func update(_ item: TimelineItem) -> Bool {
+        guard let index = position(of: item.stableId) else { return false }
+        let row = rows[index]
+        guard Self.hasChanged(from: row.item, to: item) else { return true }
+
+        row.item = item
+        trackGroupMembership(of: item)
+        return true
+    }
+
+    /// Update a tool call wherever it renders: its own row or the group row holding it.
+    /// Returns whether a row changed.
+    @discardableResult
+    func update(toolCall: ToolCall) -> Bool {
+        if let index = position(of: toolCall.id) {
+            let row = rows[index]
+            guard Self.hasChanged(from: row.item, to: .toolCall(toolCall)) else { return false }
+            row.item = .toolCall(toolCall)
+            return true
+        }
+
+        guard let groupId = groupMembership[toolCall.id],
+              let index = position(of: groupId),
+              case .toolCallGroup(var group) = rows[index].item,
+              let callIndex = group.toolCalls.firstIndex(where: { $0.id == toolCall.id }),
+              Self.hasChanged(from: .toolCall(group.toolCalls[callIndex]), to: .toolCall(toolCall)) else {
+            return false
+        }
+        group.toolCalls[callIndex] = toolCall
+        rows[index].item = .toolCallGroup(group)
+        return true
+    }
+
+    func remove(ids: Set<String>) {
+        guard !ids.isEmpty else { return }
+        let indices = ids.compactMap { position(of: $0) }.sorted(by: >)
+        guard let lowest = indices.last else { return }
+
+        for index in indices {
+            let row = rows.remove(at: index)
+            positions.removeValue(forKey: row.id)
+        }
+        groupMembership = groupMembership.filter { !ids.contains($0.value) }
+        markStale(from: lowest)
+    }
+
+    /// Collapse the tool call rows directly before where an item at `timestamp` would be
+    /// inserted into one group row: the in-place form of regrouping when an agent message
+    /// arrives. The run is found by binary search and only its rows are replaced. Child calls
+    /// in the run are dropped, as they render inside their parent. Returns false, leaving the
+    /// timeline unchanged, when a system message borders or interrupts the run, since a full
+    /// regroup moves those to the end of the turn.
+    func groupToolCalls(before timestamp: Date, makeGroup: ([ToolCall]) -> ToolCallGroup) -> Bool {
+        let end: Int
+        if let last = rows.last, last.item.timestamp > timestamp {
+            end = insertionIndex(for: timestamp)
+        } else {
+            end = rows.count
+        }
+
+        var start = end
+        var calls: [ToolCall] = []
+        scan: while start > 0 {
+            switch rows[start - 1].item {
+            case .toolCall(let call):
+                if call.parentToolCallId == nil {
+                    calls.append(call)
+                }
+                start -= 1
+            case .message(let message) where message.role == .system:
+                return false
+            default:
+                break scan
+            }
+        }
+        guard start < end else { return true }
+
+        for row in rows[start..<end] {
+            positions.removeValue(forKey: row.id)
+        }
+        if calls.isEmpty {
+            rows.removeSubrange(start..<end)
+        } else {
+            let group = TimelineItem.toolCallGroup(makeGroup(calls.reversed()))
+            rows.replaceSubrange(start..<end, with: [TimelineRow(group)])
+            trackGroupMembership(of: group)
+        }
+        markStale(from: start)
+        return true
+    }
+
+    /// Re-render the row showing `toolCallId` (directly or through its group), e.g. after
+    /// one of its child tool calls changed
+    func refreshRow(containingToolCall toolCallId: String) {
+        guard let id = contains(toolCallId) ? toolCallId : groupMembership[toolCallId],
+              let index = position(of: id) else { return }
+        rows[index].objectWillChange.send()
+    }
+
+    /// Replace the timeline. Rows whose stable id survives are kept and updated in place.
+    func replaceAll(with items: [TimelineItem]) {
+        let existing = Dictionary(rows.map { ($0.id, $0) }, uniquingKeysWith: { first, _ in first })
+        var seen = Set<String>()
+        var newRows: [TimelineRow] = []
+        newRows.reserveCapacity(items.count)
+
+        for item in items {
+            let id = item.stableId
+            guard seen.insert(id).inserted else { continue }
+            if let row = existing[id] {
+                if Self.hasChanged(from: row.item, to: item) {
+                    row.item = item
+                }
+                newRows.append(row)
+            } else {
+                newRows.append(TimelineRow(item))
+            }
+        }
+
+        rows = newRows
+        positions = Dictionary(newRows.enumerated().map { ($1.id, $0) }, uniquingKeysWith: { first, _ in first })
+        staleFrom = nil
+        groupMembership = [:]
+        for row in newRows {
+            trackGroupMembership(of: row.item)
+        }
+    }
+
+    func removeAll() {
+        guard !rows.isEmpty else { return }
+        rows = []
+        positions = [:]
+        staleFrom = nil
+        groupMembership = [:]
+    }
+
+    // MARK: - Indexing
+
+    private func position(of id: String) -> Int? {
+        reindexIfNeeded()
+        return positions[id]
+    }
+
+    private func markStale(from index: Int) {
+        staleFrom = min(staleFrom ?? index, index)
+    }
+
+    private func reindexIfNeeded() {
+        guard let start = staleFrom else { return }
+        staleFrom = nil
+        for index in start..<rows.count {
+            positions[rows[index].id] = index
+        }
+    }
+
+    // First index whose timestamp is after `timestamp` (equal timestamps keep arrival order)
+    private func insertionIndex(for timestamp: Date) -> Int {
+        var low = 0
+        var high = rows.count
+        while low < high {
+            let mid = (low + high) / 2
+            if rows[mid].item.timestamp <= timestamp {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return low
+    }
+
+    private func trackGroupMembership(of item: TimelineItem) {
+        guard case .toolCallGroup(let group) = item else { return }
+        for call in group.toolCalls {
+            groupMembership[call.id] = item.stableId
+        }
+    }
+
+    // Cheap revision check so unchanged items don't re-render their row
+    private static func hasChanged(from old: TimelineItem, to new: TimelineItem) -> Bool {
+        switch (old, new) {
+        case (.message(let a), .message(let b)):
+            return a != b
+        case (.toolCall(let a), .toolCall(let b)):
+            // Every stored change bumps the revision, including output streamed into existing
+            // content blocks; the field checks cover calls built outside AgentSession
+            return a.revision != b.revision
+                || a.status != b.status
+                || a.title != b.title
+                || a.kind != b.kind
+                || a.content.count != b.content.count
+                || a.locations?.count != b.locations?.count
+                || (a.rawOutput == nil) != (b.rawOutput == nil)
+        case (.toolCallGroup(let a), .toolCallGroup(let b)):
+            return a.isCompletedTurn != b.isCompletedTurn
+                || a.messageId != b.messageId
+                || a.turnEndTime != b.turnEndTime
+                || a.toolCalls.count != b.toolCalls.count
+                || zip(a.toolCalls, b.toolCalls).contains { old, new in
+                    old.id != new.id || hasChanged(from: .toolCall(old), to: .toolCall(new))
+                }
+        case (.turnSummary(let a), .turnSummary(let b)):
+            return a.toolCallCount != b.toolCallCount
+                || a.duration != b.duration
+                || a.fileChanges.count != b.fileChanges.count
+        default:
+            return old.id != new.id
+        }
+    }
+}
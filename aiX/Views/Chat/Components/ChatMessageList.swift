@@ -197,7 +197,7 @@ private struct ScrollViewObserver: NSViewRepresentable {
 }
 
 struct ChatMessageList: View {
-    let timelineItems: [TimelineItem]
+    @ObservedObject var timeline: ChatTimelineStore
     let isProcessing: Bool
     let isSessionInitializing: Bool
     let selectedAgent: String
@@ -220,7 +220,7 @@ struct ChatMessageList: View {
     @State private var allowAnimations = false
 
     private var shouldShowLoading: Bool {
-        isSessionInitializing && timelineItems.isEmpty
+        isSessionInitializing && timeline.isEmpty
     }
 
     var body: some View {
@@ -275,58 +275,8 @@ struct ChatMessageList: View {
     private var messageListContent: some View {
         ScrollView(showsIndicators: false) {
             LazyVStack(spacing: 16) {
-                ForEach(timelineItems, id: \.stableId) { item in
-                    switch item {
-                    case .message(let message):
-                        MessageBubbleView(
-                            message: message,
-                            agentName: message.role == .agent ? selectedAgent : nil
-                        )
-                        .id(message.id)
-                        .transition(
-                            message.isComplete
-                                ? .opacity.combined(with: .scale(scale: 0.95)) : .identity)
-                    case .toolCall(let toolCall):
-                        // Skip child tool calls (rendered inside parent Task)
-                        if toolCall.parentToolCallId != nil {
-                            EmptyView()
-                        } else {
-                            let children = childToolCallsProvider(toolCall.toolCallId)
-                            ToolCallView(
-                                toolCall: toolCall,
-                                currentIterationId: currentIterationId,
-                                onOpenDetails: { tapped in onToolTap(tapped) },
-                                agentSession: agentSession,
-                                onOpenInEditor: onOpenFileInEditor,
-                                childToolCalls: children
-                            )
-                            .id(toolCall.id)
-                            .transition(
-                                toolCall.status == .pending
-                                    ? .opacity.combined(with: .move(edge: .leading)) : .identity
-                            )
-                        }
-                    case .toolCallGroup(let group):
-                        ToolCallGroupView(
-                            group: group,
-                            currentIterationId: currentIterationId,
-                            agentSession: agentSession,
-                            onOpenDetails: { tapped in onToolTap(tapped) },
-                            onOpenInEditor: onOpenFileInEditor,
-                            childToolCallsProvider: childToolCallsProvider
-                        )
-                        .id(group.id)
-                        .transition(.opacity.combined(with: .scale(scale: 0.98)))
-
-                    case .turnSummary(let summary):
-                        TurnSummaryView(
-                            summary: summary,
-                            onOpenInEditor: onOpenFileInEditor
-                        )
-                        .frame(maxWidth: .infinity, alignment: .leading)
-                        .id(summary.id)
-                        .transition(.opacity)
-                    }
+                ForEach(timeline.rows) { row in
+                    TimelineRowHost(row: row, content: timelineRowContent)
                 }
 
                 if isProcessing {
@@ -366,6 +316,61 @@ struct ChatMessageList: View {
         }
     }
 
+    @ViewBuilder
+    private func timelineRowContent(_ item: TimelineItem) -> some View {
+        switch item {
+        case .message(let message):
+            MessageBubbleView(
+                message: message,
+                agentName: message.role == .agent ? selectedAgent : nil
+            )
+            .id(message.id)
+            .transition(
+                message.isComplete
+                    ? .opacity.combined(with: .scale(scale: 0.95)) : .identity)
+        case .toolCall(let toolCall):
+            // Skip child tool calls (rendered inside parent Task)
+            if toolCall.parentToolCallId != nil {
+                EmptyView()
+            } else {
+                let children = childToolCallsProvider(toolCall.toolCallId)
+                ToolCallView(
+                    toolCall: toolCall,
+                    currentIterationId: currentIterationId,
+                    onOpenDetails: { tapped in onToolTap(tapped) },
+                    agentSession: agentSession,
+                    onOpenInEditor: onOpenFileInEditor,
+                    childToolCalls: children
+                )
+                .id(toolCall.id)
+                .transition(
+                    toolCall.status == .pending
+                        ? .opacity.combined(with: .move(edge: .leading)) : .identity
+                )
+            }
+        case .toolCallGroup(let group):
+            ToolCallGroupView(
+                group: group,
+                currentIterationId: currentIterationId,
+                agentSession: agentSession,
+                onOpenDetails: { tapped in onToolTap(tapped) },
+                onOpenInEditor: onOpenFileInEditor,
+                childToolCallsProvider: childToolCallsProvider
+            )
+            .id(group.id)
+            .transition(.opacity.combined(with: .scale(scale: 0.98)))
+
+        case .turnSummary(let summary):
+            TurnSummaryView(
+                summary: summary,
+                onOpenInEditor: onOpenFileInEditor
+            )
+            .frame(maxWidth: .infinity, alignment: .leading)
+            .id(summary.id)
+            .transition(.opacity)
+        }
+    }
+
     /// Only trigger scroll if force is true or auto-scroll is enabled
     private var shouldTriggerScroll: Bool {
         guard let request = scrollRequest else { return false }
@@ -422,3 +427,13 @@ struct ChatMessageList: View {
         .frame(maxWidth: .infinity, alignment: .leading)
     }
 }
+
+/// Observes a single timeline row so its content updates re-render only that row
+private struct TimelineRowHost<Content: View>: View {
+    @ObservedObject var row: TimelineRow
+    let content: (TimelineItem) -> Content
+
+    var body: some View {
+        content(row.item)
+    }
+}
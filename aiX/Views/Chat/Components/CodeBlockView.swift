@@ -221,7 +221,8 @@ struct CodeBlockView: View {
         if let attributed = await HighlightingQueue.shared.highlight(
             code: codeSnapshot,
             language: detectedLanguage,
-            theme: theme
+            theme: theme,
+            themeName: effectiveThemeName
         ) {
             if codeSnapshot == trimmedCode {
                 highlightedText = attributed
@@ -297,13 +297,28 @@ final class MarkdownParser {
     func parse(_ content: String) -> ParsedMarkdownDocument {
         guard !content.isEmpty else { return .empty }
 
+        let result = parseBlocks(content, startIndex: 0)
+        return ParsedMarkdownDocument(
+            blocks: result.blocks,
+            footnotes: result.footnotes,
+            isComplete: true,
+            streamingBuffer: ""
+        )
+    }
+
+    /// Parse a run of complete blocks. Block IDs are numbered from `startIndex`, so a
+    /// document parsed in consecutive pieces gets the same IDs as a single parse would.
+    func parseBlocks(
+        _ content: String,
+        startIndex: Int
+    ) -> (blocks: [MarkdownBlock], footnotes: [String: MarkdownBlock], nextIndex: Int) {
         var parserOptions: ParseOptions = []
         if options.parseSymbolLinks { parserOptions.insert(.parseSymbolLinks) }
         if options.parseBlockDirectives { parserOptions.insert(.parseBlockDirectives) }
 
         var blocks: [MarkdownBlock] = []
         var footnotes: [String: MarkdownBlock] = [:]
-        var index = 0
+        var index = startIndex
 
         // Extract $$...$$ math blocks first, then parse markdown segments
         let segments = extractMathBlocks(from: content)
@@ -326,19 +341,15 @@ final class MarkdownParser {
             }
         }
 
-        return ParsedMarkdownDocument(
-            blocks: blocks,
-            footnotes: footnotes,
-            isComplete: true,
-            streamingBuffer: ""
-        )
+        return (blocks, footnotes, index)
     }
 
     /// Extract $$...$$ block math from content, skipping fenced code blocks
     private func extractMathBlocks(from content: String) -> [(content: String, isMath: Bool)] {
         var segments: [(content: String, isMath: Bool)] = []
         var current = ""
-        var inCodeFence = false
+        // Fence that opened the current code block; only the same fence closes it
+        var openFence: String?
 
         func flushCurrentIfNeeded() {
             if !current.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty {
@@ -347,23 +358,24 @@ final class MarkdownParser {
             current = ""
         }
 
-        func isFenceStart(at index: String.Index) -> Bool {
-            guard content[index...].hasPrefix("```") else { return false }
+        func fence(at index: String.Index) -> String? {
+            let candidates = openFence.map { [$0] } ?? ["```", "~~~"]
+            guard let fence = candidates.first(where: { content[index...].hasPrefix($0) }) else { return nil }
             let lineStart = content[..<index].lastIndex(of: "\n").map { content.index(after: $0) } ?? content.startIndex
             let prefix = content[lineStart..<index]
-            return prefix.allSatisfy { $0 == " " || $0 == "\t" }
+            return prefix.allSatisfy { $0 == " " || $0 == "\t" } ? fence : nil
         }
 
         var i = content.startIndex
         while i < content.endIndex {
-            if isFenceStart(at: i) {
-                inCodeFence.toggle()
-                current.append(contentsOf: "```")
+            if let fence = fence(at: i) {
+                openFence = openFence == nil ? fence : nil
+                current.append(contentsOf: fence)
                 i = content.index(i, offsetBy: 3)
                 continue
             }
 
-            if !inCodeFence && content[i...].hasPrefix("$$") {
+            if openFence == nil && content[i...].hasPrefix("$$") {
                 flushCurrentIfNeeded()
 
                 let afterStart = content.index(i, offsetBy: 2)
@@ -391,32 +403,6 @@ final class MarkdownParser {
         return segments.isEmpty ? [(content, false)] : segments
     }
 
-    /// Parse markdown content with streaming support
-    func parseStreaming(_ content: String, isComplete: Bool) -> ParsedMarkdownDocument {
-        if isComplete {
-            return parse(content)
-        }
-
-        let (stableContent, buffer) = findStableBoundary(in: content)
-
-        if stableContent.isEmpty {
-            return ParsedMarkdownDocument(
-                blocks: [],
-                footnotes: [:],
-                isComplete: false,
-                streamingBuffer: content
-            )
-        }
-
-        let result = parse(stableContent)
-        return ParsedMarkdownDocument(
-            blocks: result.blocks,
-            footnotes: result.footnotes,
-            isComplete: false,
-            streamingBuffer: buffer
-        )
-    }
-
     // MARK: - Block Parsing
 
     private func parseBlockElement(_ element: Markup, index: inout Int) -> MarkdownBlock? {
@@ -861,85 +847,6 @@ final class MarkdownParser {
         }
         return alt.isEmpty ? nil : alt
     }
-
-    private func findStableBoundary(in content: String) -> (stable: String, buffer: String) {
-        var inCodeBlock = false
-        var inMathBlock = false
-        var codeBlockStart: String.Index?
-        var mathBlockStart: String.Index?
-        var lastStableBoundary = content.startIndex
-        var i = content.startIndex
-
-        while i < content.endIndex {
-            // Check for $$ math block
-            if content[i] == "$" && !inCodeBlock {
-                let remaining = content[i...]
-                if remaining.hasPrefix("$$") {
-                    if inMathBlock {
-                        // End of math block
-                        let endOfMath = content.index(i, offsetBy: 2, limitedBy: content.endIndex) ?? content.endIndex
-                        inMathBlock = false
-                        mathBlockStart = nil
-                        lastStableBoundary = endOfMath
-                        i = endOfMath
-                        continue
-                    } else {
-                        // Start of math block
-                        inMathBlock = true
-                        mathBlockStart = i
-                        i = content.index(i, offsetBy: 2, limitedBy: content.endIndex) ?? content.endIndex
-                        continue
-                    }
-                }
-            }
-
-            // Check for ``` code block
-            if content[i] == "`" && !inMathBlock {
-                let remaining = content[i...]
-                if remaining.hasPrefix("```") {
-                    if inCodeBlock {
-                        var endOfLine = content.index(i, offsetBy: 3, limitedBy: content.endIndex) ?? content.endIndex
-                        while endOfLine < content.endIndex && content[endOfLine] != "\n" {
-                            endOfLine = content.index(after: endOfLine)
-                        }
-                        if endOfLine < content.endIndex {
-                            endOfLine = content.index(after: endOfLine)
-                        }
-                        inCodeBlock = false
-                        codeBlockStart = nil
-                        lastStableBoundary = endOfLine
-                        i = endOfLine
-                        continue
-                    } else {
-                        inCodeBlock = true
-                        codeBlockStart = i
-                    }
-                }
-            }
-
-            if !inCodeBlock && !inMathBlock && content[i] == "\n" {
-                let next = content.index(after: i)
-                if next < content.endIndex && content[next] == "\n" {
-                    lastStableBoundary = content.index(after: next)
-                }
-            }
-
-            i = content.index(after: i)
-        }
-
-        // If we're inside an unclosed block, reset to before that block
-        if inCodeBlock, let start = codeBlockStart {
-            lastStableBoundary = start
-        }
-        if inMathBlock, let start = mathBlockStart {
-            lastStableBoundary = min(lastStableBoundary, start)
-        }
-
-        let stable = String(content[..<lastStableBoundary])
-        let buffer = String(content[lastStableBoundary...])
-
-        return (stable, buffer)
-    }
 }
 
 // MARK: - AttributedString Rendering
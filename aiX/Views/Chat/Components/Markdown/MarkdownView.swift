@@ -475,6 +475,7 @@ final class MarkdownViewModel: ObservableObject {
     @Published var streamingBuffer: String = ""
 
     private let parser = MarkdownParser()
+    private lazy var streamingParser = StreamingMarkdownParser(parser: parser)
     private var lastContent: String = ""
     private var lastIsStreaming: Bool = false
 
@@ -484,12 +485,21 @@ final class MarkdownViewModel: ObservableObject {
         lastContent = content
         lastIsStreaming = isStreaming
 
-        let document = isStreaming
-            ? parser.parseStreaming(content, isComplete: false)
-            : parser.parse(content)
+        let document: ParsedMarkdownDocument
+        if isStreaming {
+            // Only newly settled blocks are parsed; earlier blocks keep their IDs
+            document = streamingParser.update(content)
+        } else {
+            streamingParser.reset()
+            document = parser.parse(content)
+        }
 
-        blocks = document.blocks
-        streamingBuffer = document.streamingBuffer
+        if document.blocks != blocks {
+            blocks = document.blocks
+        }
+        if document.streamingBuffer != streamingBuffer {
+            streamingBuffer = document.streamingBuffer
+        }
     }
 }
 
@@ -0,0 +1,248 @@
+//
+//  StreamingMarkdownParser.swift
+//  aizen
+//
+//  Incremental block parsing for streamed chat markdown
+//
+
+import Foundation
+
+/// Parses a growing markdown string without re-parsing what is already settled.
+///
+/// Content is split at stable boundaries (blank lines, closed ``` or ~~~ fences, closed `$$`
+/// blocks), found by a byte scan that resumes where the previous update stopped. Blocks
+/// before the last boundary that can't be continued by later text are frozen: parsed
+/// once and kept with their IDs. Only the still-open stable region is re-parsed, and only
+/// when a new boundary arrives; text after the last boundary is returned raw as the
+/// streaming buffer.
+final class StreamingMarkdownParser {
+    private let parser: MarkdownParser
+
+    // Frozen prefix (UTF-8 offsets)
+    private var frozenBlocks: [MarkdownBlock] = []
+    private var frozenFootnotes: [String: MarkdownBlock] = [:]
+    private var frozenEnd = 0
+    private var frozenNextIndex = 0
+
+    // Stable region after the frozen prefix, re-parsed when its end moves
+    private var openBlocks: [MarkdownBlock] = []
+    private var openFootnotes: [String: MarkdownBlock] = [:]
+    private var openEnd = 0
+    // Boundaries after frozenEnd where freezing may become possible
+    private var candidates: [Int] = []
+
+    // frozen + open, rebuilt only when either changes
+    private var blocks: [MarkdownBlock] = []
+    private var footnotes: [String: MarkdownBlock] = [:]
+
+    // Boundary scan state, resumed on the next update
+    private var scanOffset = 0
+    private var stableEnd = 0
+    private var inCodeBlock = false
+    private var inMathBlock = false
+    private var codeBlockStart = 0
+    // "`" or "~"; only a fence of the same character closes the block
+    private var codeFenceByte: UInt8 = 0
+
+    // Detects content that was replaced rather than appended to
+    private var contentLength = 0
+    private var contentTail: [UInt8] = []
+    private static let tailCheckLength = 32
+
+    init(parser: MarkdownParser = MarkdownParser()) {
+        self.parser = parser
+    }
+
+    func reset() {
+        frozenBlocks = []
+        frozenFootnotes = [:]
+        frozenEnd = 0
+        frozenNextIndex = 0
+        openBlocks = []
+        openFootnotes = [:]
+        openEnd = 0
+        candidates = []
+        blocks = []
+        footnotes = [:]
+        scanOffset = 0
+        stableEnd = 0
+        inCodeBlock = false
+        inMathBlock = false
+        codeBlockStart = 0
+        codeFenceByte = 0
+        contentLength = 0
+        contentTail = []
+    }
+
+    /// Parse the current streamed content. Cheap when `content` extends the previous call's.
+    func update(_ content: String) -> ParsedMarkdownDocument {
+        var content = content
+        return content.withUTF8 { bytes in
+            if !extendsPrevious(bytes) {
+                reset()
+            }
+            rememberTail(bytes)
+
+            scan(bytes)
+
+            let effectiveStable = inCodeBlock ? max(codeBlockStart, frozenEnd) : stableEnd
+            var changed = freeze(bytes, upTo: effectiveStable)
+            if effectiveStable != openEnd {
+                parseOpenRegion(bytes, upTo: effectiveStable)
+                changed = true
+            }
+            if changed {
+                blocks = frozenBlocks + openBlocks
+                footnotes = frozenFootnotes.merging(openFootnotes) { _, new in new }
+            }
+
+            return ParsedMarkdownDocument(
+                blocks: blocks,
+                footnotes: footnotes,
+                isComplete: false,
+                streamingBuffer: Self.string(bytes, effectiveStable..<bytes.count)
+            )
+        }
+    }
+
+    // MARK: - Boundary Scan
+
+    private func scan(_ bytes: UnsafeBufferPointer<UInt8>) {
+        let end = bytes.count
+        var i = scanOffset
+
+        // Stops early (without consuming) where a marker's lookahead hasn't arrived yet
+        scanning: while i < end {
+            let byte = bytes[i]
+
+            if byte == UInt8(ascii: "$") && !inCodeBlock {
+                guard i + 1 < end else { break scanning }
+                if bytes[i + 1] == UInt8(ascii: "$") {
+                    if inMathBlock {
+                        inMathBlock = false
+                        markBoundary(i + 2)
+                    } else {
+                        inMathBlock = true
+                    }
+                    i += 2
+                    continue
+                }
+            }
+
+            if (byte == UInt8(ascii: "`") || byte == UInt8(ascii: "~")) && !inMathBlock
+                && (!inCodeBlock || byte == codeFenceByte) {
+                guard i + 2 < end else { break scanning }
+                if bytes[i + 1] == byte && bytes[i + 2] == byte {
+                    if inCodeBlock {
+                        // The fence closes at the end of its line
+                        var lineEnd = i + 3
+                        while lineEnd < end && bytes[lineEnd] != UInt8(ascii: "\n") {
+                            lineEnd += 1
+                        }
+                        guard lineEnd < end else { break scanning }
+                        inCodeBlock = false
+                        markBoundary(lineEnd + 1)
+                        i = lineEnd + 1
+                    } else {
+                        inCodeBlock = true
+                        codeBlockStart = i
+                        codeFenceByte = byte
+                        i += 3
+                    }
+                    continue
+                }
+            }
+
+            if byte == UInt8(ascii: "\n") && !inCodeBlock && !inMathBlock {
+                guard i + 1 < end else { break scanning }
+                if bytes[i + 1] == UInt8(ascii: "\n") {
+                    markBoundary(i + 2)
+                }
+            }
+
+            i += 1
+        }
+        scanOffset = i
+    }
+
+    private func markBoundary(_ offset: Int) {
+        stableEnd = offset
+        candidates.append(offset)
+    }
+
+    // MARK: - Freezing
+
+    /// Freeze at the last boundary whose following text can't continue the block before it
+    /// (list items, indented continuations, quotes and tables can span blank lines)
+    private func freeze(_ bytes: UnsafeBufferPointer<UInt8>, upTo limit: Int) -> Bool {
+        var target: Int?
+        var decided = 0
+        for boundary in candidates {
+            // The byte after the boundary must have arrived to decide
+            guard boundary <= limit, boundary < bytes.count else { break }
+            decided += 1
+            if !Self.mayContinueBlock(bytes[boundary]) {
+                target = boundary
+            }
+        }
+        candidates.removeFirst(decided)
+        guard let target else { return false }
+
+        let result = parser.parseBlocks(Self.string(bytes, frozenEnd..<target), startIndex: frozenNextIndex)
+        frozenBlocks.append(contentsOf: result.blocks)
+        frozenFootnotes.merge(result.footnotes) { _, new in new }
+        frozenNextIndex = result.nextIndex
+        frozenEnd = target
+
+        openBlocks = []
+        openFootnotes = [:]
+        openEnd = target
+        return true
+    }
+
+    private static func mayContinueBlock(_ byte: UInt8) -> Bool {
+        switch byte {
+        case UInt8(ascii: " "), UInt8(ascii: "\t"), UInt8(ascii: "\n"),
+             UInt8(ascii: "-"), UInt8(ascii: "*"), UInt8(ascii: "+"),
+             UInt8(ascii: ">"), UInt8(ascii: "|"),
+             UInt8(ascii: "0")...UInt8(ascii: "9"):
+            return true
+        default:
+            return false
+        }
+    }
+
+    private func parseOpenRegion(_ bytes: UnsafeBufferPointer<UInt8>, upTo limit: Int) {
+        openEnd = limit
+        guard limit > frozenEnd else {
+            openBlocks = []
+            openFootnotes = [:]
+            return
+        }
+        let result = parser.parseBlocks(Self.string(bytes, frozenEnd..<limit), startIndex: frozenNextIndex)
+        openBlocks = result.blocks
+        openFootnotes = result.footnotes
+    }
+
+    // MARK: - Helpers
+
+    private func extendsPrevious(_ bytes: UnsafeBufferPointer<UInt8>) -> Bool {
+        guard bytes.count >= contentLength else { return false }
+        let start = contentLength - contentTail.count
+        for (offset, byte) in contentTail.enumerated() where bytes[start + offset] != byte {
+            return false
+        }
+        return true
+    }
+
+    private func rememberTail(_ bytes: UnsafeBufferPointer<UInt8>) {
+        contentLength = bytes.count
+        let start = max(0, bytes.count - Self.tailCheckLength)
+        contentTail = Array(bytes[start..<bytes.count])
+    }
+
+    private static func string(_ bytes: UnsafeBufferPointer<UInt8>, _ range: Range<Int>) -> String {
+        guard !range.isEmpty else { return "" }
+        return String(decoding: UnsafeBufferPointer(rebasing: bytes[range]), as: UTF8.self)
+    }
+}
@@ -8,12 +8,18 @@
 import SwiftUI
 
 struct CopyButton: View {
-    let text: String
     let iconSize: CGFloat
+    private let text: () -> String
 
     @State private var showConfirmation = false
 
     init(text: String, iconSize: CGFloat = 10) {
+        self.text = { text }
+        self.iconSize = iconSize
+    }
+
+    /// Text made only when clicked, for content that is expensive to put together
+    init(iconSize: CGFloat = 10, text: @escaping () -> String) {
         self.text = text
         self.iconSize = iconSize
     }
@@ -30,7 +36,7 @@ struct CopyButton: View {
 
     private func copyToClipboard() {
         NSPasteboard.general.clearContents()
-        NSPasteboard.general.setString(text, forType: .string)
+        NSPasteboard.general.setString(text(), forType: .string)
 
         withAnimation {
             showConfirmation = true
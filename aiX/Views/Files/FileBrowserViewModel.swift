@@ -273,6 +273,9 @@ class FileBrowserViewModel: ObservableObject {
         let file = openFiles[index]
         try file.content.write(toFile: file.path, atomically: true, encoding: .utf8)
         openFiles[index].hasUnsavedChanges = false
+        Task {
+            await FileContentIndexService.shared.noteFileChanged(atPath: file.path)
+        }
     }
 
     func updateFileContent(id: UUID, content: String) {
@@ -19,6 +19,10 @@ class FileSearchViewModel: ObservableObject {
     private let searchService = FileSearchService.shared
     private let worktreePath: String
     private var allResults: [FileSearchIndexResult] = []
+    // Partial walk batches are accepted only while the walk runs; a search is re-run
+    // each time the listing doubles so ranking work stays linear in the tree size
+    private var isReceivingPartialResults = false
+    private var nextPartialSearchCount = 0
     private var cancellables = Set<AnyCancellable>()
     private var searchTask: Task<Void, Never>?
 
@@ -43,9 +47,18 @@ class FileSearchViewModel: ObservableObject {
         isIndexing = true
         searchTask?.cancel()
 
+        isReceivingPartialResults = true
+        nextPartialSearchCount = 256
+
         Task {
             do {
-                allResults = try await searchService.indexDirectory(worktreePath)
+                let indexed = try await searchService.indexDirectory(worktreePath) { [weak self] batch in
+                    Task { @MainActor [weak self] in
+                        self?.appendPartialResults(batch)
+                    }
+                }
+                isReceivingPartialResults = false
+                allResults = indexed
                 // Show recent files initially
                 let initialResults = await searchService.search(
                     query: "",
@@ -57,11 +70,21 @@ class FileSearchViewModel: ObservableObject {
                 isIndexing = false
             } catch {
                 print("Failed to index directory: \(error)")
+                isReceivingPartialResults = false
                 isIndexing = false
             }
         }
     }
 
+    // Show files found so far while a large non-git tree is still being walked
+    private func appendPartialResults(_ batch: [FileSearchIndexResult]) {
+        guard isReceivingPartialResults else { return }
+        allResults.append(contentsOf: batch)
+        guard allResults.count >= nextPartialSearchCount else { return }
+        nextPartialSearchCount = allResults.count * 2
+        performSearch()
+    }
+
     // Perform search (debouncing handled by Combine in init)
     func performSearch() {
         searchTask?.cancel()
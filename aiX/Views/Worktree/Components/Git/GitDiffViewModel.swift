@@ -7,7 +7,6 @@
 
 import SwiftUI
 import Combine
-import CryptoKit
 
 @MainActor
 class GitDiffViewModel: ObservableObject {
@@ -18,11 +17,14 @@ class GitDiffViewModel: ObservableObject {
     var visibleFile: String? // Not @Published to avoid re-renders
 
     private let cache: GitDiffCache
+    private let diffService = GitDiffService()
+    // Lines parsed before a streamed diff is first shown
+    nonisolated private static let previewLineCount = 200
     private var activeTasks: [String: Task<Void, Never>] = [:]
     private let repoPath: String
     private let untrackedFiles: Set<String>
 
-    init(repoPath: String, cache: GitDiffCache = GitDiffCache(), untrackedFiles: Set<String> = []) {
+    init(repoPath: String, cache: GitDiffCache = .shared, untrackedFiles: Set<String> = []) {
         self.repoPath = repoPath
         self.cache = cache
         self.untrackedFiles = untrackedFiles
@@ -46,9 +48,13 @@ class GitDiffViewModel: ObservableObject {
                 }
             }
 
-            if let cached = await self.cache.getDiff(for: file) {
+            let key = await self.diffKeys(for: [file])[file]
+            if let key, let cached = await self.cache.diff(for: key) {
+                let lines = await Task.detached(priority: .utility) {
+                    cached.diffLines()
+                }.value
                 await MainActor.run { [weak self] in
-                    self?.loadedDiffs[file] = cached.lines
+                    self?.loadedDiffs[file] = lines
                     self?.loadingFiles.remove(file)
                 }
                 return
@@ -60,23 +66,29 @@ class GitDiffViewModel: ObservableObject {
                 if isUntracked {
                     // For untracked files, read file content and show as all additions
                     lines = await self.loadUntrackedFileAsDiff(file)
+                    guard !Task.isCancelled else { return }
+                    if let key {
+                        await self.store(lines, for: key)
+                    }
                 } else {
-                    // Use git command for formatted diff output
-                    var diffOutput = await self.runGitDiff(["diff", "HEAD", "--", file])
-                    if diffOutput == nil {
-                        diffOutput = await self.runGitDiff(["diff", "--", file])
+                    // Parse git output as it streams in; the first screen is shown before git exits
+                    let diff = await Self.streamGitDiff(file, in: self.repoPath) { preview in
+                        await MainActor.run { [weak self] in
+                            guard !Task.isCancelled, self?.loadedDiffs[file] == nil else { return }
+                            self?.loadedDiffs[file] = preview
+                        }
                     }
-                    // Parse off the main actor to avoid blocking UI on large diffs
-                    lines = await Task.detached(priority: .utility) {
-                        DiffParser.parseUnifiedDiff(diffOutput ?? "")
+                    guard !Task.isCancelled else { return }
+                    let maxLines = self.cache.maxDiffLines
+                    let (expanded, cacheable) = await Task.detached(priority: .utility) {
+                        (diff.diffLines(), diff.truncated(to: maxLines))
                     }.value
+                    lines = expanded
+                    if let key {
+                        await self.cache.insert(cacheable, for: key)
+                    }
                 }
 
-                guard !Task.isCancelled else { return }
-
-                let hash = self.computeHash(file + String(lines.count))
-                await self.cache.cacheDiff(lines, for: file, contentHash: hash)
-
                 await MainActor.run { [weak self] in
                     guard !Task.isCancelled else { return }
                     self?.loadedDiffs[file] = lines
@@ -122,59 +134,105 @@ class GitDiffViewModel: ObservableObject {
             return
         }
 
-        do {
-            // Load tracked files with single git diff
-            if !filesToLoad.isEmpty {
-                var diffOutput = await runGitDiff(["diff", "HEAD"])
-                if diffOutput == nil {
-                    diffOutput = await runGitDiff(["diff"])
-                }
+        let keys = await diffKeys(for: filesToLoad + untrackedToLoad)
+        var misses: [String] = []
+        for file in filesToLoad {
+            if let key = keys[file], let cached = await cache.diff(for: key) {
+                loadedDiffs[file] = await Task.detached(priority: .utility) {
+                    cached.diffLines()
+                }.value
+            } else {
+                misses.append(file)
+            }
+        }
 
-                // Parse off the main actor to avoid blocking UI on large diffs
+        do {
+            // Load tracked cache misses from one lazy diff restricted to them; each file's
+            // patch is built and converted a hunk at a time, then released
+            if !misses.isEmpty {
+                let diff = try await diffService.getFullDiff(at: repoPath, paths: misses)
+                let maxLines = cache.maxDiffLines
                 let parsedByFile = await Task.detached(priority: .utility) {
-                    DiffParser.splitDiffByFile(diffOutput ?? "")
+                    var parsed: [String: (lines: [DiffLine], cacheable: CompactDiff)] = [:]
+                    for file in diff.files {
+                        guard let path = file.path else { continue }
+                        let lines = Self.diffLines(for: file, in: diff)
+                        parsed[path] = (lines, CompactDiff(lines: lines, maxLines: maxLines))
+                        diff.releasePatches()
+                    }
+                    return parsed
                 }.value
 
-                for file in filesToLoad {
-                    let lines = parsedByFile[file] ?? []
-                    loadedDiffs[file] = lines
+                for file in misses {
+                    let parsed = parsedByFile[file]
+                    loadedDiffs[file] = parsed?.lines ?? []
 
-                    if !lines.isEmpty {
-                        let hash = computeHash(file + String(lines.count))
-                        await cache.cacheDiff(lines, for: file, contentHash: hash)
+                    if let parsed, let key = keys[file] {
+                        await cache.insert(parsed.cacheable, for: key)
                     }
                 }
             }
 
             // Load untracked files
             for file in untrackedToLoad {
+                if let key = keys[file], let cached = await cache.diff(for: key) {
+                    loadedDiffs[file] = await Task.detached(priority: .utility) {
+                        cached.diffLines()
+                    }.value
+                    continue
+                }
+
                 let lines = await loadUntrackedFileAsDiff(file)
                 loadedDiffs[file] = lines
 
-                if !lines.isEmpty {
-                    let hash = computeHash(file + String(lines.count))
-                    await cache.cacheDiff(lines, for: file, contentHash: hash)
+                if !lines.isEmpty, let key = keys[file] {
+                    await store(lines, for: key)
                 }
             }
 
             isBatchLoading = false
         } catch {
-            for file in filesToLoad {
+            for file in misses {
                 errors[file] = error.localizedDescription
             }
             isBatchLoading = false
         }
     }
 
+    /// Drop the displayed diff; the cache is content-addressed, so the next load
+    /// misses on its own if the file changed.
     func invalidateFile(_ file: String) async {
-        await cache.invalidate(file: file)
         loadedDiffs.removeValue(forKey: file)
     }
 
-    private func computeHash(_ content: String) -> String {
-        let data = Data(content.utf8)
-        let digest = SHA256.hash(data: data)
-        return digest.prefix(8).map { String(format: "%02x", $0) }.joined()
+    /// Content-addressed cache keys for `files`; files whose blobs can't be resolved are omitted
+    private func diffKeys(for files: [String]) async -> [String: GitDiffCache.Key] {
+        guard !files.isEmpty else { return [:] }
+        let path = repoPath
+        let untracked = untrackedFiles
+
+        return await Task.detached(priority: .utility) {
+            guard let repo = try? Libgit2Repository(path: path) else { return [:] }
+            var keys: [String: GitDiffCache.Key] = [:]
+            for (file, oids) in repo.diffBlobOids(forPaths: files) {
+                if untracked.contains(file) {
+                    // The synthesized untracked diff names the file in its header
+                    guard let newOid = oids.new else { continue }
+                    keys[file] = GitDiffCache.Key(oldOid: nil, newOid: newOid, path: file)
+                } else if oids.old != nil || oids.new != nil {
+                    keys[file] = GitDiffCache.Key(oldOid: oids.old, newOid: oids.new)
+                }
+            }
+            return keys
+        }.value
+    }
+
+    private func store(_ lines: [DiffLine], for key: GitDiffCache.Key) async {
+        let maxLines = cache.maxDiffLines
+        let compact = await Task.detached(priority: .utility) {
+            CompactDiff(lines: lines, maxLines: maxLines)
+        }.value
+        await cache.insert(compact, for: key)
     }
 
     private func loadUntrackedFileAsDiff(_ file: String) async -> [DiffLine] {
@@ -213,37 +271,88 @@ class GitDiffViewModel: ObservableObject {
         }.value
     }
 
-    /// Get unified diff output using libgit2
-    private func runGitDiff(_ args: [String]) async -> String? {
-        let path = repoPath
+    /// Display lines for one file of a lazy diff, in the shape the unified diff parser produces
+    nonisolated private static func diffLines(for file: Libgit2DiffFile, in diff: Libgit2LazyDiff) -> [DiffLine] {
+        func trimmingNewline(_ text: String) -> String {
+            var text = Substring(text)
+            if text.hasSuffix("\n") { text = text.dropLast() }
+            if text.hasSuffix("\r") { text = text.dropLast() }
+            return String(text)
+        }
 
-        // For single-file diffs, use the git CLI so we don't compute a full-repo diff.
-        if args.contains("--") {
-            do {
-                let result = try await ProcessExecutor.shared.executeWithOutput(
-                    executable: "/usr/bin/git",
-                    arguments: args,
-                    workingDirectory: path
-                )
-                return result.succeeded ? result.stdout : nil
-            } catch {
-                return nil
+        var lines: [DiffLine] = []
+        for hunkIndex in diff.hunkHeaders(for: file).indices {
+            guard let hunk = diff.hunk(hunkIndex, for: file) else { continue }
+            lines.append(DiffLine(
+                lineNumber: lines.count,
+                oldLineNumber: nil,
+                newLineNumber: nil,
+                content: trimmingNewline(hunk.header),
+                type: .header
+            ))
+
+            for line in hunk.lines {
+                let type: DiffLineType
+                switch line.origin {
+                case .addition: type = .added
+                case .deletion: type = .deleted
+                case .context: type = .context
+                default: continue
+                }
+                lines.append(DiffLine(
+                    lineNumber: lines.count,
+                    oldLineNumber: line.oldLineNumber.map(String.init),
+                    newLineNumber: line.newLineNumber.map(String.init),
+                    content: trimmingNewline(line.content),
+                    type: type
+                ))
             }
         }
+        return lines
+    }
 
-        return await Task.detached(priority: .utility) {
-            do {
-                let repo = try Libgit2Repository(path: path)
-                // Check if this is a HEAD diff or unstaged diff
-                if args.contains("HEAD") {
-                    return try repo.diffUnified()
-                } else {
-                    return try repo.diffUnstagedUnified()
+    /// Run `git diff HEAD -- <file>` (or `git diff -- <file>` without a HEAD) through the
+    /// streaming parser, reporting the first screen of lines as soon as it's parsed.
+    nonisolated private static func streamGitDiff(
+        _ file: String,
+        in repoPath: String,
+        onPreview: @escaping @Sendable ([DiffLine]) async -> Void
+    ) async -> CompactDiff {
+        // The parser needs plain unified output, and results share the content-addressed cache
+        // with the libgit2 path, so user config (color.ui, diff.external, diff.noprefix,
+        // core.quotepath) must not change its shape
+        let plain = [
+            "-c", "core.quotepath=off", "diff",
+            "--no-color", "--no-ext-diff", "--no-textconv",
+            "--src-prefix=a/", "--dst-prefix=b/",
+        ]
+        for revision in [["HEAD"], []] {
+            guard let output = try? await ProcessExecutor.shared.executeOutputStream(
+                executable: "/usr/bin/git",
+                arguments: plain + revision + ["--", file],
+                workingDirectory: repoPath
+            ) else { continue }
+
+            var parser = StreamingDiffParser()
+            var previewSent = false
+
+            // Parsed as it's read; git blocks while the parser catches up
+            for await chunk in output {
+                parser.consume(chunk)
+                if !previewSent && parser.lineCount >= previewLineCount {
+                    previewSent = true
+                    await onPreview(parser.snapshot.diffLines(in: 0..<previewLineCount))
                 }
-            } catch {
-                return nil
             }
-        }.value
+            let exitCode = await output.waitForExit()
+
+            if exitCode == 0 {
+                parser.finish()
+                return parser.snapshot
+            }
+        }
+
+        return StreamingDiffParser().snapshot
     }
 
     deinit {
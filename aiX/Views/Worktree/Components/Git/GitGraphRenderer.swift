@@ -16,7 +16,8 @@ struct GitGraphRenderer {
         connections: [GitGraphConnection],
         selectedCommit: GitGraphCommit?,
         scale: CGFloat = 1.0,
-        onTapCommit: @escaping (GitGraphCommit) -> Void
+        onTapCommit: @escaping (GitGraphCommit) -> Void,
+        onReachEnd: (() -> Void)? = nil
     ) -> some View {
         // Estimate canvas size based on computed spacing and counts
         let maxCol = max(1, getMaxColumn(commits: commits) + 1)
@@ -25,29 +26,39 @@ struct GitGraphRenderer {
         let height = CGFloat(max(1, commits.count)) * config.verticalSpacing + config.padding * 2
 
         return ScrollView([.vertical, .horizontal], showsIndicators: false) {
-            Canvas { context, size in
-                drawSubwayGraph(
-                    context: context,
-                    commits: commits,
-                    connections: connections,
-                    selectedCommit: selectedCommit,
-                    scale: scale
+            LazyVStack(alignment: .leading, spacing: 0) {
+                Canvas { context, size in
+                    drawSubwayGraph(
+                        context: context,
+                        commits: commits,
+                        connections: connections,
+                        selectedCommit: selectedCommit,
+                        scale: scale
+                    )
+                }
+                .frame(height: height)
+                .frame(width: width)
+                .contentShape(Rectangle())
+                .gesture(
+                    SpatialTapGesture()
+                        .onEnded { value in
+                            handleTap(
+                                at: value.location,
+                                commits: commits,
+                                scale: scale,
+                                onTap: onTapCommit
+                            )
+                        }
                 )
+
+                // Appears when scrolled to the bottom; asks for the next page
+                if let onReachEnd {
+                    ProgressView()
+                        .controlSize(.small)
+                        .frame(width: width, height: config.verticalSpacing)
+                        .onAppear(perform: onReachEnd)
+                }
             }
-            .frame(height: height)
-            .frame(width: width)
-            .contentShape(Rectangle())
-            .gesture(
-                SpatialTapGesture()
-                    .onEnded { value in
-                        handleTap(
-                            at: value.location,
-                            commits: commits,
-                            scale: scale,
-                            onTap: onTapCommit
-                        )
-                    }
-            )
         }
     }
 
@@ -14,14 +14,15 @@ struct GitGraphView: View {
     let selectedCommit: GitCommit?
     let onSelectCommit: (GitCommit?) -> Void
 
-    @State private var graphCommits: [GitGraphCommit] = []
-    @State private var connections: [GitGraphConnection] = []
+    @State private var snapshot = GitGraphSnapshot()
     @State private var isLoading = true
+    @State private var isLoadingMore = false
     @State private var errorMessage: String?
     @State private var selectedGraphCommit: GitGraphCommit?
     @State private var graphScale: CGFloat = 1.0  // Zoom scale for the graph
 
-    private let graphService = GitGraphService()
+    // Kept in state: the service holds the layout that later pages continue from
+    @State private var graphService = GitGraphService()
     private let logger = Logger(
         subsystem: Bundle.main.bundleIdentifier ?? "win.aiX",
         category: "GitGraphView"
@@ -32,11 +33,11 @@ struct GitGraphView: View {
             header
             Divider()
 
-            if isLoading && graphCommits.isEmpty {
+            if isLoading && snapshot.commits.isEmpty {
                 loadingView
-            } else if let error = errorMessage, graphCommits.isEmpty {
+            } else if let error = errorMessage, snapshot.commits.isEmpty {
                 errorView(error)
-            } else if graphCommits.isEmpty {
+            } else if snapshot.commits.isEmpty {
                 emptyView
             } else {
                 graphContentView
@@ -54,8 +55,8 @@ struct GitGraphView: View {
 
             Spacer()
 
-            if !graphCommits.isEmpty {
-                Text("\(graphCommits.count)")
+            if !snapshot.commits.isEmpty {
+                Text("\(snapshot.commits.count)")
                     .font(.system(size: 11, weight: .medium, design: .monospaced))
                     .foregroundStyle(.secondary)
                     .padding(.horizontal, 6)
@@ -208,8 +209,8 @@ struct GitGraphView: View {
 
             // Graph canvas with zoom and magnification
             GitGraphRenderer.drawGraph(
-                commits: graphCommits,
-                connections: connections,
+                commits: snapshot.commits,
+                connections: snapshot.connections,
                 selectedCommit: selectedGraphCommit,
                 scale: graphScale,
                 onTapCommit: { commit in
@@ -226,7 +227,8 @@ struct GitGraphView: View {
                         deletions: commit.deletions
                     )
                     onSelectCommit(gitCommit)
-                }
+                },
+                onReachEnd: snapshot.hasMore ? { Task { await loadMore() } } : nil
             )
             .gesture(
                 MagnificationGesture()
@@ -246,9 +248,7 @@ struct GitGraphView: View {
         errorMessage = nil
 
         do {
-            let commits = try await graphService.getGraphData(at: worktreePath, limit: 100)
-            graphCommits = commits
-            connections = graphService.getConnections(for: commits)
+            snapshot = try await graphService.loadGraph(at: worktreePath)
         } catch {
             logger.error("Failed to load graph data: \(error.localizedDescription)")
             errorMessage = error.localizedDescription
@@ -257,9 +257,33 @@ struct GitGraphView: View {
         isLoading = false
     }
 
+    private func loadMore() async {
+        guard snapshot.hasMore, !isLoadingMore, !isLoading else { return }
+        isLoadingMore = true
+        defer { isLoadingMore = false }
+
+        do {
+            snapshot = try await graphService.loadMore(snapshot, at: worktreePath)
+        } catch {
+            logger.error("Failed to load more graph data: \(error.localizedDescription)")
+        }
+    }
+
     private func refresh() async {
-        graphCommits = []
-        connections = []
-        await loadGraphData()
+        guard !snapshot.commits.isEmpty else {
+            await loadGraphData()
+            return
+        }
+
+        isLoading = true
+        errorMessage = nil
+        do {
+            // Only commits added above the loaded ones are laid out
+            snapshot = try await graphService.refresh(snapshot, at: worktreePath)
+        } catch {
+            logger.error("Failed to refresh graph data: \(error.localizedDescription)")
+            errorMessage = error.localizedDescription
+        }
+        isLoading = false
     }
 }
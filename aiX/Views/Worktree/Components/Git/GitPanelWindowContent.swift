@@ -357,10 +357,16 @@ struct GitPanelWindowContent: View {
                 Spacer()
 
                 HStack(spacing: 8) {
-                    Text("+\(gitStatus.additions)")
-                        .foregroundStyle(.green)
-                    Text("-\(gitStatus.deletions)")
-                        .foregroundStyle(.red)
+                    if gitStatus.lineStatsOmitted {
+                        // Too many changed files to count lines
+                        Text("+? -?")
+                            .foregroundStyle(.secondary)
+                    } else {
+                        Text("+\(gitStatus.additions)")
+                            .foregroundStyle(.green)
+                        Text("-\(gitStatus.deletions)")
+                            .foregroundStyle(.red)
+                    }
                     Text("\(allChangedFiles.count) files")
                         .foregroundStyle(.secondary)
                 }
@@ -12,7 +12,21 @@ import AppKit
 enum LogRow {
     case stepHeader(id: Int, name: String, groupCount: Int, isExpanded: Bool)
     case groupHeader(id: Int, stepId: Int, title: String, lineCount: Int, isExpanded: Bool)
-    case logLine(id: Int, content: String, attributedContent: NSAttributedString)
+    /// A line of the log document, by index
+    case logLine(index: Int)
+}
+
+/// Consecutive table rows: a header, or one row per line of a line range
+enum LogRowRun {
+    case header(LogRow)
+    case lines(Range<Int>)
+
+    var rowCount: Int {
+        switch self {
+        case .header: return 1
+        case .lines(let lines): return lines.count
+        }
+    }
 }
 
 // MARK: - Log Group Model
@@ -20,7 +34,8 @@ enum LogRow {
 struct LogGroup {
     let id: Int
     let title: String
-    var lines: [(id: Int, raw: String, attributed: NSAttributedString)]
+    /// Lines of the log document
+    var lines: Range<Int>
     var isExpanded: Bool = false
 }
 
@@ -0,0 +1,466 @@
+//
+//  WorkflowLogStepBuilder.swift
+//  aizen
+//
+//  Incremental parsing of workflow logs into steps and groups
+//
+
+import Foundation
+
+/// Builds the steps of a workflow log from its lines, as they arrive.
+///
+/// Only the structure is parsed here. The text of each displayed line goes into `document`
+/// and groups refer to ranges of its lines, which are styled when they scroll into view.
+/// Lines are scanned as bytes; strings are only made for step names and group titles.
+/// Parser state is kept between appends, so a growing log only parses its new lines, and
+/// ids are assigned in order and never change, so expansion state can be matched up across
+/// appends. Used by one parse at a time.
+final class WorkflowLogStepBuilder: @unchecked Sendable {
+    enum Format: Equatable {
+        /// GitHub job logs parsed by the provider, with steps from their timestamps
+        case structured
+        /// `gh run view --log` output, with job and step names on each line
+        case githubText
+        /// GitLab job traces with section markers
+        case gitlabText
+    }
+
+    let format: Format
+    /// Displayed lines, in log order; styles carry from one line to the next
+    let document = ANSILogDocument()
+
+    /// Structured lines consumed so far
+    private(set) var structuredLineCount = 0
+
+    private var steps: [LogStep] = []
+    private var groups: [LogGroup] = []
+    private var ungroupedLines = 0..<0
+    private var currentGroup: LogGroup?
+    private var stepNameCounts: [String: Int] = [:]
+    private var currentStepName = ""
+    private var currentStepBytes: [UInt8] = []
+    private var lastGroupTitle = ""
+    private var groupId = 0
+    private var stepId = 0
+
+    // Lines in `document` and in `pendingText`, which is appended to it once per batch
+    private var lineCount = 0
+    private var pendingText: [UInt8] = []
+    private var cleanedLine: [UInt8] = []
+
+    init(format: Format) {
+        self.format = format
+    }
+
+    // MARK: - Input
+
+    func append(_ lines: ArraySlice<WorkflowLogLine>) {
+        for logLine in lines {
+            enterStep(logLine.stepName, countingRepeats: false)
+
+            if logLine.isGroupStart {
+                startGroup(logLine.groupName ?? "Output")
+            } else if logLine.isGroupEnd {
+                endGroup()
+            } else if logLine.content.utf8.contains(where: { $0 != 0x20 && $0 != 0x09 }) {
+                addStepLine(logLine.content.utf8)
+            }
+        }
+        structuredLineCount += lines.count
+        flush()
+    }
+
+    /// Parse the lines of `text` from byte `offset` on, stopping at the first line break at
+    /// least `limit` bytes further, and return the offset parsed up to. A last line without a
+    /// line break is parsed as complete.
+    func append(text: String, from offset: Int, limit: Int) -> Int {
+        var text = text
+        let end = text.withUTF8 { bytes -> Int in
+            guard let base = bytes.baseAddress, offset < bytes.count else { return bytes.count }
+            let stop = offset + min(limit, bytes.count - offset)
+
+            var lineStart = offset
+            while lineStart < bytes.count && lineStart < stop {
+                var lineEnd = bytes.count
+                if let newline = memchr(base + lineStart, 0x0A, bytes.count - lineStart) {
+                    lineEnd = UnsafeRawPointer(base).distance(to: UnsafeRawPointer(newline))
+                }
+                consume(UnsafeBufferPointer(rebasing: bytes[lineStart..<lineEnd]))
+                lineStart = lineEnd + 1
+            }
+            return min(lineStart, bytes.count)
+        }
+        flush()
+        return end
+    }
+
+    /// Steps parsed so far
+    var parsedSteps: [LogStep] {
+        if format == .gitlabText {
+            var groups = groups
+            if let group = currentGroup, !group.lines.isEmpty {
+                groups.append(group)
+            }
+            if !ungroupedLines.isEmpty {
+                groups.append(LogGroup(id: groupId, title: "", lines: ungroupedLines, isExpanded: true))
+            }
+            if groups.isEmpty {
+                return []
+            }
+            // Return as a single step containing all groups
+            return [LogStep(id: 0, name: "Job Output", groups: groups, isExpanded: true)]
+        }
+
+        var steps = steps
+        if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
+            steps[steps.count - 1].groups.append(group)
+        }
+        // Filter out empty steps
+        return steps.filter { !$0.groups.isEmpty }
+    }
+
+    private func consume(_ line: UnsafeBufferPointer<UInt8>) {
+        switch format {
+        case .gitlabText:
+            consumeGitLabLine(line)
+        case .githubText, .structured:
+            consumeGitHubLine(line)
+        }
+    }
+
+    private func addLine<Bytes: Sequence>(_ bytes: Bytes) -> Int where Bytes.Element == UInt8 {
+        pendingText.append(contentsOf: bytes)
+        pendingText.append(0x0A)
+        lineCount += 1
+        return lineCount - 1
+    }
+
+    private func flush() {
+        guard !pendingText.isEmpty else { return }
+        pendingText.withUnsafeBufferPointer { document.append($0) }
+        pendingText.removeAll(keepingCapacity: true)
+    }
+
+    private static func extend(_ lines: Range<Int>, with index: Int) -> Range<Int> {
+        lines.isEmpty ? index..<(index + 1) : lines.lowerBound..<(index + 1)
+    }
+
+    // MARK: - GitHub
+
+    private func consumeGitHubLine(_ line: UnsafeBufferPointer<UInt8>) {
+        let trimmed = Self.trimmed(line)
+        if let split = Self.splitTabbedLine(trimmed) {
+            if !split.step.isEmpty && !split.step.elementsEqual(currentStepBytes) {
+                enterStep(String(decoding: split.step, as: UTF8.self), countingRepeats: true)
+            }
+            consumeGitHubMessage(split.message)
+            return
+        }
+
+        // Other layouts: look for the timestamp anywhere in the line
+        let (step, message) = Self.extractStepAndMessage(String(decoding: trimmed, as: UTF8.self))
+        enterStep(step, countingRepeats: true)
+        var text = message
+        text.withUTF8 { consumeGitHubMessage($0) }
+    }
+
+    private func consumeGitHubMessage(_ message: UnsafeBufferPointer<UInt8>) {
+        if Self.range(of: "##[", in: message) != nil {
+            if let marker = Self.range(of: "##[group]", in: message) {
+                // Extract group title
+                var title = String(decoding: Self.trimmed(UnsafeBufferPointer(rebasing: message[marker.upperBound...])), as: UTF8.self)
+                if title.isEmpty { title = "Output" }
+                startGroup(title)
+                return
+            }
+            if Self.range(of: "##[endgroup]", in: message) != nil {
+                endGroup()
+                return
+            }
+        }
+
+        if !message.isEmpty {
+            addStepLine(message)
+        }
+    }
+
+    private func enterStep(_ name: String, countingRepeats: Bool) {
+        guard !name.isEmpty, name != currentStepName else { return }
+
+        // Save current group to previous step before transitioning
+        if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
+            steps[steps.count - 1].groups.append(group)
+            currentGroup = nil
+        }
+
+        currentStepName = name
+        currentStepBytes = Array(name.utf8)
+
+        // Always create a new step when the name changes
+        var displayName = name
+        if countingRepeats {
+            let count = stepNameCounts[name, default: 0]
+            stepNameCounts[name] = count + 1
+            if count > 0 {
+                displayName = "\(name) (\(count + 1))"
+            }
+        }
+        steps.append(LogStep(id: stepId, name: displayName, groups: [], isExpanded: false))
+        stepId += 1
+    }
+
+    private func startGroup(_ title: String) {
+        let currentStepIdx = steps.isEmpty ? nil : steps.count - 1
+
+        // Save current group
+        if let group = currentGroup, !group.lines.isEmpty, let stepIdx = currentStepIdx {
+            steps[stepIdx].groups.append(group)
+        }
+
+        // If this is "Output", merge with previous group instead of creating new one
+        if title == "Output" && !lastGroupTitle.isEmpty {
+            if let stepIdx = currentStepIdx, !steps[stepIdx].groups.isEmpty {
+                currentGroup = steps[stepIdx].groups.removeLast()
+            } else {
+                currentGroup = LogGroup(id: groupId, title: lastGroupTitle, lines: 0..<0, isExpanded: false)
+                groupId += 1
+            }
+        } else {
+            currentGroup = LogGroup(id: groupId, title: title, lines: 0..<0, isExpanded: false)
+            lastGroupTitle = title
+            groupId += 1
+        }
+    }
+
+    private func endGroup() {
+        if let group = currentGroup, !steps.isEmpty {
+            steps[steps.count - 1].groups.append(group)
+            currentGroup = nil
+        }
+    }
+
+    private func addStepLine<Bytes: Sequence>(_ content: Bytes) where Bytes.Element == UInt8 {
+        if currentGroup == nil {
+            // Lines before the first step have nowhere to go
+            guard !steps.isEmpty else { return }
+
+            // Line outside group - create implicit group for ungrouped content
+            let stepIdx = steps.count - 1
+            if steps[stepIdx].groups.isEmpty || !steps[stepIdx].groups.last!.title.isEmpty {
+                currentGroup = LogGroup(id: groupId, title: "", lines: 0..<0, isExpanded: true)
+                groupId += 1
+            } else {
+                currentGroup = steps[stepIdx].groups.removeLast()
+            }
+        }
+
+        let index = addLine(content)
+        if var group = currentGroup {
+            group.lines = Self.extend(group.lines, with: index)
+            currentGroup = group
+        }
+    }
+
+    // "job<TAB>step<TAB>timestamp message", as printed by `gh run view --log`
+    private static func splitTabbedLine(_ line: UnsafeBufferPointer<UInt8>) -> (step: UnsafeBufferPointer<UInt8>, message: UnsafeBufferPointer<UInt8>)? {
+        guard let firstTab = line.firstIndex(of: 0x09),
+              let secondTab = line[(firstTab + 1)...].firstIndex(of: 0x09),
+              let timestampEnd = timestampEnd(in: line, at: secondTab + 1) else {
+            return nil
+        }
+        let step = trimmed(UnsafeBufferPointer(rebasing: line[(firstTab + 1)..<secondTab]))
+        let message = trimmed(UnsafeBufferPointer(rebasing: line[timestampEnd...]))
+        return (step, message)
+    }
+
+    // Digits marked "d"; a fraction of one or more digits and a "Z" follow
+    private static let timestampShape = Array("dddd-dd-ddTdd:dd:dd.".utf8)
+
+    private static func timestampEnd(in line: UnsafeBufferPointer<UInt8>, at start: Int) -> Int? {
+        guard start + timestampShape.count < line.count else { return nil }
+        for (offset, expected) in timestampShape.enumerated() {
+            let byte = line[start + offset]
+            if expected == UInt8(ascii: "d") ? !isDigit(byte) : byte != expected {
+                return nil
+            }
+        }
+
+        var index = start + timestampShape.count
+        let fractionStart = index
+        while index < line.count && isDigit(line[index]) {
+            index += 1
+        }
+        guard index > fractionStart, index < line.count, line[index] == UInt8(ascii: "Z") else { return nil }
+        return index + 1
+    }
+
+    // Pre-compiled timestamp pattern for lines in other layouts
+    private static let timestampRegex = try? NSRegularExpression(pattern: #"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d+Z)"#)
+
+    private static func extractStepAndMessage(_ line: String) -> (step: String, message: String) {
+        let trimmed = line.trimmingCharacters(in: .whitespaces)
+
+        // GitHub Actions format: "job-name    step-name    timestamp message"
+        guard let regex = timestampRegex else {
+            return ("", trimmed)
+        }
+
+        let range = NSRange(trimmed.startIndex..<trimmed.endIndex, in: trimmed)
+        guard let match = regex.firstMatch(in: trimmed, options: [], range: range),
+              let timestampRange = Range(match.range, in: trimmed) else {
+            return ("", trimmed)
+        }
+
+        let beforeTimestamp = String(trimmed[..<timestampRange.lowerBound]).trimmingCharacters(in: .whitespaces)
+        let afterTimestamp = String(trimmed[timestampRange.upperBound...]).trimmingCharacters(in: .whitespaces)
+
+        // Parse job and step from beforeTimestamp
+        // Split by multiple whitespace
+        let parts = beforeTimestamp.split(omittingEmptySubsequences: true) { $0.isWhitespace }
+
+        var stepName = ""
+        if parts.count >= 2 {
+            // Step name is everything after job name
+            stepName = parts[1..<parts.count].joined(separator: " ")
+        }
+
+        return (stepName, afterTimestamp)
+    }
+
+    // MARK: - GitLab
+
+    // Section name to display name mapping
+    private static let sectionNames: [String: String] = [
+        "prepare_executor": "Prepare Executor",
+        "prepare_script": "Prepare Environment",
+        "get_sources": "Get Sources",
+        "step_script": "Execute Script",
+        "after_script": "After Script",
+        "cleanup_file_variables": "Cleanup",
+        "archive_cache": "Archive Cache",
+        "upload_artifacts": "Upload Artifacts",
+        "download_artifacts": "Download Artifacts"
+    ]
+
+    private func consumeGitLabLine(_ line: UnsafeBufferPointer<UInt8>) {
+        // Clean ANSI control codes (keep color codes for styling)
+        var cleaned = cleanedLine
+        cleanedLine = []
+        Self.clean(line, into: &cleaned)
+        cleaned.withUnsafeBufferPointer { consumeCleanGitLabLine($0) }
+        cleanedLine = cleaned
+    }
+
+    private func consumeCleanGitLabLine(_ line: UnsafeBufferPointer<UInt8>) {
+        let trimmed = Self.trimmed(line)
+
+        // Check for section_start marker
+        if Self.hasPrefix(trimmed, "section_start:") {
+            // Save ungrouped lines first
+            if !ungroupedLines.isEmpty {
+                groups.append(LogGroup(id: groupId, title: "", lines: ungroupedLines, isExpanded: true))
+                groupId += 1
+                ungroupedLines = 0..<0
+            }
+
+            // Save current group if exists
+            if let group = currentGroup, !group.lines.isEmpty {
+                groups.append(group)
+            }
+
+            // Parse section name: section_start:timestamp:name
+            let parts = String(decoding: trimmed, as: UTF8.self).split(separator: ":")
+            let sectionName = parts.count >= 3 ? String(parts[2]) : "Section"
+            let displayName = Self.sectionNames[sectionName] ?? sectionName.replacingOccurrences(of: "_", with: " ").capitalized
+
+            currentGroup = LogGroup(id: groupId, title: displayName, lines: 0..<0, isExpanded: false)
+            groupId += 1
+            return
+        }
+
+        // Check for section_end marker
+        if Self.hasPrefix(trimmed, "section_end:") {
+            if let group = currentGroup {
+                groups.append(group)
+                currentGroup = nil
+            }
+            return
+        }
+
+        // Skip empty lines
+        guard !trimmed.isEmpty else { return }
+
+        let index = addLine(line)
+        if var group = currentGroup {
+            group.lines = Self.extend(group.lines, with: index)
+            currentGroup = group
+        } else {
+            ungroupedLines = Self.extend(ungroupedLines, with: index)
+        }
+    }
+
+    // Drops carriage returns and non-color control sequences (cursor movement, clear line):
+    // ESC [ params then one of K J H f s u, and a bare "[0K"
+    private static func clean(_ line: UnsafeBufferPointer<UInt8>, into result: inout [UInt8]) {
+        result.removeAll(keepingCapacity: true)
+        var i = 0
+        while i < line.count {
+            let byte = line[i]
+            if byte == 0x0D {
+                i += 1
+                continue
+            }
+            if byte == 0x1B && i + 1 < line.count && line[i + 1] == UInt8(ascii: "[") {
+                var end = i + 2
+                while end < line.count && (isDigit(line[end]) || line[end] == UInt8(ascii: ";")) {
+                    end += 1
+                }
+                if end < line.count && "KJHfsu".utf8.contains(line[end]) {
+                    i = end + 1
+                    continue
+                }
+            } else if byte == UInt8(ascii: "["), i + 2 < line.count,
+                      line[i + 1] == UInt8(ascii: "0"), line[i + 2] == UInt8(ascii: "K") {
+                i += 3
+                continue
+            }
+            result.append(byte)
+            i += 1
+        }
+    }
+
+    // MARK: - Bytes
+
+    private static func isDigit(_ byte: UInt8) -> Bool {
+        byte >= 0x30 && byte <= 0x39
+    }
+
+    // Without leading and trailing spaces and tabs
+    private static func trimmed(_ bytes: UnsafeBufferPointer<UInt8>) -> UnsafeBufferPointer<UInt8> {
+        var start = bytes.startIndex
+        var end = bytes.endIndex
+        while start < end && (bytes[start] == 0x20 || bytes[start] == 0x09) {
+            start += 1
+        }
+        while end > start && (bytes[end - 1] == 0x20 || bytes[end - 1] == 0x09) {
+            end -= 1
+        }
+        return UnsafeBufferPointer(rebasing: bytes[start..<end])
+    }
+
+    private static func hasPrefix(_ bytes: UnsafeBufferPointer<UInt8>, _ prefix: StaticString) -> Bool {
+        let count = prefix.utf8CodeUnitCount
+        guard bytes.count >= count, let base = bytes.baseAddress else { return false }
+        return memcmp(base, prefix.utf8Start, count) == 0
+    }
+
+    private static func range(of needle: StaticString, in bytes: UnsafeBufferPointer<UInt8>) -> Range<Int>? {
+        let count = needle.utf8CodeUnitCount
+        guard bytes.count >= count, let base = bytes.baseAddress,
+              let found = memmem(base, bytes.count, needle.utf8Start, count) else {
+            return nil
+        }
+        let start = UnsafeRawPointer(base).distance(to: UnsafeRawPointer(found))
+        return start..<(start + count)
+    }
+}
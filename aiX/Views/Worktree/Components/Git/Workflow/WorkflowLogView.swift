@@ -41,7 +41,7 @@ class LogTableView: NSTableView {
 
 struct WorkflowLogTableView: NSViewRepresentable {
     let logs: String
-    let structuredLogs: WorkflowLogs?
+    let jobLogs: WorkflowLogs?
     let fontSize: CGFloat
     let provider: WorkflowProvider
     @Binding var showTimestamps: Bool
@@ -84,14 +84,14 @@ struct WorkflowLogTableView: NSViewRepresentable {
         scrollView.documentView = tableView
 
         // Parse logs in background
-        context.coordinator.parseLogs(logs, structuredLogs: structuredLogs, fontSize: fontSize, showTimestamps: showTimestamps, provider: provider)
+        context.coordinator.parseLogs(logs, jobLogs: jobLogs, fontSize: fontSize, showTimestamps: showTimestamps, provider: provider)
 
         return scrollView
     }
 
     func updateNSView(_ scrollView: NSScrollView, context: Context) {
-        if context.coordinator.currentLogs != logs {
-            context.coordinator.parseLogs(logs, structuredLogs: structuredLogs, fontSize: fontSize, showTimestamps: showTimestamps, provider: provider)
+        if !context.coordinator.isShowing(logs, jobLogs: jobLogs) {
+            context.coordinator.parseLogs(logs, jobLogs: jobLogs, fontSize: fontSize, showTimestamps: showTimestamps, provider: provider)
         }
         if context.coordinator.showTimestamps != showTimestamps {
             context.coordinator.showTimestamps = showTimestamps
@@ -108,515 +108,233 @@ struct WorkflowLogTableView: NSViewRepresentable {
     class Coordinator: NSObject, NSTableViewDelegate, NSTableViewDataSource {
         weak var tableView: LogTableView?
         var steps: [LogStep] = []
-        var displayRows: [LogRow] = []
         var currentLogs: String = ""
+        var currentJobLogs: WorkflowLogs?
         var fontSize: CGFloat = 11
         var showTimestamps: Bool = false
 
+        // Table rows as runs, so an expanded step adds one entry however many lines it has
+        private var rowRuns: [LogRowRun] = []
+        private var rowRunStarts: [Int] = []
+        private var rowCount = 0
+
         private var parseTask: Task<Void, Never>?
+        // Parser state for the logs in `steps`, continued when the logs grow
+        private var builder: WorkflowLogStepBuilder?
+        private var builtLogs = ""
+        private var builtBuffer: WorkflowLogBuffer?
+        // Parsed up to this chunk of `builtBuffer`, and this byte of it or of `builtLogs`
+        private var builtChunk = 0
+        private var builtByteCount = 0
+
+        // The first batch is small so the log shows right away; the rest follows in larger ones
+        private static let firstBatchBytes = 1 << 20
+        private static let batchBytes = 16 << 20
+        private static let firstBatchLines = 10_000
+        private static let batchLines = 200_000
+
+        /// Whether these logs are the ones last handed to `parseLogs`
+        func isShowing(_ logs: String, jobLogs: WorkflowLogs?) -> Bool {
+            currentLogs == logs
+                && currentJobLogs?.buffer === jobLogs?.buffer
+                && currentJobLogs?.chunkCount == jobLogs?.chunkCount
+                && currentJobLogs?.lineCount == jobLogs?.lineCount
+        }
 
-        func parseLogs(_ logs: String, structuredLogs: WorkflowLogs? = nil, fontSize: CGFloat, showTimestamps: Bool, provider: WorkflowProvider = .github) {
+        /// Parse `logs`, or `jobLogs` when given. A job log grows in place in its buffer, so
+        /// only what was appended since the last parse of the same buffer is parsed.
+        func parseLogs(_ logs: String, jobLogs: WorkflowLogs? = nil, fontSize: CGFloat, showTimestamps: Bool, provider: WorkflowProvider = .github) {
             currentLogs = logs
-            self.fontSize = fontSize
+            currentJobLogs = jobLogs
+            if self.fontSize != fontSize {
+                self.fontSize = fontSize
+                lineHeights.removeAll()
+            }
             self.showTimestamps = showTimestamps
 
-            parseTask?.cancel()
-            parseTask = Task.detached(priority: .userInitiated) { [weak self] in
-                let parsed: [LogStep]
-                if let structured = structuredLogs, !structured.lines.isEmpty {
-                    parsed = Self.parseStructuredLogs(structured, fontSize: fontSize)
+            // Parses run in order: a newer one stops the running one after its current batch
+            // and continues from the state it left
+            let previousTask = parseTask
+            previousTask?.cancel()
+            parseTask = Task { [weak self] in
+                await previousTask?.value
+                guard let self = self else { return }
+
+                let format: WorkflowLogStepBuilder.Format
+                if let jobLogs, jobLogs.hasSteps, jobLogs.lineCount > 0 {
+                    format = .structured
                 } else {
-                    parsed = Self.parseLogSteps(logs, fontSize: fontSize, provider: provider)
+                    format = provider == .gitlab ? .gitlabText : .githubText
                 }
 
-                await MainActor.run {
-                    guard let self = self else { return }
-                    self.steps = parsed
-                    self.rebuildDisplayRows()
-                    self.tableView?.reloadData()
-
-                    // Recalculate heights after layout settles
-                    DispatchQueue.main.asyncAfter(deadline: .now() + 0.1) { [weak self] in
-                        self?.recalculateAllHeights()
-                    }
+                // Logs that extend the ones parsed only have their new lines parsed
+                let extendsParsed: Bool
+                if let jobLogs {
+                    extendsParsed = self.builtBuffer === jobLogs.buffer
+                } else {
+                    extendsParsed = Self.text(logs, continues: self.builtLogs, at: self.builtByteCount, format: format)
                 }
-            }
-        }
-
-        private func recalculateAllHeights() {
-            guard let tableView = tableView, displayRows.count > 0 else { return }
-            tableView.noteHeightOfRows(withIndexesChanged: IndexSet(integersIn: 0..<displayRows.count))
-        }
-
-        private static func parseStructuredLogs(_ logs: WorkflowLogs, fontSize: CGFloat) -> [LogStep] {
-            var steps: [LogStep] = []
-            var currentStepName = ""
-            var currentGroup: LogGroup?
-            var groupId = 0
-            var lineId = 0
-            var stepId = 0
-            var currentStyle = ANSITextStyle()
-            var lastGroupTitle = ""
-
-            for logLine in logs.lines {
-                let stepName = logLine.stepName
-
-                // Handle step transitions
-                if stepName != currentStepName {
-                    // Save current group to previous step before transitioning
-                    if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
-                        steps[steps.count - 1].groups.append(group)
-                        currentGroup = nil
-                    }
-
-                    currentStepName = stepName
-                    steps.append(LogStep(id: stepId, name: stepName, groups: [], isExpanded: false))
-                    stepId += 1
+                let continued: Bool
+                let builder: WorkflowLogStepBuilder
+                if let current = self.builder, current.format == format, extendsParsed {
+                    builder = current
+                    continued = true
+                } else {
+                    builder = WorkflowLogStepBuilder(format: format)
+                    continued = false
+                    self.builtChunk = 0
+                    self.builtByteCount = 0
                 }
 
-                let currentStepIdx = steps.isEmpty ? nil : steps.count - 1
-
-                // Check for group markers
-                if logLine.isGroupStart {
-                    // Save current group
-                    if let group = currentGroup, !group.lines.isEmpty, let stepIdx = currentStepIdx {
-                        steps[stepIdx].groups.append(group)
-                    }
-
-                    let title = logLine.groupName ?? "Output"
-
-                    // If this is "Output", merge with previous group instead of creating new one
-                    if title == "Output" && !lastGroupTitle.isEmpty {
-                        if let stepIdx = currentStepIdx, !steps[stepIdx].groups.isEmpty {
-                            let lastIdx = steps[stepIdx].groups.count - 1
-                            currentGroup = steps[stepIdx].groups[lastIdx]
-                            steps[stepIdx].groups.removeLast()
-                        } else {
-                            currentGroup = LogGroup(id: groupId, title: lastGroupTitle, lines: [], isExpanded: false)
-                            groupId += 1
-                        }
-                    } else {
-                        currentGroup = LogGroup(id: groupId, title: title, lines: [], isExpanded: false)
-                        lastGroupTitle = title
-                        groupId += 1
-                    }
-                } else if logLine.isGroupEnd {
-                    if let group = currentGroup, let stepIdx = currentStepIdx {
-                        steps[stepIdx].groups.append(group)
-                        currentGroup = nil
-                    }
-                } else if !logLine.content.trimmingCharacters(in: .whitespaces).isEmpty {
-                    let (attributed, newStyle) = parseLineToAttributedString(logLine.content, style: currentStyle, fontSize: fontSize)
-                    currentStyle = newStyle
-
-                    if currentGroup != nil {
-                        currentGroup?.lines.append((id: lineId, raw: logLine.content, attributed: attributed))
-                    } else if let stepIdx = currentStepIdx {
-                        if steps[stepIdx].groups.isEmpty || !steps[stepIdx].groups.last!.title.isEmpty {
-                            currentGroup = LogGroup(id: groupId, title: "", lines: [], isExpanded: true)
-                            groupId += 1
-                        } else {
-                            currentGroup = steps[stepIdx].groups.removeLast()
+                let totalBytes = logs.utf8.count
+                var position = (chunk: self.builtChunk, byte: self.builtByteCount)
+                var isFirstBatch = true
+                var isDone = false
+                while !isDone && !Task.isCancelled {
+                    let from = position
+                    let batchBytes = isFirstBatch && !continued ? Self.firstBatchBytes : Self.batchBytes
+                    let batchLines = isFirstBatch && !continued ? Self.firstBatchLines : Self.batchLines
+                    let (end, parsed, done) = await Task.detached(priority: .userInitiated) { () -> ((chunk: Int, byte: Int), [LogStep], Bool) in
+                        guard let jobLogs else {
+                            let end = builder.append(text: logs, from: from.byte, limit: batchBytes)
+                            return ((0, end), builder.parsedSteps, end >= totalBytes)
                         }
-                        currentGroup?.lines.append((id: lineId, raw: logLine.content, attributed: attributed))
-                    }
-                    lineId += 1
-                }
-            }
-
-            // Save final group
-            if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
-                steps[steps.count - 1].groups.append(group)
-            }
-
-            return steps.filter { !$0.groups.isEmpty || $0.groups.contains { !$0.lines.isEmpty } }
-        }
-
-        private static func parseLogSteps(_ text: String, fontSize: CGFloat, provider: WorkflowProvider = .github) -> [LogStep] {
-            let lines = text.components(separatedBy: "\n")
-            var steps: [LogStep] = []
-            var stepNameCounts: [String: Int] = [:] // track occurrences of each step name
-            var currentStepName = "" // raw step name from current line
-            var currentGroup: LogGroup?
-            var groupId = 0
-            var lineId = 0
-            var stepId = 0
-            var currentStyle = ANSITextStyle()
-            var lastGroupTitle = ""
-
-            // For GitLab (plain text logs), parse section markers into collapsible groups
-            if provider == .gitlab {
-                return parseGitLabLogs(lines, fontSize: fontSize)
-            }
 
-            // GitHub Actions format parsing
-            for line in lines {
-                // Extract step name from log line format
-                let (extractedStep, message) = extractStepAndMessage(line)
-
-                // Handle step transitions
-                if !extractedStep.isEmpty && extractedStep != currentStepName {
-                    // Save current group to previous step before transitioning
-                    if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
-                        steps[steps.count - 1].groups.append(group)
-                        currentGroup = nil
-                    }
-
-                    currentStepName = extractedStep
-
-                    // Always create a new step when the name changes
-                    let count = stepNameCounts[extractedStep, default: 0]
-                    stepNameCounts[extractedStep] = count + 1
-
-                    let displayName = count > 0 ? "\(extractedStep) (\(count + 1))" : extractedStep
-                    steps.append(LogStep(id: stepId, name: displayName, groups: [], isExpanded: false))
-                    stepId += 1
-                }
-
-                // Helper to get current step index
-                let currentStepIdx = steps.isEmpty ? nil : steps.count - 1
-
-                // Check for group markers
-                if message.contains("##[group]") {
-                    // Save current group
-                    if let group = currentGroup, !group.lines.isEmpty, let stepIdx = currentStepIdx {
-                        steps[stepIdx].groups.append(group)
-                    }
-
-                    // Extract group title
-                    var title = "Output"
-                    if let range = message.range(of: "##[group]") {
-                        title = String(message[range.upperBound...]).trimmingCharacters(in: .whitespaces)
-                        if title.isEmpty { title = "Output" }
-                    }
-
-                    // If this is "Output", merge with previous group instead of creating new one
-                    if title == "Output" && !lastGroupTitle.isEmpty {
-                        // Continue using the previous group - don't create new one
-                        if let stepIdx = currentStepIdx, !steps[stepIdx].groups.isEmpty {
-                            let lastIdx = steps[stepIdx].groups.count - 1
-                            currentGroup = steps[stepIdx].groups[lastIdx]
-                            steps[stepIdx].groups.removeLast()
-                        } else {
-                            currentGroup = LogGroup(id: groupId, title: lastGroupTitle, lines: [], isExpanded: false)
-                            groupId += 1
+                        if format == .structured {
+                            let lines = jobLogs.lines
+                            let count = builder.structuredLineCount
+                            builder.append(lines[count..<min(count + batchLines, lines.count)])
+                            return (from, builder.parsedSteps, builder.structuredLineCount >= lines.count)
                         }
-                    } else {
-                        currentGroup = LogGroup(id: groupId, title: title, lines: [], isExpanded: false)
-                        lastGroupTitle = title
-                        groupId += 1
-                    }
-                } else if message.contains("##[endgroup]") {
-                    // End current group
-                    if let group = currentGroup, let stepIdx = currentStepIdx {
-                        steps[stepIdx].groups.append(group)
-                        currentGroup = nil
-                    }
-                } else if !message.trimmingCharacters(in: .whitespaces).isEmpty {
-                    // Regular log line - add to current group
-                    let (attributed, newStyle) = parseLineToAttributedString(message, style: currentStyle, fontSize: fontSize)
-                    currentStyle = newStyle
-
-                    if currentGroup != nil {
-                        currentGroup?.lines.append((id: lineId, raw: message, attributed: attributed))
-                    } else if let stepIdx = currentStepIdx {
-                        // Line outside group - create implicit group for ungrouped content
-                        if steps[stepIdx].groups.isEmpty || !steps[stepIdx].groups.last!.title.isEmpty {
-                            currentGroup = LogGroup(id: groupId, title: "", lines: [], isExpanded: true)
-                            groupId += 1
-                        } else {
-                            currentGroup = steps[stepIdx].groups.removeLast()
-                        }
-                        currentGroup?.lines.append((id: lineId, raw: message, attributed: attributed))
-                    }
-                    lineId += 1
-                }
-            }
-
-            // Save final group
-            if let group = currentGroup, !group.lines.isEmpty, !steps.isEmpty {
-                steps[steps.count - 1].groups.append(group)
-            }
-
-            // Filter out empty steps
-            return steps.filter { !$0.groups.isEmpty || $0.groups.contains { !$0.lines.isEmpty } }
-        }
-
-        private static func parseGitLabLogs(_ lines: [String], fontSize: CGFloat) -> [LogStep] {
-            var groups: [LogGroup] = []
-            var currentGroup: LogGroup?
-            var ungroupedLines: [(id: Int, raw: String, attributed: NSAttributedString)] = []
-            var groupId = 0
-            var lineId = 0
-            var currentStyle = ANSITextStyle()
-
-            // Section name to display name mapping
-            let sectionNames: [String: String] = [
-                "prepare_executor": "Prepare Executor",
-                "prepare_script": "Prepare Environment",
-                "get_sources": "Get Sources",
-                "step_script": "Execute Script",
-                "after_script": "After Script",
-                "cleanup_file_variables": "Cleanup",
-                "archive_cache": "Archive Cache",
-                "upload_artifacts": "Upload Artifacts",
-                "download_artifacts": "Download Artifacts"
-            ]
-
-            // Regex to clean non-color ANSI codes (cursor movement, clear line, etc.)
-            let controlCodePattern = try? NSRegularExpression(pattern: #"\x1B\[[0-9;]*[KJHfsu]|\[0K"#, options: [])
-
-            for line in lines {
-                // Clean ANSI control codes (keep color codes for the ANSI parser)
-                var cleanLine = line.replacingOccurrences(of: "\r", with: "")
-                if let regex = controlCodePattern {
-                    cleanLine = regex.stringByReplacingMatches(in: cleanLine, options: [], range: NSRange(cleanLine.startIndex..., in: cleanLine), withTemplate: "")
-                }
-
-                let trimmed = cleanLine.trimmingCharacters(in: .whitespaces)
-
-                // Check for section_start marker
-                if trimmed.hasPrefix("section_start:") {
-                    // Save ungrouped lines first
-                    if !ungroupedLines.isEmpty {
-                        let group = LogGroup(id: groupId, title: "", lines: ungroupedLines, isExpanded: true)
-                        groups.append(group)
-                        groupId += 1
-                        ungroupedLines = []
-                    }
-
-                    // Save current group if exists
-                    if let group = currentGroup, !group.lines.isEmpty {
-                        groups.append(group)
-                    }
-
-                    // Parse section name: section_start:timestamp:name
-                    let parts = trimmed.split(separator: ":")
-                    let sectionName = parts.count >= 3 ? String(parts[2]) : "Section"
-                    let displayName = sectionNames[sectionName] ?? sectionName.replacingOccurrences(of: "_", with: " ").capitalized
-
-                    currentGroup = LogGroup(id: groupId, title: displayName, lines: [], isExpanded: false)
-                    groupId += 1
-                    continue
-                }
 
-                // Check for section_end marker
-                if trimmed.hasPrefix("section_end:") {
-                    if let group = currentGroup {
-                        groups.append(group)
-                        currentGroup = nil
-                    }
-                    continue
-                }
-
-                // Skip empty lines
-                guard !trimmed.isEmpty else { continue }
-
-                // Parse line with ANSI colors
-                let (attributed, newStyle) = parseLineToAttributedString(cleanLine, style: currentStyle, fontSize: fontSize)
-                currentStyle = newStyle
-
-                if currentGroup != nil {
-                    currentGroup?.lines.append((id: lineId, raw: cleanLine, attributed: attributed))
-                } else {
-                    ungroupedLines.append((id: lineId, raw: cleanLine, attributed: attributed))
+                        let chunks = jobLogs.chunks
+                        var (chunk, byte) = from
+                        var budget = batchBytes
+                        while chunk < chunks.count && budget > 0 {
+                            let end = builder.append(text: chunks[chunk], from: byte, limit: budget)
+                            budget -= end - byte
+                            if end >= chunks[chunk].utf8.count {
+                                chunk += 1
+                                byte = 0
+                            } else {
+                                byte = end
+                            }
+                        }
+                        return ((chunk, byte), builder.parsedSteps, chunk >= chunks.count)
+                    }.value
+
+                    self.builder = builder
+                    self.builtLogs = jobLogs == nil ? logs : ""
+                    self.builtBuffer = jobLogs?.buffer
+                    self.builtChunk = end.chunk
+                    self.builtByteCount = end.byte
+                    self.commitSteps(parsed, keepingExpansion: continued || !isFirstBatch)
+                    position = end
+                    isFirstBatch = false
+                    isDone = done
                 }
-                lineId += 1
-            }
-
-            // Save remaining content
-            if let group = currentGroup, !group.lines.isEmpty {
-                groups.append(group)
             }
-            if !ungroupedLines.isEmpty {
-                let group = LogGroup(id: groupId, title: "", lines: ungroupedLines, isExpanded: true)
-                groups.append(group)
-            }
-
-            if groups.isEmpty {
-                return []
-            }
-
-            // Return as a single step containing all groups
-            return [LogStep(id: 0, name: "Job Output", groups: groups, isExpanded: true)]
         }
 
-        private static func extractStepAndMessage(_ line: String) -> (step: String, message: String) {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-
-            // GitHub Actions format: "job-name    step-name    timestamp message"
-            // Match timestamp pattern
-            let timestampPattern = #"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d+Z)"#
-            guard let regex = try? NSRegularExpression(pattern: timestampPattern, options: []) else {
-                return ("", trimmed)
-            }
-
-            let range = NSRange(trimmed.startIndex..<trimmed.endIndex, in: trimmed)
-            guard let match = regex.firstMatch(in: trimmed, options: [], range: range),
-                  let timestampRange = Range(match.range, in: trimmed) else {
-                return ("", trimmed)
-            }
-
-            let beforeTimestamp = String(trimmed[..<timestampRange.lowerBound]).trimmingCharacters(in: .whitespaces)
-            let afterTimestamp = String(trimmed[timestampRange.upperBound...]).trimmingCharacters(in: .whitespaces)
-
-            // Parse job and step from beforeTimestamp
-            // Split by multiple whitespace
-            let parts = beforeTimestamp.split(omittingEmptySubsequences: true) { $0.isWhitespace }
-
-            var stepName = ""
-            if parts.count >= 2 {
-                // Step name is everything after job name
-                stepName = parts[1..<parts.count].joined(separator: " ")
+        private func commitSteps(_ parsed: [LogStep], keepingExpansion: Bool) {
+            // Ids are stable across appends, so steps and groups keep how they were expanded
+            steps = keepingExpansion ? Self.keepingExpansion(of: steps, in: parsed) : parsed
+            if !keepingExpansion {
+                lineHeights.removeAll()
             }
-
-            return (stepName, afterTimestamp)
+            rebuildDisplayRows()
+            tableView?.reloadData()
         }
 
-        private static func parseLineToAttributedString(_ text: String, style: ANSITextStyle, fontSize: CGFloat) -> (NSAttributedString, ANSITextStyle) {
-            let result = NSMutableAttributedString()
-            var currentStyle = style
-
-            let font = NSFont.monospacedSystemFont(ofSize: fontSize, weight: .regular)
-            let defaultAttrs: [NSAttributedString.Key: Any] = [
-                .font: font,
-                .foregroundColor: NSColor.labelColor
-            ]
-
-            let pattern = "\u{001B}\\[([0-9;]*)m"
-            guard let regex = try? NSRegularExpression(pattern: pattern, options: []) else {
-                return (NSAttributedString(string: text, attributes: defaultAttrs), currentStyle)
-            }
-
-            var lastEnd = text.startIndex
-            let nsString = text as NSString
-            let matches = regex.matches(in: text, options: [], range: NSRange(location: 0, length: nsString.length))
-
-            for match in matches {
-                if let swiftRange = Range(match.range, in: text) {
-                    let textBefore = String(text[lastEnd..<swiftRange.lowerBound])
-                    if !textBefore.isEmpty {
-                        result.append(NSAttributedString(string: textBefore, attributes: attributesForStyle(currentStyle, fontSize: fontSize)))
-                    }
-
-                    if let codeRange = Range(match.range(at: 1), in: text) {
-                        let codes = String(text[codeRange])
-                        parseANSICodes(codes, style: &currentStyle)
-                    }
-
-                    lastEnd = swiftRange.upperBound
+        // Whether `text` holds `parsed` up to `count` bytes and continues after a whole line
+        private static func text(_ text: String, continues parsed: String, at count: Int, format: WorkflowLogStepBuilder.Format) -> Bool {
+            guard count > 0, text.utf8.count >= count, parsed.utf8.count >= count else { return false }
+            var text = text
+            var parsed = parsed
+            return text.withUTF8 { textBytes in
+                parsed.withUTF8 { parsedBytes in
+                    memcmp(textBytes.baseAddress!, parsedBytes.baseAddress!, count) == 0
+                        && (format == .structured || textBytes[count - 1] == 0x0A)
                 }
             }
-
-            let remaining = String(text[lastEnd...])
-            if !remaining.isEmpty {
-                result.append(NSAttributedString(string: remaining, attributes: attributesForStyle(currentStyle, fontSize: fontSize)))
-            }
-
-            if result.length == 0 {
-                result.append(NSAttributedString(string: " ", attributes: defaultAttrs))
-            }
-
-            return (result, currentStyle)
         }
 
-        private static func attributesForStyle(_ style: ANSITextStyle, fontSize: CGFloat) -> [NSAttributedString.Key: Any] {
-            var attrs: [NSAttributedString.Key: Any] = [:]
-
-            let weight: NSFont.Weight = style.bold ? .bold : .regular
-            attrs[.font] = NSFont.monospacedSystemFont(ofSize: fontSize, weight: weight)
-
-            var color = NSColor.labelColor
-            switch style.foreground {
-            case .red: color = NSColor(red: 0.8, green: 0.2, blue: 0.2, alpha: 1)
-            case .green: color = NSColor(red: 0.2, green: 0.8, blue: 0.2, alpha: 1)
-            case .yellow: color = NSColor(red: 0.8, green: 0.8, blue: 0.2, alpha: 1)
-            case .blue: color = NSColor(red: 0.2, green: 0.4, blue: 0.9, alpha: 1)
-            case .magenta: color = NSColor(red: 0.8, green: 0.2, blue: 0.8, alpha: 1)
-            case .cyan: color = NSColor(red: 0.2, green: 0.8, blue: 0.8, alpha: 1)
-            case .brightRed: color = NSColor(red: 1.0, green: 0.4, blue: 0.4, alpha: 1)
-            case .brightGreen: color = NSColor(red: 0.4, green: 1.0, blue: 0.4, alpha: 1)
-            case .brightYellow: color = NSColor(red: 1.0, green: 1.0, blue: 0.4, alpha: 1)
-            case .brightBlue: color = NSColor(red: 0.4, green: 0.6, blue: 1.0, alpha: 1)
-            case .brightMagenta: color = NSColor(red: 1.0, green: 0.4, blue: 1.0, alpha: 1)
-            case .brightCyan: color = NSColor(red: 0.4, green: 1.0, blue: 1.0, alpha: 1)
-            case .white, .brightWhite: color = NSColor.white
-            case .black, .brightBlack: color = NSColor(white: 0.4, alpha: 1)
-            default: break
-            }
-
-            if style.dim {
-                color = color.withAlphaComponent(0.6)
-            }
-            attrs[.foregroundColor] = color
-
-            if style.underline {
-                attrs[.underlineStyle] = NSUnderlineStyle.single.rawValue
+        private static func keepingExpansion(of old: [LogStep], in new: [LogStep]) -> [LogStep] {
+            var stepExpansion: [Int: Bool] = [:]
+            var groupExpansion: [Int: Bool] = [:]
+            for step in old {
+                stepExpansion[step.id] = step.isExpanded
+                for group in step.groups {
+                    groupExpansion[group.id] = group.isExpanded
+                }
             }
 
-            return attrs
-        }
-
-        private static func parseANSICodes(_ codes: String, style: inout ANSITextStyle) {
-            let parts = codes.split(separator: ";").compactMap { Int($0) }
-            if parts.isEmpty { style.reset(); return }
-
-            for code in parts {
-                switch code {
-                case 0: style.reset()
-                case 1: style.bold = true
-                case 2: style.dim = true
-                case 4: style.underline = true
-                case 22: style.bold = false; style.dim = false
-                case 24: style.underline = false
-                case 30: style.foreground = .black
-                case 31: style.foreground = .red
-                case 32: style.foreground = .green
-                case 33: style.foreground = .yellow
-                case 34: style.foreground = .blue
-                case 35: style.foreground = .magenta
-                case 36: style.foreground = .cyan
-                case 37: style.foreground = .white
-                case 39: style.foreground = .default
-                case 90: style.foreground = .brightBlack
-                case 91: style.foreground = .brightRed
-                case 92: style.foreground = .brightGreen
-                case 93: style.foreground = .brightYellow
-                case 94: style.foreground = .brightBlue
-                case 95: style.foreground = .brightMagenta
-                case 96: style.foreground = .brightCyan
-                case 97: style.foreground = .brightWhite
-                default: break
+            var steps = new
+            for i in steps.indices {
+                steps[i].isExpanded = stepExpansion[steps[i].id] ?? steps[i].isExpanded
+                for j in steps[i].groups.indices {
+                    steps[i].groups[j].isExpanded = groupExpansion[steps[i].groups[j].id] ?? steps[i].groups[j].isExpanded
                 }
             }
+            return steps
         }
 
+        // MARK: - Rows
+
         func rebuildDisplayRows() {
-            displayRows.removeAll()
+            rowRuns.removeAll()
             for step in steps {
                 // Count total lines in step
                 let totalLines = step.groups.reduce(0) { $0 + $1.lines.count }
 
                 // Add step header
-                displayRows.append(.stepHeader(id: step.id, name: step.name, groupCount: totalLines, isExpanded: step.isExpanded))
+                rowRuns.append(.header(.stepHeader(id: step.id, name: step.name, groupCount: totalLines, isExpanded: step.isExpanded)))
 
                 // Add groups and lines if step is expanded
                 if step.isExpanded {
                     for group in step.groups {
                         // Add group header (only if it has a title)
                         if !group.title.isEmpty {
-                            displayRows.append(.groupHeader(id: group.id, stepId: step.id, title: group.title, lineCount: group.lines.count, isExpanded: group.isExpanded))
+                            rowRuns.append(.header(.groupHeader(id: group.id, stepId: step.id, title: group.title, lineCount: group.lines.count, isExpanded: group.isExpanded)))
                         }
 
                         // Add lines if expanded or if no header (ungrouped)
-                        if group.isExpanded || group.title.isEmpty {
-                            for line in group.lines {
-                                displayRows.append(.logLine(id: line.id, content: line.raw, attributedContent: line.attributed))
-                            }
+                        if (group.isExpanded || group.title.isEmpty) && !group.lines.isEmpty {
+                            rowRuns.append(.lines(group.lines))
                         }
                     }
                 }
             }
+
+            rowRunStarts.removeAll(keepingCapacity: true)
+            rowCount = 0
+            for run in rowRuns {
+                rowRunStarts.append(rowCount)
+                rowCount += run.rowCount
+            }
+        }
+
+        private func row(at index: Int) -> LogRow? {
+            guard index >= 0 && index < rowCount else { return nil }
+
+            // Last run starting at or before the row
+            var low = 0
+            var high = rowRunStarts.count - 1
+            while low < high {
+                let mid = (low + high + 1) / 2
+                if rowRunStarts[mid] <= index {
+                    low = mid
+                } else {
+                    high = mid - 1
+                }
+            }
+
+            switch rowRuns[low] {
+            case .header(let row):
+                return row
+            case .lines(let lines):
+                return .logLine(index: lines.lowerBound + index - rowRunStarts[low])
+            }
         }
 
         func toggleStep(_ stepId: Int) {
@@ -658,31 +376,48 @@ struct WorkflowLogTableView: NSViewRepresentable {
             tableView?.reloadData()
         }
 
+        // MARK: - Copy
+
         func copyAllLogs() {
-            var allLines: [String] = []
-            for step in steps {
-                for group in step.groups {
-                    for line in group.lines {
-                        allLines.append(line.raw)
-                    }
-                }
-            }
-            NSPasteboard.general.clearContents()
-            NSPasteboard.general.setString(allLines.joined(separator: "\n"), forType: .string)
+            copyLines(of: steps)
         }
 
         func copyStepLogs(_ stepId: Int) {
             guard let step = steps.first(where: { $0.id == stepId }) else { return }
+            copyLines(of: [step])
+        }
+
+        private func copyLines(of steps: [LogStep]) {
+            guard let document = builder?.document else { return }
+            let text = steps
+                .flatMap { $0.groups }
+                .filter { !$0.lines.isEmpty }
+                .map { document.text(lines: $0.lines) }
+                .joined(separator: "\n")
+            NSPasteboard.general.clearContents()
+            NSPasteboard.general.setString(text, forType: .string)
+        }
+
+        func getSelectedContent() -> String {
+            guard let tableView = tableView else { return "" }
             var lines: [String] = []
-            for group in step.groups {
-                for line in group.lines {
-                    lines.append(line.raw)
+            for rowIndex in tableView.selectedRowIndexes {
+                switch row(at: rowIndex) {
+                case .logLine(let index):
+                    lines.append(builder?.document.text(lines: index..<(index + 1)) ?? "")
+                case .groupHeader(_, _, let title, _, _):
+                    lines.append("[\(title)]")
+                case .stepHeader(_, let name, _, _):
+                    lines.append("== \(name) ==")
+                case nil:
+                    continue
                 }
             }
-            NSPasteboard.general.clearContents()
-            NSPasteboard.general.setString(lines.joined(separator: "\n"), forType: .string)
+            return lines.joined(separator: "\n")
         }
 
+        // MARK: - Layout
+
         private var frameObserver: NSObjectProtocol?
         private var columnObserver: NSObjectProtocol?
         private var lastTableWidth: CGFloat = 0
@@ -727,7 +462,7 @@ struct WorkflowLogTableView: NSViewRepresentable {
             // Only recalculate if width changed significantly
             if abs(newWidth - lastTableWidth) > 5 {
                 lastTableWidth = newWidth
-                let rowCount = displayRows.count
+                // Heights are remeasured (or estimated) for the new width as rows are asked for
                 if rowCount > 0 {
                     tableView.noteHeightOfRows(withIndexesChanged: IndexSet(integersIn: 0..<rowCount))
                 }
@@ -743,78 +478,177 @@ struct WorkflowLogTableView: NSViewRepresentable {
             }
         }
 
-        func getSelectedContent() -> String {
-            guard let tableView = tableView else { return "" }
-            var lines: [String] = []
-            for rowIndex in tableView.selectedRowIndexes {
-                guard rowIndex < displayRows.count else { continue }
-                switch displayRows[rowIndex] {
-                case .logLine(_, let content, _):
-                    lines.append(content)
-                case .groupHeader(_, _, let title, _, _):
-                    lines.append("[\(title)]")
-                case .stepHeader(_, let name, _, _):
-                    lines.append("== \(name) ==")
+        // MARK: - Line Heights
+
+        // Measured heights of lines that have been shown, valid for `lineHeightWidth`
+        private var lineHeights: [Int: CGFloat] = [:]
+        private var lineHeightWidth: CGFloat = 0
+        private var remeasuredRows = IndexSet()
+        private var fontMetrics: (fontSize: CGFloat, characterWidth: CGFloat, lineHeight: CGFloat)?
+
+        private func textWidth(in tableView: NSTableView) -> CGFloat {
+            // Use column width for accurate calculation
+            let columnWidth = tableView.tableColumns.first?.width ?? tableView.bounds.width
+            return max(columnWidth - 20, 100) // 12 leading + 8 trailing
+        }
+
+        private func heightOfLine(_ index: Int, in tableView: NSTableView) -> CGFloat {
+            let width = textWidth(in: tableView)
+            if width != lineHeightWidth {
+                lineHeights.removeAll()
+                lineHeightWidth = width
+            }
+            return lineHeights[index] ?? estimatedHeightOfLine(index, width: width)
+        }
+
+        // From the line's length in a monospaced font; escape sequences and wide
+        // characters make it approximate until the line is shown and measured
+        private func estimatedHeightOfLine(_ index: Int, width: CGFloat) -> CGFloat {
+            let metrics: (fontSize: CGFloat, characterWidth: CGFloat, lineHeight: CGFloat)
+            if let cached = fontMetrics, cached.fontSize == fontSize {
+                metrics = cached
+            } else {
+                let font = NSFont.monospacedSystemFont(ofSize: fontSize, weight: .regular)
+                let characterWidth = ("M" as NSString).size(withAttributes: [.font: font]).width
+                metrics = (fontSize, max(characterWidth, 1), NSLayoutManager().defaultLineHeight(for: font))
+                fontMetrics = metrics
+            }
+
+            let length = builder?.document.lineLength(at: index) ?? 0
+            let columns = max(Int(width / metrics.characterWidth), 1)
+            let wrappedLines = max((length + columns - 1) / columns, 1)
+            return max(ceil(CGFloat(wrappedLines) * metrics.lineHeight) + 4, 16)
+        }
+
+        private func measuredHeight(of attributed: NSAttributedString, width: CGFloat) -> CGFloat {
+            // Use text storage for accurate height calculation
+            let textStorage = NSTextStorage(attributedString: attributed)
+            let textContainer = NSTextContainer(size: NSSize(width: width, height: .greatestFiniteMagnitude))
+            let layoutManager = NSLayoutManager()
+
+            textContainer.lineFragmentPadding = 0
+            layoutManager.addTextContainer(textContainer)
+            textStorage.addLayoutManager(layoutManager)
+
+            layoutManager.ensureLayout(for: textContainer)
+            let textHeight = layoutManager.usedRect(for: textContainer).height
+
+            return max(ceil(textHeight) + 4, 16)
+        }
+
+        // Measure a line as it's shown; if the estimate was off, have the table ask again
+        private func rememberHeight(of attributed: NSAttributedString, line index: Int, row: Int, in tableView: NSTableView) {
+            let current = heightOfLine(index, in: tableView)
+            guard lineHeights[index] == nil else { return }
+
+            let measured = measuredHeight(of: attributed, width: lineHeightWidth)
+            lineHeights[index] = measured
+            guard measured != current else { return }
+
+            remeasuredRows.insert(row)
+            if remeasuredRows.count == 1 {
+                DispatchQueue.main.async { [weak self] in
+                    guard let self = self else { return }
+                    let rows = self.remeasuredRows.filteredIndexSet { $0 < self.rowCount }
+                    self.remeasuredRows.removeAll()
+                    self.tableView?.noteHeightOfRows(withIndexesChanged: rows)
                 }
             }
-            return lines.joined(separator: "\n")
+        }
+
+        // MARK: - Styling
+
+        private func attributedLine(_ index: Int) -> NSAttributedString {
+            let line = builder?.document.line(at: index) ?? ANSIStyledLine(runs: [])
+            let result = NSMutableAttributedString()
+            for run in line.runs {
+                result.append(NSAttributedString(string: run.text, attributes: Self.attributesForStyle(run.style, fontSize: fontSize)))
+            }
+
+            if result.length == 0 {
+                let font = NSFont.monospacedSystemFont(ofSize: fontSize, weight: .regular)
+                result.append(NSAttributedString(string: " ", attributes: [.font: font, .foregroundColor: NSColor.labelColor]))
+            }
+            return result
+        }
+
+        private static func attributesForStyle(_ style: ANSITextStyle, fontSize: CGFloat) -> [NSAttributedString.Key: Any] {
+            var attrs: [NSAttributedString.Key: Any] = [:]
+
+            let weight: NSFont.Weight = style.bold ? .bold : .regular
+            attrs[.font] = NSFont.monospacedSystemFont(ofSize: fontSize, weight: weight)
+
+            var color = NSColor.labelColor
+            switch style.foreground {
+            case .red: color = NSColor(red: 0.8, green: 0.2, blue: 0.2, alpha: 1)
+            case .green: color = NSColor(red: 0.2, green: 0.8, blue: 0.2, alpha: 1)
+            case .yellow: color = NSColor(red: 0.8, green: 0.8, blue: 0.2, alpha: 1)
+            case .blue: color = NSColor(red: 0.2, green: 0.4, blue: 0.9, alpha: 1)
+            case .magenta: color = NSColor(red: 0.8, green: 0.2, blue: 0.8, alpha: 1)
+            case .cyan: color = NSColor(red: 0.2, green: 0.8, blue: 0.8, alpha: 1)
+            case .brightRed: color = NSColor(red: 1.0, green: 0.4, blue: 0.4, alpha: 1)
+            case .brightGreen: color = NSColor(red: 0.4, green: 1.0, blue: 0.4, alpha: 1)
+            case .brightYellow: color = NSColor(red: 1.0, green: 1.0, blue: 0.4, alpha: 1)
+            case .brightBlue: color = NSColor(red: 0.4, green: 0.6, blue: 1.0, alpha: 1)
+            case .brightMagenta: color = NSColor(red: 1.0, green: 0.4, blue: 1.0, alpha: 1)
+            case .brightCyan: color = NSColor(red: 0.4, green: 1.0, blue: 1.0, alpha: 1)
+            case .white, .brightWhite: color = NSColor.white
+            case .black, .brightBlack: color = NSColor(white: 0.4, alpha: 1)
+            default: break
+            }
+
+            if style.dim {
+                color = color.withAlphaComponent(0.6)
+            }
+            attrs[.foregroundColor] = color
+
+            if style.underline {
+                attrs[.underlineStyle] = NSUnderlineStyle.single.rawValue
+            }
+
+            return attrs
         }
 
         // MARK: - NSTableViewDataSource
 
         func numberOfRows(in tableView: NSTableView) -> Int {
-            displayRows.count
+            rowCount
         }
 
         // MARK: - NSTableViewDelegate
 
         func tableView(_ tableView: NSTableView, viewFor tableColumn: NSTableColumn?, row: Int) -> NSView? {
-            guard row < displayRows.count else { return nil }
-
-            switch displayRows[row] {
+            switch self.row(at: row) {
             case .stepHeader(let id, let name, let count, let isExpanded):
                 return makeStepHeaderCell(id: id, name: name, count: count, isExpanded: isExpanded, tableView: tableView)
             case .groupHeader(let id, let stepId, let title, let count, let isExpanded):
                 return makeGroupHeaderCell(id: id, stepId: stepId, title: title, count: count, isExpanded: isExpanded, tableView: tableView)
-            case .logLine(_, _, let attributed):
+            case .logLine(let index):
+                // Styled only now that it's on screen
+                let attributed = attributedLine(index)
+                rememberHeight(of: attributed, line: index, row: row, in: tableView)
                 return makeLogLineCell(attributed: attributed, tableView: tableView)
+            case nil:
+                return nil
             }
         }
 
         func tableView(_ tableView: NSTableView, heightOfRow row: Int) -> CGFloat {
-            guard row < displayRows.count else { return 20 }
-            switch displayRows[row] {
+            switch self.row(at: row) {
             case .stepHeader: return 28
             case .groupHeader: return 22
-            case .logLine(_, _, let attributed):
-                // Use column width for accurate calculation
-                let columnWidth = tableView.tableColumns.first?.width ?? tableView.bounds.width
-                let textWidth = max(columnWidth - 20, 100) // 12 leading + 8 trailing
-
-                // Use text storage for accurate height calculation
-                let textStorage = NSTextStorage(attributedString: attributed)
-                let textContainer = NSTextContainer(size: NSSize(width: textWidth, height: .greatestFiniteMagnitude))
-                let layoutManager = NSLayoutManager()
-
-                textContainer.lineFragmentPadding = 0
-                layoutManager.addTextContainer(textContainer)
-                textStorage.addLayoutManager(layoutManager)
-
-                layoutManager.ensureLayout(for: textContainer)
-                let textHeight = layoutManager.usedRect(for: textContainer).height
-
-                return max(ceil(textHeight) + 4, 16)
+            case .logLine(let index): return heightOfLine(index, in: tableView)
+            case nil: return 20
             }
         }
 
         func tableView(_ tableView: NSTableView, rowViewForRow row: Int) -> NSTableRowView? {
             let rowView = LogRowView()
-            if row < displayRows.count {
-                switch displayRows[row] {
-                case .stepHeader: rowView.isHeader = true; rowView.isStepHeader = true
-                case .groupHeader: rowView.isHeader = true; rowView.isStepHeader = false
-                case .logLine: rowView.isHeader = false
-                }
+            switch self.row(at: row) {
+            case .stepHeader: rowView.isHeader = true; rowView.isStepHeader = true
+            case .groupHeader: rowView.isHeader = true; rowView.isStepHeader = false
+            case .logLine: rowView.isHeader = false
+            case nil: break
             }
             return rowView
         }
@@ -867,21 +701,21 @@ struct WorkflowLogTableView: NSViewRepresentable {
 
 struct WorkflowLogView: View {
     let logs: String
-    let structuredLogs: WorkflowLogs?
+    let jobLogs: WorkflowLogs?
     let fontSize: CGFloat
     let provider: WorkflowProvider
 
     @State private var showTimestamps: Bool = false
 
-    init(_ logs: String, structuredLogs: WorkflowLogs? = nil, fontSize: CGFloat = 11, provider: WorkflowProvider = .github) {
+    init(_ logs: String, jobLogs: WorkflowLogs? = nil, fontSize: CGFloat = 11, provider: WorkflowProvider = .github) {
         self.logs = logs
-        self.structuredLogs = structuredLogs
+        self.jobLogs = jobLogs
         self.fontSize = fontSize
         self.provider = provider
     }
 
     var body: some View {
-        WorkflowLogTableView(logs: logs, structuredLogs: structuredLogs, fontSize: fontSize, provider: provider, showTimestamps: $showTimestamps, onCoordinatorReady: nil)
+        WorkflowLogTableView(logs: logs, jobLogs: jobLogs, fontSize: fontSize, provider: provider, showTimestamps: $showTimestamps, onCoordinatorReady: nil)
             .background(Color(nsColor: .textBackgroundColor))
     }
 }
@@ -264,7 +264,10 @@ struct WorkflowRunDetailView: View {
                     }
                 }
 
-                if !service.runLogs.isEmpty {
+                if let jobLogs = service.jobLogs {
+                    CopyButton(iconSize: 12) { jobLogs.content }
+                        .help("Copy all logs")
+                } else if !service.runLogs.isEmpty {
                     CopyButton(text: service.runLogs, iconSize: 12)
                         .help("Copy all logs")
                 }
@@ -290,7 +293,9 @@ struct WorkflowRunDetailView: View {
             Divider()
 
             // Logs content
-            if service.isLoadingLogs && service.runLogs.isEmpty {
+            if let jobLogs = service.jobLogs {
+                WorkflowLogView("", jobLogs: jobLogs, fontSize: 11, provider: service.provider)
+            } else if service.isLoadingLogs && service.runLogs.isEmpty {
                 VStack(spacing: 8) {
                     ProgressView()
                         .controlSize(.small)
@@ -328,7 +333,7 @@ struct WorkflowRunDetailView: View {
                 .frame(maxWidth: .infinity, maxHeight: .infinity, alignment: .center)
                 .padding()
             } else {
-                WorkflowLogView(service.runLogs, structuredLogs: service.structuredLogs, fontSize: 11, provider: service.provider)
+                WorkflowLogView(service.runLogs, fontSize: 11, provider: service.provider)
             }
         }
     }
@@ -748,7 +748,8 @@ struct WorktreeListItemView: View {
                     aheadCount: detailedStatus.aheadBy,
                     behindCount: detailedStatus.behindBy,
                     additions: detailedStatus.additions,
-                    deletions: detailedStatus.deletions
+                    deletions: detailedStatus.deletions,
+                    lineStatsOmitted: detailedStatus.lineStatsOmitted
                 )
                 
                 await MainActor.run {
@@ -834,6 +835,16 @@ struct GitChangesIndicatorView: View {
                     .foregroundStyle(.red)
             }
 
+            if gitStatus.lineStatsOmitted {
+                // Too many changed files to count lines
+                Image(systemName: "plusminus.circle.fill")
+                    .font(.system(size: 8))
+                    .foregroundStyle(.secondary)
+                Text("?")
+                    .font(.caption2)
+                    .foregroundStyle(.secondary)
+            }
+
             if !gitStatus.untrackedFiles.isEmpty {
                 Image(systemName: "questionmark.circle.fill")
                     .font(.system(size: 8))
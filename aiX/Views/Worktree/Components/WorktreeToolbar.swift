@@ -93,6 +93,7 @@ struct GitStatusView: View {
     let deletions: Int
     let untrackedFiles: Int
     let stagedFiles: Int
+    var lineStatsOmitted = false
 
     var body: some View {
         HStack(spacing: 8) {
@@ -107,6 +108,14 @@ struct GitStatusView: View {
                 .transition(.opacity)
             }
 
+            if lineStatsOmitted {
+                Text("±?")
+                    .font(.system(size: 11, weight: .medium))
+                    .foregroundStyle(.secondary)
+                    .help("Too many changed files to count lines")
+                    .transition(.opacity)
+            }
+
             if additions > 0 {
                 Text("+\(additions)")
                     .font(.system(size: 11, weight: .medium))
@@ -136,6 +145,7 @@ struct GitStatusView: View {
         .animation(.easeInOut(duration: 0.2), value: stagedFiles)
         .animation(.easeInOut(duration: 0.2), value: additions)
         .animation(.easeInOut(duration: 0.2), value: deletions)
+        .animation(.easeInOut(duration: 0.2), value: lineStatsOmitted)
         .animation(.easeInOut(duration: 0.2), value: untrackedFiles)
     }
 }
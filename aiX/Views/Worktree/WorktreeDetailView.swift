@@ -138,6 +138,7 @@ struct WorktreeDetailView: View {
     var hasGitChanges: Bool {
         gitRepositoryService.currentStatus.additions > 0 ||
         gitRepositoryService.currentStatus.deletions > 0 ||
+        gitRepositoryService.currentStatus.lineStatsOmitted ||
         gitRepositoryService.currentStatus.untrackedFiles.count > 0 ||
         gitRepositoryService.currentStatus.stagedFiles.count > 0
     }
@@ -410,7 +411,8 @@ struct WorktreeDetailView: View {
             additions: gitRepositoryService.currentStatus.additions,
             deletions: gitRepositoryService.currentStatus.deletions,
             untrackedFiles: gitRepositoryService.currentStatus.untrackedFiles.count,
-            stagedFiles: gitRepositoryService.currentStatus.stagedFiles.count
+            stagedFiles: gitRepositoryService.currentStatus.stagedFiles.count,
+            lineStatsOmitted: gitRepositoryService.currentStatus.lineStatsOmitted
         )
 
         if #available(macOS 14.0, *) {
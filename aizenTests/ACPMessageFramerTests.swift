@@ -0,0 +1,121 @@
+//
+//  ACPMessageFramerTests.swift
+//  aizenTests
+//
+//  Structural framing of agent stdout across arbitrary chunk boundaries
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class ACPMessageFramerTests: XCTestCase {
+
+    private let messages = [
+        #"{"jsonrpc":"2.0","id":1,"result":{"ok":true}}"#,
+        #"{"jsonrpc":"2.0","method":"session/update","params":{"text":"braces } ] { [ in a string"}}"#,
+        #"{"jsonrpc":"2.0","id":2,"result":{"text":"escaped \" quote and \\ backslash \\"}}"#,
+        #"[{"jsonrpc":"2.0","id":3},{"jsonrpc":"2.0","id":4}]"#,
+    ]
+
+    private func feed(_ stream: Data, chunkSizes: [Int], into framer: inout ACPMessageFramer) -> [String] {
+        var frames: [String] = []
+        var offset = 0
+        var sizeIndex = 0
+        while offset < stream.count {
+            let size = chunkSizes[sizeIndex % chunkSizes.count]
+            sizeIndex += 1
+            let end = min(offset + size, stream.count)
+            frames += framer.append(stream.subdata(in: offset..<end)).map { String(decoding: $0, as: UTF8.self) }
+            offset = end
+        }
+        return frames
+    }
+
+    func testNewlineDelimitedMessagesAtEveryChunkBoundary() {
+        let stream = Data(messages.joined(separator: "\n").appending("\n").utf8)
+
+        for split in 1..<stream.count {
+            var framer = ACPMessageFramer()
+            let first = framer.append(stream.subdata(in: 0..<split)).map { String(decoding: $0, as: UTF8.self) }
+            let second = framer.append(stream.subdata(in: split..<stream.count)).map { String(decoding: $0, as: UTF8.self) }
+            XCTAssertEqual(first + second, messages, "split at \(split)")
+            XCTAssertEqual(framer.pendingByteCount, 0)
+        }
+    }
+
+    func testSingleByteAndIrregularChunks() {
+        let stream = Data(messages.joined(separator: "\r\n").utf8)
+
+        for sizes in [[1], [2, 7, 3], [13, 1, 64], [4096]] {
+            var framer = ACPMessageFramer()
+            XCTAssertEqual(feed(stream, chunkSizes: sizes, into: &framer), messages, "chunks \(sizes)")
+        }
+    }
+
+    func testPrettyPrintedMessages() throws {
+        let values: [[String: Any]] = [
+            ["jsonrpc": "2.0", "id": 7, "result": ["nested": ["a": [1, 2, 3], "b": "x}y"]]],
+            ["jsonrpc": "2.0", "method": "session/update", "params": ["lines": ["one", "two"]]],
+        ]
+        let pretty = try values.map {
+            try JSONSerialization.data(withJSONObject: $0, options: [.prettyPrinted, .sortedKeys])
+        }
+        var stream = Data()
+        for data in pretty {
+            stream.append(data)
+            stream.append(Data("\n".utf8))
+        }
+
+        var framer = ACPMessageFramer()
+        let frames = feed(stream, chunkSizes: [5, 11], into: &framer)
+        XCTAssertEqual(frames, pretty.map { String(decoding: $0, as: UTF8.self) })
+    }
+
+    func testMultiMegabyteFrame() {
+        let payload = String(repeating: "abcdefgh{}[]\\\"", count: 300_000)
+        let escaped = payload.replacingOccurrences(of: "\\", with: "\\\\").replacingOccurrences(of: "\"", with: "\\\"")
+        let big = #"{"jsonrpc":"2.0","id":9,"result":{"content":""# + escaped + #""}}"#
+        XCTAssertGreaterThan(big.utf8.count, 4_000_000)
+        let stream = Data((big + "\n" + messages[0] + "\n").utf8)
+
+        var framer = ACPMessageFramer()
+        var frames: [Data] = []
+        var offset = 0
+        while offset < stream.count {
+            let end = min(offset + 65_536, stream.count)
+            frames += framer.append(stream.subdata(in: offset..<end))
+            if frames.isEmpty {
+                XCTAssertEqual(framer.pendingByteCount, end)
+            }
+            offset = end
+        }
+
+        XCTAssertEqual(frames.count, 2)
+        XCTAssertEqual(Data(frames[0]), Data(big.utf8))
+        XCTAssertEqual(String(decoding: frames[1], as: UTF8.self), messages[0])
+        let decoded = try? JSONSerialization.jsonObject(with: Data(frames[0])) as? [String: Any]
+        let content = (decoded?["result"] as? [String: Any])?["content"] as? String
+        XCTAssertEqual(content, payload)
+    }
+
+    func testNonJSONLinesAreDiscarded() {
+        let stream = Data("starting agent v1.2\n\(messages[0])\nwarning: {not json}\n\(messages[1])\n".utf8)
+
+        var framer = ACPMessageFramer()
+        XCTAssertEqual(feed(stream, chunkSizes: [3], into: &framer), [messages[0], messages[1]])
+        XCTAssertEqual(framer.discardedLines, 2)
+    }
+
+    func testTruncatedMessageIsReturnedAsRemainder() {
+        var framer = ACPMessageFramer()
+        let frames = framer.append(Data((messages[0] + "\n" + #"{"jsonrpc":"2.0","id":"#).utf8))
+        XCTAssertEqual(frames.count, 1)
+        XCTAssertEqual(framer.takeRemainder().map { String(decoding: $0, as: UTF8.self) }, #"{"jsonrpc":"2.0","id":"#)
+        XCTAssertEqual(framer.pendingByteCount, 0)
+
+        var whitespaceOnly = ACPMessageFramer()
+        _ = whitespaceOnly.append(Data((messages[0] + "\n  \n").utf8))
+        XCTAssertNil(whitespaceOnly.takeRemainder())
+    }
+}
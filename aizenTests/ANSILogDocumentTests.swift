@@ -0,0 +1,124 @@
+//
+//  ANSILogDocumentTests.swift
+//  aizenTests
+//
+//  Chunk checkpoints and appends must style lines as a single pass would
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class ANSILogDocumentTests: XCTestCase {
+    private struct Run: Equatable {
+        let text: String
+        let style: ANSITextStyle
+    }
+
+    private func runs(_ line: ANSIStyledLine) -> [Run] {
+        line.runs.map { Run(text: $0.text, style: $0.style) }
+    }
+
+    /// Every line styled in order by one state machine
+    private func reference(_ text: String) -> [[Run]] {
+        var lines = text.split(separator: "\n", omittingEmptySubsequences: false).map(String.init)
+        if lines.last == "" { lines.removeLast() }
+
+        var machine = ANSIStateMachine()
+        return lines.map { line in
+            var bytes = Array(line.utf8)
+            if bytes.last == 0x0D { bytes.removeLast() }
+            return runs(bytes.withUnsafeBufferPointer { machine.styledLine($0) })
+        }
+    }
+
+    /// A log whose styles are set on one line and only reset many lines later,
+    /// so lines in later chunks depend on state carried across chunk boundaries
+    private func log(lineCount: Int) -> String {
+        (0..<lineCount).map { index -> String in
+            switch index % 300 {
+            case 0: return "\u{1B}[31mred from \(index)"
+            case 100: return "\u{1B}[1mbold too \(index)\r"
+            case 200: return "plain again\u{1B}[0m \(index)"
+            case 250: return "\u{1B}[38;2;10;20;30mrgb \(index)\u{1B}[39m back to default"
+            default: return "line \(index)"
+            }
+        }
+        .joined(separator: "\n") + "\n"
+    }
+
+    private func assertMatchesReference(_ document: ANSILogDocument, _ text: String, order: [Int], file: StaticString = #filePath, line: UInt = #line) {
+        let expected = reference(text)
+        XCTAssertEqual(document.lineCount, expected.count, file: file, line: line)
+        for index in order {
+            XCTAssertEqual(runs(document.line(at: index)), expected[index], "line \(index)", file: file, line: line)
+        }
+    }
+
+    func testLinesStyledOutOfOrderMatchSinglePass() {
+        let text = log(lineCount: ANSILogDocument.chunkLineCount * 6 + 17)
+        let document = ANSILogDocument(text)
+        let count = document.lineCount
+
+        // Jump straight to the end first, so checkpoints are built without styling earlier chunks
+        let order = [count - 1, 0] + Array((0..<count).reversed()) + Array(stride(from: 0, to: count, by: 97))
+        assertMatchesReference(document, text, order: order)
+    }
+
+    func testEvictedChunksAreRestyledFromCheckpoints() {
+        let text = log(lineCount: ANSILogDocument.chunkLineCount * 5)
+        let document = ANSILogDocument(maxCachedChunks: 1)
+        document.append(text)
+
+        let order = stride(from: 0, to: document.lineCount, by: 31).flatMap { [$0, document.lineCount - 1 - $0] }
+        assertMatchesReference(document, text, order: order)
+    }
+
+    func testAppendsMatchSinglePass() {
+        let text = log(lineCount: ANSILogDocument.chunkLineCount * 4 + 3)
+        let bytes = Array(text.utf8)
+        let document = ANSILogDocument()
+
+        // Irregular appends that split lines and escape sequences, reading after each one
+        var offset = 0
+        var step = 0
+        while offset < bytes.count {
+            let end = min(offset + 1 + (step * 211) % 1_500, bytes.count)
+            step += 1
+            bytes[offset..<end].withUnsafeBufferPointer { document.append($0) }
+            offset = end
+
+            let prefix = String(decoding: bytes[..<end], as: UTF8.self)
+            let expected = reference(prefix)
+            XCTAssertEqual(document.lineCount, expected.count)
+            // The last line may be partial and is restyled when it grows
+            if let last = expected.indices.last {
+                XCTAssertEqual(runs(document.line(at: last)), expected[last], "after \(end) bytes")
+            }
+        }
+
+        assertMatchesReference(document, text, order: Array(0..<document.lineCount))
+        XCTAssertEqual(document.byteCount, bytes.count)
+    }
+
+    func testExtendAppendsOnlyAPrefixMatch() {
+        let document = ANSILogDocument("one\n\u{1B}[32mtwo\n")
+        XCTAssertTrue(document.extend(to: "one\n\u{1B}[32mtwo\nthree"))
+        XCTAssertEqual(document.lineCount, 3)
+        XCTAssertEqual(document.line(at: 2).text, "three")
+        XCTAssertEqual(document.line(at: 2).runs.first?.style.foreground, .green)
+
+        XCTAssertFalse(document.extend(to: "uno\n\u{1B}[32mtwo\nthree and more"))
+        XCTAssertFalse(document.extend(to: "one\n"))
+        XCTAssertEqual(document.text(lines: 0..<3), "one\n\u{1B}[32mtwo\nthree")
+    }
+
+    func testLineLengthAndTextExcludeLineBreaks() {
+        let document = ANSILogDocument("ab\r\ncde\n\nf")
+        XCTAssertEqual(document.lineCount, 4)
+        XCTAssertEqual((0..<4).map(document.lineLength(at:)), [3, 3, 0, 1])
+        XCTAssertEqual(document.text(lines: 1..<3), "cde\n")
+        XCTAssertEqual(document.line(at: 0).text, "ab")
+        XCTAssertEqual(document.line(at: 9).runs.count, 0)
+    }
+}
@@ -0,0 +1,103 @@
+//
+//  ChatTimelineStoreTests.swift
+//  aizenTests
+//
+//  Grouping tool calls in place when an agent message arrives
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class ChatTimelineStoreTests: XCTestCase {
+    private let start = Date(timeIntervalSinceReferenceDate: 0)
+
+    private func message(_ id: String, _ role: MessageRole, at seconds: TimeInterval) -> TimelineItem {
+        .message(MessageItem(id: id, role: role, content: id, timestamp: start + seconds))
+    }
+
+    private func call(_ id: String, at seconds: TimeInterval, parent: String? = nil) -> ToolCall {
+        var call = ToolCall(
+            toolCallId: id,
+            title: id,
+            kind: .read,
+            status: .completed,
+            content: [],
+            locations: nil,
+            rawInput: nil,
+            rawOutput: nil,
+            timestamp: start + seconds
+        )
+        call.parentToolCallId = parent
+        return call
+    }
+
+    private func group(_ calls: [ToolCall]) -> ToolCallGroup {
+        ToolCallGroup(iterationId: nil, toolCalls: calls, messageId: "a1", isCompletedTurn: true)
+    }
+
+    func testGroupsTheRunBeforeTheNewMessage() {
+        let store = ChatTimelineStore()
+        store.insert(message("u1", .user, at: 0))
+        store.insert(message("a1", .agent, at: 1))
+        let first = store.rows[1]
+        for (index, id) in ["t1", "t2", "t3"].enumerated() {
+            store.insert(.toolCall(call(id, at: 2 + Double(index))))
+        }
+        store.insert(.toolCall(call("child", at: 2.5, parent: "t1")))
+
+        let expected = group([call("t1", at: 2), call("t2", at: 3), call("t3", at: 4)])
+        XCTAssertTrue(store.groupToolCalls(before: start + 5) { calls in
+            XCTAssertEqual(calls.map(\.id), ["t1", "t2", "t3"])
+            return self.group(calls)
+        })
+        store.insert(message("a2", .agent, at: 5))
+
+        XCTAssertEqual(store.items.map(\.stableId), ["u1", "a1", TimelineItem.toolCallGroup(expected).stableId, "a2"])
+        XCTAssertTrue(store.rows[1] === first)
+        XCTAssertFalse(store.contains("t2"))
+        XCTAssertFalse(store.contains("child"))
+
+        // Calls now update through their group row
+        var updated = call("t2", at: 3)
+        updated.title = "renamed"
+        updated.revision = 1
+        XCTAssertTrue(store.update(toolCall: updated))
+        guard case .toolCallGroup(let stored) = store.rows[2].item else {
+            return XCTFail("expected a group row")
+        }
+        XCTAssertEqual(stored.toolCalls.map(\.title), ["t1", "renamed", "t3"])
+    }
+
+    func testNothingToGroupLeavesTheTimeline() {
+        let store = ChatTimelineStore()
+        store.insert(message("u1", .user, at: 0))
+        XCTAssertTrue(store.groupToolCalls(before: start + 1) { self.group($0) })
+        XCTAssertEqual(store.items.map(\.stableId), ["u1"])
+    }
+
+    func testSystemMessageInTheRunNeedsAFullRegroup() {
+        let store = ChatTimelineStore()
+        store.insert(message("a1", .agent, at: 0))
+        store.insert(.toolCall(call("t1", at: 1)))
+        store.insert(message("mode", .system, at: 2))
+        store.insert(.toolCall(call("t2", at: 3)))
+
+        XCTAssertFalse(store.groupToolCalls(before: start + 4) { self.group($0) })
+        XCTAssertEqual(store.items.map(\.stableId), ["a1", "t1", "mode", "t2"])
+    }
+
+    func testRevisionChangeReachesTheRow() {
+        let store = ChatTimelineStore()
+        var running = call("t1", at: 0)
+        running.rawOutput = AnyCodable("first")
+        store.insert(.toolCall(running))
+
+        // Same status, counts and rawOutput presence; only the revision tells them apart
+        var replaced = running
+        replaced.rawOutput = AnyCodable("second")
+        XCTAssertFalse(store.update(toolCall: replaced))
+        replaced.revision += 1
+        XCTAssertTrue(store.update(toolCall: replaced))
+    }
+}
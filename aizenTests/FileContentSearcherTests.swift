@@ -0,0 +1,126 @@
+//
+//  FileContentSearcherTests.swift
+//  aizenTests
+//
+//  Regex prefilter literals must be contained in every real match
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class FileContentSearcherTests: XCTestCase {
+
+    // MARK: - requiredLiteral
+
+    func testPlainRunsAreExtracted() {
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "hello.*world"), "hello")
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "foo\\.barbaz"), "foo.barbaz")
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "\\bstruct\\s+\\w+"), "struct")
+    }
+
+    func testOptionalCharactersAreNotRequired() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "abc?"))
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "colou?r-scheme"), "r-scheme")
+    }
+
+    func testCountedRepetitionGivesUp() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\d{2,3}"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "version\\d{2,3}"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "abcd{2}"))
+    }
+
+    func testGroupSyntaxGivesUp() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "foo(?!bar)"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(?=prefix)pre"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(?<name>abc)def"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(?i)hello"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(abc)\\k<name>"))
+    }
+
+    func testCodePointAndPropertyEscapesGiveUp() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\x41BC"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\x{1F600}abc"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\u0041bcd"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\p{Lu}abc"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\N{LATIN SMALL LETTER A}bc"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "\\Qa.b\\Ecd"))
+    }
+
+    func testAlternationGivesUp() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(foo|bar)baz"))
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "alpha|beta"))
+    }
+
+    func testOptionalGroupsAreNotRequired() {
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "(hello)?world"), "world")
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "(prefix)*ab"))
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "(hello)+x"), "hello")
+    }
+
+    func testNestedClassesDoNotLeak() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "[[a-z]&&[^xyz]]+"))
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "[[:alpha:]]name"), "name")
+    }
+
+    func testCaseInsensitiveNonASCIIGivesUp() {
+        XCTAssertNil(FileContentSearcher.requiredLiteral(inPattern: "café", caseSensitive: false))
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "café", caseSensitive: true), "café")
+        XCTAssertEqual(FileContentSearcher.requiredLiteral(inPattern: "cafe", caseSensitive: false), "cafe")
+    }
+
+    // MARK: - Scanning
+
+    func testRegexMatchesSurviveThePrefilter() throws {
+        let file = try makeFile("let id = 123\nlet CAFÉ = 1\n")
+
+        let counted = FileContentSearcher(query: "id = \\d{2,3}", options: regexOptions(caseSensitive: true))
+        XCTAssertEqual(counted?.scan(file).map(\.lineNumber), [1])
+
+        let unicode = FileContentSearcher(query: "café", options: regexOptions(caseSensitive: false))
+        XCTAssertEqual(unicode?.scan(file).map(\.lineNumber), [2])
+
+        let lookahead = FileContentSearcher(query: "let (?!id)", options: regexOptions(caseSensitive: true))
+        XCTAssertEqual(lookahead?.scan(file).map(\.lineNumber), [2])
+    }
+
+    func testCaseInsensitiveNonASCIILiteralFoldsUnicode() throws {
+        let file = try makeFile("Straße\nÄRGER (x+1)\närger\n")
+
+        let umlaut = FileContentSearcher(query: "ärger", options: FileContentSearchOptions())
+        XCTAssertEqual(umlaut?.scan(file).map(\.lineNumber), [2, 3])
+        XCTAssertEqual(umlaut?.scan(file).first?.matchRanges, [NSRange(location: 0, length: 5)])
+
+        // Regex metacharacters in the query stay literal
+        let escaped = FileContentSearcher(query: "Ärger (X+1)", options: FileContentSearchOptions())
+        XCTAssertEqual(escaped?.scan(file).map(\.lineNumber), [2])
+
+        var caseSensitive = FileContentSearchOptions()
+        caseSensitive.caseSensitive = true
+        XCTAssertEqual(FileContentSearcher(query: "ärger", options: caseSensitive)?.scan(file).map(\.lineNumber), [3])
+
+        XCTAssertNil(FileContentSearcher.prefilterLiteral(for: "ärger", options: FileContentSearchOptions()))
+        XCTAssertEqual(FileContentSearcher.prefilterLiteral(for: "ärger", options: caseSensitive), "ärger")
+        XCTAssertEqual(FileContentSearcher.prefilterLiteral(for: "Arger", options: FileContentSearchOptions()), "Arger")
+    }
+
+    // MARK: - Helpers
+
+    private func regexOptions(caseSensitive: Bool) -> FileContentSearchOptions {
+        var options = FileContentSearchOptions()
+        options.isRegex = true
+        options.caseSensitive = caseSensitive
+        return options
+    }
+
+    private func makeFile(_ contents: String) throws -> FileSearchIndexResult {
+        let directory = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        addTeardownBlock {
+            try? FileManager.default.removeItem(at: directory)
+        }
+        try contents.write(to: directory.appendingPathComponent("sample.swift"), atomically: true, encoding: .utf8)
+        return FileSearchIndexResult(basePath: directory.path, relativePath: "sample.swift", isDirectory: false)
+    }
+}
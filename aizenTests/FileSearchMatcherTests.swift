@@ -0,0 +1,46 @@
+//
+//  FileSearchMatcherTests.swift
+//  aizenTests
+//
+//  Quick-open scoring over the candidate arena
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class FileSearchMatcherTests: XCTestCase {
+
+    private func entry(_ relativePath: String) -> FileSearchIndexResult {
+        FileSearchIndexResult(basePath: "/repo", relativePath: relativePath, isDirectory: false)
+    }
+
+    func testFileNamePrefixMatchesWhenPathScoresZero() async {
+        // Path score: "a" after "/" (25) + consecutive "b" (15) - 400 * 0.1 length penalty = 0
+        let path = "x/ab" + String(repeating: "c", count: 396)
+        let index = FileSearchCandidateIndex(entries: [entry(path), entry("other/file.txt")])
+
+        let results = await index.search(query: "ab", limit: 10)
+        XCTAssertEqual(results.map(\.relativePath), [path])
+        XCTAssertGreaterThanOrEqual(results.first?.matchScore ?? 0, 500)
+    }
+
+    func testNonMatchingPathsAreRejected() async {
+        let index = FileSearchCandidateIndex(entries: [entry("src/main.swift"), entry("README.md")])
+
+        let results = await index.search(query: "zq", limit: 10)
+        XCTAssertTrue(results.isEmpty)
+    }
+
+    func testBetterMatchesRankFirst() async {
+        let index = FileSearchCandidateIndex(entries: [
+            entry("docs/notes/config-old.md"),
+            entry("config"),
+            entry("src/config.swift"),
+        ])
+
+        let results = await index.search(query: "config", limit: 10)
+        XCTAssertEqual(results.first?.relativePath, "config")
+        XCTAssertEqual(results.count, 3)
+    }
+}
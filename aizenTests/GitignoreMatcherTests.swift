@@ -0,0 +1,157 @@
+//
+//  GitignoreMatcherTests.swift
+//  aizenTests
+//
+//  Compiled gitignore rules and the parallel walk that applies them
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class GitignoreMatcherTests: XCTestCase {
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory
+            .appendingPathComponent("GitignoreMatcherTests-\(UUID().uuidString)", isDirectory: true)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    private func matcher(_ patterns: [String]) -> GitignoreMatcher {
+        GitignoreMatcher.root(at: directory.path, defaultPatterns: patterns)
+    }
+
+    private func write(_ relativePath: String, _ content: String = "") throws {
+        let url = directory.appendingPathComponent(relativePath)
+        try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+        try Data(content.utf8).write(to: url)
+    }
+
+    private func walk(_ root: String) -> [String] {
+        final class Paths: @unchecked Sendable {
+            var values: [String] = []
+        }
+        let paths = Paths()
+        let done = expectation(description: "walk")
+        let walker = ParallelDirectoryWalker(
+            rootPath: root,
+            matcher: GitignoreMatcher.root(at: root, defaultPatterns: [".git", "node_modules"])
+        )
+        Task.detached {
+            for await batch in walker.walk() {
+                paths.values.append(contentsOf: batch)
+            }
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 120)
+        return paths.values.sorted()
+    }
+
+    // MARK: - Rules
+
+    func testLastMatchingRuleWins() {
+        let matcher = matcher(["*.log", "!keep.log"])
+        XCTAssertTrue(matcher.isIgnored(["debug.log"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["keep.log"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["sub", "trace.log"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["sub", "keep.log"], isDirectory: false))
+    }
+
+    func testDirectoryOnlyRules() {
+        let matcher = matcher(["build/"])
+        XCTAssertTrue(matcher.isIgnored(["build"], isDirectory: true))
+        XCTAssertTrue(matcher.isIgnored(["src", "build"], isDirectory: true))
+        XCTAssertFalse(matcher.isIgnored(["build"], isDirectory: false))
+    }
+
+    func testAnchoredRulesMatchFromTheirDirectory() {
+        let matcher = matcher(["/root-only.txt", "docs/generated"])
+        XCTAssertTrue(matcher.isIgnored(["root-only.txt"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["sub", "root-only.txt"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["docs", "generated"], isDirectory: true))
+        XCTAssertFalse(matcher.isIgnored(["sub", "docs", "generated"], isDirectory: true))
+    }
+
+    func testDoubleStarSegments() {
+        let matcher = matcher(["docs/**/draft.md", "out/**"])
+        XCTAssertTrue(matcher.isIgnored(["docs", "draft.md"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["docs", "a", "b", "draft.md"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["notes", "draft.md"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["out", "x.o"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["out"], isDirectory: true))
+    }
+
+    func testWildcardsAndCharacterClasses() {
+        let matcher = matcher(["a?c", "[0-9]x", "[!a-z]y", "\\#hash", "\\!bang"])
+        XCTAssertTrue(matcher.isIgnored(["abc"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["ac"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["7x"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["ax"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["Ay"], isDirectory: false))
+        XCTAssertFalse(matcher.isIgnored(["ay"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["#hash"], isDirectory: false))
+        XCTAssertTrue(matcher.isIgnored(["!bang"], isDirectory: false))
+    }
+
+    // MARK: - Walk
+
+    func testWalkAppliesNestedIgnoreFiles() throws {
+        try write(".gitignore", "*.tmp\n")
+        try write("a.swift")
+        try write("a.tmp")
+        try write("node_modules/pkg/index.js")
+        try write("lib/.gitignore", "!keep.tmp\ngenerated/\n")
+        try write("lib/keep.tmp")
+        try write("lib/drop.tmp")
+        try write("lib/generated/out.swift")
+        try write("lib/src/b.swift")
+        try write(".git/info/exclude", "secret.txt\n")
+        try write("secret.txt")
+
+        XCTAssertEqual(walk(directory.path), ["a.swift", "lib/keep.tmp", "lib/src/b.swift"])
+    }
+
+    // MARK: - Benchmarks
+
+    /// 20k files in 400 directories, a quarter of them under ignored directories or patterns
+    func testWalkBenchmark() throws {
+        try write(".gitignore", "*.o\nbuild/\n!keep.o\n")
+        for dir in 0..<400 {
+            let base = dir % 10 == 0 ? "module\(dir)/build" : "module\(dir)/src"
+            try write("module\(dir)/.gitignore", dir % 2 == 0 ? "*.gen.swift\n" : "")
+            for file in 0..<50 {
+                let name = file % 5 == 0 ? "file\(file).o" : "file\(file).swift"
+                try write("\(base)/\(name)")
+            }
+        }
+
+        var count = 0
+        measure(metrics: [XCTClockMetric()]) {
+            count = walk(directory.path).count
+        }
+        // 360 unignored directories with 40 .swift files each
+        XCTAssertEqual(count, 360 * 40)
+    }
+
+    /// Rule evaluation alone over 200k synthetic paths
+    func testMatcherBenchmark() {
+        let matcher = matcher([
+            ".DS_Store", "node_modules", "*.log", "*.o", "build/", "/dist",
+            "docs/**/draft.md", "tmp-[0-9]*", "!important.log",
+        ])
+        let paths = (0..<200_000).map { index -> [String] in
+            ["pkg\(index % 500)", "src\(index % 7)", index % 9 == 0 ? "out\(index).log" : "file\(index).swift"]
+        }
+
+        var ignored = 0
+        measure(metrics: [XCTClockMetric()]) {
+            ignored = paths.reduce(0) { $0 + (matcher.isIgnored($1, isDirectory: false) ? 1 : 0) }
+        }
+        XCTAssertEqual(ignored, (0..<200_000).filter { $0 % 9 == 0 }.count)
+    }
+}
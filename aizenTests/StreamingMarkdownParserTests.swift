@@ -0,0 +1,131 @@
+//
+//  StreamingMarkdownParserTests.swift
+//  aizenTests
+//
+//  Replaying streamed responses must match a single parse of the whole text
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class StreamingMarkdownParserTests: XCTestCase {
+
+    private func section(_ number: Int) -> String {
+        """
+        ## Section \(number)
+
+        Paragraph \(number) with **bold**, `code`, a [link](https://example.com/\(number)) and café.
+        It continues on a second line.
+
+        - item one \(number)
+        - item two
+
+          continued paragraph inside item two
+
+        1. first
+        2. second
+
+        > quoted \(number)
+        > still quoted
+
+        ```swift
+        let value\(number) = \(number)
+
+        print(value\(number))
+        ```
+
+        ~~~python
+        price = "$$\(number)"
+
+        print(price)
+        ~~~
+
+        $$
+        x_\(number) = \\frac{a}{b}
+        $$
+
+        | a | b |
+        |---|---|
+        | \(number) | \(number + 1) |
+
+        ---
+
+        """
+    }
+
+    private func response(minimumBytes: Int) -> String {
+        var sections: [String] = []
+        var bytes = 0
+        while bytes < minimumBytes {
+            let next = section(sections.count)
+            bytes += next.utf8.count + 1
+            sections.append(next)
+        }
+        return sections.joined(separator: "\n") + "\n"
+    }
+
+    /// Feed `content` in growing prefixes of irregular size, returning every intermediate document
+    private func replay(_ content: String, through parser: StreamingMarkdownParser) -> [ParsedMarkdownDocument] {
+        var documents: [ParsedMarkdownDocument] = []
+        var end = content.startIndex
+        var step = 0
+        while end < content.endIndex {
+            end = content.index(end, offsetBy: 1 + (step * 37) % 97, limitedBy: content.endIndex) ?? content.endIndex
+            step += 1
+            documents.append(parser.update(String(content[..<end])))
+        }
+        return documents
+    }
+
+    func testReplayMatchesSingleParseWithStableIDs() throws {
+        let content = response(minimumBytes: 50_000)
+        let expected = MarkdownParser().parse(content)
+
+        let documents = replay(content, through: StreamingMarkdownParser())
+        let final = try XCTUnwrap(documents.last)
+
+        XCTAssertEqual(final.streamingBuffer, "")
+        XCTAssertEqual(final.blocks.map(\.id), expected.blocks.map(\.id))
+        XCTAssertEqual(final.blocks.map(\.type), expected.blocks.map(\.type))
+
+        // Only the last block of an update may still change; everything before it keeps its ID
+        let finalIDs = final.blocks.map(\.id)
+        for (step, document) in documents.enumerated() {
+            let settled = document.blocks.dropLast().map(\.id)
+            XCTAssertEqual(Array(finalIDs.prefix(settled.count)), settled, "update \(step)")
+        }
+    }
+
+    func testTildeFenceWithBlankLinesStaysOneCodeBlock() {
+        let parser = StreamingMarkdownParser()
+        let content = "Intro\n\n~~~\nfirst\n\nsecond ``` not a fence\n\n$$ not math\n~~~\n\nAfter\n\n"
+
+        for document in replay(content, through: parser) {
+            let codeBlocks = document.blocks.filter {
+                if case .codeBlock = $0.type { return true }
+                return false
+            }
+            XCTAssertLessThanOrEqual(codeBlocks.count, 1)
+            XCTAssertFalse(document.blocks.contains {
+                if case .mathBlock = $0.type { return true }
+                return false
+            })
+        }
+
+        let final = parser.update(content)
+        XCTAssertEqual(final.blocks.map(\.id), MarkdownParser().parse(content).blocks.map(\.id))
+        guard final.blocks.count == 3, case .codeBlock(let code, _, _) = final.blocks[1].type else {
+            return XCTFail("expected paragraph, code block, paragraph")
+        }
+        XCTAssertEqual(code, "first\n\nsecond ``` not a fence\n\n$$ not math\n")
+    }
+
+    func testReplacedContentStartsOver() {
+        let parser = StreamingMarkdownParser()
+        _ = parser.update("# Old heading\n\nOld paragraph\n\n")
+
+        let replaced = "New paragraph\n\n"
+        XCTAssertEqual(parser.update(replaced).blocks.map(\.id), MarkdownParser().parse(replaced).blocks.map(\.id))
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  TrigramIndexTests.swift
+//  aizenTests
+//
+//  Trigram queries, index persistence and candidate narrowing
+//
+
+import XCTest
+@testable import aiX
+
+@MainActor
+final class TrigramIndexTests: XCTestCase {
+    private var directory: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory
+            .appendingPathComponent("TrigramIndexTests-\(UUID().uuidString)", isDirectory: true)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    private func trigrams(of text: String) -> [UInt32] {
+        Array(text.utf8).withUnsafeBufferPointer { Trigram.extract(from: $0) }
+    }
+
+    private func oid(_ number: Int) -> String {
+        String(format: "%040x", number)
+    }
+
+    // MARK: - Trigram.query
+
+    func testQueryIsSortedDeduplicatedAndCaseFolded() {
+        let query = Trigram.query("abcABC")
+        XCTAssertEqual(query, query.sorted())
+        XCTAssertEqual(query.count, 3) // abc, bca, cab
+        XCTAssertEqual(Trigram.query("ABC"), Trigram.query("abc"))
+    }
+
+    func testShortQueryHasNoTrigrams() {
+        XCTAssertTrue(Trigram.query("").isEmpty)
+        XCTAssertTrue(Trigram.query("ab").isEmpty)
+    }
+
+    func testQueryTrigramsAreContainedInMatchingText() {
+        let text = Set(trigrams(of: "let value = Needle(haystack)"))
+        XCTAssertTrue(Set(Trigram.query("needle")).isSubset(of: text))
+        XCTAssertFalse(Set(Trigram.query("needles")).isSubset(of: text))
+    }
+
+    // MARK: - Candidate narrowing
+
+    func testCandidatesNarrowToBlobsWithEveryTrigram() {
+        let store = TrigramIndexStore(directory: directory)
+        let match = store.addBlob(oid: oid(1), trigrams: trigrams(of: "func findNeedle()"))
+        let partial = store.addBlob(oid: oid(2), trigrams: trigrams(of: "need a needle-less file"))
+        store.addBlob(oid: oid(3), trigrams: trigrams(of: "nothing here"))
+        let unindexed = store.addBlob(oid: oid(4), trigrams: nil)
+
+        XCTAssertEqual(store.candidates(containingAll: Trigram.query("findneedle")), [match, unindexed])
+        XCTAssertEqual(store.candidates(containingAll: Trigram.query("needle")), [match, partial, unindexed])
+        XCTAssertEqual(store.candidates(containingAll: Trigram.query("absent")), [unindexed])
+    }
+
+    func testAddingKnownBlobKeepsItsOrdinal() {
+        let store = TrigramIndexStore(directory: directory)
+        let first = store.addBlob(oid: oid(1), trigrams: trigrams(of: "first"))
+        XCTAssertEqual(store.addBlob(oid: oid(1), trigrams: trigrams(of: "other")), first)
+        XCTAssertEqual(store.candidates(containingAll: Trigram.query("other")), [])
+    }
+
+    // MARK: - Persistence
+
+    func testFlushedBlobsSurviveReload() {
+        let store = TrigramIndexStore(directory: directory)
+        let match = store.addBlob(oid: oid(1), trigrams: trigrams(of: "struct Needle {}"))
+        store.addBlob(oid: oid(2), trigrams: trigrams(of: "enum Other {}"))
+        let unindexed = store.addBlob(oid: oid(3), trigrams: nil)
+        store.flush()
+
+        let reloaded = TrigramIndexStore(directory: directory)
+        XCTAssertEqual(reloaded.ordinal(forBlob: oid(1)), match)
+        XCTAssertEqual(reloaded.ordinal(forBlob: oid(3)), unindexed)
+        XCTAssertEqual(reloaded.candidates(containingAll: Trigram.query("needle")), [match, unindexed])
+    }
+
+    func testUnflushedBlobsAreDroppedOnReload() {
+        let store = TrigramIndexStore(directory: directory)
+        store.addBlob(oid: oid(1), trigrams: trigrams(of: "flushed"))
+        store.flush()
+        store.addBlob(oid: oid(2), trigrams: trigrams(of: "pending"))
+
+        let reloaded = TrigramIndexStore(directory: directory)
+        XCTAssertNotNil(reloaded.ordinal(forBlob: oid(1)))
+        XCTAssertNil(reloaded.ordinal(forBlob: oid(2)))
+    }
+
+    func testIncrementalFlushesKeepEarlierPostings() {
+        let store = TrigramIndexStore(directory: directory)
+        var expected: Set<UInt32> = []
+        for number in 0..<40 {
+            let text = number % 4 == 0 ? "needle \(number)" : "hay \(number)"
+            let ordinal = store.addBlob(oid: oid(number), trigrams: trigrams(of: text))
+            if number % 4 == 0 {
+                expected.insert(ordinal)
+            }
+            // Small flushes go to the delta segment, larger ones merge into the base
+            if number % 3 == 0 {
+                store.flush()
+            }
+        }
+        store.flush()
+
+        let reloaded = TrigramIndexStore(directory: directory)
+        XCTAssertEqual(reloaded.candidates(containingAll: Trigram.query("needle")), expected)
+        XCTAssertEqual(reloaded.ordinal(forBlob: oid(39)), 39)
+    }
+
+    // MARK: - Blob identity
+
+    func testBlobHashMatchesGit() {
+        let hello = Data("hello\n".utf8)
+        hello.withUnsafeBytes { bytes in
+            XCTAssertTrue(FileContentIndexService.isBlob(bytes, oid: "ce013625030ba8dba906f756967f9e9ca394464a"))
+            XCTAssertFalse(FileContentIndexService.isBlob(bytes, oid: "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"))
+        }
+        Data().withUnsafeBytes { bytes in
+            XCTAssertTrue(FileContentIndexService.isBlob(bytes, oid: "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"))
+        }
+    }
+}
@@ -0,0 +1,153 @@
+//
+//  WorkflowLogTailTests.swift
+//  aizenTests
+//
+//  Tailing a growing job log through a provider into WorkflowLogs
+//
+
+import XCTest
+@testable import aiX
+
+/// Serves a log that grows between polls. Tails are answered the way a provider that honors
+/// byte ranges does: from one byte early, checking that byte is the line break the previous
+/// tail ended on, and falling back to the whole log marked as a reset.
+private actor FakeWorkflowProvider: WorkflowProviderProtocol {
+    nonisolated let provider: WorkflowProvider = .gitlab
+
+    private var log = Data()
+    private(set) var fullFetches = 0
+
+    func write(_ text: String) {
+        log.append(Data(text.utf8))
+    }
+
+    func replace(with text: String) {
+        log = Data(text.utf8)
+    }
+
+    func getLogTail(repoPath: String, runId: String, job: WorkflowJob, offset: Int, firstLineId: Int) async throws -> WorkflowLogTail {
+        let jobFinished = job.status == .completed
+        if offset > 0, offset <= log.count, log[offset - 1] == 0x0A {
+            let (text, end) = completeLines(of: log, from: offset, jobFinished: jobFinished)
+            return WorkflowLogTail(text: text, lines: [], nextOffset: end, isReset: false)
+        }
+
+        fullFetches += 1
+        let (text, end) = completeLines(of: log, from: 0, jobFinished: jobFinished)
+        return WorkflowLogTail(text: text, lines: [], nextOffset: end, isReset: offset > 0)
+    }
+
+    func listWorkflows(repoPath: String) async throws -> [Workflow] { [] }
+    func getWorkflowInputs(repoPath: String, workflow: Workflow) async throws -> [WorkflowInput] { [] }
+    func listRuns(repoPath: String, workflow: Workflow?, branch: String?, limit: Int) async throws -> [WorkflowRun] { [] }
+    func getRun(repoPath: String, runId: String) async throws -> WorkflowRun { throw WorkflowError.workflowNotFound(runId) }
+    func getRunJobs(repoPath: String, runId: String) async throws -> [WorkflowJob] { [] }
+    func triggerWorkflow(repoPath: String, workflow: Workflow, branch: String, inputs: [String: String]) async throws -> WorkflowRun? { nil }
+    func cancelRun(repoPath: String, runId: String) async throws {}
+    func getRunLogs(repoPath: String, runId: String, jobId: String?) async throws -> String { "" }
+    func checkAuthentication() async -> Bool { true }
+}
+
+@MainActor
+final class WorkflowLogTailTests: XCTestCase {
+    private var provider: FakeWorkflowProvider!
+    private var logs: WorkflowLogs?
+    private var offset = 0
+
+    override func setUp() {
+        provider = FakeWorkflowProvider()
+        logs = nil
+        offset = 0
+    }
+
+    private func job(_ status: RunStatus) -> WorkflowJob {
+        WorkflowJob(id: "42", name: "build", status: status, conclusion: nil, startedAt: nil, completedAt: nil, steps: [])
+    }
+
+    /// One poll, applied the way WorkflowService shows a tail: appended in place when it
+    /// continues the shown log, otherwise replacing it
+    @discardableResult
+    private func poll(_ status: RunStatus = .inProgress) async throws -> WorkflowLogTail {
+        let tail = try await provider.getLogTail(
+            repoPath: "/repo", runId: "1", job: job(status), offset: offset, firstLineId: logs?.lineCount ?? 0
+        )
+        offset = tail.nextOffset
+        if !tail.isReset, let current = logs {
+            if !tail.text.isEmpty {
+                logs = current.appending(tail)
+            }
+        } else {
+            logs = WorkflowLogs(runId: "1", jobId: "42", hasSteps: false, tail: tail)
+        }
+        return tail
+    }
+
+    func testTailsContinueFromTheOffset() async throws {
+        await provider.write("step 1\nstep 2\n")
+        try await poll()
+        let buffer = try XCTUnwrap(logs?.buffer)
+
+        await provider.write("step 3\n")
+        let tail = try await poll()
+        XCTAssertEqual(tail.text, "step 3\n")
+        XCTAssertFalse(tail.isReset)
+        XCTAssertEqual(offset, 21)
+
+        XCTAssertTrue(logs?.buffer === buffer)
+        XCTAssertEqual(logs?.chunkCount, 2)
+        XCTAssertEqual(logs?.content, "step 1\nstep 2\nstep 3\n")
+        let fullFetches = await provider.fullFetches
+        XCTAssertEqual(fullFetches, 1)
+    }
+
+    func testUnchangedLogAddsNothing() async throws {
+        await provider.write("only line\n")
+        try await poll()
+
+        let tail = try await poll()
+        XCTAssertEqual(tail.text, "")
+        XCTAssertEqual(logs?.chunkCount, 1)
+        XCTAssertEqual(logs?.byteCount, 10)
+    }
+
+    func testPartialLineIsHeldBackUntilComplete() async throws {
+        await provider.write("done\nhalf a li")
+        try await poll()
+        XCTAssertEqual(logs?.content, "done\n")
+        XCTAssertEqual(offset, 5)
+
+        await provider.write("ne\nnext")
+        try await poll()
+        XCTAssertEqual(logs?.content, "done\nhalf a line\n")
+
+        // A finished job's last line won't get its line break
+        try await poll(.completed)
+        XCTAssertEqual(logs?.content, "done\nhalf a line\nnext")
+        XCTAssertEqual(logs?.chunkCount, 3)
+    }
+
+    func testRewrittenLogResets() async throws {
+        await provider.write("attempt 1\nfailed\n")
+        try await poll()
+        let firstBuffer = try XCTUnwrap(logs?.buffer)
+
+        // A re-run replaces the log; the byte before the old offset is no longer a line break
+        await provider.replace(with: "attempt 2 starting\nok\n")
+        let tail = try await poll()
+        XCTAssertTrue(tail.isReset)
+        XCTAssertFalse(logs?.buffer === firstBuffer)
+        XCTAssertEqual(logs?.content, "attempt 2 starting\nok\n")
+        XCTAssertEqual(offset, 22)
+    }
+
+    func testShorterLogResets() async throws {
+        await provider.write("line 1\nline 2\nline 3\n")
+        try await poll()
+
+        await provider.replace(with: "new\n")
+        let tail = try await poll()
+        XCTAssertTrue(tail.isReset)
+        XCTAssertEqual(logs?.content, "new\n")
+        XCTAssertEqual(logs?.lineCount, 0)
+    }
+}